@@ -0,0 +1,51 @@
+#-------------------------------------------------
+#
+# Throughput of the parsers, built with the rest of the project
+#
+#-------------------------------------------------
+
+QT += core
+QT -= gui
+
+TARGET = parserbenchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+configfile = ../kryolibs/config/qryomol.pri
+include($${configfile} )
+
+#the sample outputs read by default
+DEFINES += KRYOMOL_SOURCE_DIR=\\\"$$PWD/..\\\"
+
+INCLUDEPATH += ../kryolibs/core ../kryolibs/tools ../kryolibs/parsers ../kryolibs/plugin ../kryolibs/plugin/tools
+
+win32{
+
+  CONFIG(debug, debug|release){
+    LIBS += -L../kryolibs/parsers/debug -L../kryolibs/core/debug -L../kryolibs/tools/debug/
+  }
+  CONFIG(release, debug|release){
+    LIBS += -L../kryolibs/parsers/release -L../kryolibs/core/release -L../kryolibs/tools/release
+  }
+}
+
+LIBS += -L../kryolibs/parsers -L../kryolibs/core -L../kryolibs/tools
+LIBS += -lqryomolparsers -lqryomolcore -lqryomoltools
+
+libbasepath=
+!equals($$IN_PWD,$$OUT_PWD) {
+libbasepath=$$OUT_PWD/../kryolibs
+} else {
+libbasepath=$$IN_PWD/../kryolibs
+}
+
+unix {
+POST_TARGETDEPS += $$libbasepath/tools/libqryomoltools.a \
+                   $$libbasepath/core/libqryomolcore.a \
+                   $$libbasepath/parsers/libqryomolparsers.a
+}
+
+DEFINES += KRYOMOLSTATIC
+
+SOURCES += parserbenchmark.cpp
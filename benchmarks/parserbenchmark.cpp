@@ -0,0 +1,523 @@
+/*****************************************************************************************
+                            parserbenchmark.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+/* Throughput of the parsers over the sample outputs of the source tree, or the files and folders given.
+   Every file is read through ParserFactory as KryoMol reads it, and the time, the allocations and the peak
+   resident memory of each phase are reported by parser: format detection, Jobs(), Parse, ParseFrequencies and
+   ParseUV. Each input is also read scaled: concatenated several times, which gives more jobs or frames, and the
+   frames of optimizations and trajectories repeated in a multi-structure XYZ file. A Molden file with a large
+   basis set is generated to measure the reading of molecular orbitals.
+
+   parserbenchmark [--repeat n] [--scale n] [--basis n] [--csv file] [files or folders]*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#include "parserfactory.h"
+#include "parser.h"
+#include "structurewriter.h"
+#include "molecule.h"
+#include "atom.h"
+
+#ifndef KRYOMOL_SOURCE_DIR
+#define KRYOMOL_SOURCE_DIR "."
+#endif
+
+namespace
+{
+    /** allocations made with new since the program started, and their bytes*/
+    std::atomic<size_t> allocations ( 0 );
+    std::atomic<size_t> allocatedbytes ( 0 );
+}
+
+void* operator new ( std::size_t n )
+{
+    ++allocations;
+    allocatedbytes+=n;
+    void* p=std::malloc ( n == 0 ? 1 : n );
+    if ( p == NULL ) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete ( void* p ) noexcept { std::free ( p ); }
+void operator delete ( void* p, std::size_t ) noexcept { std::free ( p ); }
+
+namespace
+{
+    const char* phases[]= { "detection", "jobs", "parse", "frequencies", "uv" };
+    enum phase { DETECTION, JOBS, PARSE, FREQUENCIES, UV, NPHASES };
+
+    const char* FileTypeName ( kryomol::ParserFactory::filetype type )
+    {
+        static const char* names[]= { "None", "Aces", "Gaussian", "GaussianArchive", "GaussianInput", "GaussianFile",
+                                      "GaussianCube", "Gamess", "MdlV2000", "PDB", "MacroModel", "Maestro", "NwChem",
+                                      "XYZ", "HyperChem", "PCModel", "Orca", "FChk", "Molden", "OrcaHessian" };
+        const size_t i=static_cast<size_t> ( type );
+        return i < sizeof ( names ) /sizeof ( const char* ) ? names[i] : "Unknown";
+    }
+
+    /** reset the peak resident memory of the process, where the system allows it*/
+    void ResetPeakMemory()
+    {
+#if defined(Q_OS_LINUX)
+        std::ofstream clear ( "/proc/self/clear_refs" );
+        clear << "5";
+#endif
+    }
+
+    /** @return the peak resident memory of the process in bytes since the last reset, or since it started*/
+    size_t PeakMemory()
+    {
+#if defined(Q_OS_LINUX)
+        std::ifstream status ( "/proc/self/status" );
+        std::string line;
+        while ( std::getline ( status,line ) )
+        {
+            if ( line.compare ( 0,6,"VmHWM:" ) == 0 ) return std::strtoul ( line.c_str()+6,NULL,10 ) *1024;
+        }
+#endif
+#if defined(Q_OS_UNIX)
+        struct rusage usage;
+        if ( getrusage ( RUSAGE_SELF,&usage ) == 0 )
+        {
+#if defined(Q_OS_MACOS)
+            return static_cast<size_t> ( usage.ru_maxrss );
+#else
+            return static_cast<size_t> ( usage.ru_maxrss ) *1024;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+    /** @brief cost of a phase: wall time, allocations and peak resident memory*/
+    struct Sample
+    {
+        Sample() : seconds ( 0 ), allocations ( 0 ), bytes ( 0 ), peak ( 0 ), runs ( 0 ) {}
+        double seconds;
+        size_t allocations;
+        size_t bytes;
+        size_t peak;
+        /** times the phase was run, 0 if it was not*/
+        size_t runs;
+        /** add @param s, a part of the same phase*/
+        void Add ( const Sample& s )
+        {
+            seconds+=s.seconds;
+            allocations+=s.allocations;
+            bytes+=s.bytes;
+            peak=std::max ( peak,s.peak );
+            runs+=s.runs;
+        }
+    };
+
+    /** @brief measure of the phase run between the construction and Stop*/
+    class Probe
+    {
+    public:
+        Probe() : m_allocations ( allocations ), m_bytes ( allocatedbytes )
+        {
+            ResetPeakMemory();
+            m_start=std::chrono::steady_clock::now();
+        }
+        Sample Stop() const
+        {
+            Sample s;
+            s.seconds=std::chrono::duration<double> ( std::chrono::steady_clock::now()-m_start ).count();
+            s.allocations=allocations-m_allocations;
+            s.bytes=allocatedbytes-m_bytes;
+            s.peak=PeakMemory();
+            s.runs=1;
+            return s;
+        }
+    private:
+        std::chrono::steady_clock::time_point m_start;
+        size_t m_allocations;
+        size_t m_bytes;
+    };
+
+    /** @brief the phases of a file read once*/
+    struct Run
+    {
+        Run() : type ( kryomol::ParserFactory::None ), ok ( true ), nframes ( 0 ) {}
+        kryomol::ParserFactory::filetype type;
+        Sample phase[NPHASES];
+        /** false if a phase threw*/
+        bool ok;
+        /** the molecules of the job with most frames, kept to write the inflated copy*/
+        std::vector<kryomol::Molecule> molecules;
+        size_t nframes;
+    };
+
+    /** read @param file as KryoMol opens it, every job parsed and its spectra read*/
+    void ReadFile ( const std::string& file, Run& run )
+    {
+        Probe detection;
+        kryomol::ParserFactory factory ( file.c_str() );
+        run.type=factory.GetFileType();
+        factory.Capabilities();
+        kryomol::Parser* parser=factory.BuildParser();
+        run.phase[DETECTION]=detection.Stop();
+        if ( parser == NULL ) return;
+
+        try
+        {
+            Probe jobs;
+            const std::vector<kryomol::JobHeader> headers=parser->Jobs();
+            run.phase[JOBS]=jobs.Stop();
+
+            for ( const kryomol::JobHeader& j : headers )
+            {
+                std::vector<kryomol::Molecule> molecules;
+                parser->SetMolecules ( &molecules );
+                Probe parse;
+                parser->Parse ( j.pos );
+                run.phase[PARSE].Add ( parse.Stop() );
+                if ( j.type == kryomol::freq )
+                {
+                    Probe frequencies;
+                    parser->ParseFrequencies ( j.pos );
+                    run.phase[FREQUENCIES].Add ( frequencies.Stop() );
+                }
+                if ( j.type == kryomol::uv )
+                {
+                    Probe uv;
+                    parser->ParseUV ( j.pos );
+                    run.phase[UV].Add ( uv.Stop() );
+                }
+                if ( !molecules.empty() && molecules.back().Frames().size() > run.nframes )
+                {
+                    run.nframes=molecules.back().Frames().size();
+                    run.molecules.swap ( molecules );
+                }
+            }
+        }
+        catch ( const std::exception& e )
+        {
+            std::cerr << file << ": " << e.what() << std::endl;
+            run.ok=false;
+        }
+        catch ( ... )
+        {
+            run.ok=false;
+        }
+        delete parser;
+    }
+
+    /** @brief results of a file, the fastest of the runs of each phase*/
+    struct Result
+    {
+        std::string file;
+        std::string label;
+        size_t size;
+        Run best;
+    };
+
+    Result Measure ( const std::string& file, const std::string& label, size_t repeat )
+    {
+        Result r;
+        r.file=file;
+        r.label=label;
+        r.size=static_cast<size_t> ( QFileInfo ( QString::fromStdString ( file ) ).size() );
+        for ( size_t i=0;i<repeat;++i )
+        {
+            Run run;
+            ReadFile ( file,run );
+            if ( i == 0 )
+            {
+                r.best=std::move ( run );
+                continue;
+            }
+            for ( size_t p=0;p<NPHASES;++p )
+            {
+                if ( run.phase[p].runs > 0 && run.phase[p].seconds < r.best.phase[p].seconds ) r.best.phase[p]=run.phase[p];
+            }
+        }
+        return r;
+    }
+
+    /** @return the files of @param path, all the files below it if it is a folder*/
+    void CollectFiles ( const QString& path, std::vector<std::string>& files )
+    {
+        QFileInfo info ( path );
+        if ( info.isFile() )
+        {
+            files.push_back ( QFile::encodeName ( info.absoluteFilePath() ).toStdString() );
+            return;
+        }
+        std::vector<std::string> found;
+        QDirIterator it ( path,QDir::Files,QDirIterator::Subdirectories );
+        while ( it.hasNext() )
+            found.push_back ( QFile::encodeName ( it.next() ).toStdString() );
+        std::sort ( found.begin(),found.end() );
+        files.insert ( files.end(),found.begin(),found.end() );
+    }
+
+    std::string BaseName ( const std::string& file )
+    {
+        return QFileInfo ( QString::fromStdString ( file ) ).fileName().toStdString();
+    }
+
+    /** write @param file @param n times in @param copy, more jobs for outputs and more frames for structure files*/
+    bool Concatenate ( const std::string& file, size_t n, const std::string& copy )
+    {
+        std::ifstream in ( file.c_str(),std::ios::binary );
+        std::stringstream text;
+        text << in.rdbuf();
+        std::ofstream out ( copy.c_str(),std::ios::binary );
+        const std::string s=text.str();
+        for ( size_t i=0;i<n && out;++i ) out.write ( s.data(),s.size() );
+        return static_cast<bool> ( out );
+    }
+
+    /** write the frames of @param molecule @param n times over in the multi-structure XYZ file @param copy*/
+    bool InflateFrames ( const kryomol::Molecule& molecule, size_t n, const std::string& copy )
+    {
+        const size_t nframes=molecule.Frames().size();
+        std::vector<size_t> frames ( n*nframes );
+        for ( size_t i=0;i<frames.size();++i ) frames[i]=i%nframes;
+        kryomol::StructureWriter writer ( &molecule,kryomol::StructureWriter::XYZ );
+        writer.SetFrames ( frames );
+        return writer.Write ( QString::fromStdString ( copy ) );
+    }
+
+    /** write a Molden file of a chain of carbon atoms with about @param nbasis basis functions, eight s and four
+        p shells on each atom, and as many molecular orbitals*/
+    bool LargeBasis ( size_t nbasis, const std::string& file )
+    {
+        const size_t natoms=std::max<size_t> ( 1,nbasis/20 );
+        nbasis=20*natoms;
+        std::ofstream out ( file.c_str() );
+        char buffer[128];
+        out << "[Molden Format]\n[Atoms] Angs\n";
+        for ( size_t i=0;i<natoms;++i )
+        {
+            std::snprintf ( buffer,sizeof ( buffer ),"C %6zu 6 %12.6f %12.6f %12.6f\n",i+1,1.5*i,0.1* ( i%2 ),0.0 );
+            out << buffer;
+        }
+        out << "[GTO]\n";
+        for ( size_t i=0;i<natoms;++i )
+        {
+            out << "  " << i+1 << " 0\n";
+            for ( size_t s=0;s<12;++s )
+            {
+                out << ( s < 8 ? " s" : " p" ) << "    1 1.00\n";
+                std::snprintf ( buffer,sizeof ( buffer )," %20.10E %20.10E\n",0.1*std::pow ( 2.5,double ( s%8 ) ),1.0 );
+                out << buffer;
+            }
+            out << "\n";
+        }
+        out << "[MO]\n";
+        for ( size_t j=0;j<nbasis;++j )
+        {
+            std::snprintf ( buffer,sizeof ( buffer )," Sym= A\n Ene= %12.6f\n Spin= Alpha\n Occup= %8.6f\n",
+                            -10.0+20.0*j/nbasis,j < nbasis/4 ? 2.0 : 0.0 );
+            out << buffer;
+            for ( size_t k=0;k<nbasis;++k )
+            {
+                std::snprintf ( buffer,sizeof ( buffer ),"%5zu %12.6f\n",k+1,std::sin ( 0.37*double ( j+1 ) *double ( k+1 ) ) );
+                out << buffer;
+            }
+        }
+        return static_cast<bool> ( out );
+    }
+
+    /** @brief phase totals of a parser*/
+    struct Total
+    {
+        Total() : size ( 0 ) {}
+        size_t size;
+        Sample phase;
+    };
+
+    double MB ( double bytes ) { return bytes/ ( 1024.0*1024.0 ); }
+
+    double Rate ( size_t size, double seconds ) { return seconds > 0 ? MB ( size ) /seconds : 0.0; }
+
+    void Report ( const std::vector<Result>& results, std::ostream& s )
+    {
+        char line[256];
+        std::snprintf ( line,sizeof ( line ),"%-44s %-15s %-11s %9s %10s %9s %11s %10s %9s\n","file","parser","phase","MB",
+                        "seconds","MB/s","allocations","alloc MB","peak MB" );
+        s << line;
+        std::map<std::string,Total> totals;
+        for ( const Result& r : results )
+        {
+            const std::string parser=FileTypeName ( r.best.type );
+            for ( size_t p=0;p<NPHASES;++p )
+            {
+                const Sample& sample=r.best.phase[p];
+                if ( sample.runs == 0 ) continue;
+                std::snprintf ( line,sizeof ( line ),"%-44.44s %-15s %-11s %9.2f %10.4f %9.1f %11zu %10.2f %9.1f%s\n",
+                                r.label.c_str(),parser.c_str(),phases[p],MB ( r.size ),sample.seconds,Rate ( r.size,sample.seconds ),
+                                sample.allocations,MB ( sample.bytes ),MB ( sample.peak ),r.best.ok ? "" : " failed" );
+                s << line;
+                Total& t=totals[parser+"\t"+phases[p]];
+                t.size+=r.size;
+                t.phase.Add ( sample );
+            }
+        }
+
+        s << "\n";
+        std::snprintf ( line,sizeof ( line ),"%-15s %-11s %9s %10s %9s %11s %10s %9s\n","parser","phase","MB","seconds","MB/s",
+                        "allocations","alloc MB","peak MB" );
+        s << line;
+        for ( const auto& t : totals )
+        {
+            const size_t tab=t.first.find ( '\t' );
+            std::snprintf ( line,sizeof ( line ),"%-15s %-11s %9.2f %10.4f %9.1f %11zu %10.2f %9.1f\n",
+                            t.first.substr ( 0,tab ).c_str(),t.first.substr ( tab+1 ).c_str(),MB ( t.second.size ),t.second.phase.seconds,
+                            Rate ( t.second.size,t.second.phase.seconds ),t.second.phase.allocations,MB ( t.second.phase.bytes ),
+                            MB ( t.second.phase.peak ) );
+            s << line;
+        }
+    }
+
+    void WriteCSV ( const std::vector<Result>& results, std::ostream& s )
+    {
+        s << "file,parser,phase,bytes,seconds,allocations,allocated bytes,peak bytes,failed\n";
+        for ( const Result& r : results )
+        {
+            for ( size_t p=0;p<NPHASES;++p )
+            {
+                const Sample& sample=r.best.phase[p];
+                if ( sample.runs == 0 ) continue;
+                s << r.label << "," << FileTypeName ( r.best.type ) << "," << phases[p] << "," << r.size << "," << sample.seconds << ","
+                  << sample.allocations << "," << sample.bytes << "," << sample.peak << "," << ( r.best.ok ? 0 : 1 ) << "\n";
+            }
+        }
+    }
+
+    void Usage()
+    {
+        std::cerr << "parserbenchmark [--repeat n] [--scale n] [--basis n] [--csv file] [files or folders]\n"
+                  << "  --repeat n  read every file n times and keep the fastest, 3 by default\n"
+                  << "  --scale n   read also the files concatenated n times and the frames of optimizations\n"
+                  << "              and trajectories repeated n times, 8 by default, 0 reads only the files\n"
+                  << "  --basis n   read also a Molden file of about n basis functions, 1500 by default, 0 for none\n"
+                  << "  --csv file  write the results to file as comma separated values\n"
+                  << "The tests and examples folders of the source tree are read when no file is given" << std::endl;
+    }
+}
+
+int main ( int argc, char* argv[] )
+{
+    kryomol::BuildPeriodicTable();
+
+    size_t repeat=3;
+    size_t scale=8;
+    size_t nbasis=1500;
+    std::string csv;
+    std::vector<std::string> files;
+    for ( int i=1;i<argc;++i )
+    {
+        const std::string arg=argv[i];
+        if ( ( arg == "--repeat" || arg == "--scale" || arg == "--basis" || arg == "--csv" ) && i+1 < argc )
+        {
+            const std::string value=argv[++i];
+            if ( arg == "--csv" ) csv=value;
+            else
+            {
+                const size_t n=std::strtoul ( value.c_str(),NULL,10 );
+                if ( arg == "--repeat" ) repeat=std::max<size_t> ( n,1 );
+                else if ( arg == "--scale" ) scale=n;
+                else nbasis=n;
+            }
+        }
+        else if ( arg == "-h" || arg == "--help" || arg.compare ( 0,2,"--" ) == 0 )
+        {
+            Usage();
+            return arg.compare ( 0,2,"--" ) == 0 && arg != "--help" ? 1 : 0;
+        }
+        else
+            CollectFiles ( QFile::decodeName ( argv[i] ),files );
+    }
+    if ( files.empty() )
+    {
+        const QString source=QStringLiteral ( KRYOMOL_SOURCE_DIR );
+        CollectFiles ( source+"/tests",files );
+        CollectFiles ( source+"/examples",files );
+    }
+    if ( files.empty() )
+    {
+        Usage();
+        return 1;
+    }
+
+    QTemporaryDir scratch;
+    const std::string dir=QFile::encodeName ( scratch.path() ).toStdString()+"/";
+
+    std::vector<Result> results;
+    for ( const std::string& file : files )
+    {
+        results.push_back ( Measure ( file,BaseName ( file ),repeat ) );
+        //the molecules read are kept only to write the inflated copy, not to weigh on the next files
+        std::vector<kryomol::Molecule> molecules;
+        molecules.swap ( results.back().best.molecules );
+        if ( scale < 2 || !scratch.isValid() || results.back().best.type == kryomol::ParserFactory::None ) continue;
+
+        //the inputs scaled, the frames inflated only for optimizations and trajectories
+        const std::string label=BaseName ( file )+" x"+std::to_string ( scale );
+        const std::string copy=dir+label;
+        if ( molecules.size() > 0 && molecules.back().Frames().size() > 1 )
+        {
+            const std::string xyz=copy+".xyz";
+            if ( InflateFrames ( molecules.back(),scale,xyz ) )
+            {
+                molecules.clear();
+                results.push_back ( Measure ( xyz,label+" frames",repeat ) );
+            }
+            std::remove ( xyz.c_str() );
+        }
+        molecules.clear();
+
+        if ( Concatenate ( file,scale,copy ) ) results.push_back ( Measure ( copy,label+" jobs",repeat ) );
+        std::remove ( copy.c_str() );
+    }
+
+    if ( nbasis > 0 && scratch.isValid() )
+    {
+        const std::string molden=dir+"basis"+std::to_string ( nbasis )+".molden";
+        if ( LargeBasis ( nbasis,molden ) ) results.push_back ( Measure ( molden,BaseName ( molden ),repeat ) );
+        std::remove ( molden.c_str() );
+    }
+
+    //the parsers write the formats they find, leave the table apart
+    std::cout << std::endl;
+    Report ( results,std::cout );
+    if ( !csv.empty() )
+    {
+        std::ofstream out ( csv.c_str() );
+        WriteCSV ( results,out );
+    }
+    return 0;
+}
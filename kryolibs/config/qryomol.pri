@@ -4,6 +4,7 @@ QT += widgets
 #CONFIG += cuda
 
 CONFIG += timers
+CONFIG += openmp
 #CONFIG += noverbose
 CONFIG += sse
 
@@ -22,7 +23,15 @@ win32 {
   mkl {
   INCLUDEPATH+=$$(MKLROOT)/include
   }
-  CONFIG+= c++17
+}
+
+#std::string_view and std::from_chars in the parsers
+CONFIG += c++17
+
+#compressed outputs: gzip with the zlib of Qt, xz with liblzma when it is installed
+CONFIG += zlib
+unix:packagesExist(liblzma) {
+CONFIG += lzma
 }
 
 
@@ -34,6 +43,29 @@ noverbose {
 DEFINES += QT_NO_DEBUG_OUTPUT
 }
 
+zlib {
+ DEFINES += WITH_ZLIB
+ win32 {
+ #the zlib built in QtCore
+ INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
+ } else {
+ LIBS += -lz
+ }
+}
+
+lzma {
+ DEFINES += WITH_LZMA
+ LIBS += -llzma
+}
+
+openmp {
+ !macx {
+ QMAKE_CXXFLAGS += -fopenmp
+ QMAKE_LFLAGS += -fopenmp
+ DEFINES += WITH_OPENMP
+ }
+}
+
 sse {
  unix {
  #QMAKE_CXXFLAGS += -mmmx -mfpmath=sse -msse -msse2 -msse3  -Wno-narrowing
@@ -38,10 +38,8 @@ void Animation::OnAnimationTimer()
     m_direction*=-1;
     m_counter=0;
   }
-  for (size_t i=0;i<m_molecule.CurrentFrame().XYZ().size();++i)
-  {
-      m_molecule.CurrentFrame().XYZ().at(i) += m_molecule.GetMode().at(m_animationmode).at(i)*m_direction*0.1;
-  }
+  if ( m_animationmode < 0 || static_cast<size_t>(m_animationmode) >= m_molecule.Modes().Size() ) return;
+  m_molecule.Modes().Displace(m_animationmode,m_direction*0.1,m_molecule.CurrentFrame().XYZ());
 
   emit shot();
   m_counter++;
@@ -62,14 +60,12 @@ void Animation::SetMode(int mode,int frame)
 
 void Animation::SetFrame(int frame)
 {
+  if ( m_animationmode < 0 || static_cast<size_t>(m_animationmode) >= m_molecule.Modes().Size() ) return;
 
   int nframes=frame-m_previousframe[m_animationmode];
   m_previousframe[m_animationmode]=frame;
   const double framescaling=0.10;
-  for (size_t i=0;i<m_molecule.CurrentFrame().XYZ().size();++i)
-  {
-      m_molecule.CurrentFrame().XYZ().at(i) += m_molecule.GetMode().at(m_animationmode).at(i)*nframes*framescaling;
-  }
+  m_molecule.Modes().Displace(m_animationmode,nframes*framescaling,m_molecule.CurrentFrame().XYZ());
 }
 
 void Animation::Start()
@@ -0,0 +1,432 @@
+/*****************************************************************************************
+                            conformerclustering.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <limits>
+#include <map>
+#include <utility>
+
+#include "conformerclustering.h"
+#include "molecule.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+namespace
+{
+    const size_t npos=static_cast<size_t> ( -1 );
+    /** number of frames in each side of the tiles of the rmsd matrix*/
+    const size_t tilesize=32;
+    /** largest group of equivalent atoms whose permutations are enumerated*/
+    const size_t maxgroupsize=4;
+
+    std::vector<size_t> AllIndexes ( size_t n )
+    {
+        std::vector<size_t> v ( n );
+        for ( size_t i=0;i<n;++i ) v[i]=i;
+        return v;
+    }
+
+    /** @return the row with the lowest sum of distances to the other rows of the set*/
+    size_t Medoid ( const RMSDMatrix& matrix, const std::vector<size_t>& rows )
+    {
+        size_t best=rows.front();
+        double bestsum=std::numeric_limits<double>::max();
+        for ( std::vector<size_t>::const_iterator it=rows.begin();it!=rows.end();++it )
+        {
+            double sum=0;
+            for ( std::vector<size_t>::const_iterator jt=rows.begin();jt!=rows.end() && sum < bestsum;++jt )
+                sum+=matrix ( *it,*jt );
+            if ( sum < bestsum )
+            {
+                bestsum=sum;
+                best=*it;
+            }
+        }
+        return best;
+    }
+
+    size_t Find ( std::vector<size_t>& parent, size_t i )
+    {
+        while ( parent[i] != i )
+        {
+            parent[i]=parent[parent[i]];
+            i=parent[i];
+        }
+        return i;
+    }
+
+    struct Merge
+    {
+        size_t a;
+        size_t b;
+        float height;
+    };
+
+    bool MergeLess ( const Merge& x, const Merge& y )
+    {
+        return x.height < y.height;
+    }
+
+    bool IsEmpty ( const std::vector<size_t>& v )
+    {
+        return v.empty();
+    }
+
+    bool LargerCluster ( const std::vector<size_t>& a, const std::vector<size_t>& b )
+    {
+        if ( a.size() != b.size() ) return a.size() > b.size();
+        return a.front() < b.front();
+    }
+}
+
+RMSDMatrix::RMSDMatrix ( const Molecule& molecule, const std::vector<size_t>& frames, const std::vector<size_t>& atoms, bool massweighted ) :
+    m_frames ( frames ), m_superposition ( molecule,atoms,massweighted )
+{
+    if ( m_frames.empty() ) m_frames=AllIndexes ( molecule.FrameCount() );
+    m_coordinates.reserve ( m_frames.size() );
+    //the structures read on demand are read one after the other, only their coordinates are kept
+    kryomol::Frame read ( NULL );
+    for ( std::vector<size_t>::const_iterator it=m_frames.begin();it!=m_frames.end();++it )
+    {
+        if ( *it >= molecule.FrameCount() ) throw kryomol::Exception ( "Frame index out of range in rmsd matrix" );
+        if ( molecule.HasFrameSource() )
+        {
+            if ( !molecule.ReadFrame ( *it,read ) )
+                throw kryomol::Exception ( "a structure of the file could not be read for the rmsd matrix" );
+            m_coordinates.push_back ( m_superposition.Coordinates ( read.XYZ() ) );
+        }
+        else
+            m_coordinates.push_back ( m_superposition.Coordinates ( molecule.Frames() [*it].XYZ() ) );
+    }
+}
+
+void RMSDMatrix::SetEquivalentGroups ( const std::vector< std::vector<size_t> >& groups )
+{
+    //translate atom indexes into positions in the list of fitted atoms
+    std::map<size_t,size_t> position;
+    for ( size_t i=0;i<m_superposition.Atoms().size();++i )
+        position[m_superposition.Atoms() [i]]=i;
+
+    m_groups.clear();
+    for ( std::vector< std::vector<size_t> >::const_iterator gt=groups.begin();gt!=groups.end();++gt )
+    {
+        if ( gt->size() < 2 || gt->size() > maxgroupsize ) continue;
+        std::vector<size_t> g;
+        for ( std::vector<size_t>::const_iterator it=gt->begin();it!=gt->end();++it )
+        {
+            std::map<size_t,size_t>::const_iterator pt=position.find ( *it );
+            if ( pt == position.end() ) break;
+            g.push_back ( pt->second );
+        }
+        if ( g.size() == gt->size() ) m_groups.push_back ( g );
+    }
+}
+
+double RMSDMatrix::PairRMSD ( const FitCoordinates& a, const FitCoordinates& b ) const
+{
+    if ( m_groups.empty() ) return Superposition::Fit ( a,b );
+
+    //one pass of coordinate descent over the groups, trying every permutation of each group
+    FitCoordinates c ( b );
+    double best=Superposition::Fit ( a,c );
+    for ( std::vector< std::vector<size_t> >::const_iterator gt=m_groups.begin();gt!=m_groups.end();++gt )
+    {
+        const std::vector<size_t>& p=*gt;
+        const size_t k=p.size();
+        std::vector<size_t> order=AllIndexes ( k );
+        std::vector<size_t> bestorder=order;
+        std::vector<size_t> count ( k,0 );
+        //Heap's algorithm, a single swap between permutations
+        for ( size_t i=1;i<k; )
+        {
+            if ( count[i] < i )
+            {
+                size_t j= ( i%2 == 0 ) ? 0 : count[i];
+                c.Swap ( p[i],p[j] );
+                std::swap ( order[i],order[j] );
+                double rmsd=Superposition::Fit ( a,c );
+                if ( rmsd < best )
+                {
+                    best=rmsd;
+                    bestorder=order;
+                }
+                ++count[i];
+                i=1;
+            }
+            else
+            {
+                count[i]=0;
+                ++i;
+            }
+        }
+        for ( size_t i=0;i<k;++i )
+        {
+            if ( order[i] == bestorder[i] ) continue;
+            size_t j=std::find ( order.begin() +i+1,order.end(),bestorder[i] )-order.begin();
+            c.Swap ( p[i],p[j] );
+            std::swap ( order[i],order[j] );
+        }
+    }
+    return best;
+}
+
+void RMSDMatrix::Calculate()
+{
+    const size_t n=m_frames.size();
+    m_values.assign ( n > 1 ? n* ( n-1 ) /2 : 0,0.f );
+
+    const size_t ntiles= ( n+tilesize-1 ) /tilesize;
+    std::vector< std::pair<size_t,size_t> > tiles;
+    tiles.reserve ( ntiles* ( ntiles+1 ) /2 );
+    for ( size_t ti=0;ti<ntiles;++ti )
+        for ( size_t tj=ti;tj<ntiles;++tj )
+            tiles.push_back ( std::make_pair ( ti,tj ) );
+
+    const long ntasks=static_cast<long> ( tiles.size() );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for ( long t=0;t<ntasks;++t )
+    {
+        const size_t iend=std::min ( n, ( tiles[t].first+1 ) *tilesize );
+        const size_t jend=std::min ( n, ( tiles[t].second+1 ) *tilesize );
+        for ( size_t i=tiles[t].first*tilesize;i<iend;++i )
+        {
+            const size_t row=i* ( 2*n-i-1 ) /2;
+            for ( size_t j=std::max ( i+1,tiles[t].second*tilesize );j<jend;++j )
+                m_values[row+j-i-1]=static_cast<float> ( PairRMSD ( m_coordinates[i],m_coordinates[j] ) );
+        }
+    }
+}
+
+std::vector< std::vector<size_t> > RMSDMatrix::EquivalentGroups ( const Molecule& molecule )
+{
+    const std::vector<Bond>& bonds=molecule.Bonds().empty() ? molecule.CurrentFrame().Bonds() : molecule.Bonds();
+    const size_t natoms=molecule.Atoms().size();
+    std::vector< std::vector<size_t> > neighbours ( natoms );
+    for ( std::vector<Bond>::const_iterator bt=bonds.begin();bt!=bonds.end();++bt )
+    {
+        if ( bt->J() >= natoms ) continue;
+        neighbours[bt->I()].push_back ( bt->J() );
+        neighbours[bt->J()].push_back ( bt->I() );
+    }
+
+    std::vector< std::vector<size_t> > groups;
+    for ( size_t a=0;a<natoms;++a )
+    {
+        std::map< int,std::vector<size_t> > terminal;
+        for ( std::vector<size_t>::const_iterator it=neighbours[a].begin();it!=neighbours[a].end();++it )
+        {
+            if ( neighbours[*it].size() == 1 )
+                terminal[molecule.Atoms() [*it].Z()].push_back ( *it );
+        }
+        for ( std::map< int,std::vector<size_t> >::const_iterator it=terminal.begin();it!=terminal.end();++it )
+        {
+            if ( it->second.size() > 1 ) groups.push_back ( it->second );
+        }
+    }
+    return groups;
+}
+
+ConformerClustering::ConformerClustering ( const RMSDMatrix& matrix, const std::vector<size_t>& labels )
+{
+    size_t nlabels=0;
+    for ( std::vector<size_t>::const_iterator it=labels.begin();it!=labels.end();++it )
+        nlabels=std::max ( nlabels,*it+1 );
+
+    std::vector< std::vector<size_t> > rows ( nlabels );
+    for ( size_t i=0;i<labels.size();++i )
+        rows[labels[i]].push_back ( i );
+    rows.erase ( std::remove_if ( rows.begin(),rows.end(),IsEmpty ),rows.end() );
+    std::sort ( rows.begin(),rows.end(),LargerCluster );
+
+    size_t maxframe=0;
+    for ( size_t i=0;i<matrix.Size();++i )
+        maxframe=std::max ( maxframe,matrix.Frame ( i ) );
+    m_clusterof.assign ( matrix.Size() ? maxframe+1 : 0,npos );
+
+    for ( size_t c=0;c<rows.size();++c )
+    {
+        m_representatives.push_back ( matrix.Frame ( Medoid ( matrix,rows[c] ) ) );
+        m_members.push_back ( std::vector<size_t>() );
+        for ( std::vector<size_t>::const_iterator it=rows[c].begin();it!=rows[c].end();++it )
+        {
+            m_members.back().push_back ( matrix.Frame ( *it ) );
+            m_clusterof[matrix.Frame ( *it )]=c;
+        }
+    }
+}
+
+ConformerClustering ConformerClustering::Threshold ( const RMSDMatrix& matrix, double cutoff )
+{
+    const size_t n=matrix.Size();
+    std::vector<size_t> neighbours ( n,0 );
+    for ( size_t i=0;i<n;++i )
+        for ( size_t j=i+1;j<n;++j )
+            if ( matrix ( i,j ) <= cutoff )
+            {
+                ++neighbours[i];
+                ++neighbours[j];
+            }
+
+    std::vector< std::pair<size_t,size_t> > order;
+    order.reserve ( n );
+    for ( size_t i=0;i<n;++i )
+        order.push_back ( std::make_pair ( n-neighbours[i],i ) );
+    std::sort ( order.begin(),order.end() );
+
+    std::vector<size_t> labels ( n,npos );
+    size_t nclusters=0;
+    for ( std::vector< std::pair<size_t,size_t> >::const_iterator it=order.begin();it!=order.end();++it )
+    {
+        size_t i=it->second;
+        if ( labels[i] != npos ) continue;
+        labels[i]=nclusters;
+        for ( size_t j=0;j<n;++j )
+            if ( labels[j] == npos && matrix ( i,j ) <= cutoff ) labels[j]=nclusters;
+        ++nclusters;
+    }
+    return ConformerClustering ( matrix,labels );
+}
+
+ConformerClustering ConformerClustering::Hierarchical ( const RMSDMatrix& matrix, double cutoff, size_t nclusters/*=0*/ )
+{
+    const size_t n=matrix.Size();
+    //working copy of the upper triangle, updated with the Lance-Williams formula
+    std::vector<float> d ( n > 1 ? n* ( n-1 ) /2 : 0 );
+    for ( size_t i=0;i<n;++i )
+        for ( size_t j=i+1;j<n;++j )
+            d[i* ( 2*n-i-1 ) /2+j-i-1]=matrix ( i,j );
+#define DIST(i,j) d[ ( (i)<(j) ) ? (i)* ( 2*n-(i)-1 ) /2+(j)-(i)-1 : (j)* ( 2*n-(j)-1 ) /2+(i)-(j)-1 ]
+
+    //nearest neighbour chain algorithm
+    std::vector<bool> active ( n,true );
+    std::vector<size_t> size ( n,1 );
+    std::vector<size_t> chain;
+    std::vector<Merge> merges;
+    merges.reserve ( n );
+    size_t nactive=n;
+    size_t next=0;
+    while ( nactive > 1 )
+    {
+        if ( chain.empty() )
+        {
+            while ( !active[next] ) ++next;
+            chain.push_back ( next );
+        }
+        size_t a=chain.back();
+        size_t previous= ( chain.size() > 1 ) ? chain[chain.size()-2] : npos;
+        size_t best=previous;
+        float bestd= ( previous != npos ) ? DIST ( a,previous ) : std::numeric_limits<float>::max();
+        for ( size_t k=0;k<n;++k )
+        {
+            if ( k == a || !active[k] ) continue;
+            if ( DIST ( a,k ) < bestd )
+            {
+                bestd=DIST ( a,k );
+                best=k;
+            }
+        }
+        if ( best != previous || previous == npos )
+        {
+            chain.push_back ( best );
+            continue;
+        }
+        chain.pop_back();
+        chain.pop_back();
+        Merge m={ previous,a,bestd };
+        merges.push_back ( m );
+        //the merged cluster takes the place of previous
+        for ( size_t k=0;k<n;++k )
+        {
+            if ( !active[k] || k == a || k == previous ) continue;
+            DIST ( previous,k ) = ( size[previous]*DIST ( previous,k ) +size[a]*DIST ( a,k ) ) / ( size[previous]+size[a] );
+        }
+        size[previous]+=size[a];
+        active[a]=false;
+        --nactive;
+    }
+#undef DIST
+
+    //average linkage is reducible, so sorted merges form a valid dendrogram
+    std::stable_sort ( merges.begin(),merges.end(),MergeLess );
+    std::vector<size_t> parent=AllIndexes ( n );
+    size_t remaining=n;
+    for ( std::vector<Merge>::const_iterator it=merges.begin();it!=merges.end();++it )
+    {
+        if ( nclusters > 0 ? remaining <= nclusters : it->height > cutoff ) break;
+        parent[Find ( parent,it->b )]=Find ( parent,it->a );
+        --remaining;
+    }
+    std::vector<size_t> labels ( n );
+    for ( size_t i=0;i<n;++i )
+        labels[i]=Find ( parent,i );
+    return ConformerClustering ( matrix,labels );
+}
+
+ConformerClustering ConformerClustering::KMedoids ( const RMSDMatrix& matrix, size_t k, size_t maxiterations/*=100*/ )
+{
+    if ( k == 0 ) throw kryomol::Exception ( "The number of clusters must be greater than zero" );
+    const size_t n=matrix.Size();
+    if ( k >= n ) return ConformerClustering ( matrix,AllIndexes ( n ) );
+
+    //seed with the global medoid and then the farthest points, the chosen ones marked negative. Conformers
+    //identical to a medoid are not distinct points, so there are no more seeds than distinct conformers
+    std::vector<size_t> medoids;
+    medoids.push_back ( Medoid ( matrix,AllIndexes ( n ) ) );
+    std::vector<float> nearest ( n );
+    for ( size_t i=0;i<n;++i )
+        nearest[i]=matrix ( i,medoids.front() );
+    nearest[medoids.front()]=-1;
+    while ( medoids.size() < k )
+    {
+        size_t far=std::max_element ( nearest.begin(),nearest.end() )-nearest.begin();
+        if ( nearest[far] <= 0 ) break;
+        medoids.push_back ( far );
+        for ( size_t i=0;i<n;++i )
+            nearest[i]=std::min ( nearest[i],matrix ( i,far ) );
+        nearest[far]=-1;
+    }
+    k=medoids.size();
+
+    std::vector<size_t> labels ( n,0 );
+    for ( size_t iteration=0;iteration<maxiterations;++iteration )
+    {
+        for ( size_t i=0;i<n;++i )
+        {
+            float bestd=std::numeric_limits<float>::max();
+            for ( size_t c=0;c<k;++c )
+            {
+                if ( matrix ( i,medoids[c] ) < bestd )
+                {
+                    bestd=matrix ( i,medoids[c] );
+                    labels[i]=c;
+                }
+            }
+        }
+        std::vector< std::vector<size_t> > rows ( k );
+        for ( size_t i=0;i<n;++i )
+            rows[labels[i]].push_back ( i );
+        bool changed=false;
+        for ( size_t c=0;c<k;++c )
+        {
+            if ( rows[c].empty() ) continue;
+            size_t m=Medoid ( matrix,rows[c] );
+            if ( m != medoids[c] )
+            {
+                medoids[c]=m;
+                changed=true;
+            }
+        }
+        if ( !changed ) break;
+    }
+    return ConformerClustering ( matrix,labels );
+}
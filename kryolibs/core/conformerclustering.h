@@ -0,0 +1,98 @@
+/*****************************************************************************************
+                            conformerclustering.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef CONFORMERCLUSTERING_H
+#define CONFORMERCLUSTERING_H
+
+#include <algorithm>
+#include <vector>
+#include "superposition.h"
+#include "coreexport.h"
+
+namespace kryomol
+{
+  class Molecule;
+
+  /** @brief all pairs rmsd between the frames of a molecule
+
+  Every pair of frames is superimposed with @see Superposition. The upper triangle is computed in
+  square tiles of frames, so the coordinates of both tiles stay in cache, and the tiles are distributed
+  over threads when compiled with OpenMP. Optionally groups of symmetry equivalent atoms (like the
+  hydrogens of a methyl group) are permuted to find the lowest rmsd*/
+  class KRYOMOLCORE_API RMSDMatrix
+  {
+    public:
+      /** prepare the matrix for frames @param frames (all if empty) fitting atoms @param atoms (all if empty)*/
+      RMSDMatrix ( const Molecule& molecule, const std::vector<size_t>& frames=std::vector<size_t>(),
+                   const std::vector<size_t>& atoms=std::vector<size_t>(), bool massweighted=false );
+      /** set groups of equivalent atoms (molecule atom indexes) to be permuted when comparing two frames*/
+      void SetEquivalentGroups ( const std::vector< std::vector<size_t> >& groups );
+      /** compute all the pairwise rmsd values*/
+      void Calculate();
+      /** @return the number of frames in the matrix*/
+      size_t Size() const { return m_frames.size(); }
+      /** @return the molecule frame index of matrix row i*/
+      size_t Frame ( size_t i ) const { return m_frames[i]; }
+      /** @return the molecule frame indexes of the matrix rows*/
+      const std::vector<size_t>& Frames() const { return m_frames; }
+      /** @return the rmsd between the frames in rows i and j*/
+      float operator() ( size_t i, size_t j ) const
+      {
+        if ( i == j ) return 0;
+        if ( i > j ) std::swap ( i,j );
+        return m_values[i* ( 2*m_frames.size()-i-1 ) /2+j-i-1];
+      }
+      /** @return groups of terminal atoms bonded to the same atom with the same element*/
+      static std::vector< std::vector<size_t> > EquivalentGroups ( const Molecule& molecule );
+    private:
+      double PairRMSD ( const FitCoordinates& a, const FitCoordinates& b ) const;
+    private:
+      std::vector<size_t> m_frames;
+      Superposition m_superposition;
+      std::vector<FitCoordinates> m_coordinates;
+      std::vector< std::vector<size_t> > m_groups;
+      std::vector<float> m_values;
+  };
+
+  /** @brief partition of the frames of a @see RMSDMatrix in clusters
+
+  Frame indexes refer to the molecule frames. The representative of each cluster is its medoid*/
+  class KRYOMOLCORE_API ConformerClustering
+  {
+    public:
+      enum Method { THRESHOLD, HIERARCHICAL, KMEDOIDS };
+      /** leader clustering of Butina: the frame with most neighbours closer than @param cutoff forms a cluster with them, and so on*/
+      static ConformerClustering Threshold ( const RMSDMatrix& matrix, double cutoff );
+      /** average linkage agglomerative clustering, stopping at distance @param cutoff or at @param nclusters if it is not 0*/
+      static ConformerClustering Hierarchical ( const RMSDMatrix& matrix, double cutoff, size_t nclusters=0 );
+      /** k-medoids clustering with farthest point seeding*/
+      static ConformerClustering KMedoids ( const RMSDMatrix& matrix, size_t k, size_t maxiterations=100 );
+      /** @return the number of clusters*/
+      size_t NClusters() const { return m_members.size(); }
+      /** @return the frames in cluster i*/
+      const std::vector<size_t>& Members ( size_t i ) const { return m_members[i]; }
+      /** @return the representative frame of cluster i*/
+      size_t Representative ( size_t i ) const { return m_representatives[i]; }
+      /** @return the representative frames of all the clusters*/
+      const std::vector<size_t>& Representatives() const { return m_representatives; }
+      /** @return the cluster of molecule frame f, or NClusters() if the frame was not clustered*/
+      size_t ClusterOf ( size_t f ) const { return ( f < m_clusterof.size() && m_clusterof[f] < NClusters() ) ? m_clusterof[f] : NClusters(); }
+    private:
+      /** build the clusters from the cluster index of each matrix row*/
+      ConformerClustering ( const RMSDMatrix& matrix, const std::vector<size_t>& labels );
+    private:
+      std::vector< std::vector<size_t> > m_members;
+      std::vector<size_t> m_representatives;
+      std::vector<size_t> m_clusterof;
+  };
+}
+
+#endif
@@ -22,12 +22,20 @@ HEADERS += atom.h bond.h \
            couplingconstant.h quantumcoupling.h \
            energy.h \
            molecule.h \
+           normalmodes.h \
 	   frame.h \
+           framesource.h \
+           frameloader.h \
            frequency.h \
            quantumplot.h \
            sinusoid.h \
+           linebroadening.h \
            kryomolcore_export.h \
            thermo.h coreexport.h  ringperceptor.h \
+           superposition.h \
+           conformerclustering.h \
+           geometricdescriptors.h \
+           torsionscan.h \
            pdbtools.h \
            chemicalshift.h \
            threshold.h \
@@ -45,8 +53,13 @@ SOURCES += atom.cpp bond.cpp \
            energy.cpp \
            quantumplot.cpp \
            sinusoid.cpp \
+           linebroadening.cpp \
            molecule.cpp quantumcoupling.cpp  frame.cpp \
            thermo.cpp couplingconstant.cpp ringperceptor.cpp \
+           superposition.cpp \
+           conformerclustering.cpp \
+           geometricdescriptors.cpp \
+           torsionscan.cpp \
            pdbtools.cpp \
            chemicalshift.cpp \
            animation.cpp \
@@ -13,12 +13,16 @@ the Free Software Foundation version 2 of the License.
 #include <iomanip>
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <utility>
 
 
 #include "frame.h"
+#include "frameloader.h"
 #include "molecule.h"
 #include "ringperceptor.h"
 #include "grid.h"
+#include "exception.h"
 
 
 struct fcolor {
@@ -30,7 +34,7 @@ struct fcolor {
 class kryomol::FramePrivate
 {
 public:
-    FramePrivate()  : m_hasorbitals(false) {}
+    FramePrivate()  : m_hasorbitals(false), m_pending(0), m_loading(0) {}
     ~FramePrivate() {}
     std::vector<Bond> m_bonds;
     std::vector<Coordinate> m_xyz;
@@ -63,6 +67,11 @@ public:
     std::vector< std::vector<TransitionChange> > m_transitionchanges;
     fcolor m_color;
     bool m_hasorbitals;
+    /** loaders of the frame with the data each one reads, the data not read yet and the data being read*/
+    std::vector< std::pair<unsigned,std::shared_ptr<FrameLoader> > > m_loaders;
+    unsigned m_pending;
+    unsigned m_loading;
+    RingCache m_rings;
 };
 
 using namespace kryomol;
@@ -192,8 +201,14 @@ float Frame::Angle ( int a1, int a2, int a3 ) const
 
 std::vector < std::vector<size_t> > Frame::Rings ( size_t size/*=0*/ ) const
 {
-    RingPerceptor pr ( this );
-    return pr.Rings ( size );
+    const std::vector<Bond>& bonds=m_private->m_bonds.empty() ? m_molecule->Bonds() : m_private->m_bonds;
+    return m_private->m_rings.Rings ( m_molecule->Atoms().size(),bonds,size );
+}
+
+std::vector < std::vector<size_t> > Frame::RelevantCycles ( size_t size/*=0*/ ) const
+{
+    const std::vector<Bond>& bonds=m_private->m_bonds.empty() ? m_molecule->Bonds() : m_private->m_bonds;
+    return m_private->m_rings.RelevantCycles ( m_molecule->Atoms().size(),bonds,size );
 }
 
 Coordinate Frame::Centroid() const
@@ -352,11 +367,13 @@ const std::vector< D2Array<double> >&  Frame::CShiftTensors() const
 
 OrbitalData& Frame::OrbitalsData()
 {
+    Load ( ORBITALS );
     return m_private->m_orbitaldata;
 }
 
 const OrbitalData& Frame::OrbitalsData() const
 {
+    Load ( ORBITALS );
     return m_private->m_orbitaldata;
 }
 
@@ -423,7 +440,7 @@ std::ostream& kryomol::operator << ( std::ostream& s,const kryomol::Frame& m )
           << ct->x() <<
              std::setw ( 12 ) << ct->y()
           << std::setw ( 12 ) << ct->z()
-          << std::resetiosflags ( std::ios::right ) << std::endl;
+          << std::resetiosflags ( std::ios::right ) << '\n';
     }
 
     s << std::resetiosflags ( std::ios::fixed );
@@ -462,12 +479,7 @@ void Frame::AllocateVectors(bool rottransmodes/*=false*/)
     rottransmodes ? size =3*ParentMolecule()->Atoms().size() : size = 3*ParentMolecule()->Atoms().size()-6;
 
     m_private->m_modes.reserve(size);
-    ParentMolecule()->GetMode().resize(size);
-
-    for( std::vector< std::vector<Coordinate> >::iterator it=ParentMolecule()->GetMode().begin();it != ParentMolecule()->GetMode().end();++it)
-    {
-        it->resize(ParentMolecule()->Atoms().size());
-    }
+    ParentMolecule()->Modes().Initialize(size,ParentMolecule()->Atoms().size());
 
 }
 
@@ -583,7 +595,7 @@ void Frame::SetMaximumDisplacement(double d) { m_private->m_maximumdisplacement=
 void Frame::SetThreshold(const Threshold& thr) { m_private->m_threshold=thr; }
 void Frame::SetDipole(const Coordinate& coor) { m_private->m_dipole=coor; }
 void Frame::SetGrid(const Grid &grid) { m_private->m_grid=grid; }
-void Frame::SetOrbitalData(const OrbitalData &orbitaldata) { m_private->m_orbitaldata=orbitaldata; }
+void Frame::SetOrbitalData(const OrbitalData &orbitaldata) { m_private->m_pending&=~ORBITALS; m_private->m_orbitaldata=orbitaldata; }
 void Frame::SetTransitionChanges(const std::vector< std::vector<TransitionChange> > &transitions) { m_private->m_transitionchanges=transitions; }
 void Frame::SetElectronicDensityData(const ElectronicDensity &density) {m_private->m_electronicdensity=density; }
 void Frame::SetPositiveDensity(const std::vector<RenderDensity> &positivedensity) {m_private->m_positivedensity=positivedensity;}
@@ -599,6 +611,8 @@ Coordinate Frame::GetDipole() const { return m_private->m_dipole; }
 
 D1Array<double>& Frame::GetForces()  { return m_private->m_forces; }
 D2Array<double>& Frame::GetHessian()  { return m_private->m_hessian; }
+const D1Array<double>& Frame::GetForces() const { return m_private->m_forces; }
+const D2Array<double>& Frame::GetHessian() const { return m_private->m_hessian; }
 std::vector<Frequency> &Frame::GetFrequencies() { return m_private->m_modes; }
 const std::vector<Frequency>& Frame::GetFrequencies() const { return m_private->m_modes; }
 std::vector<Spectralline>& Frame::GetSpectralLines() { return m_private->m_spectrallines; }
@@ -613,3 +627,59 @@ bool Frame::HasOrbitals() const
 {
     return m_private->m_hasorbitals;
 }
+
+/** a loader set later replaces the ones set before for the same data*/
+void Frame::SetLoader(FrameLoader* loader, unsigned data)
+{
+    for ( size_t i=0;i<m_private->m_loaders.size();++i )
+        m_private->m_loaders[i].first&=~data;
+    m_private->m_loaders.push_back(std::make_pair(data,std::shared_ptr<FrameLoader>(loader)));
+    m_private->m_pending|=data;
+}
+
+unsigned Frame::PendingData() const
+{
+    return m_private->m_pending;
+}
+
+/** the data being decoded is not loaded again, so the loaders can fill it through the accessors of the frame.
+    It is marked as read once its loader succeeds, a loader that fails is tried again on the next use. The
+    members of the frame are behind its private pointer, the const accessors can read them too*/
+void Frame::LoadData(unsigned data) const
+{
+    data&=m_private->m_pending & ~m_private->m_loading;
+    if ( data == 0 ) return;
+    std::string error;
+    for ( size_t i=0;i<m_private->m_loaders.size();++i )
+    {
+        const unsigned read=m_private->m_loaders[i].first & data;
+        if ( read == 0 ) continue;
+        m_private->m_loading|=read;
+        try
+        {
+            m_private->m_loaders[i].second->Load(const_cast<Frame&>(*this),read);
+            m_private->m_pending&=~read;
+        }
+        catch ( std::exception& e )
+        {
+            //the frame is shown without the data, not with the part decoded before the error
+            if ( error.empty() ) error=e.what();
+            if ( read & ORBITALS ) m_private->m_orbitaldata=OrbitalData();
+        }
+        m_private->m_loading&=~read;
+    }
+    if ( !error.empty() ) throw kryomol::Exception("the data of the frame could not be read: "+error);
+}
+
+/** the accessors can not report the error, the views that show the data call LoadData first*/
+void Frame::Load(unsigned data) const
+{
+    try
+    {
+        LoadData(data);
+    }
+    catch ( std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
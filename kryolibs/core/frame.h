@@ -31,12 +31,15 @@ namespace kryomol
 {
   class Molecule;
   class FramePrivate;
+  class FrameLoader;
 
   /** @brief Representation of a conformer*/
   class KRYOMOLCORE_API Frame
   {
     public:
       enum Charge { ESP, MULLIKEN, NBO, AIM };
+      /** data that can be read on first use by a @see FrameLoader*/
+      enum Data { ORBITALS=1 };
       Frame ( Molecule* molecule );
       Frame ( const Frame& frame );
       Frame& operator = ( const Frame& frame );
@@ -83,12 +86,16 @@ namespace kryomol
       Coordinate Centroid() const;
       /** @return rings of size @param size or all rings if 0*/
       std::vector < std::vector<size_t> > Rings ( size_t size=0 ) const;
+      /** @return relevant cycles of size @param size or all relevant cycles if 0*/
+      std::vector < std::vector<size_t> > RelevantCycles ( size_t size=0 ) const;
       /** @return 3D vector betwwen atoms i and j*/
       Coordinate Vector ( int i, int j ) const;
       /** @return a const pointer to the parent molecule of this conformer*/
       const Molecule* ParentMolecule() const { return m_molecule; }
       /** @return a pointer to the parent molecule of this conformer*/
       Molecule* ParentMolecule() { return m_molecule; }
+      /** make @param molecule the parent of this conformer, once it was copied to another molecule*/
+      void SetParentMolecule ( Molecule* molecule ) { m_molecule=molecule; }
       /** @return a vector with the chemical shift tensors*/
       const std::vector< D2Array<double> >& CShiftTensors() const;
       /** @return a vector with the chemical shift tensors*/
@@ -125,7 +132,9 @@ namespace kryomol
       std::pair<Coordinate,Coordinate> Box() const;
       Coordinate Dipole();
       D1Array<double>& GetForces() ;
+      const D1Array<double>& GetForces() const;
       D2Array<double>& GetHessian()  ;
+      const D2Array<double>& GetHessian() const;
       /** get the HSL representative color for the conformer*/
       void GetColor(float& h,float& s,float& l) const;
       /** set the HSL representative color for the conformer*/
@@ -145,6 +154,14 @@ namespace kryomol
       void SetNegativeDensity(const std::vector<RenderDensity>& negativedensity);
       void SetHasOrbitals(bool hasorbitals);
       bool HasOrbitals() const;
+      /** read @param data, an or of Data, with @param loader the first time it is accessed. The frame takes the
+          ownership of the loader, shared with its copies*/
+      void SetLoader(FrameLoader* loader, unsigned data);
+      /** @return the data not read yet by the loaders of the frame, an or of Data*/
+      unsigned PendingData() const;
+      /** read the pending @param data, an or of Data, now instead of on first access. Throws kryomol::Exception
+          if a loader fails, its data is then left empty and read again on the next use*/
+      void LoadData(unsigned data) const;
 
       double GetEnergy() const;
       double GetRMSForce() const ;
@@ -169,6 +186,8 @@ namespace kryomol
       void CalculateGrid(float resolution);
 
     private:
+      /** read the pending @param data with the loaders of the frame*/
+      void Load ( unsigned data ) const;
       void RotateNeighbours ( const Coordinate& axisorigin,const Coordinate& axisend,size_t i,size_t j,float pass,bool clockwise,std::vector<size_t>& rotatedatoms );
 
     private:
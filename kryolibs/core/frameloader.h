@@ -0,0 +1,35 @@
+/*****************************************************************************************
+                            frameloader.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef FRAMELOADER_H
+#define FRAMELOADER_H
+
+#include "coreexport.h"
+
+namespace kryomol
+{
+  class Frame;
+
+  /** @brief reads heavy data of a frame the first time it is used
+
+  A parser can record where the data of a frame, as its molecular orbitals, is written in the file and give
+  the frame a loader instead of the data (@see Frame::SetLoader). The data is decoded when one of the accessors
+  of the frame asks for it, so opening an output is fast and the memory grows only with what is viewed*/
+  class KRYOMOLCORE_API FrameLoader
+  {
+    public:
+      virtual ~FrameLoader() {}
+      /** read @param data, an or of Frame::Data, into @param frame*/
+      virtual void Load ( Frame& frame, unsigned data )=0;
+  };
+}
+
+#endif
@@ -0,0 +1,40 @@
+/*****************************************************************************************
+                            framesource.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <cstddef>
+
+#include "coreexport.h"
+
+namespace kryomol
+{
+  class Frame;
+
+  /** @brief the structures of a molecule that are read on demand
+
+  A molecule with a frame source keeps a single frame in memory, and the structure selected with
+  @see Molecule::SetCurrentFrame is read into it from the source. Files with many thousands of structures
+  are then shown without holding all of them in memory*/
+  class KRYOMOLCORE_API FrameSource
+  {
+    public:
+      virtual ~FrameSource() {}
+      /** @return the number of structures*/
+      virtual size_t Size() const=0;
+      /** read the coordinates of structure @param i into @param frame @return false if it can not be read,
+          @param frame is then left unchanged*/
+      virtual bool Read ( size_t i, Frame& frame )=0;
+  };
+}
+
+#endif
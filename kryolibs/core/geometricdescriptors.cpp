@@ -0,0 +1,245 @@
+/*****************************************************************************************
+                            geometricdescriptors.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+
+#include "geometricdescriptors.h"
+#include "molecule.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** number of frames evaluated together*/
+    const size_t blocksize=256;
+
+    /** coordinates of the involved atoms for a block of frames, atom major*/
+    struct Block
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+    };
+
+    void Distances ( const float* ax, const float* ay, const float* az,
+                     const float* bx, const float* by, const float* bz,
+                     long n, float* out )
+    {
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+        for ( long t=0;t<n;++t )
+        {
+            float dx=ax[t]-bx[t];
+            float dy=ay[t]-by[t];
+            float dz=az[t]-bz[t];
+            out[t]=std::sqrt ( dx*dx+dy*dy+dz*dz );
+        }
+    }
+
+    /** angle a-b-c*/
+    void Angles ( const float* ax, const float* ay, const float* az,
+                  const float* bx, const float* by, const float* bz,
+                  const float* cx, const float* cy, const float* cz,
+                  long n, float scale, float* out )
+    {
+        for ( long t=0;t<n;++t )
+        {
+            float ux=ax[t]-bx[t], uy=ay[t]-by[t], uz=az[t]-bz[t];
+            float vx=cx[t]-bx[t], vy=cy[t]-by[t], vz=cz[t]-bz[t];
+            float proj= ( ux*vx+uy*vy+uz*vz ) /std::sqrt ( ( ux*ux+uy*uy+uz*uz ) * ( vx*vx+vy*vy+vz*vz ) );
+            proj=std::min ( 1.0f,std::max ( -1.0f,proj ) );
+            out[t]=scale*std::acos ( proj );
+        }
+    }
+
+    /** dihedral a-b-c-d, with the sign convention of Coordinate::Dihedral*/
+    void Dihedrals ( const float* ax, const float* ay, const float* az,
+                     const float* bx, const float* by, const float* bz,
+                     const float* cx, const float* cy, const float* cz,
+                     const float* dx, const float* dy, const float* dz,
+                     long n, float scale, float* out )
+    {
+        for ( long t=0;t<n;++t )
+        {
+            float b1x=bx[t]-ax[t], b1y=by[t]-ay[t], b1z=bz[t]-az[t];
+            float b2x=cx[t]-bx[t], b2y=cy[t]-by[t], b2z=cz[t]-bz[t];
+            float b3x=dx[t]-cx[t], b3y=dy[t]-cy[t], b3z=dz[t]-cz[t];
+            //normals to the planes a-b-c and b-c-d
+            float n1x=b1y*b2z-b1z*b2y, n1y=b1z*b2x-b1x*b2z, n1z=b1x*b2y-b1y*b2x;
+            float n2x=b2y*b3z-b2z*b3y, n2y=b2z*b3x-b2x*b3z, n2z=b2x*b3y-b2y*b3x;
+            float b2=std::sqrt ( b2x*b2x+b2y*b2y+b2z*b2z );
+            float sine=b2* ( b1x*n2x+b1y*n2y+b1z*n2z );
+            float cosine=n1x*n2x+n1y*n2y+n1z*n2z;
+            out[t]=scale*std::atan2 ( sine,cosine );
+        }
+    }
+}
+
+GeometricDescriptors::GeometricDescriptors() : m_nframes ( 0 )
+{
+}
+
+size_t GeometricDescriptors::AddDistance ( size_t i, size_t j )
+{
+    std::vector<size_t> atoms ( 2 );
+    atoms[0]=i; atoms[1]=j;
+    return Add ( atoms );
+}
+
+size_t GeometricDescriptors::AddAngle ( size_t i, size_t j, size_t k )
+{
+    std::vector<size_t> atoms ( 3 );
+    atoms[0]=i; atoms[1]=j; atoms[2]=k;
+    return Add ( atoms );
+}
+
+size_t GeometricDescriptors::AddDihedral ( size_t i, size_t j, size_t k, size_t l )
+{
+    std::vector<size_t> atoms ( 4 );
+    atoms[0]=i; atoms[1]=j; atoms[2]=k; atoms[3]=l;
+    return Add ( atoms );
+}
+
+size_t GeometricDescriptors::Add ( const std::vector<size_t>& atoms )
+{
+    if ( atoms.size() < 2 || atoms.size() > 4 )
+        throw kryomol::Exception ( "a geometric descriptor needs 2, 3 or 4 atoms" );
+    m_types.push_back ( static_cast<Type> ( atoms.size() ) );
+    m_atoms.push_back ( atoms );
+    m_values.clear();
+    m_nframes=0;
+    return m_types.size()-1;
+}
+
+void GeometricDescriptors::Clear()
+{
+    m_types.clear();
+    m_atoms.clear();
+    m_values.clear();
+    m_nframes=0;
+}
+
+void GeometricDescriptors::Calculate ( const Molecule& molecule, bool degrees /*=true*/ )
+{
+    const size_t natoms=molecule.Atoms().size();
+    m_nframes=molecule.FrameCount();
+    m_values.assign ( m_types.size() *m_nframes,0.0f );
+    if ( m_types.empty() || m_nframes == 0 ) return;
+
+    //atoms involved in any descriptor and the slot of each descriptor atom in the block arrays
+    std::vector<size_t> used;
+    for ( std::vector< std::vector<size_t> >::const_iterator it=m_atoms.begin();it!=m_atoms.end();++it )
+        used.insert ( used.end(),it->begin(),it->end() );
+    std::sort ( used.begin(),used.end() );
+    used.erase ( std::unique ( used.begin(),used.end() ),used.end() );
+    if ( used.back() >= natoms )
+        throw kryomol::Exception ( "geometric descriptor atom out of range" );
+
+    std::vector< std::vector<size_t> > slots ( m_atoms.size() );
+    for ( size_t d=0;d<m_atoms.size();++d )
+    {
+        for ( std::vector<size_t>::const_iterator it=m_atoms[d].begin();it!=m_atoms[d].end();++it )
+            slots[d].push_back ( std::lower_bound ( used.begin(),used.end(),*it )-used.begin() );
+    }
+
+    const float scale=degrees ? static_cast<float> ( 180.0/M_PI ) : 1.0f;
+    const long nused=static_cast<long> ( used.size() );
+    const long nblocks=static_cast<long> ( ( m_nframes+blocksize-1 ) /blocksize );
+
+    //copy the coordinates of the atoms used in frame @param t of @param block
+    auto fill=[&] ( Block& block, long t, const std::vector<Coordinate>& xyz )
+    {
+        for ( long u=0;u<nused;++u )
+        {
+            const Coordinate& c=xyz[used[u]];
+            block.x[u*blocksize+t]=c.x();
+            block.y[u*blocksize+t]=c.y();
+            block.z[u*blocksize+t]=c.z();
+        }
+    };
+    //evaluate every descriptor for the @param n frames of @param block, the first one being @param first
+    auto evaluate=[&] ( const Block& block, size_t first, long n )
+    {
+        for ( size_t d=0;d<m_types.size();++d )
+        {
+            const std::vector<size_t>& s=slots[d];
+            const float* x[4]; const float* y[4]; const float* z[4];
+            for ( size_t a=0;a<s.size();++a )
+            {
+                x[a]=&block.x[s[a]*blocksize];
+                y[a]=&block.y[s[a]*blocksize];
+                z[a]=&block.z[s[a]*blocksize];
+            }
+            float* out=&m_values[d*m_nframes+first];
+            switch ( m_types[d] )
+            {
+            case DISTANCE:
+                Distances ( x[0],y[0],z[0],x[1],y[1],z[1],n,out );
+                break;
+            case ANGLE:
+                Angles ( x[0],y[0],z[0],x[1],y[1],z[1],x[2],y[2],z[2],n,scale,out );
+                break;
+            case DIHEDRAL:
+                Dihedrals ( x[0],y[0],z[0],x[1],y[1],z[1],x[2],y[2],z[2],x[3],y[3],z[3],n,scale,out );
+                break;
+            }
+        }
+    };
+
+    if ( molecule.HasFrameSource() )
+    {
+        //the structures read on demand are streamed through a single frame, one block at a time, by one thread
+        Block block;
+        block.x.resize ( used.size() *blocksize );
+        block.y.resize ( used.size() *blocksize );
+        block.z.resize ( used.size() *blocksize );
+        Frame read ( NULL );
+        for ( long b=0;b<nblocks;++b )
+        {
+            const size_t first=b*blocksize;
+            const long n=static_cast<long> ( std::min ( blocksize,m_nframes-first ) );
+            for ( long t=0;t<n;++t )
+            {
+                if ( !molecule.ReadFrame ( first+t,read ) )
+                    throw kryomol::Exception ( "a structure of the file could not be read" );
+                fill ( block,t,read.XYZ() );
+            }
+            evaluate ( block,first,n );
+        }
+        return;
+    }
+
+    const std::vector<Frame>& frames=molecule.Frames();
+#ifdef WITH_OPENMP
+#pragma omp parallel
+#endif
+    {
+        Block block;
+        block.x.resize ( used.size() *blocksize );
+        block.y.resize ( used.size() *blocksize );
+        block.z.resize ( used.size() *blocksize );
+
+#ifdef WITH_OPENMP
+#pragma omp for schedule(static)
+#endif
+        for ( long b=0;b<nblocks;++b )
+        {
+            const size_t first=b*blocksize;
+            const long n=static_cast<long> ( std::min ( blocksize,m_nframes-first ) );
+            for ( long t=0;t<n;++t )
+                fill ( block,t,frames[first+t].XYZ() );
+            evaluate ( block,first,n );
+        }
+    }
+}
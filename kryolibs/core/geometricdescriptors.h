@@ -0,0 +1,70 @@
+/*****************************************************************************************
+                            geometricdescriptors.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef GEOMETRICDESCRIPTORS_H
+#define GEOMETRICDESCRIPTORS_H
+
+#include <cstddef>
+#include <vector>
+#include "coreexport.h"
+
+namespace kryomol
+{
+  class Molecule;
+
+  /** @brief distances, angles and dihedrals of a molecule along all its frames
+
+  The descriptors are defined once and evaluated for every frame in a single pass. Frames are processed
+  in blocks: the coordinates of the atoms involved in any descriptor are copied to contiguous x, y and z
+  arrays, and each descriptor is then computed for the whole block in a vectorizable loop. Blocks are
+  distributed over threads when compiled with OpenMP. The result of each descriptor is a dense time
+  series with one value per frame*/
+  class KRYOMOLCORE_API GeometricDescriptors
+  {
+    public:
+      /** the type of a descriptor, equal to its number of atoms*/
+      enum Type { DISTANCE=2, ANGLE=3, DIHEDRAL=4 };
+      GeometricDescriptors();
+      /** add the distance i-j @return the index of the descriptor*/
+      size_t AddDistance ( size_t i, size_t j );
+      /** add the angle i-j-k @return the index of the descriptor*/
+      size_t AddAngle ( size_t i, size_t j, size_t k );
+      /** add the dihedral i-j-k-l @return the index of the descriptor*/
+      size_t AddDihedral ( size_t i, size_t j, size_t k, size_t l );
+      /** add a distance, angle or dihedral depending on the number of atoms in @param atoms
+          @return the index of the descriptor*/
+      size_t Add ( const std::vector<size_t>& atoms );
+      /** remove all the descriptors*/
+      void Clear();
+      /** @return the number of descriptors*/
+      size_t Size() const { return m_types.size(); }
+      /** @return the type of descriptor d*/
+      Type GetType ( size_t d ) const { return m_types[d]; }
+      /** @return the atoms of descriptor d*/
+      const std::vector<size_t>& Atoms ( size_t d ) const { return m_atoms[d]; }
+      /** evaluate all the descriptors for every frame of @param molecule.
+          Angles and dihedrals are given in degrees if @param degrees, in radians otherwise*/
+      void Calculate ( const Molecule& molecule, bool degrees=true );
+      /** @return the number of frames of the last calculation*/
+      size_t NFrames() const { return m_nframes; }
+      /** @return the values of descriptor d for all the frames*/
+      const float* Series ( size_t d ) const { return m_values.empty() ? NULL : &m_values[d*m_nframes]; }
+      /** @return the value of descriptor d in frame f*/
+      float Value ( size_t d, size_t f ) const { return m_values[d*m_nframes+f]; }
+    private:
+      std::vector<Type> m_types;
+      std::vector< std::vector<size_t> > m_atoms;
+      std::vector<float> m_values;
+      size_t m_nframes;
+  };
+}
+
+#endif
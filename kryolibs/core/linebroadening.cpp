@@ -0,0 +1,489 @@
+/*****************************************************************************************
+                            linebroadening.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "linebroadening.h"
+#include "fidarray.h"
+
+#ifndef M_PI
+# define M_PI       3.14159265358979323846  // matches value in gcc v2 math.h
+#endif
+
+using namespace kryomol;
+
+namespace
+{
+    /** ratio of the full width at half maximum to the standard deviation of a gaussian, 2 sqrt(2 ln 2)*/
+    const double fwhmtosigma=2.3548200450309493;
+
+    /** costs of finding the window of a line, of a butterfly of the FFT and of the exponential of a gaussian,
+        relative to the evaluation of a lorentzian at a point*/
+    const double windowcost=200;
+    const double butterflycost=16;
+    const double exponentialcost=2;
+    /** points of the curves summed at once*/
+    const size_t sumblock=1024;
+    /** largest uniform grid for the convolution, relative to the points of the grid of the spectrum*/
+    const double maxrefinement=8;
+
+    /** lowest argument of @see Exp, where e^x is near the smallest normal float*/
+    const double minexponent=-87;
+
+    /** e^x for minexponent <= x <= 0 within 2e-7, the reduction of Cody and Waite and the polynomial of Cephes,
+        without calls nor branches so the loops over the points are vectorized*/
+    inline float Exp ( float x )
+    {
+        //x=n ln 2+r, rounding to nearest by truncation of the negative x/ln 2-1/2
+        const int n=static_cast<int> ( x*1.44269504f-0.5f );
+        const float r=x-n*0.693359375f+n*2.12194440e-4f;
+        float p=1.9875691500e-4f;
+        p=p*r+1.3981999507e-3f;
+        p=p*r+8.3334519073e-3f;
+        p=p*r+4.1665795894e-2f;
+        p=p*r+1.6666665459e-1f;
+        p=p*r+5.0000001201e-1f;
+        p=p*r*r+r+1.f;
+        //2^n assembled in the exponent bits
+        const std::int32_t bits= ( n+127 ) <<23;
+        float scale;
+        std::memcpy ( &scale,&bits,sizeof ( scale ) );
+        return p*scale;
+    }
+
+    void Gaussian ( const float* x, float* y, long n, float centre, float height, float exponent )
+    {
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+        for ( long k=0;k<n;++k )
+        {
+            const float d=x[k]-centre;
+            y[k]+=height*Exp ( -d*d*exponent );
+        }
+    }
+
+    void Lorentzian ( const float* x, float* y, long n, float centre, float height, float gamma2 )
+    {
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+        for ( long k=0;k<n;++k )
+        {
+            const float d=x[k]-centre;
+            y[k]+=height/ ( d*d+gamma2 );
+        }
+    }
+
+    /** @return the points of the ascending or descending grid @param x of @param n points within @param window of
+        @param centre, from @param first*/
+    long Window ( const float* x, size_t n, bool ascending, float centre, float window, long& first )
+    {
+        const float* begin;
+        const float* end;
+        if ( ascending )
+        {
+            begin=std::lower_bound ( x,x+n,centre-window );
+            end=std::upper_bound ( begin,x+n,centre+window );
+        }
+        else
+        {
+            begin=std::lower_bound ( x,x+n,centre+window,std::greater<float>() );
+            end=std::upper_bound ( begin,x+n,centre-window,std::greater<float>() );
+        }
+        first=begin-x;
+        return end-begin;
+    }
+
+    /** @return the step of the grid @param x of @param n points, the smallest one unless all the points are within
+        1% of a step of a uniform grid, @param uniform*/
+    double Step ( const float* x, size_t n, bool& uniform )
+    {
+        uniform=false;
+        if ( n < 2 ) return 0;
+        const double step= ( static_cast<double> ( x[n-1] )-x[0] ) / ( n-1 );
+        uniform=true;
+        double min=std::numeric_limits<double>::max();
+        for ( size_t k=0;k<n;++k )
+        {
+            if ( std::fabs ( x[k]-x[0]-k*step ) > 0.01*std::fabs ( step ) ) uniform=false;
+            if ( k > 0 ) min=std::min ( min,std::fabs ( static_cast<double> ( x[k] )-x[k-1] ) );
+        }
+        return uniform ? std::fabs ( step ) : min;
+    }
+}
+
+LineBroadening::LineBroadening ( Shape shape, double fwhm ) : m_shape ( shape ), m_method ( AUTOMATIC ), m_accuracy ( 5e-3 ),
+    m_fwhm ( fwhm ), m_lorentzianfwhm ( -1 ), m_tolerance ( 1e-4 )
+{
+    Update();
+}
+
+void LineBroadening::SetShape ( Shape shape )
+{
+    m_shape=shape;
+    Update();
+}
+
+void LineBroadening::SetWidth ( double fwhm )
+{
+    m_fwhm=fwhm;
+    Update();
+}
+
+void LineBroadening::SetLorentzianWidth ( double fwhm )
+{
+    m_lorentzianfwhm=fwhm;
+    Update();
+}
+
+void LineBroadening::SetTolerance ( double tolerance )
+{
+    m_tolerance=std::max ( tolerance,0.0 );
+    Update();
+}
+
+void LineBroadening::Update()
+{
+    double gaussian=m_fwhm;
+    double lorentzian=m_fwhm;
+    //the mixing of the pseudo-Voigt shape, eta, weighs the lorentzian part
+    double eta= ( m_shape == LORENTZIAN ) ? 1 : 0;
+    if ( m_shape == VOIGT )
+    {
+        const double fg=m_fwhm;
+        const double fl= ( m_lorentzianfwhm < 0 ) ? m_fwhm : m_lorentzianfwhm;
+        const double f=std::pow ( std::pow ( fg,5 ) +2.69269*std::pow ( fg,4 ) *fl+2.42843*std::pow ( fg,3 ) *fl*fl
+                                  +4.47163*fg*fg*std::pow ( fl,3 ) +0.07842*fg*std::pow ( fl,4 ) +std::pow ( fl,5 ),0.2 );
+        const double r= ( f > 0 ) ? fl/f : 0;
+        eta=1.36603*r-0.47719*r*r+0.11116*r*r*r;
+        gaussian=lorentzian=f;
+    }
+
+    const double sigma=gaussian/fwhmtosigma;
+    const double gamma=lorentzian/2;
+    m_gaussianexponent=static_cast<float> ( 1/ ( 2*sigma*sigma ) );
+    m_gaussiannorm=static_cast<float> ( ( 1-eta ) / ( sigma*std::sqrt ( 2*M_PI ) ) );
+    m_gamma2=static_cast<float> ( gamma*gamma );
+    m_lorentziannorm=static_cast<float> ( eta*gamma/M_PI );
+
+    //distance where each part drops below the tolerance times its height, the gaussian one never beyond the
+    //range of Exp, where it is below the smallest float anyway
+    m_gaussianwindow=sigma*std::sqrt ( -2*minexponent );
+    m_lorentzianwindow=std::numeric_limits<double>::infinity();
+    if ( m_tolerance >= 1 ) m_gaussianwindow=m_lorentzianwindow=0;
+    else if ( m_tolerance > 0 )
+    {
+        m_gaussianwindow=std::min ( m_gaussianwindow,sigma*std::sqrt ( 2*std::log ( 1/m_tolerance ) ) );
+        m_lorentzianwindow=gamma*std::sqrt ( 1/m_tolerance-1 );
+    }
+}
+
+double LineBroadening::Window() const
+{
+    switch ( m_shape )
+    {
+        case GAUSSIAN:
+            return m_gaussianwindow;
+        case LORENTZIAN:
+            return m_lorentzianwindow;
+        default:
+            return std::max ( m_gaussianwindow,m_lorentzianwindow );
+    }
+}
+
+double LineBroadening::Value ( double d ) const
+{
+    double v=0;
+    if ( m_shape != LORENTZIAN ) v+=m_gaussiannorm*std::exp ( -d*d*m_gaussianexponent );
+    if ( m_shape != GAUSSIAN ) v+=m_lorentziannorm/ ( d*d+m_gamma2 );
+    return v;
+}
+
+double LineBroadening::ConvolutionError ( double step ) const
+{
+    //linear interpolation of the line shape between two points, step^2/8 times its curvature at the top
+    const double top=m_gaussiannorm+m_lorentziannorm/m_gamma2;
+    const double curvature=2*m_gaussiannorm*m_gaussianexponent+2*m_lorentziannorm/ ( m_gamma2*m_gamma2 );
+    return step*step/8*curvature/top;
+}
+
+LineBroadening::Method LineBroadening::Choose ( size_t nlines, const float* x, size_t n ) const
+{
+    if ( m_method != AUTOMATIC ) return m_method;
+    if ( n < 2 || nlines == 0 || m_fwhm <= 0 ) return DIRECT;
+    bool uniform;
+    const double step=Step ( x,n,uniform );
+    const double range=std::fabs ( static_cast<double> ( x[n-1] )-x[0] );
+    if ( !( step > 0 ) || range/step+1 > maxrefinement*n ) return DIRECT;
+    if ( ConvolutionError ( step ) * ( uniform ? 1 : 2 ) > m_accuracy ) return DIRECT;
+
+    //points evaluated by the direct sums
+    const double meanstep=range/ ( n-1 );
+    double direct=0;
+    if ( m_shape != LORENTZIAN ) direct+=windowcost+exponentialcost*std::min<double> ( n,2*m_gaussianwindow/meanstep+1 );
+    if ( m_shape != GAUSSIAN ) direct+=windowcost+std::min<double> ( n,2*m_lorentzianwindow/meanstep+1 );
+    direct*=nlines;
+
+    //against the two transforms of a pair of sets, halved, and the binning and interpolation
+    const double npoints=range/step+1;
+    const double l=npoints+2*std::min ( Window() /step,npoints );
+    double m=1;
+    while ( m < l ) m*=2;
+    const double convolution=butterflycost*m*std::log2 ( m ) /2+m+2*nlines+2*n;
+    return convolution < direct ? CONVOLUTION : DIRECT;
+}
+
+void LineBroadening::Broaden ( const SpectralLines& lines, const float* x, float* y, size_t n ) const
+{
+    if ( n == 0 || m_fwhm <= 0 ) return;
+    if ( Choose ( lines.Size(),x,n ) == CONVOLUTION )
+        Convolve ( std::vector<const SpectralLines*> ( 1,&lines ),x,std::vector<float*> ( 1,y ),n );
+    else Sum ( lines,x,y,n );
+}
+
+void LineBroadening::Sum ( const SpectralLines& lines, const float* x, float* y, size_t n ) const
+{
+    const bool ascending=x[0] <= x[n-1];
+    const float gwindow=static_cast<float> ( m_gaussianwindow );
+    const float lwindow=static_cast<float> ( m_lorentzianwindow );
+    const size_t nlines=lines.Size();
+    for ( size_t i=0;i<nlines;++i )
+    {
+        const float centre=lines.x[i];
+        const float area=lines.area[i];
+        if ( area == 0 || !std::isfinite ( centre ) ) continue;
+
+        //each part over the points of its own window
+        long first;
+        long count;
+        if ( m_shape != LORENTZIAN )
+        {
+            count=::Window ( x,n,ascending,centre,gwindow,first );
+            if ( count > 0 ) Gaussian ( x+first,y+first,count,centre,area*m_gaussiannorm,m_gaussianexponent );
+        }
+        if ( m_shape != GAUSSIAN )
+        {
+            count=::Window ( x,n,ascending,centre,lwindow,first );
+            if ( count > 0 ) Lorentzian ( x+first,y+first,count,centre,area*m_lorentziannorm,m_gamma2 );
+        }
+    }
+}
+
+void LineBroadening::Convolve ( const std::vector<const SpectralLines*>& sets, const float* x, const std::vector<float*>& curves,
+                                size_t n ) const
+{
+    bool uniform;
+    const double step=Step ( x,n,uniform );
+    const double range=std::fabs ( static_cast<double> ( x[n-1] )-x[0] );
+    if ( !( step > 0 ) ) return;
+
+    //the uniform grid covers the spectrum and the window of the lines beyond each side, and the transforms are
+    //long enough for the lines not to wrap around
+    const size_t npoints=static_cast<size_t> ( std::ceil ( range/step-1e-3 ) ) +1;
+    const size_t w=static_cast<size_t> ( std::min ( Window() /step,static_cast<double> ( npoints ) ) );
+    const size_t l=npoints+2*w;
+    size_t m=1;
+    while ( m < l ) m*=2;
+    const double origin=std::min ( x[0],x[n-1] )-w*step;
+
+    //the line shape sampled on the grid, wrapped around the origin. Its transform is real as it is even, and
+    //the normalization of the inverse transform is included
+    fidarray kernel ( m );
+    kernel[0]=static_cast<float> ( Value ( 0 ) );
+    for ( size_t i=1;i<=w;++i )
+        kernel[i]=kernel[m-i]=static_cast<float> ( Value ( i*step ) );
+    kernel.fft ( -1 );
+    std::vector<float> filter ( m );
+    for ( size_t i=0;i<m;++i ) filter[i]=kernel[i].real() /m;
+
+    const long npairs=static_cast<long> ( ( sets.size() +1 ) /2 );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for ( long p=0;p<npairs;++p )
+    {
+        const size_t nparts=std::min<size_t> ( 2,sets.size()-2*p );
+        fidarray z ( m );
+        float* data=reinterpret_cast<float*> ( &z[0] );
+        for ( size_t part=0;part<nparts;++part )
+        {
+            const SpectralLines& lines=*sets[2*p+part];
+            for ( size_t i=0;i<lines.Size();++i )
+            {
+                const float area=lines.area[i];
+                const double u= ( lines.x[i]-origin ) /step;
+                if ( area == 0 || !( u >= 0 && u < l-1 ) ) continue;
+                const size_t j=static_cast<size_t> ( u );
+                const float t=static_cast<float> ( u-j );
+                data[2*j+part]+=area* ( 1-t );
+                data[2*j+2+part]+=area*t;
+            }
+        }
+
+        z.fft ( -1 );
+        for ( size_t i=0;i<m;++i ) z[i]*=filter[i];
+        z.fft ( 1 );
+
+        //interpolated to the points of the spectrum
+        for ( size_t part=0;part<nparts;++part )
+        {
+            float* y=curves[2*p+part];
+            for ( size_t k=0;k<n;++k )
+            {
+                const double u=std::min ( std::max ( ( x[k]-origin ) /step,0.0 ),static_cast<double> ( l-1 ) );
+                const size_t j=std::min ( static_cast<size_t> ( u ),l-2 );
+                const float t=static_cast<float> ( u-j );
+                y[k]+=data[2*j+part]* ( 1-t ) +data[2*j+2+part]*t;
+            }
+        }
+    }
+}
+
+void LineBroadening::Broaden ( const std::vector<SpectralLines>& sets, const std::vector<float>& x,
+                               std::vector< std::vector<float> >& curves ) const
+{
+    curves.resize ( sets.size() );
+    std::vector<const SpectralLines*> psets ( sets.size() );
+    std::vector<float*> pcurves ( sets.size() );
+    for ( size_t i=0;i<sets.size();++i )
+    {
+        curves[i].assign ( x.size(),0.f );
+        psets[i]=&sets[i];
+        pcurves[i]=curves[i].data();
+    }
+    Broaden ( psets,x.data(),pcurves,x.size() );
+}
+
+void LineBroadening::Broaden ( const std::vector<const SpectralLines*>& sets, const float* x, const std::vector<float*>& curves,
+                               size_t n ) const
+{
+    if ( n == 0 || sets.empty() || m_fwhm <= 0 ) return;
+
+    size_t nlines=0;
+    for ( const auto s : sets ) nlines+=s->Size();
+    if ( Choose ( nlines/sets.size(),x,n ) == CONVOLUTION )
+    {
+        Convolve ( sets,x,curves,n );
+        return;
+    }
+
+    const long nsets=static_cast<long> ( sets.size() );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for ( long i=0;i<nsets;++i )
+        Sum ( *sets[i],x,curves[i],n );
+}
+
+bool LineBroadening::operator== ( const LineBroadening& other ) const
+{
+    return m_shape == other.m_shape && m_method == other.m_method && m_accuracy == other.m_accuracy &&
+           m_fwhm == other.m_fwhm && m_lorentzianfwhm == other.m_lorentzianfwhm && m_tolerance == other.m_tolerance;
+}
+
+std::vector<float> LineBroadening::Grid ( double min, double max, size_t n )
+{
+    std::vector<float> x ( n );
+    const double delta= ( n > 1 ) ? ( max-min ) / ( n-1 ) : 0;
+    for ( size_t k=0;k<n;++k ) x[k]=static_cast<float> ( min+k*delta );
+    return x;
+}
+
+EnsembleSpectrum::EnsembleSpectrum ( LineBroadening::Shape shape ) : m_broadening ( shape ), m_broadenedshape ( shape )
+{}
+
+void EnsembleSpectrum::SetWeights ( const std::vector<double>& weights )
+{
+    m_weights=weights;
+    Sum();
+}
+
+void EnsembleSpectrum::SetIncluded ( const std::vector<bool>& included )
+{
+    m_included=included;
+    Sum();
+}
+
+double EnsembleSpectrum::Weight ( size_t i ) const
+{
+    auto weight=[this] ( size_t j )
+    {
+        if ( j < m_included.size() && !m_included[j] ) return 0.0;
+        return ( j < m_weights.size() ) ? m_weights[j] : ( m_weights.empty() ? 1.0 : 0.0 );
+    };
+    double sum=0;
+    for ( size_t j=0;j<m_curves.size();++j ) sum+=weight ( j );
+    return ( sum != 0 ) ? weight ( i ) /sum : 0;
+}
+
+std::vector<size_t> EnsembleSpectrum::Calculate()
+{
+    const size_t n=m_lines.size();
+    const bool all= m_broadening != m_broadenedshape || m_grid != m_broadenedgrid;
+    m_curves.resize ( n );
+    m_broadened.resize ( n );
+
+    std::vector<size_t> changed;
+    std::vector<const SpectralLines*> sets;
+    std::vector<float*> curves;
+    for ( size_t i=0;i<n;++i )
+    {
+        if ( !all && m_curves[i].size() == m_grid.size() && m_lines[i] == m_broadened[i] ) continue;
+        changed.push_back ( i );
+        m_broadened[i]=m_lines[i];
+        m_curves[i].assign ( m_grid.size(),0.f );
+        sets.push_back ( &m_broadened[i] );
+        curves.push_back ( m_curves[i].data() );
+    }
+    m_broadening.Broaden ( sets,m_grid.data(),curves,m_grid.size() );
+    m_broadenedshape=m_broadening;
+    m_broadenedgrid=m_grid;
+
+    Sum();
+    return changed;
+}
+
+void EnsembleSpectrum::Sum()
+{
+    const size_t npoints=m_grid.size();
+    m_total.assign ( npoints,0.f );
+    std::vector<float> weights ( m_curves.size() );
+    for ( size_t i=0;i<m_curves.size();++i )
+        weights[i]= ( m_curves[i].size() == npoints ) ? static_cast<float> ( Weight ( i ) ) : 0.f;
+
+    //blocks of points, each one adding the curves in turn
+    const long nblocks=static_cast<long> ( ( npoints+sumblock-1 ) /sumblock );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for ( long b=0;b<nblocks;++b )
+    {
+        const size_t first=b*sumblock;
+        const long count=static_cast<long> ( std::min ( sumblock,npoints-first ) );
+        float* total=m_total.data() +first;
+        for ( size_t i=0;i<m_curves.size();++i )
+        {
+            const float w=weights[i];
+            if ( w == 0 ) continue;
+            const float* curve=m_curves[i].data() +first;
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+            for ( long k=0;k<count;++k ) total[k]+=w*curve[k];
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/*****************************************************************************************
+                            linebroadening.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef LINEBROADENING_H
+#define LINEBROADENING_H
+
+#include <cstddef>
+#include <vector>
+
+#include "coreexport.h"
+
+namespace kryomol
+{
+  /** @brief the lines of a spectrum, their positions and areas in two contiguous arrays*/
+  struct SpectralLines
+  {
+    std::vector<float> x;
+    std::vector<float> area;
+    void Resize ( size_t n )
+    {
+      x.resize ( n );
+      area.resize ( n );
+    }
+    size_t Size() const { return x.size(); }
+    bool Empty() const { return x.empty(); }
+    bool operator== ( const SpectralLines& other ) const { return x == other.x && area == other.area; }
+    bool operator!= ( const SpectralLines& other ) const { return ! ( *this == other ); }
+  };
+
+  /** @brief broadening of line spectra with gaussian, lorentzian or Voigt line shapes
+
+  Every line is spread over the points of a grid as its area times the line shape, normalized to unit area.
+  The constants of the shape are computed once when it is set, and each line is evaluated only in the window
+  of points where it is above @see Tolerance times its height, found by binary search in the grid, so the
+  cost grows with the points in the windows of the lines instead of the whole grid. The points of a window
+  are contiguous and evaluated in a vectorized loop (WITH_OPENMP), and line sets, one for each conformer,
+  are broadened concurrently. The Voigt shape is the pseudo-Voigt approximation of Thompson, Cox and
+  Hastings, within 1% of the convolution.
+
+  Dense line sets on fine grids are instead binned onto a uniform grid, splitting each line between its two
+  nearest points, and convolved with the line shape sampled on the grid, by FFT with @see fidarray. The
+  transform of the line shape is computed once for all the sets, and the sets are transformed in pairs as the
+  real and imaginary parts of a single array. Binning is exact for lines on the points of the grid and
+  otherwise smooths the lines slightly, by the error of @see ConvolutionError. The automatic method convolves
+  when that error is within @see Accuracy and the transforms are cheaper than the direct sums*/
+  class KRYOMOLCORE_API LineBroadening
+  {
+    public:
+      enum Shape { GAUSSIAN, LORENTZIAN, VOIGT };
+      enum Method { AUTOMATIC, DIRECT, CONVOLUTION };
+      LineBroadening ( Shape shape=GAUSSIAN, double fwhm=1.0 );
+      void SetShape ( Shape shape );
+      Shape GetShape() const { return m_shape; }
+      /** set the full width at half maximum of the gaussian or lorentzian shape, and of the gaussian part of the
+          Voigt one*/
+      void SetWidth ( double fwhm );
+      double Width() const { return m_fwhm; }
+      /** set the full width at half maximum of the lorentzian part of the Voigt shape, the same as the gaussian
+          one if negative*/
+      void SetLorentzianWidth ( double fwhm );
+      /** truncate the lines where they drop below @param tolerance times their height, 0 to evaluate them on
+          the whole grid*/
+      void SetTolerance ( double tolerance );
+      double Tolerance() const { return m_tolerance; }
+      /** @return the half width of the window of the lines*/
+      double Window() const;
+      void SetMethod ( Method method ) { m_method=method; }
+      Method GetMethod() const { return m_method; }
+      /** set the largest error of the convolution, relative to the height of a line, for the automatic method to
+          choose it*/
+      void SetAccuracy ( double accuracy ) { m_accuracy=accuracy; }
+      double Accuracy() const { return m_accuracy; }
+      /** @return the largest error of a line binned on a grid of step @param step, relative to its height.
+          Interpolating to a non uniform grid doubles it. The errors of overlapping lines add up, but they are
+          usually below it relative to the height of the curve*/
+      double ConvolutionError ( double step ) const;
+      /** @return the method, DIRECT or CONVOLUTION, for sets of @param nlines lines on the grid @param x of
+          @param n points*/
+      Method Choose ( size_t nlines, const float* x, size_t n ) const;
+      /** @return the line shape at distance @param d of its centre*/
+      double Value ( double d ) const;
+      /** add the lines @param lines to @param y, the values at the ascending or descending abscissae @param x
+          of a grid of @param n points*/
+      void Broaden ( const SpectralLines& lines, const float* x, float* y, size_t n ) const;
+      /** broaden each line set of @param sets in a curve of its own in @param curves, on the grid @param x*/
+      void Broaden ( const std::vector<SpectralLines>& sets, const std::vector<float>& x,
+                     std::vector< std::vector<float> >& curves ) const;
+      /** add each line set of @param sets to its curve of @param curves, the values at the abscissae @param x of
+          a grid of @param n points*/
+      void Broaden ( const std::vector<const SpectralLines*>& sets, const float* x, const std::vector<float*>& curves,
+                     size_t n ) const;
+      /** @return true if @param other gives the same curves*/
+      bool operator== ( const LineBroadening& other ) const;
+      bool operator!= ( const LineBroadening& other ) const { return ! ( *this == other ); }
+      /** @return @param n equally spaced abscissae from @param min to @param max*/
+      static std::vector<float> Grid ( double min, double max, size_t n );
+    private:
+      /** compute the constants of the shape and the window*/
+      void Update();
+      /** sum the lines @param lines to @param y by the direct method*/
+      void Sum ( const SpectralLines& lines, const float* x, float* y, size_t n ) const;
+      /** convolve the sets @param sets to the curves @param curves, all of them of @param n points*/
+      void Convolve ( const std::vector<const SpectralLines*>& sets, const float* x, const std::vector<float*>& curves,
+                      size_t n ) const;
+    private:
+      Shape m_shape;
+      Method m_method;
+      double m_accuracy;
+      double m_fwhm;
+      double m_lorentzianfwhm;
+      double m_tolerance;
+      /** half widths of the windows of the gaussian and lorentzian parts*/
+      double m_gaussianwindow;
+      double m_lorentzianwindow;
+      /** 1/(2 sigma^2) and 1/(sigma sqrt(2 pi)) of the gaussian part*/
+      float m_gaussianexponent;
+      float m_gaussiannorm;
+      /** gamma^2 and gamma/pi of the lorentzian part*/
+      float m_gamma2;
+      float m_lorentziannorm;
+  };
+
+  /** @brief broadened spectra of the conformers of an ensemble and their weighted sum
+
+  The curve of each conformer is kept with the lines it was broadened from, and it is broadened again only when
+  they, the line shape or the grid change, so new populations, or conformers left out of the sum, only add up
+  the kept curves again. The weights are normalized over the conformers in the sum*/
+  class KRYOMOLCORE_API EnsembleSpectrum
+  {
+    public:
+      EnsembleSpectrum ( LineBroadening::Shape shape=LineBroadening::GAUSSIAN );
+      LineBroadening& Broadening() { return m_broadening; }
+      const LineBroadening& Broadening() const { return m_broadening; }
+      /** @return the lines of each conformer*/
+      std::vector<SpectralLines>& Lines() { return m_lines; }
+      const std::vector<SpectralLines>& Lines() const { return m_lines; }
+      /** set the abscissae of the points of the curves*/
+      void SetGrid ( const std::vector<float>& x ) { m_grid=x; }
+      const std::vector<float>& Grid() const { return m_grid; }
+      /** set the weight of each conformer, the same for all if @param weights is empty, and sum the curves*/
+      void SetWeights ( const std::vector<double>& weights );
+      /** sum only the curves of the conformers flagged in @param included, all if it is empty*/
+      void SetIncluded ( const std::vector<bool>& included );
+      /** @return the normalized weight of conformer @param i in the sum*/
+      double Weight ( size_t i ) const;
+      /** broaden the conformers whose lines, line shape or grid changed and sum the curves
+          @return the conformers broadened*/
+      std::vector<size_t> Calculate();
+      size_t Size() const { return m_curves.size(); }
+      const std::vector<float>& Curve ( size_t i ) const { return m_curves[i]; }
+      const std::vector<float>& Total() const { return m_total; }
+    private:
+      void Sum();
+    private:
+      LineBroadening m_broadening;
+      std::vector<SpectralLines> m_lines;
+      std::vector<float> m_grid;
+      std::vector<double> m_weights;
+      std::vector<bool> m_included;
+      /** the lines, line shape and grid of the kept curves*/
+      std::vector<SpectralLines> m_broadened;
+      LineBroadening m_broadenedshape;
+      std::vector<float> m_broadenedgrid;
+      std::vector< std::vector<float> > m_curves;
+      std::vector<float> m_total;
+  };
+}
+
+#endif
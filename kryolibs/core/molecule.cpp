@@ -13,9 +13,12 @@ the Free Software Foundation version 2 of the License.
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <memory>
 
 #include "molecule.h"
+#include "framesource.h"
 #include "ringperceptor.h"
+#include "superposition.h"
 #include "stringtools.h"
 #include "exception.h"
 
@@ -31,7 +34,7 @@ class kryomol::MoleculePrivate
 {
 public:
 
-    MoleculePrivate()  : m_currentframe ( 0 )
+    MoleculePrivate()  : m_currentframe ( 0 ), m_sourceframe ( 0 ), m_coordinatesversion ( 0 )
     {}
     MoleculePrivate ( const MoleculePrivate& mol )
     {
@@ -39,6 +42,9 @@ public:
         m_currentframe=mol.m_currentframe;
         m_bonds=mol.m_bonds;
         m_frames=mol.m_frames;
+        m_source=mol.m_source;
+        m_sourceframe=mol.m_sourceframe;
+        m_coordinatesversion=mol.m_coordinatesversion;
         m_populations=mol.m_populations;
         m_residues.reserve ( mol.m_residues.size() );
         for ( std::vector<PDBResidue*>::const_iterator it=mol.m_residues.begin();it!=mol.m_residues.end();++it )
@@ -56,6 +62,9 @@ public:
             m_currentframe=mol.m_currentframe;
             m_bonds=mol.m_bonds;
             m_frames=mol.m_frames;
+            m_source=mol.m_source;
+            m_sourceframe=mol.m_sourceframe;
+            m_coordinatesversion=mol.m_coordinatesversion;
             m_populations=mol.m_populations;
             for ( std::vector<PDBResidue*>::iterator it=m_residues.begin();it!=m_residues.end();++it )
             {
@@ -80,9 +89,16 @@ public:
     size_t m_currentframe;
     std::vector<Bond> m_bonds;
     std::vector<Frame> m_frames;
+    /** structures read on demand into the single frame, shared by the copies of the molecule*/
+    std::shared_ptr<FrameSource> m_source;
+    /** structure of the source in the frame*/
+    size_t m_sourceframe;
+    /** increased whenever atoms move*/
+    size_t m_coordinatesversion;
     std::vector<double> m_populations;
     std::vector<PDBResidue*> m_residues;
     std::string m_energylevel;
+    RingCache m_rings;
 };
 
 
@@ -184,15 +200,18 @@ void Molecule::MoveToCentroid()
             ct->z()-=cm.z();
         }
     }
-
+    CoordinatesChanged();
 
 }
 
 std::vector < std::vector<size_t> > Molecule::Rings ( size_t size/*=0*/ ) const
 {
-    std::cout << "Rings" << std::endl;
-    RingPerceptor pr ( this );
-    return pr.Rings ( size );
+    return m_private->m_rings.Rings ( Atoms().size(),Bonds(),size );
+}
+
+std::vector < std::vector<size_t> > Molecule::RelevantCycles ( size_t size/*=0*/ ) const
+{
+    return m_private->m_rings.RelevantCycles ( Atoms().size(),Bonds(),size );
 }
 
 
@@ -381,14 +400,65 @@ Frame& Molecule::CurrentFrame()
 
 size_t Molecule::CurrentFrameIndex() const
 {
+    if ( m_private->m_source ) return m_private->m_sourceframe;
     return m_private->m_currentframe;
 }
 
 void Molecule::SetCurrentFrame ( size_t i )
 {
+    if ( m_private->m_source )
+    {
+        if ( i >= m_private->m_source->Size() ) return;
+        if ( m_private->m_frames.empty() ) m_private->m_frames.push_back ( Frame ( this ) );
+        //a malformed structure is not selected, the frame keeps the one read before
+        if ( !m_private->m_source->Read ( i,m_private->m_frames.front() ) ) return;
+        m_private->m_sourceframe=i;
+        CoordinatesChanged();
+        m_private->m_currentframe=0;
+        return;
+    }
     m_private->m_currentframe=i;
 }
 
+size_t Molecule::FrameCount() const
+{
+    if ( m_private->m_source ) return m_private->m_source->Size();
+    return m_private->m_frames.size();
+}
+
+void Molecule::SetFrameSource ( FrameSource* source )
+{
+    m_private->m_source.reset ( source );
+    m_private->m_sourceframe=0;
+    m_private->m_currentframe=0;
+    if ( source == NULL ) return;
+    m_private->m_frames.resize ( 1,Frame ( this ) );
+    if ( source->Size() > 0 ) SetCurrentFrame ( 0 );
+}
+
+bool Molecule::HasFrameSource() const
+{
+    return static_cast<bool> ( m_private->m_source );
+}
+
+bool Molecule::ReadFrame ( size_t i, Frame& frame ) const
+{
+    if ( m_private->m_source )
+        return m_private->m_source->Read ( i,frame );
+    frame=m_private->m_frames.at ( i );
+    return true;
+}
+
+size_t Molecule::CoordinatesVersion() const
+{
+    return m_private->m_coordinatesversion;
+}
+
+void Molecule::CoordinatesChanged()
+{
+    ++m_private->m_coordinatesversion;
+}
+
 const std::vector<Bond>& Molecule::Bonds() const
 {
     return m_private->m_bonds;
@@ -513,205 +583,30 @@ std::vector<double>& Molecule::Populations()
     return m_private->m_populations;
 }
 
-void Molecule::SuperImpose(size_t refframe)
+std::vector<double> Molecule::SuperImpose(size_t refframe)
 {
-    std::vector<size_t> atoms(Atoms().size());
-    for(size_t i=0;i<atoms.size();++i)
-        atoms[i]=i;
-    SuperImpose(refframe,atoms);
+    if ( HasFrameSource() ) throw kryomol::Exception("The structures read on demand from the file can not be superimposed");
+    CoordinatesChanged();
+    return Superposition(*this,std::vector<size_t>()).Apply(*this,refframe);
 }
 
 
-void Molecule::SuperImpose(size_t refframe, const std::vector<size_t>& atoms)
+std::vector<double> Molecule::SuperImpose(size_t refframe, const std::vector<size_t>& atoms)
 {
     if ( atoms.empty() ) throw kryomol::Exception("The atom list is empty");
+    if ( HasFrameSource() ) throw kryomol::Exception("The structures read on demand from the file can not be superimposed");
 
-
-    for(size_t frame=0;frame<Frames().size();++frame)
-    {
-        Coordinate centroid(0,0,0);
-        
-        for(size_t i=0;i<atoms.size();++i)
-        {
-            centroid.x()+=Frames().at(frame).XYZ().at(atoms[i]).x();
-            centroid.y()+=Frames().at(frame).XYZ().at(atoms[i]).y();
-            centroid.z()+=Frames().at(frame).XYZ().at(atoms[i]).z();
-
-        }
-        centroid.x()/=atoms.size();
-        centroid.y()/=atoms.size();
-        centroid.z()/=atoms.size();
-        
-        for(std::vector<Coordinate>::iterator ct=Frames().at(frame).XYZ().begin();ct!=Frames().at(frame).XYZ().end();++ct)
-        {
-            (*ct)-=centroid;
-        }
-        
-    }
-
-    size_t nrows=3*atoms.size();
-    D2Array<double> modelmatrix(nrows,3);
-    D1Array<double> solution(3);
-    D1Array<double> diff(nrows);
-    for(size_t frame=0;frame<Frames().size();++frame)
-    {
-        size_t nrow=0;
-        if ( frame != refframe )
-        {
-            for(size_t natom=0;natom<atoms.size();++natom)
-            {
-                size_t atomindex=atoms[natom];
-                double resx=Frames().at(frame).XYZ().at(atomindex).x()-Frames().at(refframe).XYZ().at(atomindex).x();
-                double resy=Frames().at(frame).XYZ().at(atomindex).y()-Frames().at(refframe).XYZ().at(atomindex).y();
-                double resz=Frames().at(frame).XYZ().at(atomindex).z()-Frames().at(refframe).XYZ().at(atomindex).z();
-
-                double xx=       Frames().at(refframe).XYZ().at(atomindex).x()+Frames().at(frame).XYZ().at(atomindex).x();
-                double yy= Frames().at(refframe).XYZ().at(atomindex).y()+Frames().at(frame).XYZ().at(atomindex).y();
-                double zz=Frames().at(refframe).XYZ().at(atomindex).z()+Frames().at(frame).XYZ().at(atomindex).z();
-
-                modelmatrix(nrow,0)=0;
-                modelmatrix(nrow,1)=zz;
-                modelmatrix(nrow,2)=-yy;
-                diff(nrow)=resx;
-                nrow++;
-                modelmatrix(nrow,0)=-zz;
-                modelmatrix(nrow,1)=0;
-                modelmatrix(nrow,2)=xx;
-                diff(nrow)=resy;
-                nrow++;
-
-                modelmatrix(nrow,0)=yy;
-                modelmatrix(nrow,1)=-xx;
-                modelmatrix(nrow,2)=0;
-                diff(nrow)=resz;
-                nrow++;
-            }
-            //qryomol::SVDFit(diff,modelmatrix,solution);
-            for(size_t i=0;i<3;++i)
-                std::cout << "sol(i)=" << solution(i) << std::endl;
-            double solsum=solution(0)*solution(0)+solution(1)*solution(1)+solution(2)*solution(2);
-            //\tan(theta/2)
-            double t=sqrt(solsum);
-            //obtaint the directo cosines l m and n
-            solution(0)/=t;
-            solution(1)/=t;
-            solution(2)/=t;
-            double angle=atan(t);
-            std::cout << "angle is " << (180*angle/M_PI) << std::endl;
-
-            double cangle=cos(angle);
-            double sangle=sin(angle);
-
-            Quaternion q(cangle,Coordinate(solution(0)*sangle,solution(1)*sangle,solution(2)*sangle));
-            Quaternion q1=q.Invert();
-            //and now apply rotation
-            for(std::vector<Coordinate>::iterator ct=Frames().at(frame).XYZ().begin();ct!=Frames().at(frame).XYZ().end();++ct)
-            {
-                (*ct)=(q1^(*ct)^q).V();
-            }
-            std::cout << Frames().at(frame) << std::endl;
-
-        }
-    }
-
+    CoordinatesChanged();
+    return Superposition(*this,atoms).Apply(*this,refframe);
 }
 
-void Molecule::EckartTransform(size_t refframe, const std::vector<size_t>& atoms)
+std::vector<double> Molecule::EckartTransform(size_t refframe, const std::vector<size_t>& atoms)
 {
     if ( atoms.empty() ) throw kryomol::Exception("The atom list is empty");
+    if ( HasFrameSource() ) throw kryomol::Exception("The structures read on demand from the file can not be transformed");
 
-    for(size_t frame=0;frame<Frames().size();++frame)
-    {
-        Coordinate masscenter(0,0,0);
-        double totalmass=0;
-        for(size_t i=0;i<atoms.size();++i)
-        {
-            double mass =this->Atoms().at(i).AtomicMass();
-            masscenter.x()+=Frames().at(frame).XYZ().at(atoms[i]).x()*mass;
-            masscenter.y()+=Frames().at(frame).XYZ().at(atoms[i]).y()*mass;
-            masscenter.z()+=Frames().at(frame).XYZ().at(atoms[i]).z()*mass;
-            totalmass+=mass;
-
-        }
-        masscenter.x()/=totalmass;
-        masscenter.y()/=totalmass;
-        masscenter.z()/=totalmass;
-
-        for(std::vector<Coordinate>::iterator ct=Frames().at(frame).XYZ().begin();ct!=Frames().at(frame).XYZ().end();++ct)
-        {
-            (*ct)-=masscenter;
-        }
-
-    }
-
-
-
-    size_t nrows=3*atoms.size();
-    D2Array<double> modelmatrix(nrows,3);
-    D1Array<double> solution(3);
-    D1Array<double> diff(nrows);
-    for(size_t frame=0;frame<Frames().size();++frame)
-    {
-        size_t nrow=0;
-        if ( frame != refframe )
-        {
-            for(size_t natom=0;natom<atoms.size();++natom)
-            {
-                size_t atomindex=atoms[natom];
-                double mass =this->Atoms().at(natom).AtomicMass();
-                double resx=Frames().at(frame).XYZ().at(atomindex).x()-Frames().at(refframe).XYZ().at(atomindex).x();
-                double resy=Frames().at(frame).XYZ().at(atomindex).y()-Frames().at(refframe).XYZ().at(atomindex).y();
-                double resz=Frames().at(frame).XYZ().at(atomindex).z()-Frames().at(refframe).XYZ().at(atomindex).z();
-
-                double xx=       Frames().at(refframe).XYZ().at(atomindex).x()+Frames().at(frame).XYZ().at(atomindex).x();
-                double yy= Frames().at(refframe).XYZ().at(atomindex).y()+Frames().at(frame).XYZ().at(atomindex).y();
-                double zz=Frames().at(refframe).XYZ().at(atomindex).z()+Frames().at(frame).XYZ().at(atomindex).z();
-
-                modelmatrix(nrow,0)=0;
-                modelmatrix(nrow,1)=mass*zz;
-                modelmatrix(nrow,2)=-mass*yy;
-                diff(nrow)=mass*resx;
-                nrow++;
-                modelmatrix(nrow,0)=-mass*zz;
-                modelmatrix(nrow,1)=0;
-                modelmatrix(nrow,2)=mass*xx;
-                diff(nrow)=mass*resy;
-                nrow++;
-
-                modelmatrix(nrow,0)=mass*yy;
-                modelmatrix(nrow,1)=-mass*xx;
-                modelmatrix(nrow,2)=0;
-                diff(nrow)=mass*resz;
-                nrow++;
-            }
-            //qryomol::SVDFit(diff,modelmatrix,solution);
-            for(size_t i=0;i<3;++i)
-                std::cout << "sol(i)=" << solution(i) << std::endl;
-            double solsum=solution(0)*solution(0)+solution(1)*solution(1)+solution(2)*solution(2);
-            //\tan(theta/2)
-            double t=sqrt(solsum);
-            //obtaint the directo cosines l m and n
-            solution(0)/=t;
-            solution(1)/=t;
-            solution(2)/=t;
-            double angle=atan(t);
-            std::cout << "angle is " << (180*angle/M_PI) << std::endl;
-
-            double cangle=cos(angle);
-            double sangle=sin(angle);
-
-            Quaternion q(cangle,Coordinate(solution(0)*sangle,solution(1)*sangle,solution(2)*sangle));
-            Quaternion q1=q.Invert();
-            //and now apply rotation
-            for(std::vector<Coordinate>::iterator ct=Frames().at(frame).XYZ().begin();ct!=Frames().at(frame).XYZ().end();++ct)
-            {
-                (*ct)=(q1^(*ct)^q).V();
-            }
-            std::cout << Frames().at(frame) << std::endl;
-
-        }
-    }
-
+    CoordinatesChanged();
+    return Superposition(*this,atoms,true).Apply(*this,refframe);
 }
 
 
@@ -739,6 +634,7 @@ void Molecule::CalculateMassCenter(bool real)
         }
 
     }
+    CoordinatesChanged();
 }
 
 
@@ -761,6 +657,7 @@ void Molecule::RotateBond(size_t i, size_t j, int sense)
     bool clockwise = ( sense <= 0);
     qDebug() << "sense=" << clockwise;
     this->CurrentFrame().RotateBond(i,j,rotbondpass, clockwise );
+    CoordinatesChanged();
     /*m_rotaxis[0]=CurrentFrame().XYZ().at(i);
   m_rotaxis[1]=CurrentFrame().XYZ().at(j);
   float pass=rotbondpass;
@@ -26,6 +26,7 @@ the Free Software Foundation version 2 of the License.
 #include "frame.h"
 #include "threshold.h"
 #include "frequency.h"
+#include "normalmodes.h"
 /** */
 namespace kryomol
 {
@@ -37,6 +38,7 @@ namespace kryomol
 
   class MoleculePrivate;
   class FramePrivate;
+  class FrameSource;
 
   class KRYOMOLCORE_API Molecule
   {
@@ -96,8 +98,22 @@ namespace kryomol
       Frame& CurrentFrame();
       /** return the index of the current conformer*/
       size_t CurrentFrameIndex() const;
-      /** set the active conformer to i*/
+      /** set the active conformer to i, read from the frame source if the molecule has one*/
       void SetCurrentFrame ( size_t i ) ;
+      /** @return the number of conformers, those of the frame source if the molecule has one, otherwise the size of Frames()*/
+      size_t FrameCount() const;
+      /** read the conformers from @param source on demand, Frames() then holds only the current one. The molecule takes
+          the ownership of the source, shared with its copies, NULL keeps the frames in memory again*/
+      void SetFrameSource ( FrameSource* source );
+      /** @return true if the conformers are read on demand from a frame source*/
+      bool HasFrameSource() const;
+      /** copy conformer @param i to @param frame, reading it from the frame source if the molecule has one
+          @return false if the source can not read it, @param frame is then left unchanged*/
+      bool ReadFrame ( size_t i, Frame& frame ) const;
+      /** @return a counter increased whenever the atoms of any frame move, to update what is computed from them*/
+      size_t CoordinatesVersion() const;
+      /** mark the coordinates as changed, to be called after moving atoms through Frames() or XYZ() directly*/
+      void CoordinatesChanged();
       /** @return a const stl vector of atoms in this molecule*/
       const std::vector<Atom>& Atoms() const;
       /** @return a const stl vector of atoms in this molecule*/
@@ -116,8 +132,10 @@ namespace kryomol
       double Weight() const { return CalculateWeight(); }
       /** move molecule to the centroid*/
       void MoveToCentroid();
-      /** Get the rings of size size*/
+      /** Get the rings of size size (smallest set of smallest rings)*/
       std::vector < std::vector<size_t> > Rings ( size_t size=0 ) const;
+      /** Get the relevant cycles of size size, the union of all the smallest sets of smallest rings*/
+      std::vector < std::vector<size_t> > RelevantCycles ( size_t size=0 ) const;
       /** obsolete */
       std::vector<int>  FindAtomByName ( const std::string& name ) const;
       /** Calculate Molecular Weight */
@@ -138,17 +156,17 @@ namespace kryomol
       std::vector<size_t> Neighbours ( size_t i ) const;
       /** return the index of the atom from its pdb name*/
       size_t IndexFromPDB(const std::string& pdbname,const std::string& resname,const std::string& resindex) const;
-      /** Super impose frames to referance frame*/
-      void SuperImpose(size_t refframe);
-      /** superimpose all frames to reference frame f, minimizing the displacements for atoms*/
-      void SuperImpose(size_t reframe, const std::vector<size_t>& atoms); 
-      /** superimpose all frames to reference frame f, minimizing the displacements for atoms,using mass weighted coordinates*/
-      void EckartTransform(size_t reframe, const std::vector<size_t>& atoms);
+      /** Super impose frames to referance frame. @return the rmsd of each frame*/
+      std::vector<double> SuperImpose(size_t refframe);
+      /** superimpose all frames to reference frame f, minimizing the displacements for atoms. @return the rmsd of each frame*/
+      std::vector<double> SuperImpose(size_t reframe, const std::vector<size_t>& atoms);
+      /** superimpose all frames to reference frame f, minimizing the displacements for atoms,using mass weighted coordinates. @return the rmsd of each frame*/
+      std::vector<double> EckartTransform(size_t reframe, const std::vector<size_t>& atoms);
       std::vector<Coordinate>& InputOrientation() { return m_inputorientation; }
       const std::vector<Coordinate>& InputOrientation() const { return m_inputorientation; }
-      std::vector< std::vector<Coordinate> >& GetMode() { return m_mode; }
-      const std::vector< std::vector<Coordinate> >& GetMode() const { return m_mode; }
-      //void SetMode(size_t index, const Coordinate c) { m_mode[index] = c; }
+      /** @return the cartesian displacements of the normal modes*/
+      NormalModes& Modes() { return m_modes; }
+      const NormalModes& Modes() const { return m_modes; }
 
       void CalculateMassCenter(bool real=false);
       //void SetDihedral(size_t i, size_t j, size_t k, size_t l,float dihedral);
@@ -171,7 +189,7 @@ namespace kryomol
       std::vector < Coupling > m_couplings;
       std::vector<size_t> m_rotatedatoms;
 
-      std::vector< std::vector<Coordinate> > m_mode;
+      NormalModes m_modes;
 
   private:
       bool FindInShell(std::vector<size_t>& searched,size_t j) const;
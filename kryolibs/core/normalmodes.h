@@ -0,0 +1,90 @@
+/*****************************************************************************************
+                            normalmodes.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef NORMALMODES_H
+#define NORMALMODES_H
+
+#include <assert.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "coordinate.h"
+#include "exception.h"
+
+namespace kryomol
+{
+  /** @brief the cartesian displacements of the normal modes of a molecule
+
+  The modes are stored as a single 3N x M matrix of M modes of N atoms, one mode after another, each one as
+  the x, y and z displacements of every atom in turn. The frequencies and intensities of the modes are kept by
+  each frame, @see Frame::GetFrequencies*/
+  class NormalModes
+  {
+    public:
+      NormalModes() : m_natoms ( 0 ) {}
+      /** make room for @param nmodes modes of @param natoms atoms, all the displacements zero*/
+      void Initialize ( size_t nmodes, size_t natoms )
+      {
+        m_natoms=natoms;
+        m_displacements.assign ( 3*natoms*nmodes,0.0f );
+      }
+      /** keep the first @param nmodes modes, the new ones zero*/
+      void Resize ( size_t nmodes ) { m_displacements.resize ( 3*m_natoms*nmodes,0.0f ); }
+      void Clear()
+      {
+        m_natoms=0;
+        m_displacements.clear();
+      }
+      bool Empty() const { return m_displacements.empty(); }
+      /** @return the number of modes*/
+      size_t Size() const { return m_natoms == 0 ? 0 : m_displacements.size() / ( 3*m_natoms ); }
+      size_t NAtoms() const { return m_natoms; }
+      /** @return displacement @param coordinate, 3*atom+0, 1 or 2 for x, y or z, of mode @param mode*/
+      float& operator() ( size_t mode, size_t coordinate ) { return m_displacements[3*m_natoms*mode+coordinate]; }
+      const float& operator() ( size_t mode, size_t coordinate ) const { return m_displacements[3*m_natoms*mode+coordinate]; }
+      /** @return the 3N displacements of mode @param mode*/
+      const float* Mode ( size_t mode ) const
+      {
+        assert ( mode < Size() );
+        return &m_displacements[3*m_natoms*mode];
+      }
+      /** @return the displacement of @param atom in mode @param mode*/
+      Coordinate Displacement ( size_t mode, size_t atom ) const
+      {
+        assert ( atom < m_natoms );
+        const float* d=Mode ( mode ) +3*atom;
+        return Coordinate ( d[0],d[1],d[2] );
+      }
+      /** add @param factor times mode @param mode to the coordinates @param xyz. The mode is usually chosen
+          in the interface, a mode out of range throws kryomol::Exception*/
+      void Displace ( size_t mode, float factor, std::vector<Coordinate>& xyz ) const
+      {
+        if ( mode >= Size() ) throw kryomol::Exception ( "normal mode out of range" );
+        const float* d=Mode ( mode );
+        const size_t n=std::min ( xyz.size(),m_natoms );
+        for ( size_t i=0;i<n;++i,d+=3 )
+        {
+          xyz[i].x() +=factor*d[0];
+          xyz[i].y() +=factor*d[1];
+          xyz[i].z() +=factor*d[2];
+        }
+      }
+      /** @return the whole matrix, mode after mode*/
+      const std::vector<float>& Data() const { return m_displacements; }
+      std::vector<float>& Data() { return m_displacements; }
+    private:
+      size_t m_natoms;
+      std::vector<float> m_displacements;
+  };
+}
+
+#endif
@@ -33,10 +33,13 @@ public:
     Orbital();
     Orbital(OrbitalType orbitaltype, std::vector<float> alpha, std::vector<float> xs, std::vector<float> xp) { m_orbitaltype=orbitaltype;  m_alpha=alpha; m_xs=xs; m_xp=xp;}
 
-    OrbitalType Type() { return m_orbitaltype; }
+    OrbitalType Type() const { return m_orbitaltype; }
     std::vector<float>& Xs() { return m_xs; }
+    const std::vector<float>& Xs() const { return m_xs; }
     std::vector<float>& Xp() { return m_xp; }
+    const std::vector<float>& Xp() const { return m_xp; }
     std::vector<float>& Alpha() { return m_alpha; }
+    const std::vector<float>& Alpha() const { return m_alpha; }
 
 private:
     Coordinate m_atom;
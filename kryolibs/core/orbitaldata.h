@@ -31,10 +31,10 @@ public:
     OrbitalData();
     ~OrbitalData() {}
 
-    int Homo() { return m_homo; }
-    int Lumo() { return m_lumo; }
-    int TypeD() { return m_typeD; }
-    int TypeF() { return m_typeF; }
+    int Homo() const { return m_homo; }
+    int Lumo() const { return m_lumo; }
+    int TypeD() const { return m_typeD; }
+    int TypeF() const { return m_typeF; }
     const D2Array<float>& Coefficients() const { return m_coefficients;}
     D2Array<float>& Coefficients() { return m_coefficients;}
     const std::vector<float>& Eigenvalues() const { return m_eigenvalues; }
@@ -43,12 +43,16 @@ public:
     std::vector<float>& Occupations() { return m_occupations; }
     const D2Array<float>& BetaCoefficients() const { return m_betacoefficients;}
     D2Array<float>& BetaCoefficients() { return m_betacoefficients;}
-    const std::vector<float>& BetaEigenvalues() const { return m_eigenvalues; }
+    const std::vector<float>& BetaEigenvalues() const { return m_betaeigenvalues; }
     std::vector<float>& BetaEigenvalues() { return m_betaeigenvalues; }
     const std::vector<Orbital>& Orbitals() const { return m_orbitals; }
     std::vector<Orbital>& Orbitals() { return m_orbitals; }
     const std::vector<BasisCenter>& BasisCenters() const { return m_basiscenters; }
     std::vector<BasisCenter>& BasisCenters() { return m_basiscenters; }
+    /** @return the total density matrix in the basis of the atomic orbitals, its lower triangle by rows,
+        empty if the file does not provide it*/
+    const std::vector<double>& Density() const { return m_density; }
+    std::vector<double>& Density() { return m_density; }
 
     void SetHomo(int homo) { m_homo = homo; }
     void SetLumo(int lumo) { m_lumo = lumo; }
@@ -61,6 +65,7 @@ public:
     void SetBetaEigenvalues(std::vector<float> eigenvalues) { m_betaeigenvalues = eigenvalues; }
     void SetBasisCenters(std::vector<BasisCenter> basis) {m_basiscenters = basis;}
     void SetOccupations(const std::vector<float>& v) { m_occupations=v; }
+    void SetDensity(const std::vector<double>& v) { m_density=v; }
 
 private:
     int m_homo;
@@ -74,6 +79,7 @@ private:
     std::vector<float> m_betaeigenvalues;
     std::vector<Orbital> m_orbitals;
     std::vector<BasisCenter> m_basiscenters;
+    std::vector<double> m_density;
 
 };
 
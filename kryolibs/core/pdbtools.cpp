@@ -14,11 +14,11 @@ the Free Software Foundation version 2 of the License.
 
 using namespace kryomol;
 
-PDBResidue::PDBResidue(const std::string& name,const std::string& index) : _name(name), _index(index), _visible(true)
+PDBResidue::PDBResidue(const std::string& name,const std::string& index,char chain) : _name(name), _index(index), _chain(chain), _visible(true)
 {
 }
 
 namespace kryomol
 {
-bool operator ==  ( const PDBResidue& a,const PDBResidue& b ) { return ( ( a.Name() == b.Name() ) && ( a.Index() == b.Index() ) ); }
+bool operator ==  ( const PDBResidue& a,const PDBResidue& b ) { return ( ( a.Name() == b.Name() ) && ( a.Index() == b.Index() ) && ( a.Chain() == b.Chain() ) ); }
 }
@@ -20,15 +20,19 @@ namespace kryomol
   class KRYOMOLCORE_API PDBResidue
   {
     public :
-      PDBResidue(const std::string& name="",const std::string& index="");
+      PDBResidue(const std::string& name="",const std::string& index="",char chain=' ');
       const std::string& Name() const { return _name; }
+      /** residue sequence number followed by the insertion code*/
       const std::string& Index() const { return _index; }
+      /** chain identifier, blank if there is none*/
+      char Chain() const { return _chain; }
       bool Visible() const { return _visible; }
       void SetVisible(bool b) { _visible=b; }
       friend bool operator == ( const kryomol::PDBResidue& a,const kryomol::PDBResidue& b );
     private:
       std::string _name;
       std::string _index;
+      char _chain;
       bool _visible;
   };
 }
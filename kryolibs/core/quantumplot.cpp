@@ -67,6 +67,42 @@ void QuantumPlot::setupStepMarkers()
 }
 
 
+void QuantumPlot::updateStepMarkers ( int from )
+{
+    //the markers of the last steps can be on points that were still being computed
+    const QwtPlotItemList list=itemList();
+    for ( int i=0;i<list.size();++i )
+    {
+        QuantumMarker* m=dynamic_cast<QuantumMarker*> ( list.at(i) );
+        if ( m && m->step() >= from )
+        {
+            m->detach();
+            delete m;
+        }
+    }
+
+    const QwtPlotItemList& curves=itemList();
+    for ( int i=0;i<curves.size();++i )
+    {
+        if ( curves.at(i)->rtti() == QwtPlotItem::Rtti_PlotCurve )
+        {
+            QwtPlotCurve* cv=static_cast<QwtPlotCurve*> ( curves.at(i) );
+            for ( int j=from;j<(int) cv->dataSize() ;++j )
+            {
+                QuantumMarker* mrk= new QuantumMarker (this);
+                if ( j == m_point )
+                    mrk->setSymbol ( new QwtSymbol ( QwtSymbol::Diamond, QBrush ( Qt::red ), QPen ( Qt::blue ), QSize ( 10,10 ) ) );
+                else
+                    mrk->setSymbol ( new QwtSymbol( QwtSymbol::Diamond, QBrush ( Qt::yellow ), QPen ( Qt::green ), QSize ( 7,7 ) ) );
+                mrk->setValue(cv->sample(j));
+                mrk->setLineStyle ( QwtPlotMarker::NoLine );
+                mrk->setStep ( j );
+                mrk->attach ( ( QwtPlot* ) this );
+            }
+        }
+    }
+}
+
 void QuantumPlot::mouseMoveEvent(QMouseEvent* e)
 {
     const QPoint& pos=e->pos();
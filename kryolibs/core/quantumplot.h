@@ -32,6 +32,8 @@ class QuantumPlot : public QwtPlot
     ~QuantumPlot();
 
     void setupStepMarkers();
+    /** replace the markers of the steps from @param from on, after the curves grew*/
+    void updateStepMarkers ( int from );
     void ChangeLimits(int first, int last, double ymin,double ymax);
   signals:
     void selectedPoint ( size_t );
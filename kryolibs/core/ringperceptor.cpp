@@ -9,216 +9,572 @@ it under the terms of the GNU General Public License as published by
 the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
+#include <algorithm>
+#include <set>
+#include <utility>
+
 #include "ringperceptor.h"
 #include "molecule.h"
 
 using namespace kryomol;
 
+namespace
+{
+    const size_t npos=static_cast<size_t> ( -1 );
+    /** maximum number of shortest paths followed from each end of a prototype when expanding its family of relevant cycles*/
+    const size_t maxfamilypaths=64;
 
-RingPerceptor::Edge::Edge()
-{}
+    typedef std::vector<uint64_t> EdgeSet;
+    typedef std::pair<size_t,size_t> Edge;
 
-RingPerceptor::Edge RingPerceptor::Edge::operator+ ( RingPerceptor::Edge& b )
-{
+    /** @return the lowest bit set in s, starting the search at word from*/
+    size_t LowestBit ( const EdgeSet& s, size_t from=0 )
+    {
+        for ( size_t w=from;w<s.size();++w )
+        {
+            if ( s[w] )
+            {
+                uint64_t word=s[w];
+                size_t bit=0;
+                while ( ! ( word & 1 ) )
+                {
+                    word>>=1;
+                    ++bit;
+                }
+                return 64*w+bit;
+            }
+        }
+        return npos;
+    }
+
+    /** put the lowest atom index first and walk the ring towards its lowest neighbour*/
+    void Normalize ( std::vector<size_t>& ring )
+    {
+        std::rotate ( ring.begin(),std::min_element ( ring.begin(),ring.end() ),ring.end() );
+        if ( ring.size() > 2 && ring[1] > ring.back() )
+            std::reverse ( ring.begin()+1,ring.end() );
+    }
+
+    bool RingLess ( const std::vector<size_t>& a, const std::vector<size_t>& b )
+    {
+        if ( a.size() != b.size() ) return a.size() < b.size();
+        return a < b;
+    }
 
-    Edge& a= ( *this );
-    Edge newedge;
-    newedge.Path().reserve ( this->Path().size() +b.Path().size() );
+    /** @brief GF(2) elimination of cycles stored as edge bitsets*/
+    class CycleBasis
+    {
+    public:
+        CycleBasis ( size_t nedges ) : m_pivots ( nedges,npos ) {}
+        /** @return true if s is not a sum of the cycles in the basis*/
+        bool IsIndependent ( EdgeSet s ) const { return Reduce ( s ) != npos; }
+        /** add s to the basis if it is independent. @return true if added*/
+        bool Add ( EdgeSet s )
+        {
+            size_t pivot=Reduce ( s );
+            if ( pivot == npos ) return false;
+            m_pivots[pivot]=m_rows.size();
+            m_rows.push_back ( s );
+            return true;
+        }
+        size_t Rank() const { return m_rows.size(); }
+    private:
+        /** reduce s with the rows of the basis. @return the new pivot or npos if s is reduced to zero*/
+        size_t Reduce ( EdgeSet& s ) const
+        {
+            size_t bit=LowestBit ( s );
+            while ( bit != npos )
+            {
+                size_t row=m_pivots[bit];
+                if ( row == npos ) return bit;
+                //rows have no bits below their pivot, so the lowest bit always moves forward
+                const EdgeSet& r=m_rows[row];
+                for ( size_t w=bit/64;w<s.size();++w )
+                    s[w]^=r[w];
+                bit=LowestBit ( s,bit/64 );
+            }
+            return npos;
+        }
+        std::vector<EdgeSet> m_rows;
+        std::vector<size_t> m_pivots;
+    };
 
-    if ( a.Path().back() == b.Path().back() ) // (a x ) (b x)
+    /** @brief a ring system (biconnected component) with local vertex and edge indexes*/
+    class RingSystem
     {
-        newedge.Path() =a.Path();
-        std::vector<size_t>::reverse_iterator it;
-        for ( it=b.Path().rbegin() +1;it!=b.Path().rend();++it )
+    public:
+        RingSystem ( const std::vector<size_t>& vertices, const std::vector<Edge>& edges ) : m_vertices ( vertices ), m_nedges ( edges.size() )
+        {
+            m_start.assign ( vertices.size()+1,0 );
+            for ( std::vector<Edge>::const_iterator it=edges.begin();it!=edges.end();++it )
+            {
+                ++m_start[it->first+1];
+                ++m_start[it->second+1];
+            }
+            for ( size_t i=0;i<vertices.size();++i )
+                m_start[i+1]+=m_start[i];
+            m_adj.resize ( 2*edges.size() );
+            std::vector<size_t> pos ( m_start.begin(),m_start.end()-1 );
+            for ( size_t e=0;e<edges.size();++e )
+            {
+                m_adj[pos[edges[e].first]++]=Edge ( edges[e].second,e );
+                m_adj[pos[edges[e].second]++]=Edge ( edges[e].first,e );
+            }
+        }
+        size_t NVertices() const { return m_vertices.size(); }
+        size_t NEdges() const { return m_nedges; }
+        size_t Global ( size_t v ) const { return m_vertices[v]; }
+        const Edge* Begin ( size_t v ) const { return &m_adj[0]+m_start[v]; }
+        const Edge* End ( size_t v ) const { return &m_adj[0]+m_start[v+1]; }
+        size_t EdgeIndex ( size_t v, size_t w ) const
+        {
+            for ( const Edge* it=Begin ( v );it!=End ( v );++it )
+                if ( it->first == w ) return it->second;
+            return npos;
+        }
+        /** breadth first search from root in the subgraph of vertices with index <= root*/
+        void BFS ( size_t root, std::vector<size_t>& dist, std::vector<size_t>& parent, std::vector<size_t>& queue ) const
+        {
+            dist.assign ( NVertices(),npos );
+            parent.assign ( NVertices(),npos );
+            queue.clear();
+            dist[root]=0;
+            queue.push_back ( root );
+            for ( size_t q=0;q<queue.size();++q )
+            {
+                size_t v=queue[q];
+                for ( const Edge* it=Begin ( v );it!=End ( v );++it )
+                {
+                    size_t w=it->first;
+                    if ( w > root || dist[w] != npos ) continue;
+                    dist[w]=dist[v]+1;
+                    parent[w]=v;
+                    queue.push_back ( w );
+                }
+            }
+        }
+        /** @return the edge set of the closed path*/
+        EdgeSet Edges ( const std::vector<size_t>& path ) const
         {
-            newedge.Path().push_back ( *it );
+            EdgeSet s ( ( m_nedges+63 ) /64,0 );
+            for ( size_t i=0;i<path.size();++i )
+            {
+                size_t e=EdgeIndex ( path[i],path[ ( i+1 ) %path.size()] );
+                s[e/64]|=uint64_t ( 1 ) << ( e%64 );
+            }
+            return s;
         }
-        return newedge;
+        /** @return the path with global atom indexes*/
+        std::vector<size_t> GlobalRing ( const std::vector<size_t>& path ) const
+        {
+            std::vector<size_t> ring;
+            ring.reserve ( path.size() );
+            for ( std::vector<size_t>::const_iterator it=path.begin();it!=path.end();++it )
+                ring.push_back ( m_vertices[*it] );
+            Normalize ( ring );
+            return ring;
+        }
+    private:
+        std::vector<size_t> m_vertices;
+        size_t m_nedges;
+        std::vector<size_t> m_start;
+        std::vector<Edge> m_adj;
+    };
+
+    /** @brief a Vismara prototype: a cycle through root built with shortest paths to y and z.
+        Odd cycles close with the edge y-z, even cycles close through the vertex p*/
+    struct Candidate
+    {
+        size_t root;
+        size_t y;
+        size_t z;
+        size_t p;
+        std::vector<size_t> path;
+        EdgeSet edges;
+    };
+
+    bool CandidateLess ( const Candidate& a, const Candidate& b )
+    {
+        return a.path.size() < b.path.size();
     }
 
-    if ( a.Path().back() == b.Path().front() ) //  (a x ) (x b)
+    /** @return true if the tree paths from the root to a and b only share the root*/
+    bool Disjoint ( const std::vector<size_t>& dist, const std::vector<size_t>& parent, size_t a, size_t b, size_t root )
     {
-        newedge.Path() =a.Path();
-        std::vector<size_t>::const_iterator it;
-        for ( it=b.Path().begin() +1;it!=b.Path().end();++it )
+        while ( dist[a] > dist[b] ) a=parent[a];
+        while ( dist[b] > dist[a] ) b=parent[b];
+        while ( a != b )
         {
-            newedge.Path().push_back ( *it );
+            a=parent[a];
+            b=parent[b];
         }
-        return newedge;
+        return a == root;
     }
 
+    /** @return the tree path root...v*/
+    std::vector<size_t> TreePath ( const std::vector<size_t>& parent, size_t v )
+    {
+        std::vector<size_t> path;
+        for ( ;v != npos;v=parent[v] )
+            path.push_back ( v );
+        std::reverse ( path.begin(),path.end() );
+        return path;
+    }
+
+    /** build the closed path root..y (p) z..root without repeating the root*/
+    std::vector<size_t> ClosePath ( const std::vector<size_t>& py, const std::vector<size_t>& pz, size_t p )
+    {
+        std::vector<size_t> path ( py );
+        if ( p != npos ) path.push_back ( p );
+        path.insert ( path.end(),pz.rbegin(),pz.rend()-1 );
+        return path;
+    }
 
-    if ( a.Path().front() == b.Path().front() )  // (x a) (x b)
+    /** collect up to maxfamilypaths shortest paths root...v in the subgraph of vertices <= root*/
+    void ShortestPaths ( const RingSystem& g, const std::vector<size_t>& dist, size_t root, size_t v,
+                         std::vector<size_t>& current, std::vector< std::vector<size_t> >& paths )
     {
-        std::vector<size_t>::reverse_iterator it;
-        for ( it=a.Path().rbegin();it!=a.Path().rend();++it )
+        if ( paths.size() >= maxfamilypaths ) return;
+        current.push_back ( v );
+        if ( v == root )
         {
-            std::cout << ( *it ) << std::endl;
-            newedge.Path().push_back ( *it );
+            paths.push_back ( std::vector<size_t> ( current.rbegin(),current.rend() ) );
         }
-        std::vector<size_t>::iterator jjt;
-        for ( jjt=b.Path().begin() +1;jjt!=b.Path().end();++jjt )
+        else
         {
-            newedge.Path().push_back ( *jjt );
+            for ( const Edge* it=g.Begin ( v );it!=g.End ( v );++it )
+            {
+                size_t w=it->first;
+                if ( w <= root && dist[w] != npos && dist[w]+1 == dist[v] )
+                    ShortestPaths ( g,dist,root,w,current,paths );
+            }
         }
-        return newedge;
+        current.pop_back();
+    }
+
+    bool SharesVertex ( const std::vector<size_t>& a, const std::vector<size_t>& b )
+    {
+        //both paths start at the root
+        for ( size_t i=1;i<a.size();++i )
+            for ( size_t j=1;j<b.size();++j )
+                if ( a[i] == b[j] ) return true;
+        return false;
     }
-    if ( a.Path().front() == b.Path().back() ) // ( x a ) (b x)
+
+    /** perceive the rings of a single ring system*/
+    void PerceiveSystem ( const RingSystem& g, std::vector< std::vector<size_t> >& sssr, std::set< std::vector<size_t> >& relevant )
     {
-        std::vector<size_t>::reverse_iterator it;
-        for ( it=a.Path().rbegin();it!=a.Path().rend();++it )
+        size_t nu=g.NEdges()-g.NVertices()+1;
+        if ( g.NEdges() < g.NVertices() || nu == 0 ) return;
+
+        if ( nu == 1 )
+        {
+            //the whole ring system is a single cycle, just walk it
+            std::vector<size_t> path;
+            size_t previous=npos;
+            size_t v=0;
+            do
+            {
+                path.push_back ( v );
+                const Edge* it=g.Begin ( v );
+                size_t next= ( it->first != previous ) ? it->first : ( it+1 )->first;
+                previous=v;
+                v=next;
+            }
+            while ( v != 0 );
+            sssr.push_back ( g.GlobalRing ( path ) );
+            relevant.insert ( sssr.back() );
+            return;
+        }
+
+        std::vector<Candidate> candidates;
+        std::vector<size_t> dist,parent,queue,preds;
+        for ( size_t r=0;r<g.NVertices();++r )
+        {
+            g.BFS ( r,dist,parent,queue );
+            for ( std::vector<size_t>::const_iterator yt=queue.begin();yt!=queue.end();++yt )
+            {
+                size_t y=*yt;
+                preds.clear();
+                for ( const Edge* it=g.Begin ( y );it!=g.End ( y );++it )
+                {
+                    size_t z=it->first;
+                    if ( z > r || dist[z] == npos ) continue;
+                    if ( dist[z]+1 == dist[y] )
+                        preds.push_back ( z );
+                    else if ( dist[z] == dist[y] && z < y && Disjoint ( dist,parent,y,z,r ) )
+                    {
+                        Candidate c;
+                        c.root=r; c.y=y; c.z=z; c.p=npos;
+                        c.path=ClosePath ( TreePath ( parent,y ),TreePath ( parent,z ),npos );
+                        c.edges=g.Edges ( c.path );
+                        candidates.push_back ( c );
+                    }
+                }
+                for ( size_t a=0;a<preds.size();++a )
+                {
+                    for ( size_t b=a+1;b<preds.size();++b )
+                    {
+                        if ( !Disjoint ( dist,parent,preds[a],preds[b],r ) ) continue;
+                        Candidate c;
+                        c.root=r; c.y=preds[a]; c.z=preds[b]; c.p=y;
+                        c.path=ClosePath ( TreePath ( parent,c.y ),TreePath ( parent,c.z ),y );
+                        c.edges=g.Edges ( c.path );
+                        candidates.push_back ( c );
+                    }
+                }
+            }
+        }
+        std::stable_sort ( candidates.begin(),candidates.end(),CandidateLess );
+
+        //a cycle is relevant if it is independent of all the shorter cycles
+        CycleBasis basis ( g.NEdges() );
+        std::vector<const Candidate*> prototypes;
+        size_t i=0;
+        while ( i<candidates.size() && basis.Rank() < nu )
         {
-            newedge.Path().push_back ( *it );
+            size_t j=i;
+            while ( j<candidates.size() && candidates[j].path.size() == candidates[i].path.size() ) ++j;
+            for ( size_t k=i;k<j;++k )
+            {
+                if ( basis.IsIndependent ( candidates[k].edges ) )
+                    prototypes.push_back ( &candidates[k] );
+            }
+            for ( size_t k=i;k<j && basis.Rank() < nu;++k )
+            {
+                if ( basis.Add ( candidates[k].edges ) )
+                    sssr.push_back ( g.GlobalRing ( candidates[k].path ) );
+            }
+            i=j;
         }
-        for ( it=b.Path().rbegin() +1;it!=b.Path().rend();++it )
+
+        //expand the families of the relevant prototypes with all the alternative shortest paths
+        size_t root=npos;
+        std::vector<size_t> current;
+        for ( size_t k=0;k<prototypes.size();++k )
         {
-            newedge.Path().push_back ( *it );
+            const Candidate& c=*prototypes[k];
+            if ( c.root != root )
+            {
+                root=c.root;
+                g.BFS ( root,dist,parent,queue );
+            }
+            std::vector< std::vector<size_t> > py,pz;
+            ShortestPaths ( g,dist,root,c.y,current,py );
+            ShortestPaths ( g,dist,root,c.z,current,pz );
+            for ( size_t a=0;a<py.size();++a )
+            {
+                for ( size_t b=0;b<pz.size();++b )
+                {
+                    if ( SharesVertex ( py[a],pz[b] ) ) continue;
+                    relevant.insert ( g.GlobalRing ( ClosePath ( py[a],pz[b],c.p ) ) );
+                }
+            }
         }
-        return newedge;
     }
 
-    return newedge;
+    std::vector< std::vector<size_t> > FilterBySize ( const std::vector< std::vector<size_t> >& rings, size_t size )
+    {
+        if ( size == 0 ) return rings;
+        std::vector< std::vector<size_t> > filtered;
+        for ( std::vector< std::vector<size_t> >::const_iterator it=rings.begin();it!=rings.end();++it )
+        {
+            if ( it->size() == size ) filtered.push_back ( *it );
+        }
+        return filtered;
+    }
 }
 
-RingPerceptor::RingPerceptor ( const Molecule* molecule ) : m_molecule ( molecule ), m_frame ( NULL )
+RingPerceptor::RingPerceptor()
 {}
 
-RingPerceptor::RingPerceptor ( const Frame* frame ) : m_molecule ( NULL ), m_frame ( frame )
-{}
+RingPerceptor::RingPerceptor ( const Molecule* molecule )
+{
+    Perceive ( molecule->Atoms().size(),molecule->Bonds() );
+}
+
+RingPerceptor::RingPerceptor ( const Frame* frame )
+{
+    const Molecule* molecule=frame->ParentMolecule();
+    const std::vector<Bond>& bonds=frame->Bonds().empty() ? molecule->Bonds() : frame->Bonds();
+    Perceive ( molecule->Atoms().size(),bonds );
+}
+
+RingPerceptor::RingPerceptor ( size_t natoms, const std::vector<Bond>& bonds )
+{
+    Perceive ( natoms,bonds );
+}
 
 RingPerceptor::~RingPerceptor()
 {}
 
-std::vector< std::vector<size_t> > RingPerceptor::Rings ( size_t size/*=0*/ )
+std::vector< std::vector<size_t> > RingPerceptor::Rings ( size_t size/*=0*/ ) const
 {
-    Convert();
-    while ( !m_vertex.empty() )
-        Remove();
-
-    //Output Rings
-    std::vector< std::vector<size_t> > rings;
-    std::vector<Edge>::iterator it;
-    for ( it=m_rings.begin();it!=m_rings.end();++it )
-    {
-        std::vector<size_t>::iterator st;
-        if ( size == 0 || size == it->Path().size() -1 )
-        {
-            rings.push_back ( it->Path() );
-            rings.back().pop_back();
-        }
-    }
-    return rings;
+    return FilterBySize ( m_sssr,size );
 }
 
-void RingPerceptor::Convert()
+std::vector< std::vector<size_t> > RingPerceptor::RelevantCycles ( size_t size/*=0*/ ) const
 {
-    m_vertex.resize ( m_molecule->Atoms().size() );
-    for ( size_t i=0;i< m_molecule->Atoms().size();++i )
-    {
-        m_vertex[i]=i;
-    }
-    std::vector<Bond>::const_iterator bt;
-    const std::vector<Bond>* bonds;
-    if ( m_molecule )
-        bonds=&m_molecule->Bonds();
-    else bonds=&m_frame->Bonds();
+    return FilterBySize ( m_relevant,size );
+}
 
-    for ( bt=bonds->begin();bt!=bonds->end();++bt )
+uint64_t RingPerceptor::Signature ( size_t natoms, const std::vector<Bond>& bonds )
+{
+    //FNV-1a
+    uint64_t hash=14695981039346656037ULL;
+    const uint64_t prime=1099511628211ULL;
+    hash= ( hash ^ natoms ) * prime;
+    for ( std::vector<Bond>::const_iterator it=bonds.begin();it!=bonds.end();++it )
     {
-        m_edges.push_back ( Edge() );
-        m_edges.back().Path().push_back ( bt->I() );
-        m_edges.back().Path().push_back ( bt->J() );
-
+        hash= ( hash ^ it->I() ) * prime;
+        hash= ( hash ^ it->J() ) * prime;
     }
+    return hash;
 }
 
-
-
-void RingPerceptor::Remove()
+void RingPerceptor::Perceive ( size_t natoms, const std::vector<Bond>& bonds )
 {
-    size_t vertex=m_vertex.back();
+    m_sssr.clear();
+    m_relevant.clear();
 
-    std::vector<Edge>::iterator it;
-    std::vector<Edge> newedges;
-    for ( it=m_edges.begin();it!=m_edges.end();++it )
+    std::vector<Edge> edges;
+    edges.reserve ( bonds.size() );
+    for ( std::vector<Bond>::const_iterator bt=bonds.begin();bt!=bonds.end();++bt )
+    {
+        if ( bt->I() != bt->J() && bt->I() < natoms && bt->J() < natoms )
+            edges.push_back ( Edge ( bt->I(),bt->J() ) );
+    }
+    std::sort ( edges.begin(),edges.end() );
+    edges.erase ( std::unique ( edges.begin(),edges.end() ),edges.end() );
+    if ( edges.size() < 3 ) return;
+
+    std::vector<size_t> vertices ( natoms );
+    for ( size_t i=0;i<natoms;++i ) vertices[i]=i;
+    RingSystem graph ( vertices,edges );
+
+    //split the graph in biconnected components with an iterative Tarjan search
+    struct Visit { size_t v; size_t parentedge; const Edge* it; };
+    std::vector<size_t> disc ( natoms,0 ), low ( natoms,0 );
+    std::vector<size_t> local ( natoms,npos );
+    std::vector<size_t> estack;
+    std::vector<Visit> stack;
+    std::set< std::vector<size_t> > relevant;
+    size_t timer=1;
+    for ( size_t s=0;s<natoms;++s )
     {
-        if ( it->Path().front() == vertex || it->Path().back() ==vertex )
+        if ( disc[s] || graph.Begin ( s ) == graph.End ( s ) ) continue;
+        disc[s]=low[s]=timer++;
+        Visit root={ s,npos,graph.Begin ( s ) };
+        stack.push_back ( root );
+        while ( !stack.empty() )
         {
-            std::vector<Edge>::iterator it1;
-            //bool bfound=false;
-            for ( it1=it+1;it1!=m_edges.end();++it1 )
+            size_t v=stack.back().v;
+            if ( stack.back().it != graph.End ( v ) )
             {
-
-                if ( it1->Path().front() == vertex || it1->Path().back() == vertex )
+                size_t w=stack.back().it->first;
+                size_t e=stack.back().it->second;
+                ++stack.back().it;
+                if ( e == stack.back().parentedge ) continue;
+                if ( !disc[w] )
+                {
+                    estack.push_back ( e );
+                    disc[w]=low[w]=timer++;
+                    Visit child={ w,e,graph.Begin ( w ) };
+                    stack.push_back ( child );
+                }
+                else if ( disc[w] < disc[v] )
+                {
+                    estack.push_back ( e );
+                    low[v]=std::min ( low[v],disc[w] );
+                }
+                continue;
+            }
+            size_t parentedge=stack.back().parentedge;
+            stack.pop_back();
+            if ( stack.empty() ) break;
+            size_t u=stack.back().v;
+            low[u]=std::min ( low[u],low[v] );
+            if ( low[v] < disc[u] ) continue;
+
+            //u is an articulation point (or the root), pop the component
+            std::vector<size_t> cvertices;
+            std::vector<Edge> cedges;
+            size_t e;
+            do
+            {
+                e=estack.back();
+                estack.pop_back();
+                size_t ends[2]={ edges[e].first,edges[e].second };
+                for ( size_t k=0;k<2;++k )
                 {
-                    if ( ( it->Path().front() != it->Path().back() ) && ( it1->Path().front() != it1->Path().back() ) )
+                    if ( local[ends[k]] == npos )
                     {
-                        if ( CommonElements ( *it,*it1 ) == 1 )
-                        {
-                            newedges.push_back ( ( *it ) + ( *it1 ) );
-
-                        }
-                        if ( CommonElements ( *it,*it1 ) ==  2 )
-                        {
-                            if ( (it->Path().back() == it1->Path().back() && it->Path().front() == it1->Path().front()) ||
-                                 (it->Path().back() == it1->Path().front() && it->Path().front() == it1->Path().back()) )
-                            {
-                                newedges.push_back ( ( *it ) + ( *it1 ) );
-
-                            }
-                        }
+                        local[ends[k]]=cvertices.size();
+                        cvertices.push_back ( ends[k] );
                     }
                 }
-                //   if ( bfound ) break;
+                cedges.push_back ( Edge ( local[ends[0]],local[ends[1]] ) );
             }
+            while ( e != parentedge );
+            for ( std::vector<size_t>::const_iterator it=cvertices.begin();it!=cvertices.end();++it )
+                local[*it]=npos;
+            if ( cedges.size() >= cvertices.size() )
+                PerceiveSystem ( RingSystem ( cvertices,cedges ),m_sssr,relevant );
         }
+    }
 
-    }   //append new edges
+    m_relevant.assign ( relevant.begin(),relevant.end() );
+    std::sort ( m_sssr.begin(),m_sssr.end(),RingLess );
+    std::sort ( m_relevant.begin(),m_relevant.end(),RingLess );
+}
 
-    bool found;
-    do
-    {
-#ifdef __GNUC__
-#warning optimize this loop
-#endif
-        found=false;
-        std::vector<Edge>::iterator it;
-        for ( it=m_edges.begin();it!=m_edges.end();++it )
-        {
-            if ( it->Path().front() ==vertex || it->Path().back() == vertex ) break;
-        }
-        if ( it!=m_edges.end() )
-        {
-            if ( it->Path().front() == it->Path().back() ) m_rings.push_back ( *it );
-            found=true;
-            m_edges.erase ( it );
-        }
-    }
-    while ( found );
+RingCache::RingCache() : m_signature ( 0 ), m_valid ( false )
+{}
 
-    for ( it=newedges.begin();it!=newedges.end();++it )
-    {
-        m_edges.push_back ( *it );
-    }
+RingCache::RingCache ( const RingCache& other ) : m_signature ( 0 ), m_valid ( false )
+{
+    *this=other;
+}
+
+/** the mutex is not copied, each cache locks its own rings*/
+RingCache& RingCache::operator= ( const RingCache& other )
+{
+    if ( this == &other ) return *this;
+    std::lock ( m_mutex,other.m_mutex );
+    std::lock_guard<std::mutex> lock ( m_mutex,std::adopt_lock );
+    std::lock_guard<std::mutex> otherlock ( other.m_mutex,std::adopt_lock );
+    m_signature=other.m_signature;
+    m_valid=other.m_valid;
+    m_perceptor=other.m_perceptor;
+    return *this;
+}
 
-    m_vertex.pop_back();
+std::vector< std::vector<size_t> > RingCache::Rings ( size_t natoms, const std::vector<Bond>& bonds, size_t size )
+{
+    std::lock_guard<std::mutex> lock ( m_mutex );
+    return Get ( natoms,bonds ).Rings ( size );
+}
 
+std::vector< std::vector<size_t> > RingCache::RelevantCycles ( size_t natoms, const std::vector<Bond>& bonds, size_t size )
+{
+    std::lock_guard<std::mutex> lock ( m_mutex );
+    return Get ( natoms,bonds ).RelevantCycles ( size );
 }
 
-size_t RingPerceptor::CommonElements ( const Edge& edg1, const Edge& edg2 )
+void RingCache::Invalidate()
 {
-    size_t counter=0;
-    std::vector<size_t>::const_iterator it;
-    std::vector<size_t>::const_iterator it1;
-    for ( it=edg1.Path().begin();it!=edg1.Path().end();++it )
+    std::lock_guard<std::mutex> lock ( m_mutex );
+    m_valid=false;
+}
+
+const RingPerceptor& RingCache::Get ( size_t natoms, const std::vector<Bond>& bonds )
+{
+    uint64_t signature=RingPerceptor::Signature ( natoms,bonds );
+    if ( !m_valid || signature != m_signature )
     {
-        for ( it1=edg2.Path().begin();it1!=edg2.Path().end();++it1 )
-        {
-#ifdef __GNUC__
-#warning optimization
-#endif
-            if ( ( *it ) == ( *it1 ) ) counter++;
-        }
+        m_perceptor=RingPerceptor ( natoms,bonds );
+        m_signature=signature;
+        m_valid=true;
     }
-    return counter;
+    return m_perceptor;
 }
@@ -10,48 +10,81 @@ the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
 #ifndef RINGPERCEPTOR_H
+#define RINGPERCEPTOR_H
 
+#include <cstdint>
+#include <mutex>
 #include <vector>
-#include "molecule.h"
+#include "bond.h"
+#include "coreexport.h"
 
 namespace kryomol
 {
+  class Molecule;
+  class Frame;
 
   /** @brief Implementation of a ring perception algorithm
 
-  Implementation of the ring perception algorithm of Hansser et al
-  J. Chem. Inf. Comput. Sci. 1996, 36, 1146-1152
+  The bond graph is split into biconnected components, so acyclic parts (chains, side chains, bridges
+  between ring systems) are discarded in linear time. For each ring system the Horton candidate cycles are
+  built from breadth first spanning trees and reduced by Gaussian elimination over GF(2), using edge bitsets.
+  This gives the smallest set of smallest rings (SSSR, a minimum cycle basis) and the set of relevant cycles,
+  the union of all minimum cycle bases (Vismara, Electron. J. Comb. 1997, 4, R9).
+  Each ring is returned as the ordered list of its atoms, starting from the lowest atom index
   */
-  class RingPerceptor
+  class KRYOMOLCORE_API RingPerceptor
   {
-      class Edge
-      {
-        public:
-          Edge();
-          std::vector<size_t>& Path() { return _path; }
-          const std::vector<size_t>& Path() const { return _path;}
-          //Edge operator ^ (Edge& b);
-          Edge operator+ ( Edge& b );
-        private:
-          std::vector< size_t > _path;
-      };
     public:
+      /** build an empty perceptor with no rings*/
+      RingPerceptor();
+      /** perceive the rings of the molecule bonds*/
       RingPerceptor ( const kryomol::Molecule* molecule );
+      /** perceive the rings of the frame bonds, or of the parent molecule bonds if the frame has none*/
       RingPerceptor ( const kryomol::Frame* frame );
+      /** perceive the rings of a graph with @param natoms vertices and @param bonds edges*/
+      RingPerceptor ( size_t natoms, const std::vector<Bond>& bonds );
       ~RingPerceptor();
-      /** @return a vector with the ring paths*
+      /** @return a vector with the ring paths of the SSSR
           @param size if size==0 return all rings */
-      std::vector< std::vector<size_t> >Rings ( size_t size=0 );
+      std::vector< std::vector<size_t> > Rings ( size_t size=0 ) const;
+      /** @return the relevant cycles, the union of all the minimum cycle bases
+          @param size if size==0 return all rings */
+      std::vector< std::vector<size_t> > RelevantCycles ( size_t size=0 ) const;
+      /** @return the smallest set of smallest rings*/
+      const std::vector< std::vector<size_t> >& SSSR() const { return m_sssr; }
+      /** @return a hash of the connectivity used to decide if the rings must be perceived again*/
+      static uint64_t Signature ( size_t natoms, const std::vector<Bond>& bonds );
+    private:
+      void Perceive ( size_t natoms, const std::vector<Bond>& bonds );
+    private:
+      std::vector< std::vector<size_t> > m_sssr;
+      std::vector< std::vector<size_t> > m_relevant;
+  };
+
+  /** @brief rings cached for a given connectivity
+
+  The rings are perceived again only when the connectivity signature changes. The cache is read by the const
+  accessors of frames and molecules from several threads, so it is locked while it is checked and read */
+  class KRYOMOLCORE_API RingCache
+  {
+    public:
+      RingCache();
+      RingCache ( const RingCache& other );
+      RingCache& operator= ( const RingCache& other );
+      /** @return the rings of size @param size, all if 0, for this connectivity*/
+      std::vector< std::vector<size_t> > Rings ( size_t natoms, const std::vector<Bond>& bonds, size_t size );
+      /** @return the relevant cycles of size @param size, all if 0, for this connectivity*/
+      std::vector< std::vector<size_t> > RelevantCycles ( size_t natoms, const std::vector<Bond>& bonds, size_t size );
+      /** force perception in the next call*/
+      void Invalidate();
     private:
-      void Convert();
-      void Remove();
-      size_t CommonElements ( const Edge& edg1, const Edge& edg2 );
+      /** @return the rings for this connectivity, the cache must be locked*/
+      const RingPerceptor& Get ( size_t natoms, const std::vector<Bond>& bonds );
     private:
-      const Molecule* m_molecule;
-      const Frame* m_frame;
-      std::vector< size_t > m_vertex;
-      std::vector < Edge > m_edges;
-      std::vector<Edge> m_rings;
+      uint64_t m_signature;
+      bool m_valid;
+      RingPerceptor m_perceptor;
+      mutable std::mutex m_mutex;
   };
 }
 #endif
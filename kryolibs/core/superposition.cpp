@@ -0,0 +1,311 @@
+/*****************************************************************************************
+                            superposition.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+
+#include "superposition.h"
+#include "molecule.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** weighted covariance S(p,q)=sum w b_p a_q between the moving structure b and the reference a*/
+    void Covariance ( const FitCoordinates& a, const FitCoordinates& b, double s[3][3] )
+    {
+        const double* ax=a.X(); const double* ay=a.Y(); const double* az=a.Z();
+        const double* bx=b.X(); const double* by=b.Y(); const double* bz=b.Z();
+        const double* w=a.W();
+        const long n=static_cast<long> ( a.Size() );
+        double sxx=0,sxy=0,sxz=0,syx=0,syy=0,syz=0,szx=0,szy=0,szz=0;
+#ifdef WITH_OPENMP
+#pragma omp simd reduction(+:sxx,sxy,sxz,syx,syy,syz,szx,szy,szz)
+#endif
+        for ( long i=0;i<n;++i )
+        {
+            double wx=w[i]*bx[i];
+            double wy=w[i]*by[i];
+            double wz=w[i]*bz[i];
+            sxx+=wx*ax[i]; sxy+=wx*ay[i]; sxz+=wx*az[i];
+            syx+=wy*ax[i]; syy+=wy*ay[i]; syz+=wy*az[i];
+            szx+=wz*ax[i]; szy+=wz*ay[i]; szz+=wz*az[i];
+        }
+        s[0][0]=sxx; s[0][1]=sxy; s[0][2]=sxz;
+        s[1][0]=syx; s[1][1]=syy; s[1][2]=syz;
+        s[2][0]=szx; s[2][1]=szy; s[2][2]=szz;
+    }
+
+    /** build the symmetric traceless 4x4 key matrix of Horn*/
+    void KeyMatrix ( const double s[3][3], double k[4][4] )
+    {
+        k[0][0]=s[0][0]+s[1][1]+s[2][2];
+        k[0][1]=k[1][0]=s[1][2]-s[2][1];
+        k[0][2]=k[2][0]=s[2][0]-s[0][2];
+        k[0][3]=k[3][0]=s[0][1]-s[1][0];
+        k[1][1]=s[0][0]-s[1][1]-s[2][2];
+        k[1][2]=k[2][1]=s[0][1]+s[1][0];
+        k[1][3]=k[3][1]=s[2][0]+s[0][2];
+        k[2][2]=-s[0][0]+s[1][1]-s[2][2];
+        k[2][3]=k[3][2]=s[1][2]+s[2][1];
+        k[3][3]=-s[0][0]-s[1][1]+s[2][2];
+    }
+
+    double Det3 ( double a00, double a01, double a02, double a10, double a11, double a12, double a20, double a21, double a22 )
+    {
+        return a00* ( a11*a22-a12*a21 )-a01* ( a10*a22-a12*a20 ) +a02* ( a10*a21-a11*a20 );
+    }
+
+    /** @return the largest eigenvalue of the key matrix with Newton iterations on its characteristic polynomial,
+        starting from the upper bound @param start*/
+    double LargestEigenvalue ( const double k[4][4], double start )
+    {
+        //det(lI-K)=l^4+e2 l^2-e3 l+det(K), the matrix is traceless
+        double e2=0;
+        for ( int i=0;i<4;++i )
+            for ( int j=i+1;j<4;++j )
+                e2+=k[i][i]*k[j][j]-k[i][j]*k[i][j];
+        double e3=0;
+        for ( int skip=0;skip<4;++skip )
+        {
+            int r[3];
+            for ( int i=0,n=0;i<4;++i ) if ( i != skip ) r[n++]=i;
+            e3+=Det3 ( k[r[0]][r[0]],k[r[0]][r[1]],k[r[0]][r[2]],
+                       k[r[1]][r[0]],k[r[1]][r[1]],k[r[1]][r[2]],
+                       k[r[2]][r[0]],k[r[2]][r[1]],k[r[2]][r[2]] );
+        }
+        double det=0;
+        for ( int j=0;j<4;++j )
+        {
+            int c[3];
+            for ( int i=0,n=0;i<4;++i ) if ( i != j ) c[n++]=i;
+            double minor=Det3 ( k[1][c[0]],k[1][c[1]],k[1][c[2]],
+                                k[2][c[0]],k[2][c[1]],k[2][c[2]],
+                                k[3][c[0]],k[3][c[1]],k[3][c[2]] );
+            det+= ( j%2 ? -1 : 1 ) *k[0][j]*minor;
+        }
+
+        double l=start;
+        for ( int it=0;it<50;++it )
+        {
+            double l2=l*l;
+            double p=l2*l2+e2*l2-e3*l+det;
+            double dp=4*l2*l+2*e2*l-e3;
+            if ( dp == 0 ) break;
+            double step=p/dp;
+            l-=step;
+            if ( std::fabs ( step ) <= 1e-11*std::fabs ( l ) ) break;
+        }
+        return l;
+    }
+
+    /** cyclic Jacobi diagonalization of the symmetric 4x4 matrix a. Eigenvectors are stored as columns of v*/
+    void Jacobi4 ( double a[4][4], double v[4][4] )
+    {
+        for ( int i=0;i<4;++i )
+            for ( int j=0;j<4;++j )
+                v[i][j]= ( i == j ) ? 1 : 0;
+
+        for ( int sweep=0;sweep<50;++sweep )
+        {
+            double off=0;
+            for ( int p=0;p<4;++p )
+                for ( int q=p+1;q<4;++q )
+                    off+=a[p][q]*a[p][q];
+            if ( off < 1e-22 ) break;
+
+            for ( int p=0;p<4;++p )
+            {
+                for ( int q=p+1;q<4;++q )
+                {
+                    if ( a[p][q] == 0 ) continue;
+                    double theta= ( a[q][q]-a[p][p] ) / ( 2*a[p][q] );
+                    double t= ( theta >= 0 ? 1 : -1 ) / ( std::fabs ( theta ) +std::sqrt ( theta*theta+1 ) );
+                    double c=1/std::sqrt ( t*t+1 );
+                    double s=t*c;
+                    for ( int k=0;k<4;++k )
+                    {
+                        double akp=a[k][p];
+                        double akq=a[k][q];
+                        a[k][p]=c*akp-s*akq;
+                        a[k][q]=s*akp+c*akq;
+                    }
+                    for ( int k=0;k<4;++k )
+                    {
+                        double apk=a[p][k];
+                        double aqk=a[q][k];
+                        a[p][k]=c*apk-s*aqk;
+                        a[q][k]=s*apk+c*aqk;
+                    }
+                    for ( int k=0;k<4;++k )
+                    {
+                        double vkp=v[k][p];
+                        double vkq=v[k][q];
+                        v[k][p]=c*vkp-s*vkq;
+                        v[k][q]=s*vkp+c*vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    double ToRMSD ( const FitCoordinates& a, const FitCoordinates& b, double lambda )
+    {
+        double e= ( a.Inner() +b.Inner()-2*lambda ) /a.Weight();
+        return e > 0 ? std::sqrt ( e ) : 0;
+    }
+}
+
+FitCoordinates::FitCoordinates() : m_inner ( 0 ), m_weight ( 0 )
+{
+    m_centre[0]=m_centre[1]=m_centre[2]=0;
+}
+
+FitCoordinates::FitCoordinates ( const std::vector<Coordinate>& xyz, const std::vector<size_t>& atoms, const std::vector<double>& weights ) :
+    m_x ( atoms.size() ), m_y ( atoms.size() ), m_z ( atoms.size() ), m_w ( weights ), m_inner ( 0 ), m_weight ( 0 )
+{
+    double cx=0,cy=0,cz=0;
+    for ( size_t i=0;i<atoms.size();++i )
+    {
+        const Coordinate& c=xyz[atoms[i]];
+        m_x[i]=c.x();
+        m_y[i]=c.y();
+        m_z[i]=c.z();
+        cx+=m_w[i]*m_x[i];
+        cy+=m_w[i]*m_y[i];
+        cz+=m_w[i]*m_z[i];
+        m_weight+=m_w[i];
+    }
+    m_centre[0]=cx/m_weight;
+    m_centre[1]=cy/m_weight;
+    m_centre[2]=cz/m_weight;
+    for ( size_t i=0;i<atoms.size();++i )
+    {
+        m_x[i]-=m_centre[0];
+        m_y[i]-=m_centre[1];
+        m_z[i]-=m_centre[2];
+        m_inner+=m_w[i]* ( m_x[i]*m_x[i]+m_y[i]*m_y[i]+m_z[i]*m_z[i] );
+    }
+}
+
+void FitCoordinates::Swap ( size_t i, size_t j )
+{
+    std::swap ( m_x[i],m_x[j] );
+    std::swap ( m_y[i],m_y[j] );
+    std::swap ( m_z[i],m_z[j] );
+}
+
+Superposition::Superposition ( const Molecule& molecule, const std::vector<size_t>& atoms, bool massweighted/*=false*/ ) : m_atoms ( atoms )
+{
+    if ( m_atoms.empty() )
+    {
+        m_atoms.resize ( molecule.Atoms().size() );
+        for ( size_t i=0;i<m_atoms.size();++i )
+            m_atoms[i]=i;
+    }
+    if ( m_atoms.empty() ) throw kryomol::Exception ( "The atom list is empty" );
+
+    m_weights.reserve ( m_atoms.size() );
+    for ( std::vector<size_t>::const_iterator it=m_atoms.begin();it!=m_atoms.end();++it )
+    {
+        if ( *it >= molecule.Atoms().size() ) throw kryomol::Exception ( "Atom index out of range in superposition" );
+        m_weights.push_back ( massweighted ? molecule.Atoms() [*it].AtomicMass() : 1.0 );
+    }
+}
+
+FitCoordinates Superposition::Coordinates ( const std::vector<Coordinate>& xyz ) const
+{
+    return FitCoordinates ( xyz,m_atoms,m_weights );
+}
+
+double Superposition::Fit ( const FitCoordinates& a, const FitCoordinates& b, double* rotation/*=NULL*/ )
+{
+    double s[3][3];
+    Covariance ( a,b,s );
+    double k[4][4];
+    KeyMatrix ( s,k );
+
+    if ( !rotation )
+        return ToRMSD ( a,b,LargestEigenvalue ( k, ( a.Inner() +b.Inner() ) /2 ) );
+
+    double v[4][4];
+    Jacobi4 ( k,v );
+    int best=0;
+    for ( int i=1;i<4;++i )
+        if ( k[i][i] > k[best][best] ) best=i;
+    double q0=v[0][best],q1=v[1][best],q2=v[2][best],q3=v[3][best];
+    double norm=std::sqrt ( q0*q0+q1*q1+q2*q2+q3*q3 );
+    q0/=norm; q1/=norm; q2/=norm; q3/=norm;
+
+    rotation[0]=q0*q0+q1*q1-q2*q2-q3*q3;
+    rotation[1]=2* ( q1*q2-q0*q3 );
+    rotation[2]=2* ( q1*q3+q0*q2 );
+    rotation[3]=2* ( q1*q2+q0*q3 );
+    rotation[4]=q0*q0-q1*q1+q2*q2-q3*q3;
+    rotation[5]=2* ( q2*q3-q0*q1 );
+    rotation[6]=2* ( q1*q3-q0*q2 );
+    rotation[7]=2* ( q2*q3+q0*q1 );
+    rotation[8]=q0*q0-q1*q1-q2*q2+q3*q3;
+
+    return ToRMSD ( a,b,k[best][best] );
+}
+
+std::vector<double> Superposition::Apply ( Molecule& molecule, size_t refframe ) const
+{
+    std::vector<Frame>& frames=molecule.Frames();
+    if ( refframe >= frames.size() ) throw kryomol::Exception ( "Reference frame out of range in superposition" );
+
+    const FitCoordinates reference=Coordinates ( frames[refframe].XYZ() );
+    std::vector<double> rmsd ( frames.size(),0. );
+    const long nframes=static_cast<long> ( frames.size() );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for ( long f=0;f<nframes;++f )
+    {
+        std::vector<Coordinate>& xyz=frames[f].XYZ();
+        FitCoordinates moving=Coordinates ( xyz );
+        const double* c=moving.Centre();
+        double r[9]={ 1,0,0,0,1,0,0,0,1 };
+        if ( static_cast<size_t> ( f ) != refframe )
+            rmsd[f]=Fit ( reference,moving,r );
+        for ( std::vector<Coordinate>::iterator ct=xyz.begin();ct!=xyz.end();++ct )
+        {
+            double x=ct->x()-c[0];
+            double y=ct->y()-c[1];
+            double z=ct->z()-c[2];
+            ct->x() =r[0]*x+r[1]*y+r[2]*z;
+            ct->y() =r[3]*x+r[4]*y+r[5]*z;
+            ct->z() =r[6]*x+r[7]*y+r[8]*z;
+        }
+    }
+    return rmsd;
+}
+
+std::vector<double> Superposition::RMSD ( const Molecule& molecule, size_t refframe ) const
+{
+    const std::vector<Frame>& frames=molecule.Frames();
+    if ( refframe >= frames.size() ) throw kryomol::Exception ( "Reference frame out of range in superposition" );
+
+    const FitCoordinates reference=Coordinates ( frames[refframe].XYZ() );
+    std::vector<double> rmsd ( frames.size(),0. );
+    const long nframes=static_cast<long> ( frames.size() );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for ( long f=0;f<nframes;++f )
+    {
+        if ( static_cast<size_t> ( f ) != refframe )
+            rmsd[f]=Fit ( reference,Coordinates ( frames[f].XYZ() ) );
+    }
+    return rmsd;
+}
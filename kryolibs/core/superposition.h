@@ -0,0 +1,89 @@
+/*****************************************************************************************
+                            superposition.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef SUPERPOSITION_H
+#define SUPERPOSITION_H
+
+#include <vector>
+#include "coordinate.h"
+#include "coreexport.h"
+
+namespace kryomol
+{
+  class Molecule;
+
+  /** @brief weighted coordinates of the fitted atoms of a frame
+
+  The coordinates are translated to their weighted centroid and stored as separate x, y and z
+  arrays, so the covariance loops run over contiguous memory*/
+  class KRYOMOLCORE_API FitCoordinates
+  {
+    public:
+      FitCoordinates();
+      /** take the coordinates of @param atoms from @param xyz, with weights @param weights (one per atom in the list)*/
+      FitCoordinates ( const std::vector<Coordinate>& xyz, const std::vector<size_t>& atoms, const std::vector<double>& weights );
+      /** @return the number of fitted atoms*/
+      size_t Size() const { return m_x.size(); }
+      const double* X() const { return m_x.empty() ? NULL : &m_x[0]; }
+      const double* Y() const { return m_y.empty() ? NULL : &m_y[0]; }
+      const double* Z() const { return m_z.empty() ? NULL : &m_z[0]; }
+      const double* W() const { return m_w.empty() ? NULL : &m_w[0]; }
+      /** @return the weighted centroid removed from the coordinates*/
+      const double* Centre() const { return m_centre; }
+      /** @return the weighted sum of the squared distances to the centroid*/
+      double Inner() const { return m_inner; }
+      /** @return the sum of the weights*/
+      double Weight() const { return m_weight; }
+      /** exchange the coordinates of the fitted atoms @param i and @param j, which must have the same weight*/
+      void Swap ( size_t i, size_t j );
+    private:
+      std::vector<double> m_x;
+      std::vector<double> m_y;
+      std::vector<double> m_z;
+      std::vector<double> m_w;
+      double m_centre[3];
+      double m_inner;
+      double m_weight;
+  };
+
+  /** @brief closed form least squares superposition of conformers (quaternion Kabsch)
+
+  The optimal rotation is obtained from the weighted 3x3 covariance matrix of the two structures and
+  the largest eigenvalue of the associated 4x4 key matrix (Horn, J. Opt. Soc. Am. A 1987, 4, 629).
+  When only the rmsd is needed the eigenvalue is found with a few Newton steps on the characteristic
+  polynomial (Theobald, Acta Cryst. 2005, A61, 478) and no eigenvector is computed.
+  Frames are processed in parallel when compiled with OpenMP*/
+  class KRYOMOLCORE_API Superposition
+  {
+    public:
+      /** fit the atoms @param atoms (all the atoms if empty), weighting them with their atomic masses if @param massweighted*/
+      Superposition ( const Molecule& molecule, const std::vector<size_t>& atoms, bool massweighted=false );
+      /** translate every frame to the centroid of the fitted atoms and rotate it onto frame @param refframe
+          @return the rmsd of each frame to the reference*/
+      std::vector<double> Apply ( Molecule& molecule, size_t refframe ) const;
+      /** @return the rmsd of each frame to frame @param refframe after superposition, without moving any coordinate*/
+      std::vector<double> RMSD ( const Molecule& molecule, size_t refframe ) const;
+      /** @return the fitted atoms*/
+      const std::vector<size_t>& Atoms() const { return m_atoms; }
+      /** @return the weight of each fitted atom*/
+      const std::vector<double>& Weights() const { return m_weights; }
+      /** @return the fit coordinates of a frame*/
+      FitCoordinates Coordinates ( const std::vector<Coordinate>& xyz ) const;
+      /** @return the minimum weighted rmsd between @param a and @param b. If @param rotation is not NULL it receives
+          the row major rotation matrix that brings the centred @param b onto the centred @param a*/
+      static double Fit ( const FitCoordinates& a, const FitCoordinates& b, double* rotation=NULL );
+    private:
+      std::vector<size_t> m_atoms;
+      std::vector<double> m_weights;
+  };
+}
+
+#endif
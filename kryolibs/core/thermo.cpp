@@ -9,6 +9,8 @@ it under the terms of the GNU General Public License as published by
 the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include "thermo.h"
@@ -41,10 +43,8 @@ void Thermostat::SetPopulations(Molecule& molecule) const
 void Thermostat::SetBoltzmannPopulations(Molecule& molecule) const
 
 {
-    double k=1.98588e-3; //kcal/mol
-
-    std::vector<double> pop(molecule.Frames().size());
-    std::vector<double>::iterator it;
+    std::vector<double> energies;
+    energies.reserve(molecule.Frames().size());
     std::vector<Frame>::const_iterator ft=molecule.Frames().begin();
 
     for(;ft!=molecule.Frames().end();++ft)
@@ -53,24 +53,33 @@ void Thermostat::SetBoltzmannPopulations(Molecule& molecule) const
         {
             throw kryomol::Exception("Potential energy not defined");
         }
+        energies.push_back(ft->PotentialEnergy().Value());
     }
+    if ( energies.empty() ) return;
 
-    ft=molecule.Frames().begin();
-    double fe=ft->PotentialEnergy().Value();
-    kryomol::Energy::unit u=ft->PotentialEnergy().Units();
+    kryomol::Energy::unit u=molecule.Frames().front().PotentialEnergy().Units();
     double kb=kryomol::Energy::Kb(u);
-    double z=0;
-    for(it=pop.begin();it!=pop.end();++it,++ft)
+    molecule.Populations()=BoltzmannPopulations(energies,kb*m_temperature);
+
+}
+
+std::vector<double> Thermostat::BoltzmannPopulations(const std::vector<double>& energies, double kt)
+{
+    std::vector<double> pop(energies.size());
+    if ( energies.empty() ) return pop;
+
+    //log z = -emin/kt + log sum exp(-(e-emin)/kt), every term at most 1 and the first one 1
+    double emin=*std::min_element(energies.begin(),energies.end());
+    double sum=0;
+    for(size_t i=0;i<energies.size();++i)
     {
-        double e= ft->PotentialEnergy().Value();
-        (*it)=exp( -(e-fe)/(kb*m_temperature));
-        z+=(*it);
+        pop[i]=-(energies[i]-emin)/kt;
+        sum+=std::exp(pop[i]);
     }
-
-    for(it=pop.begin();it!=pop.end();++it)
+    double logz=std::log(sum);
+    for(std::vector<double>::iterator it=pop.begin();it!=pop.end();++it)
     {
-        (*it)/=z;
+        (*it)=std::exp((*it)-logz);
     }
-    molecule.Populations()=pop;
-
+    return pop;
 }
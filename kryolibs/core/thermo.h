@@ -41,6 +41,10 @@ public:
     ensamble Ensamble() const { return m_ensamble; }
     /** @return populations of all conformers for the @see qryomol::Molecule molecule*/
     virtual void SetPopulations(Molecule& molecule) const;
+    /** @return the Boltzmann populations of states of energies @param energies at the thermal energy @param kt,
+        in the same units. The partition function is summed as a log-sum-exp, relative to the lowest energy,
+        so it does not overflow or underflow for large energies or differences*/
+    static std::vector<double> BoltzmannPopulations(const std::vector<double>& energies, double kt);
 private: //private methodsAcesParser
    void SetBoltzmannPopulations(Molecule& molecule) const;
 private:
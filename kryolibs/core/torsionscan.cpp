@@ -0,0 +1,442 @@
+/*****************************************************************************************
+                            torsionscan.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include "torsionscan.h"
+#include "molecule.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** number of combinations given to a thread at once*/
+    const uint64_t chunksize=4096;
+
+    /** atoms reached from @param start without crossing the bond start-from*/
+    std::vector<size_t> Side ( const std::vector< std::vector<size_t> >& neighbours, size_t from, size_t start )
+    {
+        std::vector<bool> visited ( neighbours.size(),false );
+        std::vector<size_t> side;
+        visited[from]=visited[start]=true;
+        side.push_back ( start );
+        for ( size_t h=0;h<side.size();++h )
+        {
+            const std::vector<size_t>& n=neighbours[side[h]];
+            for ( std::vector<size_t>::const_iterator it=n.begin();it!=n.end();++it )
+            {
+                if ( side[h] == start && *it == from ) continue;
+                if ( *it == from ) throw kryomol::Exception ( "a bond in a ring cannot be rotated" );
+                if ( visited[*it] ) continue;
+                visited[*it]=true;
+                side.push_back ( *it );
+            }
+        }
+        return side;
+    }
+
+    /** surviving frames of a chunk of combinations*/
+    struct ChunkResult
+    {
+        ChunkResult() : nframes ( 0 ), rejected ( 0 ) {}
+        std::vector<float> xyz;
+        size_t nframes;
+        uint64_t rejected;
+    };
+}
+
+/** per thread state: coordinates after each bond and the spatial hash*/
+class TorsionScan::Worker
+{
+public:
+    Worker ( const TorsionScan& scan, const std::vector<int>& segments,
+             const std::vector< std::vector<size_t> >& excluded, double cellsize )
+        : m_scan ( scan ), m_segments ( segments ), m_excluded ( excluded ), m_cellsize ( cellsize )
+    {
+        m_levels.resize ( scan.m_torsions.size() +1 );
+        m_levels[0]=scan.m_xyz;
+        for ( size_t l=1;l<m_levels.size();++l ) m_levels[l].resize ( scan.m_xyz.size() );
+        m_digits.resize ( scan.m_torsions.size() );
+        size_t tablesize=64;
+        while ( tablesize < 2*scan.m_natoms ) tablesize*=2;
+        m_head.assign ( tablesize,-1 );
+        m_next.resize ( scan.m_natoms );
+    }
+
+    void Run ( uint64_t first, uint64_t last, ChunkResult& result )
+    {
+        const size_t nb=m_digits.size();
+        uint64_t index=first;
+        for ( size_t b=nb;b-->0; )
+        {
+            m_digits[b]=index%m_scan.m_torsions[b].nsteps;
+            index/=m_scan.m_torsions[b].nsteps;
+        }
+        Rebuild ( 0 );
+
+        for ( uint64_t c=first;c<last;++c )
+        {
+            const std::vector<double>& xyz=m_levels[nb];
+            if ( Clash ( xyz ) )
+            {
+                ++result.rejected;
+            }
+            else
+            {
+                result.xyz.insert ( result.xyz.end(),xyz.begin(),xyz.end() );
+                ++result.nframes;
+            }
+            if ( c+1 == last || nb == 0 ) continue;
+
+            size_t p=nb-1;
+            while ( ++m_digits[p] == m_scan.m_torsions[p].nsteps )
+            {
+                m_digits[p]=0;
+                --p;
+            }
+            Rebuild ( p );
+        }
+    }
+
+private:
+    /** recompute the coordinates after bonds from..end*/
+    void Rebuild ( size_t from )
+    {
+        for ( size_t b=from;b<m_digits.size();++b )
+        {
+            const Torsion& t=m_scan.m_torsions[b];
+            const std::vector<double>& in=m_levels[b];
+            std::vector<double>& out=m_levels[b+1];
+            std::copy ( in.begin(),in.end(),out.begin() );
+            if ( m_digits[b] == 0 ) continue;
+
+            const double angle=2*M_PI*m_digits[b]/t.nsteps;
+            const double* o=&in[3*t.origin];
+            const double* e=&in[3*t.end];
+            double u[3]={e[0]-o[0],e[1]-o[1],e[2]-o[2]};
+            double norm=std::sqrt ( u[0]*u[0]+u[1]*u[1]+u[2]*u[2] );
+            u[0]/=norm; u[1]/=norm; u[2]/=norm;
+            const double c=std::cos ( angle ), s=std::sin ( angle ), k=1-c;
+            const double r[3][3]=
+            {
+                { k*u[0]*u[0]+c, k*u[0]*u[1]-s*u[2], k*u[0]*u[2]+s*u[1] },
+                { k*u[0]*u[1]+s*u[2], k*u[1]*u[1]+c, k*u[1]*u[2]-s*u[0] },
+                { k*u[0]*u[2]-s*u[1], k*u[1]*u[2]+s*u[0], k*u[2]*u[2]+c }
+            };
+            for ( std::vector<size_t>::const_iterator it=t.moving.begin();it!=t.moving.end();++it )
+            {
+                const double* p=&in[3* ( *it )];
+                double x=p[0]-e[0], y=p[1]-e[1], z=p[2]-e[2];
+                double* q=&out[3* ( *it )];
+                q[0]=r[0][0]*x+r[0][1]*y+r[0][2]*z+e[0];
+                q[1]=r[1][0]*x+r[1][1]*y+r[1][2]*z+e[1];
+                q[2]=r[2][0]*x+r[2][1]*y+r[2][2]*z+e[2];
+            }
+        }
+    }
+
+    size_t Bucket ( long ix, long iy, long iz ) const
+    {
+        uint64_t h= ( static_cast<uint64_t> ( ix ) *73856093u ) ^ ( static_cast<uint64_t> ( iy ) *19349663u ) ^ ( static_cast<uint64_t> ( iz ) *83492791u );
+        return static_cast<size_t> ( h& ( m_head.size()-1 ) );
+    }
+
+    bool Excluded ( size_t a, size_t b ) const
+    {
+        const std::vector<size_t>& e=m_excluded[a];
+        return std::binary_search ( e.begin(),e.end(),b );
+    }
+
+    /** @return true if two atoms of different rigid fragments clash*/
+    bool Clash ( const std::vector<double>& xyz )
+    {
+        const double scale=m_scan.m_clashscale;
+        const std::vector<double>& radii=m_scan.m_radii;
+        bool clash=false;
+        m_touched.clear();
+        for ( size_t a=0;a<m_scan.m_natoms && !clash;++a )
+        {
+            const double* p=&xyz[3*a];
+            long ix=static_cast<long> ( std::floor ( p[0]/m_cellsize ) );
+            long iy=static_cast<long> ( std::floor ( p[1]/m_cellsize ) );
+            long iz=static_cast<long> ( std::floor ( p[2]/m_cellsize ) );
+            for ( long dx=-1;dx<=1 && !clash;++dx )
+                for ( long dy=-1;dy<=1 && !clash;++dy )
+                    for ( long dz=-1;dz<=1 && !clash;++dz )
+                    {
+                        for ( long b=m_head[Bucket ( ix+dx,iy+dy,iz+dz )];b>=0;b=m_next[b] )
+                        {
+                            if ( m_segments[a] == m_segments[b] ) continue;
+                            const double* q=&xyz[3*b];
+                            double d2= ( p[0]-q[0] ) * ( p[0]-q[0] ) + ( p[1]-q[1] ) * ( p[1]-q[1] ) + ( p[2]-q[2] ) * ( p[2]-q[2] );
+                            double limit=scale* ( radii[a]+radii[b] );
+                            if ( d2 < limit*limit && !Excluded ( a,b ) )
+                            {
+                                clash=true;
+                                break;
+                            }
+                        }
+                    }
+            size_t bucket=Bucket ( ix,iy,iz );
+            m_next[a]=m_head[bucket];
+            m_head[bucket]=static_cast<long> ( a );
+            m_touched.push_back ( bucket );
+        }
+        for ( std::vector<size_t>::const_iterator it=m_touched.begin();it!=m_touched.end();++it )
+            m_head[*it]=-1;
+        return clash;
+    }
+
+private:
+    const TorsionScan& m_scan;
+    const std::vector<int>& m_segments;
+    const std::vector< std::vector<size_t> >& m_excluded;
+    double m_cellsize;
+    std::vector< std::vector<double> > m_levels;
+    std::vector<size_t> m_digits;
+    std::vector<long> m_head;
+    std::vector<long> m_next;
+    std::vector<size_t> m_touched;
+};
+
+TorsionScan::TorsionScan ( const Molecule& molecule, size_t frame ) : m_clashscale ( 0.6 ), m_rejected ( 0 ), m_truncated ( false )
+{
+    //the conformers generated are added to the frames, that of a molecule read on demand hold only the current one
+    if ( molecule.HasFrameSource() )
+        throw kryomol::Exception ( "the structures read on demand from the file can not be scanned" );
+    if ( frame >= molecule.Frames().size() )
+        throw kryomol::Exception ( "invalid frame for the torsion scan" );
+    const Frame& f=molecule.Frames() [frame];
+    m_natoms=molecule.Atoms().size();
+
+    m_xyz.resize ( 3*m_natoms );
+    m_radii.resize ( m_natoms );
+    for ( size_t a=0;a<m_natoms;++a )
+    {
+        m_xyz[3*a]=f.XYZ() [a].x();
+        m_xyz[3*a+1]=f.XYZ() [a].y();
+        m_xyz[3*a+2]=f.XYZ() [a].z();
+        m_radii[a]=molecule.Atoms() [a].VdW();
+    }
+
+    const std::vector<Bond>& bonds=f.Bonds().empty() ? molecule.Bonds() : f.Bonds();
+    m_neighbours.resize ( m_natoms );
+    for ( std::vector<Bond>::const_iterator it=bonds.begin();it!=bonds.end();++it )
+    {
+        m_neighbours[it->I()].push_back ( it->J() );
+        m_neighbours[it->J()].push_back ( it->I() );
+    }
+}
+
+void TorsionScan::AddBond ( size_t i, size_t j, double increment )
+{
+    if ( i >= m_natoms || j >= m_natoms || std::find ( m_neighbours[i].begin(),m_neighbours[i].end(),j ) == m_neighbours[i].end() )
+        throw kryomol::Exception ( "the atoms of the torsion scan are not bonded" );
+    if ( increment <= 0 )
+        throw kryomol::Exception ( "invalid torsion increment" );
+
+    Torsion t;
+    t.nsteps=std::max<size_t> ( 1,static_cast<size_t> ( std::floor ( 360.0/increment+0.5 ) ) );
+    std::vector<size_t> side=Side ( m_neighbours,i,j );
+    if ( 2*side.size() > m_natoms )
+    {
+        side=Side ( m_neighbours,j,i );
+        t.origin=j; t.end=i;
+    }
+    else
+    {
+        t.origin=i; t.end=j;
+    }
+    //the end atom lies on the axis
+    t.moving.assign ( side.begin() +1,side.end() );
+    std::sort ( t.moving.begin(),t.moving.end() );
+    m_torsions.push_back ( t );
+}
+
+uint64_t TorsionScan::NCandidates() const
+{
+    uint64_t n=1;
+    for ( std::vector<Torsion>::const_iterator it=m_torsions.begin();it!=m_torsions.end();++it )
+    {
+        if ( n > std::numeric_limits<uint64_t>::max() /it->nsteps )
+            throw kryomol::Exception ( "too many torsion scan combinations" );
+        n*=it->nsteps;
+    }
+    return n;
+}
+
+size_t TorsionScan::Generate ( Molecule& molecule, size_t maxframes /*=0*/ )
+{
+    if ( molecule.Atoms().size() != m_natoms )
+        throw kryomol::Exception ( "the torsion scan molecule does not match" );
+    m_rejected=0;
+    m_truncated=false;
+    //candidate 0, every torsion at its first step, is the reference geometry and is skipped
+    const uint64_t ncandidates=NCandidates();
+
+    //rigid fragments: atoms connected without crossing a scanned bond never move with respect to each other
+    std::vector<int> segments ( m_natoms,-1 );
+    int nsegments=0;
+    for ( size_t a=0;a<m_natoms;++a )
+    {
+        if ( segments[a] >= 0 ) continue;
+        std::vector<size_t> stack ( 1,a );
+        segments[a]=nsegments;
+        while ( !stack.empty() )
+        {
+            size_t v=stack.back();
+            stack.pop_back();
+            for ( std::vector<size_t>::const_iterator it=m_neighbours[v].begin();it!=m_neighbours[v].end();++it )
+            {
+                if ( segments[*it] >= 0 ) continue;
+                bool scanned=false;
+                for ( std::vector<Torsion>::const_iterator t=m_torsions.begin();t!=m_torsions.end();++t )
+                {
+                    if ( ( t->origin == v && t->end == *it ) || ( t->origin == *it && t->end == v ) ) scanned=true;
+                }
+                if ( scanned ) continue;
+                segments[*it]=nsegments;
+                stack.push_back ( *it );
+            }
+        }
+        ++nsegments;
+    }
+
+    //atoms up to three bonds away are not checked for clashes
+    std::vector< std::vector<size_t> > excluded ( m_natoms );
+    for ( size_t a=0;a<m_natoms;++a )
+    {
+        std::vector<size_t> shell ( 1,a );
+        std::vector<size_t>& e=excluded[a];
+        for ( int depth=0;depth<3;++depth )
+        {
+            std::vector<size_t> next;
+            for ( std::vector<size_t>::const_iterator s=shell.begin();s!=shell.end();++s )
+                next.insert ( next.end(),m_neighbours[*s].begin(),m_neighbours[*s].end() );
+            e.insert ( e.end(),next.begin(),next.end() );
+            shell.swap ( next );
+        }
+        std::sort ( e.begin(),e.end() );
+        e.erase ( std::unique ( e.begin(),e.end() ),e.end() );
+    }
+
+    double maxradius=0;
+    for ( std::vector<double>::const_iterator it=m_radii.begin();it!=m_radii.end();++it )
+        maxradius=std::max ( maxradius,*it );
+    const double cellsize=std::max ( 2*m_clashscale*maxradius,0.1 );
+
+    const uint64_t nchunks= ( ncandidates+chunksize-2 ) /chunksize;
+    int nthreads=1;
+#ifdef WITH_OPENMP
+    nthreads=omp_get_max_threads();
+#endif
+    //chunks are processed in ordered batches so the scan stops early when enough frames were found
+    const uint64_t batch=std::max<uint64_t> ( 1,4*nthreads );
+    size_t added=0;
+    for ( uint64_t c0=0;c0<nchunks;c0+=batch )
+    {
+        const long nbatch=static_cast<long> ( std::min ( batch,nchunks-c0 ) );
+        std::vector<ChunkResult> results ( nbatch );
+#ifdef WITH_OPENMP
+#pragma omp parallel
+#endif
+        {
+            Worker worker ( *this,segments,excluded,cellsize );
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for ( long c=0;c<nbatch;++c )
+            {
+                uint64_t first=1+ ( c0+c ) *chunksize;
+                worker.Run ( first,std::min ( first+chunksize,ncandidates ),results[c] );
+            }
+        }
+
+        for ( std::vector<ChunkResult>::const_iterator r=results.begin();r!=results.end();++r )
+        {
+            m_rejected+=r->rejected;
+            for ( size_t k=0;k<r->nframes;++k )
+            {
+                if ( maxframes && added == maxframes )
+                {
+                    m_truncated=true;
+                    break;
+                }
+                Frame frame ( &molecule );
+                std::vector<Coordinate>& xyz=frame.XYZ();
+                xyz.reserve ( m_natoms );
+                const float* p=&r->xyz[3*m_natoms*k];
+                for ( size_t a=0;a<m_natoms;++a )
+                    xyz.push_back ( Coordinate ( p[3*a],p[3*a+1],p[3*a+2] ) );
+                molecule.Frames().push_back ( frame );
+                ++added;
+            }
+        }
+        if ( maxframes && added == maxframes )
+        {
+            if ( c0+batch < nchunks ) m_truncated=true;
+            break;
+        }
+    }
+    //scanned frames carry no energies, give every frame the same weight until a thermostat sets them
+    if ( added )
+    {
+        const size_t nframes=molecule.Frames().size();
+        molecule.Populations().assign ( nframes,1/static_cast<double> ( nframes ) );
+    }
+    return added;
+}
+
+std::vector<Bond> TorsionScan::RotatableBonds ( const Molecule& molecule )
+{
+    std::vector<Bond> rotatable;
+    const size_t natoms=molecule.Atoms().size();
+    const std::vector<Bond>& bonds=molecule.Bonds().empty() ? molecule.CurrentFrame().Bonds() : molecule.Bonds();
+    std::vector< std::vector<size_t> > neighbours ( natoms );
+    for ( std::vector<Bond>::const_iterator it=bonds.begin();it!=bonds.end();++it )
+    {
+        neighbours[it->I()].push_back ( it->J() );
+        neighbours[it->J()].push_back ( it->I() );
+    }
+
+    for ( std::vector<Bond>::const_iterator it=bonds.begin();it!=bonds.end();++it )
+    {
+        if ( it->Order() != Bond::SINGLE ) continue;
+        bool heavy[2]={false,false};
+        const size_t ends[2]={it->I(),it->J()};
+        for ( int e=0;e<2;++e )
+        {
+            const std::vector<size_t>& n=neighbours[ends[e]];
+            for ( std::vector<size_t>::const_iterator a=n.begin();a!=n.end();++a )
+            {
+                if ( *a != ends[1-e] && molecule.Atoms() [*a].Z() > 1 ) heavy[e]=true;
+            }
+        }
+        if ( !heavy[0] || !heavy[1] ) continue;
+        try
+        {
+            Side ( neighbours,it->I(),it->J() );
+        }
+        catch ( kryomol::Exception& )
+        {
+            continue;
+        }
+        rotatable.push_back ( *it );
+    }
+    return rotatable;
+}
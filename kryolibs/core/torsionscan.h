@@ -0,0 +1,79 @@
+/*****************************************************************************************
+                            torsionscan.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef TORSIONSCAN_H
+#define TORSIONSCAN_H
+
+#include <cstdint>
+#include <vector>
+#include "bond.h"
+#include "coreexport.h"
+
+namespace kryomol
+{
+  class Molecule;
+
+  /** @brief systematic conformer generation by rotation of selected bonds
+
+  Every combination of the torsion steps of the selected bonds is built from a reference frame. The atoms
+  moved by each bond (the smaller side of the molecule) are found once when the bond is added. Combinations
+  are enumerated like an odometer, keeping the coordinates after each bond, so when the last bonds change
+  only their fragments are rotated again. Each candidate is rejected if two atoms separated by more than
+  three bonds, and not in the same rigid fragment, are closer than a fraction of the sum of their Van der
+  Waals radii. Close pairs are searched with a spatial hash of cell size equal to the largest clash distance.
+  The combinations are split in chunks distributed over threads when compiled with OpenMP, and the
+  surviving frames are appended to the molecule in enumeration order*/
+  class KRYOMOLCORE_API TorsionScan
+  {
+    public:
+      /** prepare a scan starting from frame @param frame of @param molecule*/
+      TorsionScan ( const Molecule& molecule, size_t frame );
+      /** rotate the bond between atoms i and j in steps of @param increment degrees over a full turn*/
+      void AddBond ( size_t i, size_t j, double increment );
+      /** atoms clash when closer than @param scale times the sum of their Van der Waals radii (0.6 by default)*/
+      void SetClashScale ( double scale ) { m_clashscale=scale; }
+      /** @return the number of bonds in the scan*/
+      size_t NBonds() const { return m_torsions.size(); }
+      /** @return the atoms moved by bond b*/
+      const std::vector<size_t>& MovingAtoms ( size_t b ) const { return m_torsions[b].moving; }
+      /** @return the number of combinations of torsion steps, the reference geometry included*/
+      uint64_t NCandidates() const;
+      /** build all the combinations but the reference geometry itself and append the ones without clashes as new
+          frames of @param molecule, keeping at most @param maxframes (all if 0) @return the number of frames added*/
+      size_t Generate ( Molecule& molecule, size_t maxframes=0 );
+      /** @return the number of candidates rejected by clashes in the last call to Generate*/
+      uint64_t NRejected() const { return m_rejected; }
+      /** @return true if the last call to Generate stopped at maxframes before building all the combinations*/
+      bool Truncated() const { return m_truncated; }
+      /** @return the acyclic single bonds where both atoms have another heavy atom bonded*/
+      static std::vector<Bond> RotatableBonds ( const Molecule& molecule );
+    private:
+      struct Torsion
+      {
+        size_t origin;
+        size_t end;
+        size_t nsteps;
+        std::vector<size_t> moving;
+      };
+      class Worker;
+    private:
+      size_t m_natoms;
+      std::vector<double> m_xyz;
+      std::vector<double> m_radii;
+      std::vector< std::vector<size_t> > m_neighbours;
+      std::vector<Torsion> m_torsions;
+      double m_clashscale;
+      uint64_t m_rejected;
+      bool m_truncated;
+  };
+}
+
+#endif
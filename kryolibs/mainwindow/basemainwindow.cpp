@@ -759,7 +759,7 @@ void BaseMainWindow::OnFirstFrame()
 void BaseMainWindow::OnLastFrame()
 {
   if ( m_world->CurrentMolecule() )
-    m_world->SelectFrame ( m_world->CurrentMolecule()->Frames().size()-1 );
+    m_world->SelectFrame ( m_world->CurrentMolecule()->FrameCount()-1 );
 }
 
 void BaseMainWindow::OnNextFrame()
@@ -5,9 +5,23 @@
 #include <QFrame>
 #include <QLabel>
 #include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QMessageBox>
+
+#include <algorithm>
 
 #include "world.h"
 #include "molecule.h"
+#include "conformerclustering.h"
+#include "exception.h"
+
+namespace
+{
+    const int clustercolumn=5;
+}
 
 ConfManager::ConfManager(kryomol::World* w,QWidget* parent)
     : QWidget{parent}, m_world(w)
@@ -15,19 +29,47 @@ ConfManager::ConfManager(kryomol::World* w,QWidget* parent)
     QVBoxLayout* vbox = new QVBoxLayout(this);
     m_tree= new QTreeWidget(this);
     vbox->addWidget(m_tree);
+
+    QHBoxLayout* hbox = new QHBoxLayout();
+    m_clustermethod = new QComboBox(this);
+    m_clustermethod->addItem(tr("RMSD threshold"),kryomol::ConformerClustering::THRESHOLD);
+    m_clustermethod->addItem(tr("Hierarchical"),kryomol::ConformerClustering::HIERARCHICAL);
+    m_clustermethod->addItem(tr("k-medoids"),kryomol::ConformerClustering::KMEDOIDS);
+    m_clusterparameter = new QDoubleSpinBox(this);
+    QPushButton* clusterbutton = new QPushButton(tr("Cluster"),this);
+    QPushButton* representativesbutton = new QPushButton(tr("Show representatives"),this);
+    hbox->addWidget(m_clustermethod);
+    hbox->addWidget(m_clusterparameter);
+    hbox->addWidget(clusterbutton);
+    hbox->addWidget(representativesbutton);
+    vbox->addLayout(hbox);
+    OnClusterMethodChanged(0);
+
+    connect(m_clustermethod,SIGNAL(currentIndexChanged(int)),this,SLOT(OnClusterMethodChanged(int)));
+    connect(clusterbutton,&QPushButton::clicked,this,&ConfManager::OnCluster);
+    connect(representativesbutton,&QPushButton::clicked,this,&ConfManager::OnShowRepresentatives);
+
     InitTree();
 }
 
 void ConfManager::Refresh()
 {
+    m_clusterof.clear();
+    m_representative.clear();
     InitTree();
 }
 
 void ConfManager::InitTree()
 {
     m_tree->clear();
+    //the structures of a large file are read on demand, they have no populations nor colors to manage
+    const bool ondemand=m_world->CurrentMolecule()->HasFrameSource();
+    setEnabled(!ondemand);
+    setToolTip(ondemand ? tr("The %1 conformers are read on demand from the file, they can not be managed")
+                          .arg(m_world->CurrentMolecule()->FrameCount()) : QString());
+    if ( ondemand ) return;
     QStringList headers;
-    headers << "" << "Color" << "Population" << "Include" << "Show";
+    headers << "" << "Color" << "Population" << "Include" << "Show" << "Cluster";
     m_tree->setColumnCount(headers.size());
     m_tree->setHeaderLabels(headers);
 
@@ -90,12 +132,113 @@ void ConfManager::InitTree()
         p->setCheckState(4,Qt::Checked);
     }
 
+    UpdateClusterColumn();
+
     for(int i=0;i<m_tree->columnCount();++i)
     {
         m_tree->resizeColumnToContents(i);
     }
 
-    connect(m_tree,&QTreeWidget::itemChanged,this,&ConfManager::OnItemChanged);
+    connect(m_tree,&QTreeWidget::itemChanged,this,&ConfManager::OnItemChanged,Qt::UniqueConnection);
+}
+
+void ConfManager::UpdateClusterColumn()
+{
+    QTreeWidgetItem* spitem=m_tree->topLevelItem(0);
+    if ( !spitem ) return;
+    //child 0 is the average spectrum
+    for(int i=1;i<spitem->childCount();++i)
+    {
+        size_t fidx=i-1;
+        QString text;
+        if ( fidx < m_clusterof.size() )
+        {
+            text=QString::number(m_clusterof[fidx]+1);
+            if ( m_representative[fidx] ) text+=" *";
+        }
+        spitem->child(i)->setText(clustercolumn,text);
+    }
+}
+
+void ConfManager::OnClusterMethodChanged(int method)
+{
+    if ( m_clustermethod->itemData(method).toInt() == kryomol::ConformerClustering::KMEDOIDS )
+    {
+        m_clusterparameter->setDecimals(0);
+        m_clusterparameter->setRange(1,1e6);
+        m_clusterparameter->setSingleStep(1);
+        m_clusterparameter->setSuffix("");
+        m_clusterparameter->setPrefix("k=");
+        m_clusterparameter->setValue(10);
+    }
+    else
+    {
+        m_clusterparameter->setDecimals(2);
+        m_clusterparameter->setRange(0.01,100);
+        m_clusterparameter->setSingleStep(0.05);
+        m_clusterparameter->setPrefix("");
+        m_clusterparameter->setSuffix(QString(" ")+QChar(0x00C5));
+        m_clusterparameter->setValue(0.5);
+    }
+}
+
+void ConfManager::OnCluster()
+{
+    const kryomol::Molecule& molecule=*m_world->CurrentMolecule();
+    if ( molecule.HasFrameSource() || molecule.Frames().size() < 2 ) return;
+
+    try
+    {
+        kryomol::RMSDMatrix matrix(molecule);
+        matrix.SetEquivalentGroups(kryomol::RMSDMatrix::EquivalentGroups(molecule));
+        matrix.Calculate();
+
+        const double parameter=m_clusterparameter->value();
+        const int method=m_clustermethod->currentData().toInt();
+        //k-medoids needs at least one cluster
+        const size_t k=std::max<size_t>(1,static_cast<size_t>(qRound(parameter)));
+        const kryomol::ConformerClustering clusters=
+            method == kryomol::ConformerClustering::HIERARCHICAL ? kryomol::ConformerClustering::Hierarchical(matrix,parameter) :
+            method == kryomol::ConformerClustering::KMEDOIDS ? kryomol::ConformerClustering::KMedoids(matrix,k) :
+            kryomol::ConformerClustering::Threshold(matrix,parameter);
+
+        m_clusterof.assign(molecule.Frames().size(),0);
+        m_representative.assign(molecule.Frames().size(),false);
+        for(size_t f=0;f<m_clusterof.size();++f)
+        {
+            m_clusterof[f]=clusters.ClusterOf(f);
+        }
+        for(auto r : clusters.Representatives())
+        {
+            m_representative[r]=true;
+        }
+    }
+    catch(const kryomol::Exception& e)
+    {
+        QMessageBox::critical(this,tr("Cluster"),QString(e.what()));
+        return;
+    }
+
+    m_tree->blockSignals(true);
+    UpdateClusterColumn();
+    m_tree->blockSignals(false);
+    m_tree->resizeColumnToContents(clustercolumn);
+}
+
+void ConfManager::OnShowRepresentatives()
+{
+    QTreeWidgetItem* spitem=m_tree->topLevelItem(0);
+    if ( !spitem || m_representative.empty() ) return;
+
+    m_tree->blockSignals(true);
+    for(int i=1;i<spitem->childCount();++i)
+    {
+        size_t fidx=i-1;
+        bool show= ( fidx < m_representative.size() ) && m_representative[fidx];
+        spitem->child(i)->setCheckState(4,show ? Qt::Checked : Qt::Unchecked);
+    }
+    m_tree->blockSignals(false);
+    OnItemChanged(spitem->child(0));
 }
 
 void ConfManager::OnItemChanged(QTreeWidgetItem* item)
@@ -104,6 +247,7 @@ void ConfManager::OnItemChanged(QTreeWidgetItem* item)
     if ( item == m_tree->topLevelItem(0) ) return;
     bool b;
     std::vector<bool> vb;
+    std::vector<bool> vi;
 
     for(int i=0;i<m_tree->topLevelItem(0)->childCount();++i)
     {
@@ -115,6 +259,7 @@ void ConfManager::OnItemChanged(QTreeWidgetItem* item)
         else
         {
             vb.push_back( p->checkState(4) == Qt::Checked );
+            vi.push_back( p->checkState(3) == Qt::Checked );
         }
     }
 
@@ -125,5 +270,6 @@ void ConfManager::OnItemChanged(QTreeWidgetItem* item)
     }
 
     emit visible(b,vb);
+    emit included(vi);
 }
 
@@ -2,6 +2,7 @@
 #define CONFMANAGER_H
 
 #include <QWidget>
+#include <vector>
 
 #include "kryomolcore_export.h"
 
@@ -12,6 +13,8 @@ class World;
 
 class QTreeWidget;
 class QTreeWidgetItem;
+class QComboBox;
+class QDoubleSpinBox;
 
 class KRYOMOLCORE_EXPORT ConfManager : public QWidget
 {
@@ -22,15 +25,26 @@ public:
 
 signals:
     void visible(bool, const std::vector<bool>& );
+    /** emitted with the conformers included in the average when one of them is toggled*/
+    void included(const std::vector<bool>& );
 public slots:
     void Refresh();
 private slots:
     void OnItemChanged(QTreeWidgetItem* item);
+    void OnClusterMethodChanged(int method);
+    void OnCluster();
+    void OnShowRepresentatives();
 private:
     void InitTree();
+    void UpdateClusterColumn();
 private:
     kryomol::World* m_world;
     QTreeWidget* m_tree;
+    QComboBox* m_clustermethod;
+    QDoubleSpinBox* m_clusterparameter;
+    /** cluster index of each frame, empty if the conformers have not been clustered*/
+    std::vector<size_t> m_clusterof;
+    std::vector<bool> m_representative;
 };
 
 #endif // CONFMANAGER_H
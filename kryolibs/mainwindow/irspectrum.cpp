@@ -18,18 +18,15 @@ the Free Software Foundation version 2 of the License.
 #include "irspectrum.h"
 #include "qplotspectrum.h"
 
-#ifndef M_PI
-# define M_PI       3.14159265358979323846  // matches value in gcc v2 math.h
-#endif
-
 const std::string jcampversion="4.24";
 
-IRSpectrum::IRSpectrum() : m_spectrumtype(QPlotSpectrum::IR)
+IRSpectrum::IRSpectrum() : m_ensemble(kryomol::LineBroadening::LORENTZIAN), m_spectrumtype(QPlotSpectrum::IR)
 {
   m_title= "gaussian spectrum";
   m_linewidth = 10;
   m_npoints = 8192;
   m_shift = 0.0;
+  m_scale = 1.0;
 
 }
 
@@ -38,28 +35,22 @@ IRSpectrum::~IRSpectrum()
 
 void IRSpectrum::SetFrequencies(const std::vector< std::vector<Frequency> >& v,double scale/*=1.0*/)
 {
-  m_frequencysets=v;
-  size_t nsets=v.size();
-  m_sinusoidsets.resize(nsets);
-
-
-  for(size_t i=0;i<nsets;++i)
-  {
-      auto& fset=m_frequencysets[i];
-      m_sinusoidsets[i].resize(fset.size());
-      for(auto& f: fset)
-      {
-          f.x*=scale;
-      }
-  }
+  //the frequencies are kept as read and scaled as the lines are built
+  if ( &v != &m_frequencysets ) m_frequencysets=v;
+  m_scale=scale;
+  size_t nsets=m_frequencysets.size();
+  std::vector<kryomol::SpectralLines>& linesets=m_ensemble.Lines();
+  //populations of other frames do not apply
+  if ( nsets != linesets.size() ) m_ensemble.SetWeights(std::vector<double>());
+  linesets.resize(nsets);
 
   for(size_t i=0;i<nsets;++i)
   {
       const auto& fset=m_frequencysets[i];
-      auto& sset=m_sinusoidsets[i];
+      auto& lines=linesets[i];
+      lines.Resize(fset.size());
       for(size_t j=0;j<fset.size();++j)
       {
-          auto& s=sset[j];
           float amplitude=std::numeric_limits<float>::max();
           switch( m_spectrumtype)
           {
@@ -75,74 +66,63 @@ void IRSpectrum::SetFrequencies(const std::vector< std::vector<Frequency> >& v,d
           default:
               throw QString("Not handled QPlotSpectrum type");
           }
-          s.m_zamplitude=s.m_flamplitude=amplitude;
-          s.m_fldecay=m_linewidth;
-          s.m_flphase=0;
-          s.m_flt1=0;
-          s.m_multiplicity=1;
-          s.m_flfrequency=fset[j].x;
-          s.InitData(m_npoints);
+          lines.area[j]=amplitude;
+          lines.x[j]=fset[j].x*m_scale+m_shift;
       }
   }
-
-  m_weights=std::vector<float>(m_frequencysets.size(),1.0f/m_frequencysets.size());
-
 }
 
 
 void IRSpectrum::SetType( QPlotSpectrum::SpectrumType type )
 {
   m_spectrumtype=type;
-  SetFrequencies(m_frequencysets);
+  SetFrequencies(m_frequencysets,m_scale);
 }
 
 
 void IRSpectrum::CalculateSpectrum()
 {
-  m_data.clear();
-  m_data.resize(m_frequencysets.size());
-  m_totaldata.clear();
-  m_totaldata.grow(m_npoints);
-  for(size_t i=0;i<m_npoints;++i)
-  {
-      m_totaldata[i]=std::complex<float>(0,0);
-  }
-  for(size_t idx=0;idx<m_sinusoidsets.size();++idx)
+  m_ensemble.Broadening().SetWidth(m_linewidth);
+  m_ensemble.SetGrid(kryomol::LineBroadening::Grid(m_min,m_max,m_npoints));
+  //only the curves computed again are copied
+  const std::vector<size_t> changed=m_ensemble.Calculate();
+
+  m_data.resize(m_ensemble.Size());
+  for(size_t idx : changed )
   {
       auto& d=m_data[idx];
-      d.grow(m_npoints);
-      float max=m_max;
-      float min=m_min;
-      float width=(max-min);
-      float fdelta_v=width/(d.size()-1);
+      const std::vector<float>& curve=m_ensemble.Curve(idx);
+      d.clear();
+      d.grow(curve.size());
       for(size_t k=0;k<d.size();++k)
       {
-          float m=min+k*fdelta_v;
-          d[k]=GetIntensityAt(m,m_sinusoidsets[idx]);
-          m_totaldata[k]+=(d[k]*m_weights[idx]);
+          d[k]=curve[k];
       }
   }
-
-
+  SumSpectrum();
 }
 
-float IRSpectrum::GetIntensityAt(float lambda,const std::vector<Sinusoid>& sv)
+void IRSpectrum::SumSpectrum()
 {
-
-  float sumsignals=0;
-  //http://en.wikipedia.org/wiki/Cauchy_distribution
-  for( const auto& s: sv )
+  const std::vector<float>& total=m_ensemble.Total();
+  m_totaldata.clear();
+  m_totaldata.grow(total.size());
+  for(size_t k=0;k<total.size();++k)
   {
-    float gamma=s.m_fldecay/2;
-    float sigma2=gamma*gamma;
-    float diff=lambda-s.m_flfrequency;
-    //std::cout << "Amplitude=" << it->m_flamplitude << std::endl;
-    float x=s.m_flamplitude*gamma/( diff*diff+sigma2);
-
-    sumsignals+=x;
+      m_totaldata[k]=total[k];
   }
-  sumsignals/=M_PI;
-  return sumsignals;
+}
+
+void IRSpectrum::SetPopulations(const std::vector<double>& p)
+{
+  m_ensemble.SetWeights(p);
+  SumSpectrum();
+}
+
+void IRSpectrum::SetIncluded(const std::vector<bool>& included)
+{
+  m_ensemble.SetIncluded(included);
+  SumSpectrum();
 }
 
 bool IRSpectrum::WriteJCampDX()
@@ -238,28 +218,21 @@ void IRSpectrum::SetFile(const char* file)
 
 
 void IRSpectrum::SetLineWidth(float lw)
-{   
-    for(auto& sset : m_sinusoidsets )
-    {
-        for(auto& s: sset)
-        {
-            s.m_fldecay=lw;
-        }
-    }
+{
+    m_linewidth=lw;
 }
 
 
 void IRSpectrum::SetShift(float shift)
 {
-    std::vector<Sinusoid>::iterator it;
-    std::vector<Frequency>::iterator vit;
-
-    for(size_t idx=0;idx<m_sinusoidsets.size();++idx )
+    m_shift=shift;
+    std::vector<kryomol::SpectralLines>& linesets=m_ensemble.Lines();
+    for(size_t idx=0;idx<linesets.size();++idx )
     {
-        std::vector<Sinusoid>& set = m_sinusoidsets[idx];
-        for (size_t jdx=0;jdx<set.size();++jdx)
+        kryomol::SpectralLines& lines = linesets[idx];
+        for (size_t jdx=0;jdx<lines.Size();++jdx)
         {
-            set[jdx].m_flfrequency=m_frequencysets[idx][jdx].x+shift;
+            lines.x[jdx]=m_frequencysets[idx][jdx].x*m_scale+shift;
         }
     }
 
@@ -277,10 +250,11 @@ void IRSpectrum::SetAutoLimits()
   {
         for(auto& f : fset )
         {
-            if(f.x >max)
-                max=f.x;
-            if(f.x < min)
-                min=f.x;
+            const float x=f.x*m_scale;
+            if(x >max)
+                max=x;
+            if(x < min)
+                min=x;
         }
   }
 
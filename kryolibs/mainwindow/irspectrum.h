@@ -13,15 +13,23 @@ the Free Software Foundation version 2 of the License.
 #define IRSPECTRUM_H
 #include <vector>
 
-#include "sinusoid.h"
+#include "fidarray.h"
 #include "frequency.h"
+#include "linebroadening.h"
 #include "qplotspectrum.h"
 
+/** @brief simulation of IR, VCD and Raman spectra
+
+The bands are broadened with lorentzians by @see kryomol::LineBroadening. The curve of each frame is kept by
+@see kryomol::EnsembleSpectrum and computed again only when its bands, the width or the scaling change, so new
+populations only weight the kept curves again*/
 class IRSpectrum
 {
 public:
   IRSpectrum();
   ~IRSpectrum();
+  /** build the spectrum of the frequencies @param v of each frame scaled by @param scale. The frequencies are
+      copied unless @param v is the set of the spectrum itself, that is never scaled in place*/
   void SetFrequencies(const std::vector< std::vector<Frequency> >& v,double scale=1.0);
   void CalculateSpectrum();
   bool WriteJCampDX();
@@ -42,15 +50,29 @@ public:
   void SetNPoints (int n) {m_npoints = n;}
   void SetType(QPlotSpectrum::SpectrumType type);
   QPlotSpectrum::SpectrumType GetType() const { return m_spectrumtype; }
-private:
-  float GetIntensityAt(float lambda,const std::vector<Sinusoid>& sv);
+  /** weight the curve of each frame in the total by the populations @param p, all the same if empty*/
+  void SetPopulations(const std::vector<double>& p);
+  /** sum only the curves of the frames flagged in @param included*/
+  void SetIncluded(const std::vector<bool>& included);
+  /** set the shape of the bands, lorentzian by default*/
+  void SetLineShape(kryomol::LineBroadening::Shape shape) { m_ensemble.Broadening().SetShape(shape); }
+  kryomol::LineBroadening::Shape LineShape() const { return m_ensemble.Broadening().GetShape(); }
+  /** set how the curves are computed, by direct sums or by convolution. The method is chosen by the number of
+      bands and points by default*/
+  void SetSynthesis(kryomol::LineBroadening::Method method) { m_ensemble.Broadening().SetMethod(method); }
+  kryomol::LineBroadening::Method Synthesis() const { return m_ensemble.Broadening().GetMethod(); }
+  /** set the largest error of the convolution, relative to the height of a line, for it to be chosen*/
+  void SetSynthesisAccuracy(double accuracy) { m_ensemble.Broadening().SetAccuracy(accuracy); }
 protected:
   std::string m_file;
   /** a vector of frequencies for each frame */
   std::vector< std::vector<Frequency> > m_frequencysets;
 private:
-  /** a vector of sinusoids for each frame*/
-  std::vector< std::vector<Sinusoid> > m_sinusoidsets;
+  /** copy the weighted sum of the curves to the total*/
+  void SumSpectrum();
+private:
+  /** the scaled and shifted positions and the intensities of the bands of each frame and their curves*/
+  kryomol::EnsembleSpectrum m_ensemble;
   std::vector<fidarray> m_data;
   fidarray m_expdata;
   fidarray m_totaldata;
@@ -61,9 +83,9 @@ private:
   /** Linewidth in cm-1*/
   float m_linewidth;
   float m_shift;
+  /** scaling factor of the frequencies*/
+  double m_scale;
   int m_npoints;
-  /** conformational weights*/
-  std::vector<float> m_weights;
 };
 
 #endif
@@ -29,35 +29,33 @@ the Free Software Foundation version 2 of the License.
 
 Convergence::Convergence ( size_t size )
 {
-    m_energies= new double[size];
-    m_S2= new double[size];
-    m_rmsforces= new double[size];
-    m_maximumforces= new double[size];
-    m_rmsdisplacements= new double[size];
-    m_maximumdisplacements= new double[size];
-    m_size=size;
+    Resize ( size );
 }
 
 Convergence::~Convergence()
 {
-    delete [] m_energies;
-    delete [] m_S2;
-    delete [] m_rmsforces;
-    delete [] m_maximumforces;
-    delete [] m_rmsdisplacements;
-    delete [] m_maximumdisplacements;
+}
 
+void Convergence::Resize ( size_t size )
+{
+    m_energies.resize ( size );
+    m_S2.resize ( size );
+    m_rmsforces.resize ( size );
+    m_maximumforces.resize ( size );
+    m_rmsdisplacements.resize ( size );
+    m_maximumdisplacements.resize ( size );
+    m_size=size;
 }
 
 double Convergence::MaxEnergy()
 {
-    return GetMaxArray ( m_energies );
+    return GetMaxArray ( Energies() );
 
 }
 
 double Convergence::MinEnergy()
 {
-    return GetMinArray ( m_energies );
+    return GetMinArray ( Energies() );
 }
 
 double Convergence::GetMaxArray ( double* array )
@@ -105,7 +103,8 @@ std::ostream& operator << ( std::ostream& s, Convergence& conv )
 }
 
 QConvWidget::QConvWidget (QWidget *parent,bool gradients /*=true*/, bool displacements /*=true*/)
-    : QWidget ( parent ) , m_gradient(NULL), m_displacement(NULL)
+    : QWidget ( parent ) , m_gradient(NULL), m_displacement(NULL), m_energycurve(NULL), m_rmsforcecurve(NULL),
+      m_maxforcecurve(NULL), m_rmsdispcurve(NULL), m_maxdispcurve(NULL)
 {
     m_bshowforces = false;
 
@@ -167,7 +166,7 @@ QConvWidget::QConvWidget (QWidget *parent,bool gradients /*=true*/, bool displac
         lay->addWidget(box);
 
     }
-    m_xaxis=NULL;
+    m_ndata=0;
     m_convdata=NULL;
 
     connect ( m_energy,SIGNAL ( selectedPoint ( size_t ) ),this,SIGNAL ( selectedPoint ( size_t ) ) );
@@ -194,14 +193,13 @@ QConvWidget::QConvWidget (QWidget *parent,bool gradients /*=true*/, bool displac
 QConvWidget::~QConvWidget()
 {
 
-    if ( m_xaxis ) delete [] m_xaxis;
     if ( m_convdata ) delete m_convdata;
 }
 
 void QConvWidget::SetNData ( size_t size )
 {
 
-    m_xaxis=new double[size];
+    m_xaxis.resize(size);
     m_ndata=size;
 
     for ( size_t  i=0;i< size;i++ )
@@ -215,18 +213,37 @@ void QConvWidget::SetNData ( size_t size )
 
 }
 
-void QConvWidget::SetupCurves()
+void QConvWidget::Resize ( size_t size )
 {
-    //Take into account incomplete minimizations
-    double* forces=m_convdata->RMSForces();
-    int data=m_ndata;
-    if ( forces[m_ndata-1] < 0 )
+    if ( m_convdata == NULL )
+    {
+        SetNData ( size );
+        return;
+    }
+    m_xaxis.resize ( size );
+    for ( size_t i=m_ndata;i< size;i++ )
     {
-        data=m_ndata-1;
+        m_xaxis[i]=i+1;
     }
+    m_ndata=size;
+    m_convdata->Resize ( size );
+}
+
+int QConvWidget::CompletePoints()
+{
+    //Take into account incomplete minimizations
+    if ( m_ndata > 0 && m_convdata->RMSForces() [m_ndata-1] < 0 )
+        return m_ndata-1;
+    return m_ndata;
+}
+
+void QConvWidget::SetupCurves()
+{
+    int data=CompletePoints();
     EnergyCurve* envc= new EnergyCurve ( m_energy,"energies" );
+    m_energycurve=envc;
     envc->setExtraLabel("E");
-    envc->setRawSamples( m_xaxis,m_convdata->Energies(),data  );
+    envc->setRawSamples( m_xaxis.data(),m_convdata->Energies(),data  );
     envc->setExtraData ( m_convdata->S2() );
     envc->setPen ( QPen ( QColor ( 255,0,0 ) ) );
     envc->attach ( m_energy );
@@ -240,9 +257,11 @@ void QConvWidget::SetupCurves()
         mxfcv->setExtraLabel("Max. Force");
         QuantumCurve* rmsfcv= new QuantumCurve ( m_gradient,"rmsforces" );
         rmsfcv->setExtraLabel("RMS Force");
+        m_maxforcecurve=mxfcv;
+        m_rmsforcecurve=rmsfcv;
 
-        rmsfcv->setRawSamples ( m_xaxis,m_convdata->RMSForces(),data );
-        mxfcv->setRawSamples ( m_xaxis,m_convdata->MaximumForces(),data );
+        rmsfcv->setRawSamples ( m_xaxis.data(),m_convdata->RMSForces(),data );
+        mxfcv->setRawSamples ( m_xaxis.data(),m_convdata->MaximumForces(),data );
         rmsfcv->setPen ( QPen ( QColor ( 255,0,0 ) ) );
         mxfcv->setPen ( QPen ( QColor ( 0,0,255 ) ) );
         rmsfcv->attach ( m_gradient );
@@ -268,9 +287,11 @@ void QConvWidget::SetupCurves()
         rmsdisp->setExtraLabel("RMS Disp.");
         QuantumCurve* maxdisp = new QuantumCurve ( m_displacement,"maxdisplacements" );
         maxdisp->setExtraLabel("Max. Disp.");
+        m_rmsdispcurve=rmsdisp;
+        m_maxdispcurve=maxdisp;
 
-        rmsdisp->setRawSamples ( m_xaxis,m_convdata->RMSDisplacements(),data );
-        maxdisp->setRawSamples ( m_xaxis,m_convdata->MaximumDisplacements(),data );
+        rmsdisp->setRawSamples ( m_xaxis.data(),m_convdata->RMSDisplacements(),data );
+        maxdisp->setRawSamples ( m_xaxis.data(),m_convdata->MaximumDisplacements(),data );
         rmsdisp->setPen ( QPen ( QColor ( 255,0,0 ) ) );
         maxdisp->setPen ( QPen ( QColor ( 0,0,255 ) ) );
 
@@ -294,6 +315,34 @@ void QConvWidget::SetupCurves()
 
 }
 
+/** the curves keep pointers to the arrays, that Resize can reallocate, so all the samples are set again while
+    only the markers of the new points are created*/
+void QConvWidget::UpdateCurves ( size_t first )
+{
+    if ( m_energycurve == NULL ) return;
+    int data=CompletePoints();
+    m_energycurve->setRawSamples ( m_xaxis.data(),m_convdata->Energies(),data );
+    m_energycurve->setExtraData ( m_convdata->S2() );
+    m_energy->updateStepMarkers ( first );
+    m_energy->replot();
+
+    if ( m_gradient )
+    {
+        m_rmsforcecurve->setRawSamples ( m_xaxis.data(),m_convdata->RMSForces(),data );
+        m_maxforcecurve->setRawSamples ( m_xaxis.data(),m_convdata->MaximumForces(),data );
+        m_gradient->updateStepMarkers ( first );
+        m_gradient->replot();
+    }
+    if ( m_displacement )
+    {
+        m_rmsdispcurve->setRawSamples ( m_xaxis.data(),m_convdata->RMSDisplacements(),data );
+        m_maxdispcurve->setRawSamples ( m_xaxis.data(),m_convdata->MaximumDisplacements(),data );
+        m_displacement->updateStepMarkers ( first );
+        m_displacement->replot();
+    }
+    m_limitsbox->SetLimits ( 1,m_ndata );
+}
+
 
 void QConvWidget::OnChangeLimits ( int first, int last )
 {
@@ -13,6 +13,7 @@ the Free Software Foundation version 2 of the License.
 #define QCONVWIDGET_H
 
 #include <iostream>
+#include <vector>
 
 #include <QWidget>
 #include <QSlider>
@@ -26,29 +27,33 @@ This class contais QwtPlot widget for info on convergence of calculations
 */
 
 class QuantumPlot;
+class QuantumCurve;
+class EnergyCurve;
 class Convergence
 {
 public:
   Convergence(size_t size);
   ~Convergence();
-  double* Energies() { return m_energies; }
-  double* S2() { return m_S2; }
-  double* RMSForces()  {return m_rmsforces; }
-  double* MaximumForces() { return m_maximumforces; }
-  double* RMSDisplacements() { return m_rmsdisplacements; }
-  double* MaximumDisplacements() { return m_maximumdisplacements; }
+  double* Energies() { return m_energies.data(); }
+  double* S2() { return m_S2.data(); }
+  double* RMSForces()  {return m_rmsforces.data(); }
+  double* MaximumForces() { return m_maximumforces.data(); }
+  double* RMSDisplacements() { return m_rmsdisplacements.data(); }
+  double* MaximumDisplacements() { return m_maximumdisplacements.data(); }
   double MaxEnergy();
   double MinEnergy();
+  /** change the number of points, the values of the first ones are kept. The arrays can be reallocated*/
+  void Resize(size_t size);
 
   size_t size() const { return m_size; }
   friend std::ostream& operator << (std::ostream& s, Convergence& conv);
 private:
-  double* m_energies;
-  double* m_S2;
-  double* m_rmsforces;
-  double* m_maximumforces;
-  double* m_rmsdisplacements;
-  double* m_maximumdisplacements;
+  std::vector<double> m_energies;
+  std::vector<double> m_S2;
+  std::vector<double> m_rmsforces;
+  std::vector<double> m_maximumforces;
+  std::vector<double> m_rmsdisplacements;
+  std::vector<double> m_maximumdisplacements;
   size_t m_size;
 private:
   double GetMaxArray(double* array);
@@ -79,6 +84,10 @@ public:
   int GetForceScale() { return m_scaleslider->value();}
 
   void SetupCurves();
+  /** change the number of points of a job that is still running, the values of the first ones are kept*/
+  void Resize(size_t size);
+  /** show the values of the points from @param first on, after the job wrote new steps*/
+  void UpdateCurves(size_t first);
   void SetThreshold(const Threshold& thr) { m_threshold=thr; }
   void SetEnergyLevel(const QString& level) {  m_energylevel=level; }
 signals:
@@ -91,11 +100,13 @@ public slots:
 private slots:
   void OnChangeLimits(int, int);
   void OnForceSliderChanged(int );
+private:
+  int CompletePoints();
 private:
   QuantumPlot* m_energy;
   QuantumPlot* m_gradient;
   QuantumPlot* m_displacement;
-  double* m_xaxis;
+  std::vector<double> m_xaxis;
   double* m_yenergies;
   double* m_yrmsforces;
   double* m_ymaximumforces;
@@ -104,6 +115,11 @@ private:
   size_t m_ndata;
   QString m_energylevel;
   Convergence* m_convdata;
+  EnergyCurve* m_energycurve;
+  QuantumCurve* m_rmsforcecurve;
+  QuantumCurve* m_maxforcecurve;
+  QuantumCurve* m_rmsdispcurve;
+  QuantumCurve* m_maxdispcurve;
   Threshold m_threshold;
   QDoubleEditBox* m_limitsbox;
   QSlider* m_scaleslider;
@@ -83,6 +83,7 @@ QFreqWidget::QFreqWidget(kryomol::World* world,const QString& file,QWidget* pare
 
     connect(_scaleLineEdit,SIGNAL(returnPressed()),this,SLOT(OnScaling()));
     connect(_spectrumTypeComboBox,SIGNAL(activated(int)),this,SLOT(OnSpectrumTypeChanged(int)));
+    connect(m_world,SIGNAL(thermostatChanged()),this,SLOT(OnThermostatChanged()));
 
     m_activemode=0;
     m_npoints = 8192;
@@ -368,12 +369,13 @@ void QFreqWidget::OnScaling()
 void QFreqWidget::InitFrequencies()
 {
 
+    m_frequencysets.clear();
     for(const auto& f : m_world->CurrentMolecule()->Frames() )
     {
         m_frequencysets.push_back(f.GetFrequencies());
     }
 
-    //the above set will not be modified, scaled etc but the irspectrum set can be scaled, shifted, etc.
+    //the set of the spectrum is filled in place, scaling and shifts are applied to the sinusoids only
     IRSpectrum::SetFrequencies(m_frequencysets);
 }
 
@@ -444,4 +446,10 @@ void QFreqWidget::OnSpectrumTypeChanged(int t)
     emit Type(GetType()); //to stablish the baseline
 }
 
-
+void QFreqWidget::OnThermostatChanged()
+{
+    //the curves of the frames are kept, only their average changes
+    if ( m_world->CurrentMolecule() == nullptr ) return;
+    IRSpectrum::SetPopulations(m_world->CurrentMolecule()->Populations());
+    emit data(GetData(),Max(),Min(),Shift());
+}
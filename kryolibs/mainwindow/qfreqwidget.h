@@ -36,7 +36,7 @@ public:
 
     /** Init frequency table for conformation with index fidx*/
     void InitTable(size_t fidx);
-    /** get a copy of the frequencies for each conformation and pass it to IRSpectrum*/
+    /** fill the frequencies of IRSpectrum with those of each conformation*/
     void InitFrequencies();
 private:
     QFreqWidget(QWidget* parent=0,const char* name=0);
@@ -68,9 +68,9 @@ private slots:
   void OnResetDistortions();
   void OnSpectrumTypeChanged(int);
   void OnTableSelection(int );
+  void OnThermostatChanged();
 private:
     bool m_bshowspectrum;
-    std::vector< std::vector<Frequency> > m_frequencysets;
     std::vector<int> m_distortframes;
     int m_activemode;
     int m_npoints;
@@ -48,6 +48,9 @@ QIRWidget::QIRWidget(kryomol::World* w, QWidget* parent ) :  QWidget(parent), m_
     connect(sctopop,&QCheckBox::toggled,m_spectrum,&QPlotSpectrum::ScaleToPopulation);
     connect(m_confmanager,&ConfManager::visible,m_spectrum,&QPlotSpectrum::SetVisible);
     connect(this,&QIRWidget::populations,m_spectrum,&QPlotSpectrum::SetPopulations);
+    connect(m_confmanager,&ConfManager::included,m_spectrum,&QPlotSpectrum::SetIncluded);
+    //the curves are only weighted again with the new populations
+    connect(m_world,&kryomol::World::thermostatChanged,this,&QIRWidget::OnGetPopulations);
 
 
 
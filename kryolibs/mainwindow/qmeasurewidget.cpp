@@ -12,8 +12,13 @@ the Free Software Foundation version 2 of the License.
 #include <iostream>
 #include <sstream>
 
+#include <QVBoxLayout>
+
 #include "qmeasurewidget.h"
 #include "ui_qmeasurewidgetbase.h"
+#include "geometricdescriptors.h"
+#include "qwt_plot.h"
+#include "qwt_plot_curve.h"
 
 QMeasureWidget::QMeasureWidget(QWidget *parent) :
     QWidget(parent)
@@ -39,6 +44,17 @@ void QMeasureWidget::Init()
 
     m_bshowdistances=false;
 
+    //the measurement controls keep their designer geometry, the plot of the selected measure goes below
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    groupBox->setMinimumSize(groupBox->size());
+    layout->addWidget(groupBox);
+    m_plot = new QwtPlot(this);
+    m_plot->setAxisTitle(QwtPlot::xBottom,tr("Frame"));
+    m_curve = new QwtPlotCurve();
+    m_curve->attach(m_plot);
+    layout->addWidget(m_plot);
+    m_plot->hide();
+
     _clearAll->setWhatsThis(tr("Clear all the measurements calculated"));
     _showDistances->setWhatsThis(tr("Activate it for visualizing the distance vector in the visor"));
 }
@@ -50,6 +66,8 @@ void QMeasureWidget::OnClearAll()
     _listDihedrals->clear();
     _showDistances->setCheckState(Qt::Unchecked);
     m_bshowdistances=false;
+    m_series.clear();
+    m_plot->hide();
 
     emit clearAll();
 
@@ -150,6 +168,7 @@ void QMeasureWidget::OnDistanceChange(QListWidgetItem *i)
 {
     _listAngles->setCurrentItem(_listAngles->currentItem(),QItemSelectionModel::Deselect);
     _listDihedrals->setCurrentItem(_listDihedrals->currentItem(),QItemSelectionModel::Deselect);
+    PlotSeries(_listDistances->row(i),i->text());
     emit distanceChange(_listDistances->row(i));
 
 }
@@ -158,6 +177,7 @@ void QMeasureWidget::OnAngleChange(QListWidgetItem *i)
 {
     _listDistances->setCurrentItem(_listDistances->currentItem(),QItemSelectionModel::Deselect);
     _listDihedrals->setCurrentItem(_listDihedrals->currentItem(),QItemSelectionModel::Deselect);
+    PlotSeries(_listDistances->count()+_listAngles->row(i),i->text());
     emit angleChange(_listAngles->row(i));
 
 }
@@ -166,6 +186,7 @@ void QMeasureWidget::OnDihedralChange(QListWidgetItem *i)
 {
     _listDistances->setCurrentItem(_listDistances->currentItem(),QItemSelectionModel::Deselect);
     _listAngles->setCurrentItem(_listAngles->currentItem(),QItemSelectionModel::Deselect);
+    PlotSeries(_listDistances->count()+_listAngles->count()+_listDihedrals->row(i),i->text());
     emit dihedralChange(_listDihedrals->row(i));
 
 }
@@ -175,3 +196,30 @@ void QMeasureWidget::OnShowDistances()
     m_bshowdistances = !m_bshowdistances;
     emit showDistances(m_bshowdistances);
 }
+
+void QMeasureWidget::SetSeries(const kryomol::GeometricDescriptors& series)
+{
+    m_series.resize(series.Size());
+    for (size_t d=0; d<series.Size(); ++d)
+    {
+        const float* values=series.Series(d);
+        m_series[d].assign(values,values+series.NFrames());
+    }
+    m_frames.resize(series.NFrames());
+    for (size_t f=0; f<m_frames.size(); ++f)
+        m_frames[f]=f+1;
+}
+
+void QMeasureWidget::PlotSeries(int d, const QString& title)
+{
+    //a single frame has nothing to plot
+    if ( d < 0 || static_cast<size_t>(d) >= m_series.size() || m_frames.size() < 2 )
+    {
+        m_plot->hide();
+        return;
+    }
+    m_curve->setSamples(&m_frames[0],&m_series[d][0],static_cast<int>(m_frames.size()));
+    m_plot->setTitle(title.section("  ",0,0));
+    m_plot->show();
+    m_plot->replot();
+}
@@ -13,9 +13,17 @@ the Free Software Foundation version 2 of the License.
 #define QMEASUREWIDGET_H
 
 #include <QWidget>
+#include <vector>
 
 #include "ui_qmeasurewidgetbase.h"
 
+namespace kryomol
+{
+    class GeometricDescriptors;
+}
+
+class QwtPlot;
+class QwtPlotCurve;
 
 class QMeasureWidget : public QWidget, private Ui::QMeasureWidgetBase
 {
@@ -29,6 +37,8 @@ public:
     void updateDistances(QStringList list);
     void updateAngles(QStringList list);
     void updateDihedrals(QStringList list);
+    /** set the values of the measures along all the frames, distances first, then angles and dihedrals*/
+    void SetSeries(const kryomol::GeometricDescriptors& series);
 
 public slots:
     void OnClearAll();
@@ -49,8 +59,15 @@ private slots:
     void OnDihedralChange(QListWidgetItem*);
     void OnShowDistances();
 
+private:
+    void PlotSeries(int d, const QString& title);
+
 private:
     bool m_bshowdistances;
+    QwtPlot* m_plot;
+    QwtPlotCurve* m_curve;
+    std::vector< std::vector<double> > m_series;
+    std::vector<double> m_frames;
 
 };
 
@@ -18,8 +18,10 @@ the Free Software Foundation version 2 of the License.
 #include "renderorbitals.h"
 #include "molecule.h"
 #include "frame.h"
+#include "exception.h"
 
 #include "QButtonGroup"
+#include <QMessageBox>
 #include <QTime>
 
 #include <sstream>
@@ -722,6 +724,15 @@ void QOrbitalWidget::OnSetFrame(size_t frame)
     kryomol::Frame& fr=m_world->Molecules().back().Frames()[frame];
     if ( fr.HasOrbitals() )
     {
+        //the orbitals read on demand are decoded here, so a file that can not be read is reported
+        try
+        {
+            fr.LoadData(kryomol::Frame::ORBITALS);
+        }
+        catch(const kryomol::Exception& e)
+        {
+            QMessageBox::critical(this,"",QString(e.what()));
+        }
         this->ListOrbitals();
         m_render = kryomol::RenderOrbitals(m_world->Molecules().back().Frames()[frame]);
 
@@ -151,6 +151,20 @@ void QPlotSpectrum::PlotSpectrum()
 
     QVector<double> tdata(datasets.front().size(),0.0);
 
+    //the weights of the curves in the average, normalized over the included ones
+    std::vector<double> weights(datasets.size(),0.0);
+    double wsum=0;
+    for(size_t i=0;i<datasets.size() && i<m_weights.size();++i)
+    {
+        if ( i < m_included.size() && !m_included[i] ) continue;
+        weights[i]=m_weights[i];
+        wsum+=weights[i];
+    }
+    if ( wsum != 0 )
+    {
+        for(auto& w : weights) w/=wsum;
+    }
+
 
     for(size_t i=0;i<datasets.size();++i)
     {
@@ -168,7 +182,7 @@ void QPlotSpectrum::PlotSpectrum()
             {
                 m_y.back()*=m_weights[i];;
             }
-            tdata[j]+=(y*m_weights[i]);
+            tdata[j]+=(y*weights[i]);
             vx = vx + step;
         }
         c->setSamples(m_x,m_y);
@@ -372,3 +386,9 @@ void QPlotSpectrum::SetPopulations(const std::vector<double>& w)
     PlotSpectrum();
 
 }
+
+void QPlotSpectrum::SetIncluded(const std::vector<bool>& vb)
+{
+    m_included=vb;
+    PlotSpectrum();
+}
@@ -50,6 +50,8 @@ public slots:
     void ScaleToPopulation(bool b);
     bool ScaledToPopulation() const { return m_scaledtopop; }
     void SetPopulations(const std::vector<double>& w);
+    /** average only the curves flagged in @param vb, their weights normalized among them*/
+    void SetIncluded(const std::vector<bool>& vb);
 
 private:
     QwtPlot* m_plot;
@@ -70,6 +72,7 @@ private:
     std::vector<bool> m_showcurves;
     bool m_scaledtopop;
     std::vector<double> m_weights;
+    std::vector<bool> m_included;
 
 };
 
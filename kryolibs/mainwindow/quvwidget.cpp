@@ -94,7 +94,7 @@ QUVWidget::QUVWidget(const kryomol::World* world, const QString& file, QWidget*
     connect(_enantiomerButton,SIGNAL(toggled(bool)),this,SLOT(OnCalculateEnantiomer(bool )));
 
     connect(_boltzmannCheckBox,SIGNAL(toggled(bool)),this,SLOT(OnBoltzmannCheckBox(bool)));
-    //this->SetPopulations(&world->CurrentMolecule()->Populations());
+    connect(world,SIGNAL(thermostatChanged()),this,SLOT(OnThermostatChanged()));
 
 }
 
@@ -556,6 +556,14 @@ void QUVWidget::OnFormalismChanged(int index)
 
 void QUVWidget::OnBoltzmannCheckBox(bool b)
 {
-    //this->SetBoltzmannWeighting(b);
+    //the curves of the frames are kept, only their average changes
+    if ( b && m_world->CurrentMolecule() ) SetPopulations(m_world->CurrentMolecule()->Populations());
+    else SetPopulations(std::vector<double>());
+    UpdatePlot();
+}
+
+void QUVWidget::OnThermostatChanged()
+{
+    if ( _boltzmannCheckBox->isChecked() ) OnBoltzmannCheckBox(true);
 }
 
@@ -84,6 +84,7 @@ private slots:
     void OnFormalismChanged(int );
     void OnSolventShift(bool b);
     void OnBoltzmannCheckBox(bool b);
+    void OnThermostatChanged();
 private:
     void InitTransitionTable(int );
 
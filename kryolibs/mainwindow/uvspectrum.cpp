@@ -20,14 +20,19 @@ the Free Software Foundation version 2 of the License.
 #include "irspectrum.h"
 #include "qplotspectrum.h"
 
-#ifndef M_PI
-# define M_PI       3.14159265358979323846  // matches value in gcc v2 math.h
-#endif
-
 const std::string jcampversion="4.24";
 const bool useboltzmannweighting=false;
 
-UVSpectrum::UVSpectrum() : m_spectrumtype(QPlotSpectrum::UV)
+namespace
+{
+    /** conversion of wavelengths in nm to energies in eV, e=hc/lambda*/
+    constexpr float ltoev=PC::h*PC::jtoev*PC::c*1e9;
+    /** molar absorptivity (Mol-1 cm-1) of a band of unit dipole strength and energy, and of its ECD counterpart*/
+    const float uvfactor=2.870e4;
+    const float ecdfactor=1/22.97;
+}
+
+UVSpectrum::UVSpectrum() : m_ensemble(kryomol::LineBroadening::GAUSSIAN), m_spectrumtype(QPlotSpectrum::UV)
 {
     m_title= "gaussian spectrum";
     m_linewidth = 0.3;
@@ -35,156 +40,79 @@ UVSpectrum::UVSpectrum() : m_spectrumtype(QPlotSpectrum::UV)
     m_shift = 0.0;
     m_formalism=length;
     m_benantiomer=false;
-    //m_boltzw=useboltzmannweighting;
-    //m_populations=nullptr;
+    m_bsubstractsolventshift=false;
+    m_scale=1.0;
 }
 
 UVSpectrum::~UVSpectrum()
 {}
 
-void UVSpectrum::SetLines(std::vector< std::vector<Spectralline> >& v,double scale/*=1.0*/)
+void UVSpectrum::SetLines(const std::vector< std::vector<Spectralline> >& v,double scale/*=1.0*/)
 {
-    m_linesets=v;
-    m_sinusoidsets.resize(m_linesets.size());
-    for(size_t idx=0;idx<m_linesets.size();++idx)
-    {
-        size_t nlines=m_linesets[idx].size();
-        m_sinusoidsets[idx].resize(nlines);
-    }
-
-    //m_weights=std::vector<float>(m_linesets.size(),1.0f/m_linesets.size());
-
-    for (auto& lineset : v )
-    {
-        for(auto& l : lineset)
-        {
-            l.x*=scale;
-        }
-
-    }
+    //the transitions are kept as read and scaled as the lines are built
+    if ( &v != &m_linesets ) m_linesets=v;
+    m_scale=scale;
 
-    for(size_t idx=0;idx<m_linesets.size();++idx)
-    {
-        std::vector<Sinusoid>& sv=m_sinusoidsets[idx];
-        std::vector<Spectralline>& sl=m_linesets[idx];
-        for(size_t jdx=0;jdx<sv.size();++jdx)
-        {
-            Sinusoid& svv=sv[jdx];
-            const Spectralline& sll=sl[jdx];
-            if ( m_spectrumtype == QPlotSpectrum::ECD )
-            {
-                int enantiomerize=1;
-                if ( m_benantiomer ) enantiomerize=-1;
-
-                double y;
-                if ( m_formalism == length)
-                    y=sll.RotatoryStrengthLength()*enantiomerize; //proportional to rotatory strength
-                else
-                    y=sll.RotatoryStrengthVelocity()*enantiomerize;
-
-                svv.m_zamplitude=svv.m_flamplitude=y;
-
-            } else if ( m_spectrumtype == QPlotSpectrum::UV )
-            {
-                svv.m_zamplitude=svv.m_flamplitude=sll.y0;
-            }
-
-            svv.m_fldecay=m_linewidth;
-            svv.m_flfrequency=sll.x+m_shift;
-            svv.m_flphase=0.0f;
-            svv.m_flt1=0.0f;
-            svv.m_J=0.0f;
-            svv.m_multiplicity=1;
-            svv.InitData(m_npoints);
-        }
-    }
+    //populations of other frames do not apply
+    if ( m_linesets.size() != m_ensemble.Lines().size() ) m_ensemble.SetWeights(std::vector<double>());
 
+    RecalculateX();
 }
 
 
 void UVSpectrum::SetType( QPlotSpectrum::SpectrumType type )
 {
     m_spectrumtype=type;
-    SetLines(m_linesets);
+    SetLines(m_linesets,m_scale);
 }
 
 
 void UVSpectrum::CalculateSpectrum()
 {
-    m_data.clear();
-    m_data.resize(m_linesets.size());
-    m_totaldata.clear();
-    m_totaldata.grow(m_npoints);
-    for(size_t i=0;i<m_npoints;++i)
-    {
-        m_totaldata[i]=std::complex<float>(0,0);
-    }
-    for(size_t idx=0;idx<m_sinusoidsets.size();++idx)
+    //the lines are broadened in energy, at the energies of the points of the wavelength grid
+    std::vector<float> grid=kryomol::LineBroadening::Grid(m_min,m_max,m_npoints);
+    for(auto& x : grid ) x=ltoev/x;
+    m_ensemble.Broadening().SetWidth(m_linewidth);
+    m_ensemble.SetGrid(grid);
+    //only the curves computed again are copied
+    const std::vector<size_t> changed=m_ensemble.Calculate();
+
+    m_data.resize(m_ensemble.Size());
+    for(size_t idx : changed )
     {
         auto& d=m_data[idx];
-        d.grow(m_npoints);
-        float max=m_max;
-        float min=m_min;
-        float width=(max-min);
-        float fdelta_v=width/(d.size()-1);
+        const std::vector<float>& curve=m_ensemble.Curve(idx);
+        d.clear();
+        d.grow(curve.size());
         for(size_t k=0;k<d.size();++k)
         {
-            float m=min+k*fdelta_v;
-            d[k]=GetIntensityAt(m,m_sinusoidsets[idx]);
-
-            /*if ( this->BoltzmannWeighting() )
-            {
-                double p=(*m_populations)[idx];
-                d[k]*=p;
-            } else
-            {
-                d[k]*=m_weights[idx];
-            }*/
-            m_totaldata[k]+=(d[k]);
-        }    
+            d[k]=curve[k];
+        }
     }
+    SumSpectrum();
 }
 
-//return Mol-1 cm-1
-float UVSpectrum::GetIntensityAt(float lambda,const std::vector<Sinusoid>& sdd)
+void UVSpectrum::SumSpectrum()
 {
-    //e=hc/\lambda
-    constexpr float ltoev=PC::h*PC::jtoev*PC::c*1e9;
-    std::cout << ltoev << std::endl;
-    float eval=ltoev/lambda;
-    float prefactor;
-    double uvfactor=2.870e4/std::sqrt(2*M_PI);
-    double ecdfactor=1/(22.97*std::sqrt(2*M_PI));
-    switch(  this->GetType() )
+    const std::vector<float>& total=m_ensemble.Total();
+    m_totaldata.clear();
+    m_totaldata.grow(total.size());
+    for(size_t k=0;k<total.size();++k)
     {
-    case QPlotSpectrum::UV:
-        prefactor=uvfactor;
-        break;
-    case QPlotSpectrum::ECD:
-        prefactor=ecdfactor;
-        break;
-    default:
-        throw std::runtime_error("Invalid spectrum type");
-
+        m_totaldata[k]=total[k];
     }
+}
 
-    float sumsignals=0;
-    for( const auto& s : sdd)
-    {
-        //Get the transition uv value in ev
-        float deltae=ltoev/s.m_flfrequency;
-        //constexpr float stofwhm=2*std::sqrt(2*std::log(2));
-        //This is the factor to convert standard deviation to FWHM
-        float stofwhm=2*std::sqrt(2*std::log(2));
-        std::cout << stofwhm << std::endl;
-        float sigma=s.m_fldecay/stofwhm; //FWHM
-        float expfactor=(eval-deltae)/(sigma);
-        float cd=(1/sigma)*deltae*s.m_flamplitude*exp(-( expfactor*expfactor )/2 );
-
-        sumsignals+=cd;
-    }
-    sumsignals*=prefactor;
-    return sumsignals;
+void UVSpectrum::SetPopulations(const std::vector<double>& p)
+{
+    m_ensemble.SetWeights(p);
+    SumSpectrum();
+}
+
+void UVSpectrum::SetIncluded(const std::vector<bool>& included)
+{
+    m_ensemble.SetIncluded(included);
+    SumSpectrum();
 }
 
 bool UVSpectrum::WriteJCampDX()
@@ -312,15 +240,8 @@ void UVSpectrum::SetFile(const char* file)
 
 void UVSpectrum::SetLineWidth(float sigma)
 {
-    //set the global linewidth and each line
+    //set the global linewidth (FWHM in eV)
     m_linewidth=sigma;
-    for(auto& sd : m_sinusoidsets )
-    {
-        for(auto& s : sd)
-        {
-            s.m_fldecay=sigma;
-        }
-    }
 }
 
 
@@ -337,20 +258,47 @@ void UVSpectrum::SubstractSolventShift(bool b)
     RecalculateX();
 }
 
+//areas in Mol-1 cm-1 eV
 void UVSpectrum::RecalculateX()
 {
+    int enantiomerize=1;
+    if ( m_benantiomer ) enantiomerize=-1;
 
-    for(size_t i=0;i<m_sinusoidsets.size();++i)
+    std::vector<kryomol::SpectralLines>& linesets=m_ensemble.Lines();
+    linesets.resize(m_linesets.size());
+    for(size_t i=0;i<m_linesets.size();++i)
     {
-        std::vector<Sinusoid>& sd=m_sinusoidsets[i];
+        kryomol::SpectralLines& sd=linesets[i];
         const std::vector<Spectralline>& ld=m_linesets[i];
-        for(size_t j=0;j<sd.size();++j)
+        sd.Resize(ld.size());
+        for(size_t j=0;j<ld.size();++j)
         {
-            sd[j].m_flfrequency=ld[j].x+m_shift;
+            float x=ld[j].x*m_scale+m_shift;
             if ( m_bsubstractsolventshift )
             {
-                sd[j].m_flfrequency-=ld[j].SolventShift();
+                x-=ld[j].SolventShift();
             }
+            //Get the transition uv value in ev
+            const float deltae=ltoev/x;
+
+            float y;
+            switch( m_spectrumtype )
+            {
+            case QPlotSpectrum::UV:
+                y=uvfactor*ld[j].y0;
+                break;
+            case QPlotSpectrum::ECD:
+                if ( m_formalism == length)
+                    y=ld[j].RotatoryStrengthLength(); //proportional to rotatory strength
+                else
+                    y=ld[j].RotatoryStrengthVelocity();
+                y*=ecdfactor*enantiomerize;
+                break;
+            default:
+                throw std::runtime_error("Invalid spectrum type");
+            }
+            sd.x[j]=deltae;
+            sd.area[j]=deltae*y;
         }
     }
 
@@ -382,7 +330,7 @@ void UVSpectrum::SetAutoLimits()
 void UVSpectrum::SetEnantiomer(bool b)
 {
     m_benantiomer=b;
-    SetLines(m_linesets);
+    RecalculateX();
 }
 
 void UVSpectrum::SetFormalism(formalism f)
@@ -14,6 +14,10 @@ the Free Software Foundation version 2 of the License.
 
 /**
 A class for simulation of UV and ECD spectra
+
+The transitions are broadened with gaussians in energy by @see kryomol::LineBroadening, at the energies of the
+points of the wavelength grid. The curve of each frame is kept by @see kryomol::EnsembleSpectrum and computed
+again only when its transitions, the width or the scaling change, and the total is their weighted average
 */
 
 #include <vector>
@@ -21,7 +25,7 @@ A class for simulation of UV and ECD spectra
 #include "kryomolcore_export.h"
 #include "frequency.h"
 #include "fidarray.h"
-#include "sinusoid.h"
+#include "linebroadening.h"
 #include "qplotspectrum.h"
 
 class KRYOMOLCORE_EXPORT UVSpectrum
@@ -30,7 +34,9 @@ public:
   enum formalism { length=0, velocity };
   UVSpectrum();
   ~UVSpectrum();
-  void SetLines(std::vector< std::vector<Spectralline> >& v,double scale=1.0);
+  /** set the transitions @param v of each frame, their wavelengths scaled by @param scale. The lines are
+      copied unless @param v is the set of the spectrum itself*/
+  void SetLines(const std::vector< std::vector<Spectralline> >& v,double scale=1.0);
   void CalculateSpectrum();
   bool WriteJCampDX();
   void CopyData();
@@ -49,31 +55,42 @@ public:
   void SubstractSolventShift(bool b);
   void SetNPoints (int n) {m_npoints = n;}
   float LineWidth() const { return m_linewidth; }
+  /** set the shape of the lines, gaussian by default*/
+  void SetLineShape(kryomol::LineBroadening::Shape shape) { m_ensemble.Broadening().SetShape(shape); }
+  kryomol::LineBroadening::Shape LineShape() const { return m_ensemble.Broadening().GetShape(); }
+  /** set how the curves are computed, by direct sums or by convolution. The method is chosen by the number of
+      lines and points by default*/
+  void SetSynthesis(kryomol::LineBroadening::Method method) { m_ensemble.Broadening().SetMethod(method); }
+  kryomol::LineBroadening::Method Synthesis() const { return m_ensemble.Broadening().GetMethod(); }
+  /** set the largest error of the convolution, relative to the height of a line, for it to be chosen*/
+  void SetSynthesisAccuracy(double accuracy) { m_ensemble.Broadening().SetAccuracy(accuracy); }
   void SetType(QPlotSpectrum::SpectrumType type);
   QPlotSpectrum::SpectrumType GetType() const { return m_spectrumtype; }
   formalism Formalism() const { return m_formalism; }
   void SetFormalism(formalism f);
   void SetEnantiomer(bool b);
   bool Enantiomer() const { return m_benantiomer; }
-  /** set use boltzmann weighthing for averaged curve*/
-  //void SetBoltzmannWeighting(bool b) { m_boltzw=b; }
-  /** true if using boltzmann weighthing for averaged curve*/
-  //bool BoltzmannWeighting() const { return m_boltzw; }
-  //void SetPopulations(const std::vector<double>* p) { m_populations=p; }
+  /** weight the curve of each frame in the total by the populations @param p, all the same if empty*/
+  void SetPopulations(const std::vector<double>& p);
+  /** sum only the curves of the frames flagged in @param included*/
+  void SetIncluded(const std::vector<bool>& included);
 
 
 
 private:
-  float GetIntensityAt(float lambda,const std::vector<Sinusoid>& sdd);
+  /** compute the energies and the areas of the lines from the transitions*/
   void RecalculateX();
+  /** copy the weighted average of the curves to the total*/
+  void SumSpectrum();
 protected:
   std::string m_file;
   std::vector< std::vector<Spectralline> > m_linesets;
 private:
-  std::vector< std::vector<Sinusoid> > m_sinusoidsets;
+  /** energies (eV) and areas of the lines of each frame and their curves*/
+  kryomol::EnsembleSpectrum m_ensemble;
   /** there will be a curve for each of the n conformations*/
   std::vector<fidarray> m_data;
-  /** sum of the n curves*/
+  /** weighted average of the n curves*/
   fidarray m_totaldata;
   /** experimental curve*/
   fidarray m_expdata;
@@ -87,9 +104,8 @@ private:
   formalism m_formalism;
   bool m_benantiomer;
   bool m_bsubstractsolventshift;
-  //std::vector<float> m_weights;
-  //bool m_boltzw;
-  //const std::vector<double>* m_populations;
+  /** scaling factor of the wavelengths*/
+  double m_scale;
 };
 
 #endif
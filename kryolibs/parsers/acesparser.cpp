@@ -272,12 +272,13 @@ do
     if(line.size() > 13 ) line.insert(13," ");
     StringTokenizer token(line," \t");
     if( token.size() < 4) break;
-    std::vector< std::vector<Coordinate> >& coordinates = Molecules()->back().GetMode();
+    NormalModes& modes = Molecules()->back().Modes();
+    if ( static_cast<size_t>(m_counter+nmodes) > modes.Size() || static_cast<size_t>(atom) >= modes.NAtoms() ) return false;
     for(int j=0;j<nmodes;j++)
     {
-      coordinates.at(j+m_counter).at(atom).x() = std::atof ( token[1+3*j].c_str() );
-      coordinates.at(j+m_counter).at(atom).y() = std::atof ( token[2+3*j].c_str() );
-      coordinates.at(j+m_counter).at(atom).z() = std::atof ( token[3+3*j].c_str() );
+      modes(j+m_counter,3*atom) = std::atof ( token[1+3*j].c_str() );
+      modes(j+m_counter,3*atom+1) = std::atof ( token[2+3*j].c_str() );
+      modes(j+m_counter,3*atom+2) = std::atof ( token[3+3*j].c_str() );
     }
     atom++;
 
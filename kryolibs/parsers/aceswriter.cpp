@@ -48,7 +48,7 @@ std::ostream& kryomol::operator << (std::ostream& s, const AcesWriter& aw)
          s <<  counter << " " << r.label.str()  << " ";
 
          svalues <<  r.label.str() << "=" <<  std::setiosflags(std::ios::fixed) <<std::setprecision(4) <<
-           r.value   << std::resetiosflags(std::ios::fixed) << std::endl;
+           r.value   << std::resetiosflags(std::ios::fixed) << '\n';
          }
 
          if( counter > 1)
@@ -58,7 +58,7 @@ std::ostream& kryomol::operator << (std::ostream& s, const AcesWriter& aw)
             a.value=Coordinate::GetAngle(molecule->CurrentFrame().XYZ().at(counter),molecule->CurrentFrame().XYZ().at(counter-1),molecule->CurrentFrame().XYZ().at(counter-2),true);
             s << counter-1 << " " << a.label.str() << " ";
             svalues << a.label.str() << "=" <<  std::setiosflags(std::ios::fixed) <<std::setprecision(3) <<
-           a.value   << std::resetiosflags(std::ios::fixed) << std::endl;
+           a.value   << std::resetiosflags(std::ios::fixed) << '\n';
             }
 
          if(counter > 2)
@@ -68,15 +68,15 @@ std::ostream& kryomol::operator << (std::ostream& s, const AcesWriter& aw)
            d.value=Coordinate::GetDihedral(molecule->CurrentFrame().XYZ().at(counter),molecule->CurrentFrame().XYZ().at(counter-1),molecule->CurrentFrame().XYZ().at(counter-2),molecule->CurrentFrame().XYZ().at(counter-3),true);
            s << counter -2 << " " << d.label.str();
            svalues << d.label.str() << "=" << std::setiosflags(std::ios::fixed) <<std::setprecision(2) <<
-           d.value   << std::resetiosflags(std::ios::fixed) << std::endl;
+           d.value   << std::resetiosflags(std::ios::fixed) << '\n';
          }
 
-         s << std::endl;
+         s << '\n';
 
 
    }
 
-   s << std::endl << svalues.str() << std::endl;
+   s << '\n' << svalues.str() << '\n';
 
    return s;
 
@@ -26,11 +26,11 @@ CPMDWriter::~CPMDWriter()
 void kryomol::operator << ( std::ostream& s, const CPMDWriter& w )
 {
     std::cout << "Exporting CPMD input file" << std::endl;
- s << "&CPMD" << std::endl << "&END" << std::endl;
- s << "&SYSTEM" << std::endl;
- s << "ANGSTROM" << std::endl;
- s << "&END" << std::endl;
- s << "&ATOMS" << std::endl;
+ s << "&CPMD" << '\n' << "&END" << '\n';
+ s << "&SYSTEM" << '\n';
+ s << "ANGSTROM" << '\n';
+ s << "&END" << '\n';
+ s << "&ATOMS" << '\n';
  //OK lets do groups
  std::vector<Atom>::const_iterator at;
  std::vector <std::string> names;
@@ -46,14 +46,14 @@ void kryomol::operator << ( std::ostream& s, const CPMDWriter& w )
  }
  for ( st=names.begin();st!=names.end();++st )
  {
-   s << "*" << ( *st ) << ".psp" << std::endl;
-   s << "LMAX=" << std::endl;
+   s << "*" << ( *st ) << ".psp" << '\n';
+   s << "LMAX=" << '\n';
    size_t counter=0;
    for ( at=w.m_molecule->Atoms().begin();at!=w.m_molecule->Atoms().end();++at )
    {
      if ( at->Symbol() == ( *st ) ) ++counter;
    }
-   s << " " << counter << std::endl;
+   s << " " << counter << '\n';
 
    std::vector<Coordinate>::const_iterator ft = w.m_molecule->CurrentFrame().XYZ().begin();
    for ( at=w.m_molecule->Atoms().begin();at!=w.m_molecule->Atoms().end();++at,++ft )
@@ -63,10 +63,10 @@ void kryomol::operator << ( std::ostream& s, const CPMDWriter& w )
        s << std::setw ( 10 ) << std::setiosflags ( std::ios::right )
        << std::setiosflags ( std::ios::fixed ) << std::setprecision ( 5 )
          << ft->x() << std::setw ( 10 ) << ft->y() << std::setw ( 10 ) << ft->z()
-         << std::resetiosflags ( std::ios::right ) << std::endl;
+         << std::resetiosflags ( std::ios::right ) << '\n';
      }
    }
  }
- s << "&END" << std::endl;
+ s << "&END" << '\n';
 }
 
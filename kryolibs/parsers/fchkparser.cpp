@@ -0,0 +1,392 @@
+/*****************************************************************************************
+                            fchkparser.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "fchkparser.h"
+#include "molecule.h"
+#include "linereader.h"
+
+using namespace kryomol;
+
+namespace
+{
+    const double bohrtoangs=0.529189379;
+
+    /** columns of the header of an entry: name, type and, for arrays, the number of elements*/
+    const size_t namewidth=40;
+    const size_t typecolumn=43;
+    const size_t countcolumn=47;
+    const size_t valuecolumn=49;
+
+    /** @return true if @param line is the header of a scalar or an array, "Name   I   N=   12"*/
+    bool IsHeader ( std::string_view line )
+    {
+        if ( line.size() <= typecolumn+1 || line[0] == ' ' ) return false;
+        if ( line.compare ( namewidth,typecolumn-namewidth,"   " ) != 0 || line[typecolumn+1] != ' ' ) return false;
+        return std::strchr ( "IRCHL",line[typecolumn] ) != NULL;
+    }
+
+    bool Convert ( std::string_view s, int& value ) { return ToInt ( s,value ); }
+    bool Convert ( std::string_view s, double& value ) { return ToDouble ( s,value ); }
+
+    /** call @param store with the index and the value of each of the @param count numbers after @param offset
+        of @param text, that are separated by blanks whatever the lines they are in
+        @return false if the text ends before or a value is not a number*/
+    template<class T, class F>
+    bool ReadValues ( std::string_view text, size_t offset, size_t count, F store )
+    {
+        const Delimiters& blanks=Delimiters::Blanks();
+        const char* p=text.data()+std::min ( offset,text.size() );
+        const char* end=text.data()+text.size();
+        for ( size_t i=0;i<count;++i )
+        {
+            while ( p != end && blanks ( *p ) ) ++p;
+            if ( p == end ) return false;
+            const char* first=p;
+            while ( p != end && !blanks ( *p ) ) ++p;
+            T value;
+            if ( !Convert ( std::string_view ( first,p-first ),value ) ) return false;
+            store ( i,value );
+        }
+        return true;
+    }
+}
+
+FChkParser::FChkParser ( const char* file ) : Parser ( file ), m_nbasis ( 0 )
+{}
+
+FChkParser::FChkParser ( std::istream* stream ) : Parser ( stream ), m_nbasis ( 0 )
+{}
+
+FChkParser::~FChkParser()
+{}
+
+bool FChkParser::ParseFile ( std::streampos /*pos*/ )
+{
+    //a checkpoint file holds a single job
+    if ( m_entries.empty() ) Index();
+    if ( !GetGeometry() ) return false;
+
+    Frame& frame=Molecules()->back().Frames().back();
+    if ( GetBasisCenters ( frame ) ) GetOrbitalData ( frame );
+
+    m_file->clear();
+    m_file->seekg ( 0,std::ios::beg );
+    return true;
+}
+
+std::vector<JobHeader>& FChkParser::Jobs()
+{
+    if ( m_jobpos.empty() )
+    {
+        if ( m_entries.empty() ) Index();
+        m_jobpos.push_back ( JobHeader ( Find ( "Vib-NDim" ) != NULL ? freq : singlepoint,0 ) );
+    }
+    return m_jobpos;
+}
+
+bool FChkParser::ParseFrequencies ( std::streampos /*pos*/ )
+{
+    if ( Molecules()->empty() || Molecules()->back().Frames().empty() ) return false;
+    return GetFrequencies ( Molecules()->back().Frames().back() );
+}
+
+void FChkParser::Index()
+{
+    m_entries.clear();
+    const std::string_view text=Text();
+    LineReader reader ( text );
+    std::string_view line;
+    //the first two lines are the title and the type of job, method and basis
+    reader.Skip ( 2 );
+    while ( reader.Next ( line ) )
+    {
+        if ( !IsHeader ( line ) ) continue;
+        std::string_view name=line.substr ( 0,namewidth );
+        while ( !name.empty() && name.back() == ' ' ) name.remove_suffix ( 1 );
+
+        Entry entry;
+        entry.type=line[typecolumn];
+        if ( line.size() > valuecolumn && line.compare ( countcolumn,2,"N=" ) == 0 )
+        {
+            entry.count=static_cast<size_t> ( std::max ( ToInt ( line.substr ( valuecolumn ) ),0 ) );
+            entry.offset=reader.Offset();
+        }
+        else
+        {
+            entry.offset=reader.LineOffset()+std::min ( valuecolumn,line.size() );
+        }
+        m_entries[std::string ( name )]=entry;
+    }
+}
+
+const FChkParser::Entry* FChkParser::Find ( const char* name ) const
+{
+    std::map<std::string,Entry>::const_iterator it=m_entries.find ( name );
+    return it == m_entries.end() ? NULL : &it->second;
+}
+
+int FChkParser::Integer ( const char* name, int value )
+{
+    const Entry* entry=Find ( name );
+    if ( entry != NULL && entry->type == 'I' && entry->count == 0 ) ToInt ( Text().substr ( entry->offset ),value );
+    return value;
+}
+
+bool FChkParser::Real ( const char* name, double& value )
+{
+    const Entry* entry=Find ( name );
+    if ( entry == NULL || entry->type != 'R' || entry->count != 0 ) return false;
+    return ToDouble ( Text().substr ( entry->offset ),value );
+}
+
+bool FChkParser::ReadArray ( const char* name, std::vector<int>& values )
+{
+    values.clear();
+    const Entry* entry=Find ( name );
+    if ( entry == NULL || entry->type != 'I' ) return false;
+    values.resize ( entry->count );
+    return ReadValues<int> ( Text(),entry->offset,entry->count,[&values] ( size_t i, int v ) { values[i]=v; } );
+}
+
+bool FChkParser::ReadArray ( const char* name, std::vector<double>& values )
+{
+    values.clear();
+    const Entry* entry=Find ( name );
+    if ( entry == NULL || entry->type != 'R' ) return false;
+    values.resize ( entry->count );
+    return ReadValues<double> ( Text(),entry->offset,entry->count,[&values] ( size_t i, double v ) { values[i]=v; } );
+}
+
+bool FChkParser::ReadCoefficients ( const char* name, size_t nbasis, D2Array<float>& matrix )
+{
+    const Entry* entry=Find ( name );
+    if ( entry == NULL || entry->type != 'R' || nbasis == 0 || entry->count % nbasis != 0 ) return false;
+    if ( entry->count/nbasis > nbasis ) return false;
+
+    //the coefficients of each orbital are contiguous in the file, the orbitals are the columns of the matrix
+    matrix.Initialize ( nbasis,nbasis,0.0 );
+    return ReadValues<double> ( Text(),entry->offset,entry->count,[&matrix,nbasis] ( size_t i, double v )
+    {
+        matrix ( i%nbasis,i/nbasis ) =static_cast<float> ( v );
+    } );
+}
+
+bool FChkParser::GetGeometry()
+{
+    std::vector<int> numbers;
+    std::vector<double> xyz;
+    if ( !ReadArray ( "Atomic numbers",numbers ) || !ReadArray ( "Current cartesian coordinates",xyz ) ) return false;
+    if ( numbers.empty() || xyz.size() != 3*numbers.size() ) return false;
+
+    Molecules()->push_back ( Molecule() );
+    Molecule& molecule=Molecules()->back();
+    molecule.Frames().push_back ( Frame ( &molecule ) );
+    Frame& frame=molecule.Frames().back();
+    for ( size_t i=0;i<numbers.size();++i )
+    {
+        molecule.Atoms().push_back ( Atom ( numbers[i] ) );
+        Coordinate c;
+        c.x() =xyz[3*i]*bohrtoangs;
+        c.y() =xyz[3*i+1]*bohrtoangs;
+        c.z() =xyz[3*i+2]*bohrtoangs;
+        frame.XYZ().push_back ( c );
+    }
+
+    double energy;
+    if ( Real ( "Total Energy",energy ) )
+    {
+        double scf;
+        if ( Real ( "SCF Energy",scf ) && scf == energy )
+            frame.SetEnergy ( energy,"SCF" );
+        else
+            frame.SetEnergy ( energy );
+    }
+    return true;
+}
+
+bool FChkParser::GetFrequencies ( Frame& frame )
+{
+    Molecule& molecule=Molecules()->back();
+    const size_t n3=3*molecule.Atoms().size();
+
+    //lower triangle of the cartesian Hessian, row by row
+    std::vector<double> values;
+    if ( ReadArray ( "Cartesian Force Constants",values ) && values.size() == n3* ( n3+1 ) /2 )
+    {
+        frame.AllocateHessian();
+        D2Array<double>& hessian=frame.GetHessian();
+        size_t k=0;
+        for ( size_t i=0;i<n3;++i )
+        {
+            for ( size_t j=0;j<=i;++j,++k )
+            {
+                hessian ( i,j ) =values[k];
+                hessian ( j,i ) =values[k];
+            }
+        }
+    }
+
+    //Vib-E2 holds the frequencies, reduced masses, force constants and IR intensities of the modes, one after
+    //another, and Vib-Modes the cartesian displacements of every mode in turn
+    const int ndim=Integer ( "Vib-NDim" );
+    if ( ndim <= 0 ) return false;
+    const size_t nmodes=static_cast<size_t> ( ndim );
+    if ( !ReadArray ( "Vib-E2",values ) || values.size() < 4*nmodes ) return false;
+
+    std::vector<Frequency>& frequencies=frame.GetFrequencies();
+    frequencies.clear();
+    frequencies.reserve ( nmodes );
+    for ( size_t i=0;i<nmodes;++i )
+        frequencies.push_back ( Frequency ( values[i],values[3*nmodes+i] ) );
+
+    NormalModes& modes=molecule.Modes();
+    modes.Initialize ( nmodes,molecule.Atoms().size() );
+    const Entry* entry=Find ( "Vib-Modes" );
+    if ( entry == NULL || entry->type != 'R' || entry->count != nmodes*n3 ) return false;
+    std::vector<float>& data=modes.Data();
+    return ReadValues<double> ( Text(),entry->offset,entry->count,[&data] ( size_t i, double v )
+    {
+        data[i]=static_cast<float> ( v );
+    } );
+}
+
+bool FChkParser::GetBasisCenters ( Frame& frame )
+{
+    std::vector<int> types;
+    std::vector<int> primitives;
+    std::vector<int> atoms;
+    std::vector<double> exponents;
+    std::vector<double> coefficients;
+    std::vector<double> pcoefficients;
+    if ( !ReadArray ( "Shell types",types ) || !ReadArray ( "Number of primitives per shell",primitives ) ||
+         !ReadArray ( "Shell to atom map",atoms ) || !ReadArray ( "Primitive exponents",exponents ) ||
+         !ReadArray ( "Contraction coefficients",coefficients ) )
+        return false;
+    //present only if there are SP shells
+    ReadArray ( "P(S=P) Contraction coefficients",pcoefficients );
+    if ( primitives.size() != types.size() || atoms.size() != types.size() ) return false;
+
+    //negative types are shells of pure functions
+    int typeD=Integer ( "Pure/Cartesian d shells" ) == 0 ? 5 : 6;
+    int typeF=Integer ( "Pure/Cartesian f shells" ) == 0 ? 7 : 10;
+    for ( size_t s=0;s<types.size();++s )
+    {
+        if ( types[s] == 2 ) typeD=6;
+        if ( types[s] == -2 ) typeD=5;
+        if ( types[s] == 3 ) typeF=10;
+        if ( types[s] == -3 ) typeF=7;
+    }
+
+    std::vector<BasisCenter> basis;
+    std::vector<Orbital> orbitals;
+    size_t nbasis=0;
+    size_t primitive=0;
+    for ( size_t s=0;s<types.size();++s )
+    {
+        const size_t n=static_cast<size_t> ( std::max ( primitives[s],0 ) );
+        if ( primitive+n > exponents.size() || primitive+n > coefficients.size() ) return false;
+        std::vector<float> alpha ( exponents.begin()+primitive,exponents.begin()+primitive+n );
+        std::vector<float> xs ( coefficients.begin()+primitive,coefficients.begin()+primitive+n );
+        std::vector<float> xp;
+
+        Orbital::OrbitalType type;
+        switch ( types[s] )
+        {
+        case 0:
+            type=Orbital::S;
+            nbasis+=1;
+            break;
+        case -1:
+            if ( primitive+n > pcoefficients.size() ) return false;
+            xp.assign ( pcoefficients.begin()+primitive,pcoefficients.begin()+primitive+n );
+            type=Orbital::SP;
+            nbasis+=4;
+            break;
+        case 1:
+            type=Orbital::P;
+            nbasis+=3;
+            break;
+        case 2:
+        case -2:
+            type=Orbital::D;
+            nbasis+=typeD;
+            break;
+        case 3:
+        case -3:
+            type=Orbital::F;
+            nbasis+=typeF;
+            break;
+        default:
+            //g and higher shells can not be represented
+            return false;
+        }
+        orbitals.push_back ( Orbital ( type,alpha,xs,xp ) );
+        primitive+=n;
+
+        //the shells of an atom are consecutive
+        if ( s+1 == types.size() || atoms[s+1] != atoms[s] )
+        {
+            const int atom=atoms[s]-1;
+            if ( atom < 0 || static_cast<size_t> ( atom ) >= frame.XYZ().size() ) return false;
+            basis.push_back ( BasisCenter ( frame.XYZ().at ( atom ),orbitals ) );
+            orbitals.clear();
+        }
+    }
+    if ( static_cast<int> ( nbasis ) != Integer ( "Number of basis functions" ) ) return false;
+
+    m_nbasis=nbasis;
+    frame.OrbitalsData().SetTypeD ( typeD );
+    frame.OrbitalsData().SetTypeF ( typeF );
+    frame.OrbitalsData().SetBasisCenters ( basis );
+    return true;
+}
+
+bool FChkParser::GetOrbitalData ( Frame& frame )
+{
+    OrbitalData& data=frame.OrbitalsData();
+    std::vector<double> energies;
+    if ( !ReadArray ( "Alpha Orbital Energies",energies ) || !ReadCoefficients ( "Alpha MO coefficients",m_nbasis,data.Coefficients() ) )
+        return false;
+
+    const bool beta=Find ( "Beta MO coefficients" ) != NULL;
+    const int nalpha=Integer ( "Number of alpha electrons" );
+    const int nbeta=Integer ( "Number of beta electrons" );
+    data.SetHomo ( nalpha );
+    data.SetLumo ( beta ? nalpha : nalpha+1 );
+    data.SetEigenvalues ( std::vector<float> ( energies.begin(),energies.end() ) );
+
+    //orbitals occupied by both electrons, and the singly occupied ones of restricted open shell wavefunctions
+    std::vector<float> occupations ( energies.size(),0.0 );
+    for ( size_t i=0;i<occupations.size();++i )
+    {
+        const int orbital=static_cast<int> ( i );
+        if ( beta )
+            occupations[i]=orbital < nalpha ? 1.0 : 0.0;
+        else
+            occupations[i]=orbital < nbeta ? 2.0 : ( orbital < nalpha ? 1.0 : 0.0 );
+    }
+    data.SetOccupations ( occupations );
+
+    if ( beta )
+    {
+        if ( !ReadArray ( "Beta Orbital Energies",energies ) || !ReadCoefficients ( "Beta MO coefficients",m_nbasis,data.BetaCoefficients() ) )
+            return false;
+        data.SetBetaEigenvalues ( std::vector<float> ( energies.begin(),energies.end() ) );
+    }
+
+    std::vector<double> density;
+    if ( ReadArray ( "Total SCF Density",density ) && density.size() == m_nbasis* ( m_nbasis+1 ) /2 )
+        data.SetDensity ( density );
+    return true;
+}
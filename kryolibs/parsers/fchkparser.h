@@ -0,0 +1,83 @@
+/*****************************************************************************************
+                            fchkparser.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef FCHKPARSER_H
+#define FCHKPARSER_H
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.h"
+#include "mathtools.h"
+
+namespace kryomol
+{
+class Frame;
+
+/** @brief parser of Gaussian formatted checkpoint files (.fchk)
+
+The file is a list of named scalars and arrays. The header of every entry is indexed in a single pass over
+the text, and then the arrays needed are converted in bulk from the text in memory, without splitting it
+in lines. Besides the geometry and the energy, the basis set (shells, primitive exponents and contraction
+coefficients), the alpha and beta molecular orbitals with their energies and occupations, the total SCF
+density and, after a frequency job, the cartesian force constants and the frequencies, IR intensities and
+normal modes are read, all of them in the full precision of the file*/
+class KRYOMOLPARSERS_API FChkParser : public Parser
+{
+public:
+  FChkParser(const char* file);
+  FChkParser(std::istream* stream);
+  ~FChkParser();
+  bool ParseFile(std::streampos pos=0);
+  /** a frequency job if the file has normal modes, otherwise a single point*/
+  std::vector<JobHeader>& Jobs();
+  bool ParseFrequencies(std::streampos pos=0);
+private:
+  /** @brief a scalar or the header of an array of the file*/
+  struct Entry
+  {
+    Entry() : type(' '), count(0), offset(0) {}
+    /** I (integer), R (real), C or H (text) or L (logical)*/
+    char type;
+    /** elements of an array, 0 for a scalar*/
+    size_t count;
+    /** position of the first line of the values of an array, of the value of a scalar*/
+    size_t offset;
+  };
+  void Index();
+  const Entry* Find(const char* name) const;
+  /** @return the value of the integer scalar @param name, @param value if there is none*/
+  int Integer(const char* name, int value=0);
+  /** @return false if there is no real scalar @param name, otherwise its value in @param value*/
+  bool Real(const char* name, double& value);
+  /** read the array @param name in @param values @return false if there is none or it is truncated*/
+  bool ReadArray(const char* name, std::vector<int>& values);
+  bool ReadArray(const char* name, std::vector<double>& values);
+  /** read the molecular orbitals of array @param name, @param nbasis coefficients for each orbital, as the
+      columns of @param matrix*/
+  bool ReadCoefficients(const char* name, size_t nbasis, D2Array<float>& matrix);
+  bool GetGeometry();
+  bool GetBasisCenters(Frame& frame);
+  bool GetOrbitalData(Frame& frame);
+  /** read the Hessian, the frequencies and the normal modes of a frequency job*/
+  bool GetFrequencies(Frame& frame);
+
+private:
+  std::map<std::string,Entry> m_entries;
+  /** number of atomic orbitals of the basis set*/
+  size_t m_nbasis;
+};
+
+}
+
+#endif
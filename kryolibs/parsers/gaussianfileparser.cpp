@@ -16,6 +16,7 @@ the Free Software Foundation version 2 of the License.
 #include "stdlib.h"
 #include "mathtools.h"
 #include "orbitalarray.h"
+#include "linereader.h"
 
 #include <QProgressDialog>
 #include <QDebug>
@@ -28,15 +29,95 @@ the Free Software Foundation version 2 of the License.
 
 using namespace kryomol;
 
-GaussianFileParser::GaussianFileParser ( const char* file ) : Parser ( file )
+namespace
+{
+    /** read a table of molecular orbitals, printed in blocks of up to five: a line with their numbers, a line
+        with their symmetries or occupations (O or V), their eigenvalues and the coefficients of each of the
+        @param norbitals atomic orbitals. The numbers are F10.5 fields, that run together when they fill them.
+        @param line is the first line of the table, and is left at the line ending it, the first one with
+        @param end or @param end2 if not empty. The occupations are read if @param occupations is not NULL*/
+    void ReadOrbitalTable ( LineReader& reader, std::string_view& line, std::string_view end, std::string_view end2,
+                            size_t norbitals, D2Array<float>& matrix, std::vector<float>& eigenvalues,
+                            std::vector<float>* occupations )
+    {
+        Tokens token;
+        size_t K=0;
+        bool more=true;
+        while ( more && line.find ( end ) == std::string_view::npos && ( end2.empty() || line.find ( end2 ) == std::string_view::npos ) )
+        {
+            token.Assign ( line );
+            const size_t M=token.size();
+            if ( M == 0 || K+M > norbitals || !reader.Next ( line ) ) break;
+            if ( occupations != NULL )
+            {
+                token.Assign ( line );
+                for ( size_t i=0;i<token.size();++i )
+                    occupations->push_back ( token[i].back() == 'O' ? 2.0 : 0.0 );
+            }
+            if ( !reader.Next ( line ) ) break;
+            const FixedFields eigenvalue ( line,M,10 );
+            for ( size_t e=0;e<eigenvalue.size();++e )
+                eigenvalues.push_back ( ToDouble ( eigenvalue[e] ) );
+            for ( size_t n=0;n<norbitals && reader.Next ( line );++n )
+            {
+                const FixedFields coefficient ( line,M,10 );
+                for ( size_t m=0;m<coefficient.size();++m )
+                    matrix ( n,K+m ) =ToDouble ( coefficient[m] );
+            }
+            K+=M;
+            more=reader.Next ( line );
+        }
+    }
+}
+
+GaussianFileParser::GaussianFileParser ( const char* file ) : Parser ( file ), m_jobbegin ( 0 ), m_framesection ( STANDARDORIENTATION ),
+  m_bthreshold ( false )
 {}
 
-GaussianFileParser::GaussianFileParser ( std::istream* stream ) : Parser ( stream )
+GaussianFileParser::GaussianFileParser ( std::istream* stream ) : Parser ( stream ), m_jobbegin ( 0 ),
+  m_framesection ( STANDARDORIENTATION ), m_bthreshold ( false )
 {}
 
 GaussianFileParser::~GaussianFileParser()
 {}
 
+void GaussianFileParser::DefineSections ( SectionIndex& index )
+{
+    index.Add ( ROUTE," #",0 );
+    index.Add ( ARCHIVEHEAD,"1\\1\\",1 );
+    index.Add ( ARCHIVEHEAD,"1|1|",1 );
+    index.Add ( ARCHIVE,"1\\1\\" );
+    index.Add ( ARCHIVE,"1|1|" );
+    index.Add ( JOBSEPARATOR,"#",0 );
+    index.Add ( STANDARDORIENTATION,"Standard orientation:" );
+    index.Add ( INPUTORIENTATION,"Input orientation:" );
+    index.Add ( ZMATRIXORIENTATION,"Z-Matrix orientation:" );
+    index.Add ( STATIONARYPOINT,"Stationary point found" );
+    index.Add ( SCAN,"Scan                            !" ); //gaussian03
+    index.Add ( SCAN,"Scan                         !" ); //gaussian98
+    index.Add ( VERSION,"Gaussian 09:" );
+    index.Add ( DIPOLE,"Dipole moment" );
+    index.Add ( ESPCHARGES,"Charges from ESP fit" );
+    index.Add ( BASISTYPE,"Standard basis:" );
+    index.Add ( BASISTYPE,"General basis read from cards:" );
+    index.Add ( ELECTRONS,"alpha electrons" );
+    index.Add ( ELECTRONS,"NAE=" );
+    index.Add ( BASIS,"AO basis set in the form of general basis input" );
+    index.Add ( ORBITALS,"Molecular Orbital Coefficients" );
+    index.Add ( ALPHABETA,"Alpha Orbitals:" );
+    index.Add ( FREQUENCIES,"Harmonic frequencies" );
+    index.Add ( EXCITEDSTATE,"Excited State" );
+    index.Add ( TRANSITIONDIPOLE,"Ground to excited state transition electric dipole" );
+    index.Add ( OLDRVELOCITY,"Total R(velocity) tensor for State=" );
+    index.Add ( RVELOCITY,"R(velocity)" );
+    index.Add ( RLENGTH,"R(length)" );
+    index.Add ( SHIELDING,"Magnetic shielding" );
+    index.Add ( COUPLINGS,"Total nuclear spin-spin coupling J" );
+    index.Add ( SUSCEPTIBILITY,"Magnetic susceptibility (cgs-ppm)" );
+    index.SetJobSection ( ROUTE );
+    index.SetFrameSection ( STANDARDORIENTATION );
+}
+
 bool GaussianFileParser::ParseFile ( std::streampos pos )
 {
     //clear the position vector
@@ -75,271 +156,276 @@ bool GaussianFileParser::ParseFile ( std::streampos pos )
 bool GaussianFileParser::GetGeometry()
 {
     std::string line;
-    bool bfound=false;
     //we should have now the header skip one line
     std::getline ( *m_file,line );
     std::streampos initpos=m_file->tellg();
-    bool bscan=false;
-    while ( std::getline ( *m_file,line ) )
-    {
-        if ( !bscan )
-            if ( ( line.find ( "Scan                            !" ) != std::string::npos ) //gaussian03
-                 || ( line.find ( "Scan                         !" ) != std::string::npos ) ) bscan=true; //gaussian98
-
-        if ( line.find ( "Stationary point found" ) != std::string::npos && !bscan ) break;
-        StringTokenizer token ( line );
-        if ( token.size() )
-        {
-            if ( line.find ( "Standard orientation:" ) != std::string::npos )
-            {
-                bfound=true;
-
-                for ( int i=0;i<3;i++ )
-                {
-                    std::getline ( *m_file,line );
-
-                }
+    if ( initpos < 0 ) return false;
+    m_jobbegin=initpos;
+    m_framesection=STANDARDORIENTATION;
+    GetFramePositions ( STANDARDORIENTATION,initpos,FramesEnd ( STANDARDORIENTATION ) );
 
-                m_pos.push_back ( m_file->tellg() );
-            }
-
-        }
-
-    }
     //Kein Standard Orientation, try input
     if ( m_pos.empty() )
     {
-        m_file->clear();
-        m_file->seekg ( initpos,std::ios::beg );
-        while ( std::getline ( *m_file,line ) )
-        {
-            if ( line.find ( "Input orientation:" ) != std::string::npos )
-            {
-                bfound=true;
-
-                for ( int i=0;i<3;i++ )
-                {
-                    std::getline ( *m_file,line );
-                }
-
-                m_pos.push_back ( m_file->tellg() );
-            }
-            if ( !line.empty() )
-                if ( line.at(0)  == '#'  ) break; //split different jobs
-        }
-
+        m_framesection=INPUTORIENTATION;
+        GetFramePositions ( INPUTORIENTATION,initpos,FramesEnd ( INPUTORIENTATION ) );
     }
+
     //Kein Standard Orientation or Input Orientation, try Z-matrix
     if ( m_pos.empty() )
     {
-        m_file->clear();
-        m_file->seekg ( initpos,std::ios::beg );
-        while ( std::getline ( *m_file,line ) )
-        {
-            if ( line.find ( "Z-Matrix orientation:" ) != std::string::npos )
-            {
-                bfound=true;
-
-                for ( int i=0;i<3;i++ )
-                {
-                    std::getline ( *m_file,line );
-                }
-
-                m_pos.push_back ( m_file->tellg() );
-            }
-            if ( !line.empty() )
-                if ( line.at(0)  == '#'  ) break; //split different jobs
-        }
-
+        m_framesection=ZMATRIXORIENTATION;
+        GetFramePositions ( ZMATRIXORIENTATION,initpos,FramesEnd ( ZMATRIXORIENTATION ) );
     }
+
     if ( m_pos.empty() ) return false;
 
-    std::vector<std::streampos>::iterator pt;
-    bool bthreshold=false;
-    Threshold threshold;
     //Get simply the last molecule
     Molecules()->push_back ( Molecule() );
-    pt=m_pos.begin();
-    m_file->clear();
-    m_file->seekg ( *pt,std::ios::beg );
-    std::getline ( *m_file,line ); //skip one line
-    while ( std::getline ( *m_file,line ) )
+    Molecule& molecule=Molecules()->back();
+    //the coordinate blocks are read in place from the text of the file
+    const std::string_view text=Text();
+    std::string_view view;
+    LineReader reader ( text,m_pos.front() );
+    reader.Skip(); //skip one line
+    while ( reader.Next ( view ) )
     {
-        StringTokenizer token ( line," " );
+        Tokens token ( view );
         size_t size=token.size();
 
         if ( size >= 5 )
         {
-            Molecules()->back().Atoms().push_back ( Atom ( atoi ( token.at ( 1 ).c_str() ) ) );
+            molecule.Atoms().push_back ( Atom ( ToInt ( token[1] ) ) );
         }
         else break;
     }
-    for ( pt=m_pos.begin();pt!=m_pos.end();pt++ )
+
+    std::vector<FrameBlock> blocks ( m_pos.size() );
+    m_threshold=Threshold();
+    m_bthreshold=false;
+    ParseFrames ( molecule,blocks );
+    FinishFrames ( molecule,blocks,0 );
+
+    molecule.SetBonds();
+
+    return true;
+}
+
+/** an optimization ends at the first stationary point, unless it is a scan. Input and Z-matrix orientations
+    are read up to the next job @return -1 if the frames go on till the end of the file*/
+std::streamoff GaussianFileParser::FramesEnd ( section s )
+{
+    const SectionIndex& index=Sections();
+    std::streamoff last=-1;
+    if ( s == STANDARDORIENTATION )
+    {
+        last=index.Find ( STATIONARYPOINT,m_jobbegin );
+        std::streamoff scan=index.Find ( SCAN,m_jobbegin );
+        if ( scan >= 0 && scan <= last ) last=-1;
+    }
+    else
     {
-        Molecules()->back().Frames().push_back ( Frame ( &Molecules()->back() ) );
+        last=index.Find ( JOBSEPARATOR,m_jobbegin );
+        if ( last >= 0 ) last+=1;
+    }
+    return last;
+}
 
-        m_file->clear();
-        m_file->seekg ( *pt,std::ios::beg );
-        std::getline ( *m_file,line ); //skip one line
-        while ( std::getline ( *m_file,line ) )
-        {
-            StringTokenizer token ( line," " );
-            size_t size=token.size();
+void GaussianFileParser::FindAppendedFrames()
+{
+    //the header of the last frame known is before its coordinates
+    GetFramePositions ( m_framesection,m_pos.back(),FramesEnd ( m_framesection ) );
+}
 
-            if ( size >= 5 )
+/** the criteria are printed with every step, but only the first ones are kept*/
+void GaussianFileParser::FinishFrames ( Molecule& molecule, const std::vector<FrameBlock>& blocks, size_t first )
+{
+    for ( size_t i=0;i<blocks.size() && first+i<molecule.Frames().size();++i )
+    {
+        if ( !m_bthreshold )
+        {
+            const FrameBlock& block=blocks[i];
+            if ( block.found & FrameBlock::MAXFORCE ) m_threshold.maxforce=block.threshold.maxforce;
+            if ( block.found & FrameBlock::RMSFORCE ) m_threshold.rmsforce=block.threshold.rmsforce;
+            if ( block.found & FrameBlock::MAXDISPLACEMENT ) m_threshold.maxdisplacement=block.threshold.maxdisplacement;
+            if ( block.found & FrameBlock::RMSDISPLACEMENT )
             {
-                Coordinate c;
-                c.x() =std::atof ( token.at ( size-3 ).c_str() );
-                c.y() =std::atof ( token.at ( size-2 ).c_str() );
-                c.z() =std::atof ( token.at ( size-1 ).c_str() );
-                Molecules()->back().Frames().back().XYZ().push_back ( c );
+                m_threshold.rmsdisplacement=block.threshold.rmsdisplacement;
+                m_bthreshold=true;
             }
+        }
+        molecule.Frames() [first+i].SetThreshold ( m_threshold );
+    }
+}
 
-            else  break;
+/** each frame is read from its coordinates up to the coordinates of the next frame, so the blocks are independent*/
+void GaussianFileParser::ParseFrameBlock ( std::string_view text, size_t frame, Frame& target, FrameBlock& block )
+{
+    static const Delimiters separators ( " \t," );
+    const std::streamoff begin=m_pos[frame];
+    const std::streamoff end=frame+1 < m_pos.size() ? std::streamoff ( m_pos[frame+1] ) : static_cast<std::streamoff> ( text.size() );
+
+    std::string_view line;
+    LineReader reader ( text,begin );
+    reader.Skip(); //skip one line
+    while ( reader.Next ( line ) )
+    {
+        Tokens token ( line );
+        size_t size=token.size();
+
+        if ( size >= 5 )
+        {
+            Coordinate c;
+            c.x() =ToDouble ( token[size-3] );
+            c.y() =ToDouble ( token[size-2] );
+            c.z() =ToDouble ( token[size-1] );
+            target.XYZ().push_back ( c );
         }
-        bool bbreak=false;
-        while ( std::getline ( *m_file,line ) )
+
+        else  break;
+    }
+
+    while ( static_cast<std::streamoff> ( reader.Offset() ) < end && reader.Next ( line ) )
+    {
+        if ( line.find ( "Stationary point found" ) != std::string_view::npos ) break;
+        Tokens token ( line,separators );
+        if ( token.size() >= 4 )
         {
-            if ( line.find ( "Stationary point found" ) != std::string::npos ) break;
-            StringTokenizer token ( line," \t," );
-            if ( token.size() >= 4 )
+            switch ( m_level )
             {
-                switch ( m_level )
+            case MNDO:
+                if ( m_version != GAUSSIAN09 )
                 {
-                case MNDO:
-                    std::cout << "MNDO" << std::endl;
-                    if ( m_version != GAUSSIAN09 )
-                    {
-                        if ( line.find ( "Energy=" ) != std::string::npos )
-                        {
-                            Molecules()->back().Frames().back().SetEnergy ( atof ( token.at ( 1 ) ),"SCF" );
-                        }
-                    }
-                    else
+                    if ( line.find ( "Energy=" ) != std::string_view::npos )
                     {
-                        if ( token.size() >= 5 )
-                            if ( token.at ( 0 ) =="SCF" && token.at ( 1 ) =="Done:" )
-                            {
-                                Molecules()->back().Frames().back().SetEnergy ( std::atof ( token.at ( 4 ).c_str() ),"SCF" );
-                            }
-
+                        block.energy=ToDouble ( token.at ( 1 ) );
+                        block.level="SCF";
                     }
-                    break;
-                case MP2:
-                    if ( token.size() >= 5 )
-                        if ( token.at ( 3 ).find ( "MP2" ) != std::string::npos )
-                            Molecules()->back().Frames().back().SetEnergy ( atof ( token.at ( 5 ) ),"MP2" );
-                    break;
-                case QCISD:
-
-                    if ( token[2]=="E(CORR)=" )
-                    {
-                        Molecules()->back().Frames().back().SetEnergy ( atof ( token.at ( 3 ) ),"QCISD" );
-                    }
-                    break;
-                case SCRF:
-                    if ( m_version != GAUSSIAN09 )
-                    {
-                        if ( line.find ( "with all non electrostatic terms" ) != std::string::npos )
-                            Molecules()->back().Frames().back().SetEnergy ( atof ( token.back() ),"SCRF" );
-                        if ( line.find ( "Total energy (include solvent energy)" ) != std::string::npos )
-                            Molecules()->back().Frames().back().SetEnergy ( atof ( token.back() ),"SCRF" );
-                    }
-                    else
-                    {
-                        if ( token.size() >= 5 )
-                            if ( token.at ( 0 ) =="SCF" && token.at ( 1 ) =="Done:" )
-                            {
-                                Molecules()->back().Frames().back().SetEnergy ( std::atof ( token.at ( 4 ).c_str() ),"SCF" );
-
-                            }
-                    }
-                    break;
-                case HF:
-                default:
+                }
+                else
+                {
                     if ( token.size() >= 5 )
                         if ( token.at ( 0 ) =="SCF" && token.at ( 1 ) =="Done:" )
                         {
-                            Molecules()->back().Frames().back().SetEnergy ( std::atof ( token.at ( 4 ).c_str() ),"SCF" );
-
+                            block.energy=ToDouble ( token.at ( 4 ) );
+                            block.level="SCF";
                         }
-                    break;
-                }
-
-                if ( line.find ( "before annihilation" ) !=std::string::npos )
-                {
-                    Molecules()->back().Frames().back().SetS2 ( std::atof ( token.at ( 3 ).c_str() ) );
 
                 }
-                if ( line.find ( "Forces (Hartrees/Bohr)" ) !=std::string::npos ) GetForces ( Molecules()->back() );
+                break;
+            case MP2:
+                if ( token.size() >= 5 )
+                    if ( token.at ( 3 ).find ( "MP2" ) != std::string_view::npos )
+                    {
+                        block.energy=ToDouble ( token.at ( 5 ) );
+                        block.level="MP2";
+                    }
+                break;
+            case QCISD:
 
-                if ( token.at ( 0 ) =="Maximum" && token.at ( 1 ) =="Force" )
+                if ( token[2]=="E(CORR)=" )
                 {
-                    Molecules()->back().Frames().back().SetMaximumForce ( std::atof ( token.at ( 2 ).c_str() ) );
-                    if ( !bthreshold )
-                        threshold.maxforce = std::atof ( token.at ( 3 ).c_str() );
-
+                    block.energy=ToDouble ( token.at ( 3 ) );
+                    block.level="QCISD";
                 }
-
-                if ( token.at ( 0 ) =="RMS" && token.at ( 1 ) =="Force" )
+                break;
+            case SCRF:
+                if ( m_version != GAUSSIAN09 )
                 {
-                    Molecules()->back().Frames().back().SetRMSForce ( std::atof ( token.at ( 2 ).c_str() ) );
-                    std::cout << "RMSForce: " << std::atof ( token.at ( 2 ).c_str() ) << " " << Molecules()->back().Frames().back().GetRMSForce() << std::endl;
-                    if ( !bthreshold )
+                    if ( line.find ( "with all non electrostatic terms" ) != std::string_view::npos ||
+                         line.find ( "Total energy (include solvent energy)" ) != std::string_view::npos )
                     {
-                        threshold.rmsforce = std::atof ( token.at ( 3 ).c_str() );
-                        std::cout << "Threshold RMSForce: " << std::atof ( token.at ( 3 ).c_str() ) << std::endl;
+                        block.energy=ToDouble ( token.back() );
+                        block.level="SCRF";
                     }
                 }
-
-                if ( token.at ( 0 ) =="Maximum" && token.at ( 1 ) =="Displacement" )
+                else
                 {
-                    Molecules()->back().Frames().back().SetMaximumDisplacement ( std::atof ( token.at ( 2 ).c_str() ) );
-                    if ( !bthreshold )
-                        threshold.maxdisplacement = std::atof ( token.at ( 3 ).c_str() );
-
+                    if ( token.size() >= 5 )
+                        if ( token.at ( 0 ) =="SCF" && token.at ( 1 ) =="Done:" )
+                        {
+                            block.energy=ToDouble ( token.at ( 4 ) );
+                            block.level="SCF";
+                        }
                 }
+                break;
+            case HF:
+            default:
+                if ( token.size() >= 5 )
+                    if ( token.at ( 0 ) =="SCF" && token.at ( 1 ) =="Done:" )
+                    {
+                        block.energy=ToDouble ( token.at ( 4 ) );
+                        block.level="SCF";
+                    }
+                break;
+            }
 
+            if ( line.find ( "before annihilation" ) != std::string_view::npos )
+            {
+                target.SetS2 ( ToDouble ( token.at ( 3 ) ) );
 
-                if ( token.at ( 0 ) =="RMS" && token.at ( 1 ) =="Displacement" )
-                {
-                    Molecules()->back().Frames().back().SetRMSDisplacement ( std::atof ( token.at ( 2 ).c_str() ) );
-                    if ( !bthreshold )
-                        threshold.rmsdisplacement = std::atof ( token.at ( 3 ).c_str() );
-                    bthreshold=true;
-                    bbreak=true;
+            }
+            if ( line.find ( "Forces (Hartrees/Bohr)" ) != std::string_view::npos ) GetForces ( reader,target );
 
-                }
+            if ( token.at ( 0 ) =="Maximum" && token.at ( 1 ) =="Force" )
+            {
+                target.SetMaximumForce ( ToDouble ( token.at ( 2 ) ) );
+                block.threshold.maxforce=ToDouble ( token.at ( 3 ) );
+                block.found|=FrameBlock::MAXFORCE;
+            }
 
+            if ( token.at ( 0 ) =="RMS" && token.at ( 1 ) =="Force" )
+            {
+                target.SetRMSForce ( ToDouble ( token.at ( 2 ) ) );
+                block.threshold.rmsforce=ToDouble ( token.at ( 3 ) );
+                block.found|=FrameBlock::RMSFORCE;
+            }
 
+            if ( token.at ( 0 ) =="Maximum" && token.at ( 1 ) =="Displacement" )
+            {
+                target.SetMaximumDisplacement ( ToDouble ( token.at ( 2 ) ) );
+                block.threshold.maxdisplacement=ToDouble ( token.at ( 3 ) );
+                block.found|=FrameBlock::MAXDISPLACEMENT;
             }
-            if ( bbreak ) break;
 
+            //the last criterion closes the block
+            if ( token.at ( 0 ) =="RMS" && token.at ( 1 ) =="Displacement" )
+            {
+                target.SetRMSDisplacement ( ToDouble ( token.at ( 2 ) ) );
+                block.threshold.rmsdisplacement=ToDouble ( token.at ( 3 ) );
+                block.found|=FrameBlock::RMSDISPLACEMENT;
+                break;
+            }
         }
+    }
 
+    const std::streamoff last=frame+1 < m_pos.size() ? end : -1;
+    GetDipole ( text,begin,last,target );
+    GetESPCharges ( text,begin,last,target );
+}
 
-        Molecules()->back().Frames().back().SetThreshold ( threshold );
 
-        if ( pt+1 != m_pos.end() )
-        {
-            GetDipole ( *pt,* ( pt+1 ) );
-            GetESPCharges ( *pt,* ( pt+1 ) );
-        }
-        else
+/** the coordinates of each frame begin three lines after the orientation header*/
+void GaussianFileParser::GetFramePositions ( section s, std::streamoff from, std::streamoff to )
+{
+    std::string line;
+    const std::vector<SectionIndex::Entry>& entries=Sections().Entries ( s );
+    for ( size_t i=Sections().First ( s,from );i<entries.size();++i )
+    {
+        if ( to >= 0 && entries[i].offset >= to ) break;
+        m_file->clear();
+        m_file->seekg ( entries[i].offset,std::ios::beg );
+        for ( int j=0;j<4;j++ )
         {
-            m_file->seekg ( 0,std::ios::end );
-            std::streampos end=m_file->tellg();
-            GetDipole ( *pt,end );
-            GetESPCharges ( *pt,end );
+            std::getline ( *m_file,line );
         }
+        //the header of a frame still being written is found again later
+        const std::streampos pos=m_file->tellg();
+        if ( pos < 0 ) break;
+        m_pos.push_back ( pos );
     }
-
-    Molecules()->back().SetBonds();
-
-    return true;
 }
 
-
 bool GaussianFileParser::ParseOrbitals(std::streampos pos)
 {
     m_file->clear();
@@ -348,30 +434,74 @@ bool GaussianFileParser::ParseOrbitals(std::streampos pos)
 
     m_beta = ExistAlphaBetaOrbitals();
 
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-    if (GetCoordinatesType())
+    //each step starts directly at its own section
+    if (SeekSection(BASISTYPE,pos) && GetCoordinatesType())
     {
-        m_file->clear();
-        m_file->seekg ( pos,std::ios::beg );
-        if (GetHomoLumo())
+        if (SeekSection(ELECTRONS,pos) && GetHomoLumo())
         {
-            m_file->clear();
-            m_file->seekg ( pos,std::ios::beg );
-            if (GetBasisCenters())
-            {
-                m_file->clear();
-                m_file->seekg ( pos,std::ios::beg );
-                if (m_beta)
-                    b = GetAlphaBetaOrbitalData();
-                else
-                    b = GetOrbitalData();
-            }
+            if (SeekSection(BASIS,pos) && GetBasisCenters())
+                b = FindOrbitals(pos);
         }
     }
     return b;
 }
 
+/** the orbitals printed after the header of a frame belong to it, the last ones if there are several. Their
+    coefficients are read when they are first used, by a parser of the file that keeps the basis set*/
+bool GaussianFileParser::FindOrbitals(std::streampos pos)
+{
+    std::vector<Frame>& frames=Molecules()->back().Frames();
+    if ( frames.empty() ) return false;
+
+    std::shared_ptr<Parser> reader=OrbitalReader();
+    const std::string_view text=Text();
+    size_t pt=0;
+    bool b=false;
+    for ( const SectionIndex::Entry& e : Sections().Entries(ORBITALS) )
+    {
+        if ( e.offset < pos ) continue;
+        //the beta orbitals are read with the alpha ones
+        const std::string_view header=text.substr(static_cast<size_t>(e.offset),text.find('\n',static_cast<size_t>(e.offset))-static_cast<size_t>(e.offset));
+        if ( m_beta && header.find("Beta Molecular Orbital Coefficients") != std::string_view::npos ) continue;
+
+        while ( pt+1 < m_pos.size() && pt+1 < frames.size() && e.offset >= m_pos.at(pt+1) ) ++pt;
+        if ( reader )
+            SetSectionLoader(frames[pt],reader,Frame::ORBITALS,e.offset);
+        else
+            LoadSection(frames[pt],Frame::ORBITALS,e.offset);
+        b=true;
+    }
+    return b;
+}
+
+std::shared_ptr<Parser> GaussianFileParser::OrbitalReader() const
+{
+    std::shared_ptr<GaussianFileParser> reader ( new GaussianFileParser ( static_cast<std::istream*> ( NULL ) ) );
+    if ( !reader->ShareText ( *this ) ) return std::shared_ptr<Parser>();
+    reader->m_beta=m_beta;
+    reader->m_typeD=m_typeD;
+    reader->m_typeF=m_typeF;
+    reader->m_homo=m_homo;
+    reader->m_lumo=m_lumo;
+    reader->m_norbitals=m_norbitals;
+    reader->m_atoms=m_atoms;
+    reader->m_orbitals=m_orbitals;
+    return reader;
+}
+
+void GaussianFileParser::LoadSection(Frame& frame, unsigned data, std::streamoff offset)
+{
+    if ( ( data & Frame::ORBITALS ) == 0 ) return;
+    m_file->clear();
+    m_file->seekg(offset,std::ios::beg);
+    std::string line;
+    std::getline(*m_file,line);
+    if ( m_beta )
+        GetAlphaBetaOrbitalData(line,frame);
+    else
+        GetOrbitalData(frame);
+}
+
 bool GaussianFileParser::GetBasisCenters()
 {
     std::string line;
@@ -469,224 +599,84 @@ bool GaussianFileParser::GetBasisCenters()
     return false;
 }
 
-bool GaussianFileParser::GetOrbitalData()
+bool GaussianFileParser::GetOrbitalData(Frame& frame)
 {
-    bool b =false;
-    int frame =0;
-    std::vector<Frame>::iterator ft = Molecules()->back().Frames().begin();
-    size_t pt=0;
-    std::string line;
-    while ( std::getline(*m_file,line) )
-    {
-        if ( line.find ( "Molecular Orbital Coefficients" ) != std::string::npos )
-        {
-            while (!(pt==m_pos.size()-1))
-            {
-                if ( (m_file->tellg()>m_pos.at(pt)) && (m_file->tellg()<m_pos.at(pt+1)) )
-                    break;
-                else
-                {
-                    ++pt;
-                    ++ft;
-                    frame+=1;
-                }
-            }
-
-            D2Array<float> matrix;
-            std::vector<float> eigenvalues;
-            std::vector<float> occupations;
-            matrix.Initialize(m_norbitals,m_norbitals,0.0);
-
-            std::getline( *m_file,line );
-            size_t K=0;
-            while ( (line.find("Density Matrix:") == std::string::npos ) && (line.find("Condensed to atoms (all electrons):") == std::string::npos ) )
-            {
-                StringTokenizer tokenSize ( line," " );
-                size_t M=tokenSize.size();
-
-                std::getline( *m_file,line );
-                //get the occupation
-                StringTokenizer ocstr(line," ");
-                for(StringTokenizer::const_iterator it=ocstr.begin();it!=ocstr.end();++it)
-                {
-                    if ( it->back() == 'O' )
-                    {
-                        occupations.push_back(2.0);
-                    }
-                    else {
-                        occupations.push_back(0.0);
-                    }
-
-                }
-                std::getline( *m_file,line );
-                StringTokenizer tokenEigenv ( line," " );
-                for (size_t e=0; e<M; e++)
-                {
-                    eigenvalues.push_back(atof(tokenEigenv.at(tokenEigenv.size()-M+e)));
-                }
-                for (size_t n=0; n<(size_t)m_norbitals; n++)
-                {
-                    std::getline( *m_file,line );
-                    StringTokenizer tokenCoeff ( line," " );
-                    for (size_t m=0; m<M; m++)
-                    {
-                        matrix(n,K+m) = atof(tokenCoeff.at(tokenCoeff.size()-M+m));
-                    }
-                }
-                K += M;
-                std::getline( *m_file,line );
-            }
-            std::vector<BasisCenter> basis;
-            for (size_t i=0; i<m_atoms.size(); ++i)
-                basis.push_back(BasisCenter(ft->XYZ().at(m_atoms.at(i)),m_orbitals.at(i)));
-            ft->OrbitalsData().SetHomo(m_homo);
-            ft->OrbitalsData().SetLumo(m_lumo);
-            ft->OrbitalsData().SetTypeD(m_typeD);
-            ft->OrbitalsData().SetTypeF(m_typeF);
-            ft->OrbitalsData().SetBasisCenters(basis);
-            ft->OrbitalsData().SetCoefficients(matrix);
-            ft->OrbitalsData().SetEigenvalues(eigenvalues);
-            ft->OrbitalsData().SetOccupations(occupations);
-            b = true;
-
-            ++pt;
-            ++ft;
-            frame+=1;
-        }
-    }
-    return b;
+    //the table is read in place from the text
+    const std::streamoff pos=m_file->tellg();
+    if ( pos < 0 ) return false;
+    LineReader reader ( Text(),static_cast<size_t> ( pos ) );
+    std::string_view line;
+    D2Array<float> matrix;
+    std::vector<float> eigenvalues;
+    std::vector<float> occupations;
+    matrix.Initialize(m_norbitals,m_norbitals,0.0);
+
+    reader.Next ( line );
+    ReadOrbitalTable ( reader,line,"Density Matrix:","Condensed to atoms (all electrons):",m_norbitals,matrix,eigenvalues,&occupations );
+    m_file->clear();
+    m_file->seekg ( reader.Offset(),std::ios::beg );
+
+    std::vector<BasisCenter> basis;
+    for (size_t i=0; i<m_atoms.size(); ++i)
+        basis.push_back(BasisCenter(frame.XYZ().at(m_atoms.at(i)),m_orbitals.at(i)));
+    frame.OrbitalsData().SetHomo(m_homo);
+    frame.OrbitalsData().SetLumo(m_lumo);
+    frame.OrbitalsData().SetTypeD(m_typeD);
+    frame.OrbitalsData().SetTypeF(m_typeF);
+    frame.OrbitalsData().SetBasisCenters(basis);
+    frame.OrbitalsData().SetCoefficients(matrix);
+    frame.OrbitalsData().SetEigenvalues(eigenvalues);
+    frame.OrbitalsData().SetOccupations(occupations);
+    return true;
 }
 
-bool GaussianFileParser::GetAlphaBetaOrbitalData()
+bool GaussianFileParser::GetAlphaBetaOrbitalData(const std::string& header, Frame& frame)
 {
-    bool b =false;
-    int frame =0;
-    std::vector<Frame>::iterator ft = Molecules()->back().Frames().begin();
-    size_t pt=0;
-    std::string line;
-    while ( std::getline(*m_file,line) )
+    D2Array<float> matrix;
+    D2Array<float> betamatrix;
+    std::vector<float> eigenvalues;
+    std::vector<float> betaeigenvalues;
+    matrix.Initialize(m_norbitals,m_norbitals,0.0);
+    betamatrix.Initialize(m_norbitals,m_norbitals,0.0);
+
+    const std::streamoff pos=m_file->tellg();
+    if ( pos < 0 ) return false;
+    if ( header.find ( "Alpha Molecular Orbital Coefficients:" ) != std::string::npos )
     {
-        if ( line.find ( "Molecular Orbital Coefficients" ) != std::string::npos )
-        {
-            while (!(pt==m_pos.size()-1))
-            {
-                if ( (m_file->tellg()>m_pos.at(pt)) && (m_file->tellg()<m_pos.at(pt+1)) )
-                    break;
-                else
-                {
-                    ++pt;
-                    ++ft;
-                    frame+=1;
-                }
-            }
-
-            D2Array<float> matrix;
-            D2Array<float> betamatrix;
-            std::vector<float> eigenvalues;
-            std::vector<float> betaeigenvalues;
-            matrix.Initialize(m_norbitals,m_norbitals,0.0);
-            betamatrix.Initialize(m_norbitals,m_norbitals,0.0);
-
-            if ( line.find ( "Alpha Molecular Orbital Coefficients:" ) != std::string::npos )
-            {
-                size_t K = 0;
-
-                std::getline( *m_file,line );
-                while((line.find("Beta Molecular Orbital Coefficients:")) == std::string::npos )
-                {
-                    StringTokenizer tokenSize ( line," " );
-                    size_t M=tokenSize.size();
-
-                    std::getline( *m_file,line );
-                    std::getline( *m_file,line );
-                    StringTokenizer tokenEigenv ( line," " );
-                    for (size_t e=0; e<M; e++)
-                    {
-                        eigenvalues.push_back(atof(tokenEigenv.at(tokenEigenv.size()-M+e)));
-                    }
-                    for (size_t n=0; n<(size_t)m_norbitals; n++)
-                    {
-                        std::getline( *m_file,line );
-                        StringTokenizer tokenCoeff ( line," " );
-                        for (size_t m=0; m<M; m++)
-                        {
-                            matrix(n,K+m) = atof(tokenCoeff.at(tokenCoeff.size()-M+m));
-                        }
-                    }
-                    K += M;
-                    std::getline( *m_file,line );
-                }
-
-                K = 0;
-                std::getline( *m_file,line );
-                while((line.find("Alpha Density Matrix:")) == std::string::npos )
-                {
-                    StringTokenizer tokenSize ( line," " );
-                    size_t M=tokenSize.size();
-
-                    std::getline( *m_file,line );
-                    std::getline( *m_file,line );
-                    StringTokenizer tokenEigenv ( line," " );
-                    for (size_t e=0; e<M; e++)
-                    {
-                        betaeigenvalues.push_back(atof(tokenEigenv.at(tokenEigenv.size()-M+e)));
-                    }
-                    for (size_t n=0; n<(size_t)m_norbitals; n++)
-                    {
-                        std::getline( *m_file,line );
-                        StringTokenizer tokenCoeff ( line," " );
-                        for (size_t m=0; m<M; m++)
-                        {
-                            betamatrix(n,K+m) = atof(tokenCoeff.at(tokenCoeff.size()-M+m));
-                        }
-                    }
-                    K += M;
-                    std::getline( *m_file,line );
-                }
-            }
-
-            std::vector<BasisCenter> basis;
-            for (size_t i=0; i<m_atoms.size(); ++i)
-                basis.push_back(BasisCenter(ft->XYZ().at(m_atoms.at(i)),m_orbitals.at(i)));
-            ft->OrbitalsData().SetHomo(m_homo);
-            ft->OrbitalsData().SetLumo(m_lumo);
-            ft->OrbitalsData().SetTypeD(m_typeD);
-            ft->OrbitalsData().SetTypeF(m_typeF);
-            ft->OrbitalsData().SetBasisCenters(basis);
-            ft->OrbitalsData().SetCoefficients(matrix);
-            ft->OrbitalsData().SetEigenvalues(eigenvalues);
-            ft->OrbitalsData().SetBetaCoefficients(betamatrix);
-            ft->OrbitalsData().SetBetaEigenvalues(betaeigenvalues);
-            b = true;
-            ++pt;
-            ++ft;
-            frame+=1;
-        }
+        //the alpha table ends with the header of the beta one
+        LineReader reader ( Text(),static_cast<size_t> ( pos ) );
+        std::string_view line;
+        reader.Next ( line );
+        ReadOrbitalTable ( reader,line,"Beta Molecular Orbital Coefficients:","",m_norbitals,matrix,eigenvalues,NULL );
+        reader.Next ( line );
+        ReadOrbitalTable ( reader,line,"Alpha Density Matrix:","",m_norbitals,betamatrix,betaeigenvalues,NULL );
+        m_file->clear();
+        m_file->seekg ( reader.Offset(),std::ios::beg );
     }
-    return b;
+
+    std::vector<BasisCenter> basis;
+    for (size_t i=0; i<m_atoms.size(); ++i)
+        basis.push_back(BasisCenter(frame.XYZ().at(m_atoms.at(i)),m_orbitals.at(i)));
+    frame.OrbitalsData().SetHomo(m_homo);
+    frame.OrbitalsData().SetLumo(m_lumo);
+    frame.OrbitalsData().SetTypeD(m_typeD);
+    frame.OrbitalsData().SetTypeF(m_typeF);
+    frame.OrbitalsData().SetBasisCenters(basis);
+    frame.OrbitalsData().SetCoefficients(matrix);
+    frame.OrbitalsData().SetEigenvalues(eigenvalues);
+    frame.OrbitalsData().SetBetaCoefficients(betamatrix);
+    frame.OrbitalsData().SetBetaEigenvalues(betaeigenvalues);
+    return true;
 }
 
 bool GaussianFileParser::ExistOrbitals()
 {
-    std::string line;
-    while ( std::getline ( *m_file,line ))
-    {
-        if ( line.find("Molecular Orbital Coefficients") != std::string::npos )
-            return true;
-    }
-    return false;
+    return Sections().Find(ORBITALS,m_file->tellg()) >= 0;
 }
 
 bool GaussianFileParser::ExistAlphaBetaOrbitals()
 {
-    std::string line;
-    bool bfound = false;
-    while (( std::getline ( *m_file,line ) && !(bfound)))
-    {
-        if ( line.find("Alpha Orbitals:") != std::string::npos )
-            bfound = true;
-    }
-    return bfound;
+    return Sections().Find(ALPHABETA,m_file->tellg()) >= 0;
 }
 
 
@@ -837,56 +827,47 @@ void GaussianFileParser::GetTransitionChanges()
 }
 
 
-bool GaussianFileParser::GetESPCharges ( const std::streampos& begin, const std::streampos& end )
+bool GaussianFileParser::GetESPCharges ( std::string_view text, std::streamoff begin, std::streamoff end, Frame& frame )
 {
-    m_file->clear ( );
-    m_file->seekg ( begin, std::ios::beg );   // moves pointer to
-
-    std::string line;
-    std::streampos pos=0;
-    while ( std::getline ( *m_file,line ) )
+    const std::streamoff offset=Sections().Find ( ESPCHARGES,begin,end );
+    if ( offset < 0 ) return false;
+
+    std::string_view line;
+    LineReader reader ( text,offset );
+    reader.Skip ( 3 );
+    std::vector<double>& charges=*frame.Charges ( Frame::ESP );
+    charges.reserve ( frame.ParentMolecule()->Atoms().size() );
+    while ( reader.Next ( line ) )
     {
-        if ( line.find ( "Charges from ESP fit" ) != std::string::npos )
-            break;
-    }
-    pos=m_file->tellg();
-
-    if ( pos <= 0 ) return false;
-    if ( end > 0 && pos > end ) return false;
-
-    Molecules()->back().Frames().back().Charges (Frame::ESP)->reserve ( Molecules()->back().Atoms().size() );
-    std::getline ( *m_file,line );
-    std::getline ( *m_file,line );
-    while ( std::getline ( *m_file,line ) )
-    {
-        StringTokenizer tok ( line );
+        Tokens tok ( line );
         if ( tok.size() >= 3 )
         {
-            Molecules()->back().Frames().back().Charges ( Frame::ESP )->push_back ( std::atof ( tok.at ( 2 ).c_str() ) );
+            charges.push_back ( ToDouble ( tok.at ( 2 ) ) );
         }
-        if ( line.find ( "--" ) != std::string::npos ) break;
+        if ( line.find ( "--" ) != std::string_view::npos ) break;
     }
     return true;
 }
 
 
-void GaussianFileParser::GetForces ( Molecule& molecule )
+void GaussianFileParser::GetForces ( LineReader& reader, Frame& frame )
 {
-    std::string line;
-    molecule.Frames().back().Gradient().reserve(molecule.Atoms().size());
-    for ( int i=0;i<2;i++ ) std::getline ( *m_file,line );
-    while ( std::getline ( *m_file,line ) )
+    static const Delimiters separators ( " \t\r" );
+    std::string_view line;
+    frame.Gradient().reserve ( frame.ParentMolecule()->Atoms().size() );
+    reader.Skip ( 2 );
+    while ( reader.Next ( line ) )
     {
-        if ( line.find ( "---" ) !=std::string::npos )
+        if ( line.find ( "---" ) != std::string_view::npos )
         {
             return;
         }
-        StringTokenizer token ( line," \t\r" );
+        Tokens token ( line,separators );
         Coordinate c;
-        c.x()=std::atof ( token.at ( 2 ).c_str() );
-        c.y()=std::atof ( token.at ( 3 ).c_str() );
-        c.z()=std::atof ( token.at ( 3 ).c_str() );
-        molecule.Frames().back().Gradient().push_back(c);
+        c.x()=ToDouble ( token.at ( 2 ) );
+        c.y()=ToDouble ( token.at ( 3 ) );
+        c.z()=ToDouble ( token.at ( 4 ) );
+        frame.Gradient().push_back ( c );
     }
 
 
@@ -896,13 +877,8 @@ void GaussianFileParser::GetForces ( Molecule& molecule )
 
 GaussianFileParser::gaussversion GaussianFileParser::GetVersion()
 {
-    std::string line;
-
-    while(std::getline(*m_file,line))
-    {
-        if ( line.find("Gaussian 09:") != std::string::npos )
-            return  GAUSSIAN09;
-    }
+    if ( Sections().Find(VERSION,m_file->tellg()) >= 0 )
+        return  GAUSSIAN09;
     return UNDEFINED;
 
 }
@@ -973,59 +949,72 @@ bool GaussianFileParser::HasKeyword ( std::string& line )
 }
 
 
+/** every job of the file writes its own termination after its route*/
+bool GaussianFileParser::IsRunning()
+{
+    return !LastJobWrites ( { "Normal termination of Gaussian","Error termination" } );
+}
+
 std::vector<JobHeader>& GaussianFileParser::Jobs()
 {
     //lets get the lines beginning with a #
     std::string line;
-    m_file->clear();
-    m_file->seekg(0);
-    std::streampos pos=m_file->tellg();
-    std::getline ( *m_file,line );
-    do
+    const SectionIndex& index=Sections();
+    const std::vector<SectionIndex::Entry>& routes=index.Entries ( ROUTE );
+    const std::vector<SectionIndex::Entry>& archives=index.Entries ( ARCHIVEHEAD );
+    std::vector<SectionIndex::Entry>::const_iterator at=archives.begin();
+    //lines before skip have already been read
+    std::streamoff skip=0;
+    for ( std::vector<SectionIndex::Entry>::const_iterator rt=routes.begin();rt!=routes.end();++rt )
     {
         //it could be that by chance a # line is inside the arquive entry, so do this little hack
         // to avoid this
-        if ( line.find ( "1\\1\\",0 ) == 1 || line.find ( "1|1|",0 ) == 1 )
+        for ( ;at!=archives.end() && at->offset < rt->offset;++at )
         {
+            if ( at->offset < skip ) continue;
+            m_file->clear();
+            m_file->seekg ( at->offset,std::ios::beg );
             std::getline ( *m_file,line );
             std::getline ( *m_file,line );
             std::getline ( *m_file,line );
+            skip=m_file->tellg();
         }
-        if ( line.find ( " #",0 ) == 0 ) //#should be the second character and not -#-
-        {
-
-            std::string wholeline;
-            //take into account that route can be splitted into several lines
-            while ( line.find ( "-----" ) == std::string::npos )
-            {
-                //trim left whitespace
-                line.erase( line.begin(), std::find_if( line.begin(), line.end(),
-                                                        std::not1( std::ptr_fun( &::isspace ) ) ) );
-                wholeline+=line;
-                std::getline ( *m_file,line );
-                //line.erase ( 0,1 );
+        if ( rt->offset < skip ) continue;
 
-            }
-            //delete return carriage
-            std::string::size_type sit=0;
-            while ( sit != std::string::npos )
-            {
-                sit=wholeline.find_first_of ( "\n\r",sit );
-                if ( sit != std::string::npos )
-                    wholeline.erase ( sit,1 );
-            }
+        std::streampos pos=rt->offset;
+        m_file->clear();
+        m_file->seekg ( pos,std::ios::beg );
+        std::getline ( *m_file,line );
+        std::string wholeline;
+        //take into account that route can be splitted into several lines
+        while ( line.find ( "-----" ) == std::string::npos )
+        {
+            //trim left whitespace
+            line.erase( line.begin(), std::find_if( line.begin(), line.end(),
+                                                    std::not1( std::ptr_fun( &::isspace ) ) ) );
+            wholeline+=line;
+            std::getline ( *m_file,line );
+            //line.erase ( 0,1 );
 
-            std::cout << "route=" << wholeline << std::endl;
-            JobType tjob=GetJobFromRoute(wholeline);
-            m_jobpos.push_back ( JobHeader( tjob,pos ) );
-            do
-            {
-                std::getline(*m_file,line);
-            } while ( line.find ( "-----" ) == std::string::npos );
         }
-        pos=m_file->tellg();
+        //delete return carriage
+        std::string::size_type sit=0;
+        while ( sit != std::string::npos )
+        {
+            sit=wholeline.find_first_of ( "\n\r",sit );
+            if ( sit != std::string::npos )
+                wholeline.erase ( sit,1 );
+        }
+
+        std::cout << "route=" << wholeline << std::endl;
+        JobType tjob=GetJobFromRoute(wholeline);
+        m_jobpos.push_back ( JobHeader( tjob,pos ) );
+        do
+        {
+            std::getline(*m_file,line);
+        } while ( line.find ( "-----" ) == std::string::npos );
+        skip=m_file->tellg();
     }
-    while ( std::getline ( *m_file,line ) );
 
     return m_jobpos;
 }
@@ -1070,29 +1059,13 @@ JobType GaussianFileParser::GetJobFromRoute(const std::string& route)
 }
 bool GaussianFileParser::ParseFrequencies ( std::streampos pos )
 {
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-    if ( !GetFrequencies() ) return false;
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-    //Ok lets get the vectors;
-    scounter=0;
-    std::string line;
-    Molecule& molecule=Molecules()->back();
-    molecule.Frames().back().AllocateVectors();
-    while ( std::getline ( *m_file,line ) )
-    {
-        StringTokenizer token ( line," " );
-        if ( token.size() >=2 )
-            if ( token.at ( 0 ) =="Atom" && token.at ( 1 ) =="AN" )
-            {
-                GetVectors();
-            }
-    }
+    //the frequencies and the normal modes follow the header of the section
+    std::streamoff start=Sections().Find ( FREQUENCIES,pos );
+    if ( start < 0 ) start=pos;
+    if ( !GetFrequencies ( static_cast<size_t> ( start ) ) ) return false;
     if ( !ParseArquive ( pos ) ) std::cerr << "No arquive entry found for frequency computation" << std::endl;
 
-    std::vector<Frequency> v = Molecules()->back().Frames().back().GetFrequencies();
-    qDebug() << "LIST FREQUENCIES in ParseFrequencies: " << v.size() << endl;
+    qDebug() << "LIST FREQUENCIES in ParseFrequencies: " << Molecules()->back().Frames().back().GetFrequencies().size() << endl;
 
     return true;
 }
@@ -1103,29 +1076,16 @@ bool GaussianFileParser::ParseArquive ( std::streampos pos )
 
     std::string archive;
     std::string line;
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-    std::streampos arpos;
     Molecule& molecule=Molecules()->back();
-    while ( std::getline ( *m_file,line ) )
-    {
-        if ( ( line.find ( "1\\1\\" ) != std::string::npos ) || ( line.find ( "1|1|" ) !=  std::string::npos ) ) break;
-        arpos=m_file->tellg();
-    }
-    //windows
-    m_file->seekg ( arpos,std::ios::beg );
+    if ( !SeekSection ( ARCHIVE,pos ) ) return false;
 
+    //the archive without blanks, up to its end in \\@ or |@, the lines after it belong to the next job
     while ( std::getline ( *m_file,line ) )
     {
+        line.erase ( std::remove_if ( line.begin(),line.end(),[] ( char c ) { return c == ' ' || c == '\t' || c == '\r'; } ),line.end() );
         archive+=line;
-    }
-    //OK lets clear bakspaces
-    std::string::size_type sit=0;
-    while ( sit != std::string::npos )
-    {
-        sit=archive.find_first_of ( " \n\t\r",sit );
-        if ( sit != std::string::npos )
-            archive.erase ( sit,1 );
+        const size_t n=archive.size();
+        if ( n > 1 && archive[n-1] == '@' && ( archive[n-2] == '\\' || archive[n-2] == '|' ) ) break;
     }
 
     TokByString t ( archive,"\\\\" );
@@ -1201,13 +1161,16 @@ bool GaussianFileParser::ParseArquive ( std::streampos pos )
 
 bool GaussianFileParser::ParseUV ( std::streampos pos )
 {
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
     std::string line;
     Molecule& molecule=Molecules()->back();
     std::vector<Spectralline>& lines=molecule.Frames().back().GetSpectralLines();
-    while ( std::getline ( *m_file,line ) )
+    const SectionIndex& index=Sections();
+    const std::vector<SectionIndex::Entry>& states=index.Entries ( EXCITEDSTATE );
+    for ( size_t i=index.First ( EXCITEDSTATE,pos );i<states.size();++i )
     {
+        m_file->clear();
+        m_file->seekg ( states[i].offset,std::ios::beg );
+        std::getline ( *m_file,line );
         StringTokenizer token ( line," =\t" );
         size_t size=token.size();
         if ( size > 2 )
@@ -1230,6 +1193,8 @@ bool GaussianFileParser::ParseUV ( std::streampos pos )
     std::streampos lastpos=m_file->tellg();
     std::vector<std::streampos> positions;
     bool oldversion = false;
+    //newer versions do not print the tensors, skip the search
+    if ( index.Find ( OLDRVELOCITY,pos ) < 0 ) m_file->setstate ( std::ios::eofbit );
     while(std::getline(*m_file,line) )
     {
         positions.push_back(m_file->tellg() );
@@ -1251,11 +1216,12 @@ bool GaussianFileParser::ParseUV ( std::streampos pos )
     }
     if (!(oldversion))
     {
-        m_file->clear();
-        m_file->seekg ( pos,std::ios::beg );
-
-        while ( std::getline ( *m_file,line ) )
+        const std::vector<SectionIndex::Entry>& headers=index.Entries ( RVELOCITY );
+        for ( size_t i=index.First ( RVELOCITY,pos );i<headers.size();++i )
         {
+            m_file->clear();
+            m_file->seekg ( headers[i].offset,std::ios::beg );
+            std::getline ( *m_file,line );
             StringTokenizer token ( line );
             size_t size=token.size();
             if ( size >= 5 )
@@ -1275,11 +1241,12 @@ bool GaussianFileParser::ParseUV ( std::streampos pos )
         }
     }
     //Get Now Rotatory Strengths
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-
-    while ( std::getline ( *m_file,line ) )
+    const std::vector<SectionIndex::Entry>& headers=index.Entries ( RLENGTH );
+    for ( size_t i=index.First ( RLENGTH,pos );i<headers.size();++i )
     {
+        m_file->clear();
+        m_file->seekg ( headers[i].offset,std::ios::beg );
+        std::getline ( *m_file,line );
         StringTokenizer token ( line );
         size_t size=token.size();
         if ( size >= 5 )
@@ -1299,8 +1266,7 @@ bool GaussianFileParser::ParseUV ( std::streampos pos )
     }
     GetTransitionVectors(pos);
 
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
+    SeekSection ( EXCITEDSTATE,pos );
 
     GetTransitionChanges();
 
@@ -1311,8 +1277,7 @@ void GaussianFileParser::GetTransitionVectors(std::streampos pos)
 {
     Molecule& molecule=Molecules()->back();
     std::vector<Spectralline>& lines=molecule.Frames().back().GetSpectralLines();
-    m_file->clear();
-    m_file->seekg(pos,std::ios::beg);
+    SeekSection(TRANSITIONDIPOLE,pos);
     std::string line;
     while ( std::getline(*m_file,line))
     {
@@ -1353,90 +1318,65 @@ void GaussianFileParser::GetTransitionVectors(std::streampos pos)
     return;
 }
 
-bool GaussianFileParser::GetVectors()
+bool GaussianFileParser::GetFrequencies ( size_t offset )
 {
-    int counter=0;
-    std::string line;
-
-    //OK put vectors onto last molecule
     Molecule& molecule=Molecules()->back();
-
-    while ( std::getline ( *m_file,line ) )
+    Frame& frame=molecule.Frames().back();
+    std::vector<Frequency>& frequencies=frame.GetFrequencies();
+    frame.AllocateVectors();
+    NormalModes& modes=molecule.Modes();
+
+    //blocks of up to five modes, each one with the Frequencies, IR Inten and Rot. str. lines, among others, and
+    //the displacements of the atoms after the Atom AN header. The blocks of high precision modes (freq=HPModes),
+    //whose labels are followed by ---, are skipped
+    LineReader reader ( Text(),offset );
+    std::string_view line;
+    Tokens token;
+    size_t first=0;
+    size_t nintensities=0;
+    size_t nrotatory=0;
+    while ( reader.Next ( line ) )
     {
-        StringTokenizer token ( line," " );;
+        if ( line.find ( "- Thermochemistry -" ) != std::string_view::npos ) break;
+        token.Assign ( line );
+        if ( token.size() < 3 ) continue;
 
-        if ( token.size() <5 )
+        if ( token[0] == "Frequencies" && token[1] == "--" )
         {
-            scounter+=3;
-            return true;
+            first=frequencies.size();
+            for ( size_t j=2;j<token.size();++j )
+                frequencies.push_back ( Frequency ( ToDouble ( token[j] ),0.0f ) );
         }
-        else
+        else if ( token[0] == "IR" && token[2] == "--" )
         {
-            int nfreq= ( token.size()-2 ) /3;
-
-            std::vector< std::vector<Coordinate> >& coordinates = molecule.GetMode();
-
-            for ( int i=0;i<nfreq;i++ )
-            {
-                coordinates.at(i+scounter).at(counter).x() = std::atof ( token[2+3*i].c_str() );
-                coordinates.at(i+scounter).at(counter).y() = std::atof ( token[2+3*i+1].c_str() );
-                coordinates.at(i+scounter).at(counter).z() = std::atof ( token[2+3*i+2].c_str() );
-
-            }
-            counter++;
+            for ( size_t k=3;k<token.size() && nintensities<frequencies.size();++k )
+                frequencies[nintensities++].y=ToDouble ( token[k] );
         }
-    }
-
-    return true;
-
-}
-bool GaussianFileParser::GetFrequencies()
-{
-    Molecule& molecule=Molecules()->back();
-
-    std::vector<Frequency>& frequencies=molecule.Frames().back().GetFrequencies();
-
-    std::string line;
-
-    size_t counter=0;
-    size_t counter1=0;
-    size_t counter2=0;
-    while ( std::getline ( *m_file,line ) )
-    {
-        StringTokenizer tok ( line );
-        if ( tok.size() )
+        else if ( token[0] == "Rot." && token[2] == "--" )
         {
-            int steps=0;
-            if ( tok[0]=="Frequencies" )
-            {
-
-                for ( size_t j=2;j<tok.size();j++ )
-                {
-                    frequencies.push_back ( Frequency ( std::atof ( tok[j].c_str() ),0.0f ) );
-                    counter++;
-                }
-
-            }
-
-            if ( tok[0]=="IR" )
-            {
-                for ( size_t k=3;k<tok.size();k++ )
-                {
-                    frequencies[counter1++].y=std::atof ( tok[k].c_str() );
-                    steps++;
-                }
-            }
-            if ( tok[0]=="Rot." )
+            for ( size_t k=3;k<token.size() && nrotatory<frequencies.size();++k )
+                frequencies[nrotatory++].z=ToDouble ( token[k] );
+        }
+        else if ( token[0] == "Atom" && token[1] == "AN" )
+        {
+            //one line for each atom: number, atomic number and x, y, z for every mode of the block
+            const size_t nblock=frequencies.size()-first;
+            if ( first+nblock > modes.Size() ) modes.Resize ( first+nblock );
+            for ( size_t atom=0;atom<modes.NAtoms() && reader.Next ( line );++atom )
             {
-                for ( size_t k=3;k<tok.size();k++ )
+                token.Assign ( line );
+                if ( token.size() < 2+3*nblock ) break;
+                for ( size_t i=0;i<nblock;++i )
                 {
-                    frequencies[counter2++].z=std::atof ( tok[k].c_str() );
+                    modes ( first+i,3*atom ) =ToDouble ( token[2+3*i] );
+                    modes ( first+i,3*atom+1 ) =ToDouble ( token[3+3*i] );
+                    modes ( first+i,3*atom+2 ) =ToDouble ( token[4+3*i] );
                 }
-
             }
-
         }
     }
+    //linear molecules have one mode less than allocated
+    modes.Resize ( frequencies.size() );
 
     qDebug() << "LIST FREQUENCIES in GetFrequencies: " << frequencies.size() << endl;
 
@@ -1449,8 +1389,7 @@ void GaussianFileParser::ParseChemicalShifts()
 {
 
     const char* locale=std::setlocale(LC_NUMERIC,"C");
-    m_file->clear();
-    m_file->seekg(0,std::ios::beg);
+    SeekSection(SHIELDING,0);
 
     Frame& frame=Molecules()->back().CurrentFrame();
     std::string line;
@@ -1493,8 +1432,7 @@ void GaussianFileParser::ParseCouplingConstants(std::vector<QuantumCoupling>& c)
 {
     const char* locale=std::setlocale(LC_NUMERIC,"C");
     std::string line;
-    m_file->clear();
-    m_file->seekg(0);
+    SeekSection(COUPLINGS,0);
     while(std::getline(*m_file,line) )
     {
         if ( line.find("Total nuclear spin-spin coupling J") != std::string::npos )
@@ -1548,8 +1486,7 @@ bool GaussianFileParser::ExtractJBlock(std::vector<QuantumCoupling>& c)
 kryomol::D2Array<double> GaussianFileParser::ParseMagneticSusceptibility()
 {
     const char* locale=std::setlocale(LC_NUMERIC,"C");
-    m_file->clear();
-    m_file->seekg(0,std::ios::beg);
+    SeekSection(SUSCEPTIBILITY,0);
 
     std::string line;
     kryomol::D2Array<double> t;
@@ -1582,45 +1519,35 @@ kryomol::D2Array<double> GaussianFileParser::ParseMagneticSusceptibility()
 }
 
 
-bool GaussianFileParser::GetDipole ( const std::streampos& begin, const std::streampos& end )
+bool GaussianFileParser::GetDipole ( std::string_view text, std::streamoff begin, std::streamoff end, Frame& frame )
 {
-    m_file->clear ( );               //
-    m_file->seekg ( begin, std::ios::beg );   // moves pointer to
-
-    std::string line;
-    std::streampos pos=0;
-    while ( std::getline ( *m_file,line ) )
+    std::string_view line;
+    LineReader reader ( text );
+    bool found=false;
+    const std::vector<SectionIndex::Entry>& entries=Sections().Entries ( DIPOLE );
+    for ( size_t i=Sections().First ( DIPOLE,begin );i<entries.size();++i )
     {
-        StringTokenizer token ( line );
-        if ( token.size() )
+        if ( end >= 0 && entries[i].offset >= end ) return false;
+        reader.Seek ( entries[i].offset );
+        reader.Next ( line );
+        Tokens token ( line );
+        if ( token.size() >= 2 && token[0]=="Dipole" && token[1]=="moment" )
         {
-            if ( token[0]=="Dipole" && token[1]=="moment" )
-            {
-                pos=m_file->tellg();
-                goto lb1;
-            }
+            found=true;
+            break;
         }
     }
 
-lb1:
-
-    if ( pos <= 0 ) return false;
-    if ( end > 0 && pos > end ) return false;
-
+    if ( !found || !reader.Next ( line ) ) return false;
 
-    m_file->clear ( );               //
-
-    m_file->seekg ( pos, std::ios::beg );   // moves pointer to
-
-    std::getline ( *m_file,line );
-    StringTokenizer token ( line );
+    Tokens token ( line );
     if ( token.size() < 6 ) return false; //simply return on error
     //change from physicist to chemist convention
     Coordinate c;
-    c.x()=-std::atof ( token[1].c_str() );
-    c.y()=-std::atof ( token[3].c_str() );
-    c.z()=-std::atof ( token[5].c_str() );
-    Molecules()->back().Frames().back().SetDipole(c);
+    c.x()=-ToDouble ( token[1] );
+    c.y()=-ToDouble ( token[3] );
+    c.z()=-ToDouble ( token[5] );
+    frame.SetDipole(c);
 
     return true;
 
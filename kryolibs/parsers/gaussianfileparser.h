@@ -14,6 +14,7 @@ the Free Software Foundation version 2 of the License.
 
 
 #include <fstream>
+#include <memory>
 #include <vector>
 
 #include "parser.h"
@@ -30,6 +31,8 @@ Parser implements methods for retrieving:
 */
 namespace kryomol
 {
+class LineReader;
+
 class KRYOMOLPARSERS_API GaussianFileParser : public Parser
 {
 public:
@@ -42,26 +45,50 @@ public:
   virtual bool ParseFrequencies( std::streampos pos=0);
   /** Store the position of different jobs in a gaussian output*/
   std::vector<JobHeader>& Jobs();
+  bool IsRunning();
   void ParseChemicalShifts();
   void ParseCouplingConstants(std::vector<QuantumCoupling>& c);
   D2Array<double> ParseMagneticSusceptibility();
+protected:
+  void DefineSections(SectionIndex& index);
+  void ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& block);
+  size_t FrameCount() const { return m_pos.size(); }
+  void FindAppendedFrames();
+  void FinishFrames(Molecule& molecule, const std::vector<FrameBlock>& blocks, size_t first);
+  void LoadSection(Frame& frame, unsigned data, std::streamoff offset);
 private:
+  /** sections recorded in the index of the file*/
+  enum section { ROUTE, ARCHIVEHEAD, ARCHIVE, JOBSEPARATOR, STANDARDORIENTATION, INPUTORIENTATION, ZMATRIXORIENTATION,
+                 STATIONARYPOINT, SCAN, VERSION, DIPOLE, ESPCHARGES, BASISTYPE, ELECTRONS, BASIS, ORBITALS, ALPHABETA,
+                 FREQUENCIES, EXCITEDSTATE, TRANSITIONDIPOLE, OLDRVELOCITY, RVELOCITY, RLENGTH, SHIELDING, COUPLINGS,
+                 SUSCEPTIBILITY };
   bool ParseOrbitals(std::streampos pos);
+  /** give the frames of the current job from @param pos on their orbitals, read on first use if possible*/
+  bool FindOrbitals(std::streampos pos);
+  /** @return a parser with the basis set of this one that reads the orbitals of the frames, sharing the text
+      of the file with this one (@see ShareText), NULL if the parser does not read a mapped file*/
+  std::shared_ptr<Parser> OrbitalReader() const;
+  void GetFramePositions(section s, std::streamoff from, std::streamoff to);
+  /** @return the position where the frames of section @param s of the current job end*/
+  std::streamoff FramesEnd(section s);
   bool HasKeyword(std::string& line);
   bool GetGeometry();
   bool ParseArquive(std::streampos pos=0);
-  bool GetVectors();
   void GetTransitionVectors(std::streampos pos);
   JobType GetJobFromRoute(const std::string& route);
-  bool GetFrequencies();
+  /** read the frequencies, intensities and normal modes in a single pass from @param offset of the text*/
+  bool GetFrequencies(size_t offset);
   bool ExtractJBlock(std::vector<QuantumCoupling>& c);
-  void GetForces(Molecule& molecule);
-  bool GetDipole(const std::streampos& begin,const std::streampos& end);
-  bool GetESPCharges(const std::streampos& begin, const std::streampos& end);
+  void GetForces(LineReader& reader, Frame& frame);
+  /** the dipole and the ESP charges of @param frame between @param begin and @param end (till the end if negative)*/
+  bool GetDipole(std::string_view text, std::streamoff begin, std::streamoff end, Frame& frame);
+  bool GetESPCharges(std::string_view text, std::streamoff begin, std::streamoff end, Frame& frame);
   bool ExistOrbitals();
   bool ExistAlphaBetaOrbitals();
-  bool GetOrbitalData();
-  bool GetAlphaBetaOrbitalData();
+  /** read the orbitals that follow the header line just read into @param frame*/
+  bool GetOrbitalData(Frame& frame);
+  /** read the alpha and beta orbitals that follow the line @param header just read into @param frame*/
+  bool GetAlphaBetaOrbitalData(const std::string& header, Frame& frame);
   bool GetBasisCenters();
   bool GetCoordinatesType();
   bool GetHomoLumo();
@@ -72,7 +99,6 @@ private:
 
 private:
   bool m_beta;
-  int scounter;
   int m_typeD;
   int m_typeF;
   int m_homo;
@@ -80,6 +106,12 @@ private:
   int m_norbitals;
   gaussversion m_version;
   std::vector<std::streampos> m_pos;
+  /** beginning of the job parsed and section of its frames, kept to follow the job*/
+  std::streamoff m_jobbegin;
+  section m_framesection;
+  /** convergence criteria of the frames, complete once the RMS displacement was read*/
+  Threshold m_threshold;
+  bool m_bthreshold;
   std::vector<size_t> m_atoms;
   std::vector< std::vector<Orbital> > m_orbitals;
 
@@ -0,0 +1,148 @@
+/*****************************************************************************************
+                            indexedframes.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include "indexedframes.h"
+#include "frame.h"
+#include "linereader.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** @return true if there is something else than blanks in @param text from @param offset on*/
+    bool HasText ( std::string_view text, size_t offset )
+    {
+        return offset < text.size() && text.find_first_not_of ( " \t\r\n",offset ) != std::string_view::npos;
+    }
+
+    /** @return true if @param token is the counts line of a MDL V2000 structure: 11 numbers or "V2000" last*/
+    bool IsCountsLine ( const Tokens& token )
+    {
+        return token.size() == 11 || ( !token.empty() && token[token.size()-1] == "V2000" );
+    }
+
+    /** read @param n atom lines of @param reader, the symbol followed by the coordinates in XYZ files and the
+        coordinates followed by the symbol in MDL files*/
+    bool ReadAtoms ( LineReader& reader, size_t n, IndexedFrames::Format format, std::vector<Coordinate>& xyz,
+                     std::vector<Atom>* atoms )
+    {
+        const size_t c= ( format == IndexedFrames::XYZ ) ? 1 : 0;
+        const size_t s= ( format == IndexedFrames::XYZ ) ? 0 : 3;
+        xyz.resize ( n );
+        if ( atoms != NULL )
+        {
+            atoms->clear();
+            atoms->reserve ( n );
+        }
+        std::string_view line;
+        for ( size_t i=0;i<n;++i )
+        {
+            if ( !reader.Next ( line ) ) return false;
+            Tokens token ( line );
+            if ( token.size() < 4 ) return false;
+            xyz[i].x() =ToDouble ( token[c] );
+            xyz[i].y() =ToDouble ( token[c+1] );
+            xyz[i].z() =ToDouble ( token[c+2] );
+            if ( atoms != NULL ) atoms->push_back ( Atom ( std::string ( token[s] ) ) );
+        }
+        return true;
+    }
+}
+
+IndexedFrames::IndexedFrames ( const QString& path, Format format, const std::vector<size_t>& offsets, size_t natoms ) :
+    m_stream ( path ), m_format ( format ), m_offsets ( offsets ), m_natoms ( natoms )
+{}
+
+bool IndexedFrames::Read ( size_t i, Frame& frame )
+{
+    for ( std::list<std::pair<size_t,std::vector<Coordinate> > >::iterator it=m_cache.begin();it!=m_cache.end();++it )
+    {
+        if ( it->first == i )
+        {
+            m_cache.splice ( m_cache.begin(),m_cache,it );
+            frame.XYZ() =it->second;
+            return true;
+        }
+    }
+
+    std::vector<Coordinate> xyz;
+    if ( i >= m_offsets.size() || !Decode ( m_stream.Text(),m_offsets[i],m_format,xyz ) ) return false;
+    if ( xyz.size() != m_natoms ) return false;
+    frame.XYZ() =xyz;
+    m_cache.push_front ( std::make_pair ( i,std::vector<Coordinate>() ) );
+    m_cache.front().second.swap ( xyz );
+    if ( m_cache.size() > CACHESIZE ) m_cache.pop_back();
+    return true;
+}
+
+std::vector<size_t> IndexedFrames::Index ( std::string_view text, Format format, size_t from /*=0*/ )
+{
+    std::vector<size_t> offsets;
+    if ( format == MDLV2000 )
+    {
+        //every record but the last one ends with a $$$$ line
+        if ( HasText ( text,from ) ) offsets.push_back ( from );
+        size_t pos=from;
+        while ( ( pos=text.find ( "$$$$",pos ) ) != std::string_view::npos )
+        {
+            const bool linestart= ( pos == 0 || text[pos-1] == '\n' );
+            const size_t nl=text.find ( '\n',pos );
+            if ( nl == std::string_view::npos ) break;
+            pos=nl+1;
+            if ( linestart && HasText ( text,pos ) ) offsets.push_back ( pos );
+        }
+        return offsets;
+    }
+
+    //the atom count, a comment line and the atoms. A truncated structure at the end is left out
+    LineReader reader ( text,from );
+    std::string_view line;
+    while ( true )
+    {
+        const size_t offset=reader.Offset();
+        if ( !reader.Next ( line ) ) break;
+        Tokens token ( line );
+        if ( token.empty() ) continue;
+        int natoms;
+        if ( token.size() != 1 || !ToInt ( token[0],natoms ) || natoms < 1 ) break;
+        if ( !reader.Skip ( static_cast<size_t> ( natoms ) +1 ) ) break;
+        offsets.push_back ( offset );
+    }
+    return offsets;
+}
+
+bool IndexedFrames::Decode ( std::string_view text, size_t offset, Format format, std::vector<Coordinate>& xyz,
+                             std::vector<Atom>* atoms /*=NULL*/ )
+{
+    LineReader reader ( text,offset );
+    std::string_view line;
+    int natoms=0;
+    if ( format == XYZ )
+    {
+        if ( !reader.Next ( line ) || !ToInt ( line,natoms ) || natoms < 1 || !reader.Skip() ) return false;
+        return ReadAtoms ( reader,static_cast<size_t> ( natoms ),format,xyz,atoms );
+    }
+
+    //the counts line follows the name of the molecule and, in well formed files, two more header lines
+    reader.Skip();
+    while ( true )
+    {
+        if ( !reader.Next ( line ) || line.compare ( 0,4,"$$$$" ) == 0 ) return false;
+        Tokens token ( line );
+        if ( IsCountsLine ( token ) )
+        {
+            natoms=ToInt ( token[0] );
+            break;
+        }
+    }
+    if ( natoms < 1 ) return false;
+    return ReadAtoms ( reader,static_cast<size_t> ( natoms ),format,xyz,atoms );
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************************
+                            indexedframes.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef INDEXEDFRAMES_H
+#define INDEXEDFRAMES_H
+
+#include <list>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <QString>
+
+#include "parsersexport.h"
+#include "framesource.h"
+#include "mappedfile.h"
+#include "coordinate.h"
+#include "atom.h"
+
+namespace kryomol
+{
+  /** @brief the structures of a multi-structure XYZ or MDL (SDF) file, read on demand
+
+  A single pass over the text finds where every structure begins, from the atom count heading each XYZ
+  structure or the $$$$ line closing each SDF record. A structure is decoded from the mapped file when it is
+  selected, and the last ones decoded are cached, so going back and forth through the frames does not parse
+  them again. The memory used does not depend on the number of structures but for their offsets*/
+  class KRYOMOLPARSERS_API IndexedFrames : public FrameSource
+  {
+    public:
+      enum Format { XYZ, MDLV2000 };
+      /** structures of a file above which they are read on demand, and structures decoded kept*/
+      enum { ONDEMAND=1000, CACHESIZE=16 };
+      /** map @param path, whose structures in @param format of @param natoms atoms begin at @param offsets*/
+      IndexedFrames ( const QString& path, Format format, const std::vector<size_t>& offsets, size_t natoms );
+      bool IsOpen() const { return m_stream.IsOpen(); }
+      size_t Size() const { return m_offsets.size(); }
+      /** @return false if structure @param i is malformed or has not the atoms of the first one, the
+          coordinates of @param frame are then left unchanged*/
+      bool Read ( size_t i, Frame& frame );
+      /** @return the offsets of the structures in @param format of @param text, from @param from on*/
+      static std::vector<size_t> Index ( std::string_view text, Format format, size_t from=0 );
+      /** read the structure in @param format of @param text beginning at @param offset: its coordinates
+          in @param xyz and, if not NULL, its atoms in @param atoms @return false if it is malformed*/
+      static bool Decode ( std::string_view text, size_t offset, Format format, std::vector<Coordinate>& xyz,
+                           std::vector<Atom>* atoms=NULL );
+    private:
+      MappedStream m_stream;
+      Format m_format;
+      std::vector<size_t> m_offsets;
+      size_t m_natoms;
+      /** the structures decoded last, the most recent first*/
+      std::list<std::pair<size_t,std::vector<Coordinate> > > m_cache;
+  };
+}
+
+#endif
@@ -10,11 +10,9 @@ the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
 #include "mdlv2000parser.h"
+#include "indexedframes.h"
 #include "molecule.h"
-#include "stringtools.h"
 #include "exception.h"
-#include <vector>
-#include <sstream>
 
 using namespace kryomol;
 
@@ -30,75 +28,45 @@ MdlV2000Parser::~MdlV2000Parser ( void )
 
 bool MdlV2000Parser::ParseFile ( std::streampos pos )
 {
-  std::string line;
-  m_file->clear();
-  m_file->seekg ( pos,std::ios::beg );
-  bool bfirst=true;
+  const std::string_view text=Text();
+  m_records=IndexedFrames::Index ( text,IndexedFrames::MDLV2000,static_cast<size_t> ( pos ) );
   Molecules()->push_back ( Molecule() );
-  while ( std::getline ( *m_file,line ) )
-  {
-
-    //skip three first lines
-    size_t i=0;
-
-
-    //OK, gets the number of atoms and bonds
-
-    while ( std::getline ( *m_file,line ) )
-    {
-      StringTokenizer token ( line," \t\r" );
-      size_t size=token.size();
-      if ( size )
-        if ( size == 11L || token.back() == "V2000" ) goto lb1;
-    }
-    return true;
-  lb1:
-    StringTokenizer token ( line," \t\r" );
+  Molecule& molecule=Molecules()->back();
+  if ( m_records.empty() ) return true;
 
-    if ( token.empty() )
-    {
-      throw kryomol::Exception ( "Error parsering mol file" );
-    }
-    //either there are 11 numbers or last token is "V2000"
-    if ( token.size() != 11L  && token.back() !="V2000" )
-    {
-      throw kryomol::Exception ( "Error parsering mdl V2000 file" );
-    }
-    bfirst=false;
-    int natoms=atoi ( token.at(0).c_str() );
-    if ( natoms < 1 )
-    {
-      throw kryomol::Exception ( "Error parsering mdl V2000 file" );
-    }
-    Frame frame ( &Molecules()->back() );
-    Molecules()->back().Frames().push_back ( frame );
-
-    Molecules()->back().Atoms().clear();
-    Molecules()->back().Atoms().resize ( natoms );
-    Molecules()->back().Frames().back().XYZ().resize ( natoms );
+  std::vector<Coordinate> xyz;
+  if ( !IndexedFrames::Decode ( text,m_records.front(),IndexedFrames::MDLV2000,xyz,&molecule.Atoms() ) )
+  {
+    throw kryomol::Exception ( "Error parsering mdl V2000 file" );
+  }
 
-    std::vector<Atom>::iterator at;
-    std::vector<Coordinate>::iterator ct=Molecules()->back().Frames().back().XYZ().begin();
-    for ( at=Molecules()->back().Atoms().begin(),i=1;at!=Molecules()->back().Atoms().end();++at,++ct,i++ )
+  //large files are read on demand from a mapping of their own, the stream of the parser does not outlive it
+  const QString path=Path();
+  if ( m_records.size() > IndexedFrames::ONDEMAND && !path.isEmpty() )
+  {
+    IndexedFrames* source=new IndexedFrames ( path,IndexedFrames::MDLV2000,m_records,molecule.Atoms().size() );
+    if ( source->IsOpen() )
     {
-      std::getline ( *m_file,line );
-      StringTokenizer token ( line );
-      if ( token.size() < 4 )
-      {
-        throw kryomol::Exception ( "Error parsering mdl V2000 file" );
-      }
-      ct->x() =std::atof ( token.at(0).c_str() );
-      ct->y() =std::atof ( token.at(1).c_str() );
-      ct->z() =std::atof ( token.at(2).c_str() );
-      std::stringstream st;
-      st << i;
-      at->SetSymbol ( token.at(3) );
-
+      molecule.SetFrameSource ( source );
+      return true;
     }
+    delete source;
+  }
 
+  std::vector<FrameBlock> blocks ( m_records.size() );
+  ParseFrames ( molecule,blocks );
 
-  }
+  m_file->clear();
+  m_file->seekg ( 0,std::ios::beg );
   return true;
-
 }
 
+/** every record must have the atoms of the first one, that are those of the molecule*/
+void MdlV2000Parser::ParseFrameBlock ( std::string_view text, size_t frame, Frame& target, FrameBlock& /*block*/ )
+{
+  if ( !IndexedFrames::Decode ( text,m_records[frame],IndexedFrames::MDLV2000,target.XYZ() ) ||
+       target.XYZ().size() != Molecules()->back().Atoms().size() )
+  {
+    throw kryomol::Exception ( "Error parsering mdl V2000 file" );
+  }
+}
@@ -12,11 +12,18 @@ the Free Software Foundation version 2 of the License.
 #ifndef MDLV2000PARSER_H
 #define MDLV2000PARSER_H
 
+#include <vector>
+
 #include "parser.h"
 
 namespace kryomol
 {
 
+/** @brief parser of MDL V2000 mol and SD files
+
+Every record of the file, ended by a $$$$ line in SD files, is a frame of the molecule, whose atoms are those
+of the first record. Files with more than IndexedFrames::ONDEMAND records are read on demand through
+@see IndexedFrames, so only the frame shown is held in memory*/
 class KRYOMOLPARSERS_API  MdlV2000Parser : public kryomol::Parser
 {
 public:
@@ -24,6 +31,11 @@ public:
   MdlV2000Parser(std::istream* stream);
   ~MdlV2000Parser(void);
   bool ParseFile(std::streampos pos=0);
+protected:
+  void ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& block);
+private:
+  /** beginning of each record in the text*/
+  std::vector<size_t> m_records;
 };
 
 }
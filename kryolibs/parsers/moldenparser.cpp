@@ -0,0 +1,326 @@
+/*****************************************************************************************
+                            moldenparser.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <cctype>
+
+#include "moldenparser.h"
+#include "molecule.h"
+#include "linereader.h"
+
+using namespace kryomol;
+
+namespace
+{
+    const double bohrtoangs=0.529189379;
+
+    /** @return true if @param a and @param b are equal ignoring the case*/
+    bool EqualNoCase ( std::string_view a, std::string_view b )
+    {
+        if ( a.size() != b.size() ) return false;
+        for ( size_t i=0;i<a.size();++i )
+        {
+            if ( std::tolower ( static_cast<unsigned char> ( a[i] ) ) != std::tolower ( static_cast<unsigned char> ( b[i] ) ) )
+                return false;
+        }
+        return true;
+    }
+
+    /** @return @param s without the blanks at both ends*/
+    std::string_view Trim ( std::string_view s )
+    {
+        const Delimiters& blanks=Delimiters::Blanks();
+        while ( !s.empty() && blanks ( s.front() ) ) s.remove_prefix ( 1 );
+        while ( !s.empty() && blanks ( s.back() ) ) s.remove_suffix ( 1 );
+        return s;
+    }
+}
+
+MoldenParser::MoldenParser ( const char* file ) : Parser ( file ), m_typeD ( 6 ), m_typeF ( 10 ), m_nbasis ( 0 )
+{}
+
+MoldenParser::MoldenParser ( std::istream* stream ) : Parser ( stream ), m_typeD ( 6 ), m_typeF ( 10 ), m_nbasis ( 0 )
+{}
+
+MoldenParser::~MoldenParser()
+{}
+
+void MoldenParser::DefineSections ( SectionIndex& index )
+{
+    //the names of the sections are not case sensitive, these are the spellings found in practice
+    index.Add ( HEADER,"[",0 );
+    index.Add ( ATOMS,"[Atoms]",0 );
+    index.Add ( ATOMS,"[ATOMS]",0 );
+    index.Add ( ATOMS,"[atoms]",0 );
+    index.Add ( GTO,"[GTO]",0 );
+    index.Add ( GTO,"[gto]",0 );
+    index.Add ( MO,"[MO]",0 );
+    index.Add ( MO,"[mo]",0 );
+    index.Add ( SPHERICALD,"[5D]",0 );
+    index.Add ( SPHERICALD,"[5d]",0 );
+    index.Add ( SPHERICALDF,"[5D7F]",0 );
+    index.Add ( SPHERICALDF,"[5d7f]",0 );
+    index.Add ( SPHERICALDCARTESIANF,"[5D10F]",0 );
+    index.Add ( SPHERICALDCARTESIANF,"[5d10f]",0 );
+    index.Add ( SPHERICALF,"[7F]",0 );
+    index.Add ( SPHERICALF,"[7f]",0 );
+}
+
+bool MoldenParser::ParseFile ( std::streampos /*pos*/ )
+{
+    if ( !GetGeometry() ) return false;
+
+    //[5D] stands for 5 d and 7 f functions
+    m_typeD=6;
+    m_typeF=10;
+    if ( Sections().Count ( SPHERICALD ) > 0 || Sections().Count ( SPHERICALDF ) > 0 )
+    {
+        m_typeD=5;
+        m_typeF=7;
+    }
+    if ( Sections().Count ( SPHERICALDCARTESIANF ) > 0 )
+    {
+        m_typeD=5;
+        m_typeF=10;
+    }
+    if ( Sections().Count ( SPHERICALF ) > 0 ) m_typeF=7;
+
+    Frame& frame=Molecules()->back().Frames().back();
+    if ( GetBasisCenters ( frame ) ) GetOrbitalData ( frame );
+
+    m_file->clear();
+    m_file->seekg ( 0,std::ios::beg );
+    return true;
+}
+
+bool MoldenParser::GetSection ( section s, std::string_view& text )
+{
+    const std::streamoff begin=Sections().Find ( s,0 );
+    if ( begin < 0 ) return false;
+    const std::string_view all=Text();
+    const std::streamoff end=Sections().Find ( HEADER,begin+1 );
+    text=all.substr ( static_cast<size_t> ( begin ),end < 0 ? std::string_view::npos : static_cast<size_t> ( end-begin ) );
+    return true;
+}
+
+bool MoldenParser::GetGeometry()
+{
+    std::string_view text;
+    if ( !GetSection ( ATOMS,text ) ) return false;
+
+    LineReader reader ( text );
+    std::string_view line;
+    reader.Next ( line );
+    //[Atoms] AU or [Atoms] Angs
+    const std::string_view units=Trim ( line.substr ( line.find ( ']' )+1 ) );
+    const double factor= ( units.find ( "AU" ) != std::string_view::npos || units.find ( "au" ) != std::string_view::npos ) ? bohrtoangs : 1.0;
+
+    Molecules()->push_back ( Molecule() );
+    Molecule& molecule=Molecules()->back();
+    molecule.Frames().push_back ( Frame ( &molecule ) );
+    Frame& frame=molecule.Frames().back();
+    //name, number, atomic number and coordinates
+    while ( reader.Next ( line ) )
+    {
+        Tokens token ( line );
+        if ( token.size() < 6 ) continue;
+        molecule.Atoms().push_back ( Atom ( ToInt ( token[2] ) ) );
+        Coordinate c;
+        c.x() =ToDouble ( token[3] ) *factor;
+        c.y() =ToDouble ( token[4] ) *factor;
+        c.z() =ToDouble ( token[5] ) *factor;
+        frame.XYZ().push_back ( c );
+    }
+    return !frame.XYZ().empty();
+}
+
+bool MoldenParser::GetBasisCenters ( Frame& frame )
+{
+    std::string_view text;
+    if ( !GetSection ( GTO,text ) ) return false;
+
+    LineReader reader ( text );
+    std::string_view line;
+    reader.Next ( line );
+
+    std::vector<BasisCenter> basis;
+    std::vector<Orbital> orbitals;
+    int atom=-1;
+    size_t nbasis=0;
+    while ( true )
+    {
+        const bool more=reader.Next ( line );
+        Tokens token ( more ? line : std::string_view() );
+        //a new atom, "1 0", or the end of the section
+        if ( !more || ( !token.empty() && std::isdigit ( static_cast<unsigned char> ( token[0][0] ) ) ) )
+        {
+            if ( atom >= 0 && !orbitals.empty() )
+            {
+                basis.push_back ( BasisCenter ( frame.XYZ().at ( atom ),orbitals ) );
+                orbitals.clear();
+            }
+            if ( !more ) break;
+            atom=ToInt ( token[0] )-1;
+            if ( atom < 0 || static_cast<size_t> ( atom ) >= frame.XYZ().size() ) return false;
+            continue;
+        }
+        if ( token.size() < 2 ) continue;
+        if ( atom < 0 ) return false;
+
+        //a shell, "sp 3 1.00", followed by its primitives
+        const std::string_view label=token[0];
+        const int n=ToInt ( token[1] );
+        const double scale=token.size() > 2 ? ToDouble ( token[2] ) : 1.0;
+        const bool sp=EqualNoCase ( label,"sp" );
+        std::vector<float> alpha;
+        std::vector<float> xs;
+        std::vector<float> xp;
+        for ( int i=0;i<n;++i )
+        {
+            if ( !reader.Next ( line ) ) return false;
+            Tokens primitive ( line );
+            if ( primitive.size() < ( sp ? 3 : 2 ) ) return false;
+            alpha.push_back ( ToDouble ( primitive[0] ) * ( scale == 0.0 ? 1.0 : scale*scale ) );
+            xs.push_back ( ToDouble ( primitive[1] ) );
+            if ( sp ) xp.push_back ( ToDouble ( primitive[2] ) );
+        }
+
+        if ( EqualNoCase ( label,"s" ) )
+        {
+            orbitals.push_back ( Orbital ( Orbital::S,alpha,xs,xp ) );
+            nbasis+=1;
+        }
+        else if ( sp )
+        {
+            orbitals.push_back ( Orbital ( Orbital::SP,alpha,xs,xp ) );
+            nbasis+=4;
+        }
+        else if ( EqualNoCase ( label,"p" ) )
+        {
+            orbitals.push_back ( Orbital ( Orbital::P,alpha,xs,xp ) );
+            nbasis+=3;
+        }
+        else if ( EqualNoCase ( label,"d" ) )
+        {
+            orbitals.push_back ( Orbital ( Orbital::D,alpha,xs,xp ) );
+            nbasis+=m_typeD;
+        }
+        else if ( EqualNoCase ( label,"f" ) )
+        {
+            orbitals.push_back ( Orbital ( Orbital::F,alpha,xs,xp ) );
+            nbasis+=m_typeF;
+        }
+        else
+        {
+            //g and higher shells can not be represented
+            return false;
+        }
+    }
+    if ( basis.empty() ) return false;
+
+    m_nbasis=nbasis;
+    frame.OrbitalsData().SetTypeD ( m_typeD );
+    frame.OrbitalsData().SetTypeF ( m_typeF );
+    frame.OrbitalsData().SetBasisCenters ( basis );
+    return true;
+}
+
+bool MoldenParser::GetOrbitalData ( Frame& frame )
+{
+    std::string_view text;
+    if ( !GetSection ( MO,text ) || m_nbasis == 0 ) return false;
+
+    LineReader reader ( text );
+    std::string_view line;
+    reader.Next ( line );
+
+    OrbitalData& data=frame.OrbitalsData();
+    D2Array<float>& matrix=data.Coefficients();
+    D2Array<float>& betamatrix=data.BetaCoefficients();
+    matrix.Initialize ( m_nbasis,m_nbasis,0.0 );
+    std::vector<float> eigenvalues;
+    std::vector<float> occupations;
+    std::vector<float> betaeigenvalues;
+
+    //every orbital is a list of keys, Sym=, Ene=, Spin= and Occup=, followed by its coefficients
+    bool keys=false;
+    bool beta=false;
+    double energy=0.0;
+    double occupation=0.0;
+    D2Array<float>* coefficients=NULL;
+    size_t column=0;
+    while ( reader.Next ( line ) )
+    {
+        const size_t equal=line.find ( '=' );
+        if ( equal != std::string_view::npos )
+        {
+            if ( !keys )
+            {
+                keys=true;
+                beta=false;
+                energy=occupation=0.0;
+            }
+            const std::string_view key=Trim ( line.substr ( 0,equal ) );
+            const std::string_view value=line.substr ( equal+1 );
+            if ( EqualNoCase ( key,"Ene" ) )
+                energy=ToDouble ( value );
+            else if ( EqualNoCase ( key,"Occup" ) )
+                occupation=ToDouble ( value );
+            else if ( EqualNoCase ( key,"Spin" ) )
+            {
+                const std::string_view spin=Trim ( value );
+                beta=!spin.empty() && ( spin[0] == 'B' || spin[0] == 'b' );
+            }
+            continue;
+        }
+
+        Tokens token ( line );
+        if ( token.size() < 2 ) continue;
+        if ( keys )
+        {
+            //the first coefficient of a new orbital
+            keys=false;
+            if ( beta )
+            {
+                if ( betaeigenvalues.empty() ) betamatrix.Initialize ( m_nbasis,m_nbasis,0.0 );
+                column=betaeigenvalues.size();
+                betaeigenvalues.push_back ( energy );
+                coefficients=&betamatrix;
+            }
+            else
+            {
+                column=eigenvalues.size();
+                eigenvalues.push_back ( energy );
+                occupations.push_back ( occupation );
+                coefficients=&matrix;
+            }
+            if ( column >= m_nbasis ) return false;
+        }
+        if ( coefficients == NULL ) continue;
+        //some programs leave out the zero coefficients
+        int ao;
+        if ( !ToInt ( token[0],ao ) || ao < 1 || static_cast<size_t> ( ao ) > m_nbasis ) return false;
+        ( *coefficients ) ( ao-1,column ) =ToDouble ( token[1] );
+    }
+    if ( eigenvalues.empty() ) return false;
+
+    int homo=0;
+    for ( size_t i=0;i<occupations.size();++i )
+    {
+        if ( occupations[i] > 0.0 ) homo=static_cast<int> ( i+1 );
+    }
+    const bool unrestricted=!betaeigenvalues.empty();
+    data.SetHomo ( homo );
+    data.SetLumo ( unrestricted ? homo : homo+1 );
+    data.SetEigenvalues ( eigenvalues );
+    data.SetOccupations ( occupations );
+    if ( unrestricted ) data.SetBetaEigenvalues ( betaeigenvalues );
+    return true;
+}
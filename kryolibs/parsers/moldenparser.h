@@ -0,0 +1,57 @@
+/*****************************************************************************************
+                            moldenparser.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef MOLDENPARSER_H
+#define MOLDENPARSER_H
+
+#include <string_view>
+
+#include "parser.h"
+
+namespace kryomol
+{
+class Frame;
+
+/** @brief parser of the orbitals of Molden files
+
+Molden files are written by orca_2mkl -molden and by many other programs. The geometry is read from the
+[Atoms] section, the basis set from the [GTO] section and the molecular orbitals, alpha and beta, with
+their energies and occupations from the [MO] section. The basis functions are cartesian unless one of the
+[5D], [5D7F], [5D10F] or [7F] flags is present. The sections are found with the index of the file, and
+their lines are split and converted in place, without copies*/
+class KRYOMOLPARSERS_API MoldenParser : public Parser
+{
+public:
+  MoldenParser(const char* file);
+  MoldenParser(std::istream* stream);
+  ~MoldenParser();
+  bool ParseFile(std::streampos pos=0);
+protected:
+  void DefineSections(SectionIndex& index);
+private:
+  /** sections recorded in the index of the file, HEADER is any of them*/
+  enum section { HEADER, ATOMS, GTO, MO, SPHERICALD, SPHERICALDF, SPHERICALDCARTESIANF, SPHERICALF };
+  /** @return false if there is no section @param s, otherwise its text in @param text, the line of the name included*/
+  bool GetSection(section s, std::string_view& text);
+  bool GetGeometry();
+  bool GetBasisCenters(Frame& frame);
+  bool GetOrbitalData(Frame& frame);
+
+private:
+  int m_typeD;
+  int m_typeF;
+  /** number of atomic orbitals of the basis set*/
+  size_t m_nbasis;
+};
+
+}
+
+#endif
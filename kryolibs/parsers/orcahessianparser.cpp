@@ -0,0 +1,203 @@
+/*****************************************************************************************
+                            orcahessianparser.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include "orcahessianparser.h"
+#include "molecule.h"
+#include "linereader.h"
+
+using namespace kryomol;
+
+namespace
+{
+    const double bohrtoangs=0.529189379;
+
+    /** @return true if all the tokens of @param token are integers, as in the header of a block of columns*/
+    bool IsColumnHeader ( const Tokens& token )
+    {
+        for ( size_t i=0;i<token.size();++i )
+        {
+            if ( token[i].find_first_not_of ( "0123456789" ) != std::string_view::npos ) return false;
+        }
+        return !token.empty();
+    }
+}
+
+OrcaHessianParser::OrcaHessianParser ( const char* file ) : Parser ( file )
+{}
+
+OrcaHessianParser::OrcaHessianParser ( std::istream* stream ) : Parser ( stream )
+{}
+
+OrcaHessianParser::~OrcaHessianParser()
+{}
+
+void OrcaHessianParser::DefineSections ( SectionIndex& index )
+{
+    index.Add ( HEADER,"$",0 );
+    index.Add ( ATOMS,"$atoms",0 );
+    index.Add ( HESSIAN,"$hessian",0 );
+    index.Add ( FREQUENCIES,"$vibrational_frequencies",0 );
+    index.Add ( NORMALMODES,"$normal_modes",0 );
+    index.Add ( IRSPECTRUM,"$ir_spectrum",0 );
+}
+
+std::vector<JobHeader>& OrcaHessianParser::Jobs()
+{
+    if ( m_jobpos.empty() ) m_jobpos.push_back ( JobHeader ( freq,0 ) );
+    return m_jobpos;
+}
+
+bool OrcaHessianParser::ParseFile ( std::streampos /*pos*/ )
+{
+    if ( !GetGeometry() ) return false;
+    GetHessian ( Molecules()->back().Frames().back() );
+
+    m_file->clear();
+    m_file->seekg ( 0,std::ios::beg );
+    return true;
+}
+
+bool OrcaHessianParser::ParseFrequencies ( std::streampos /*pos*/ )
+{
+    if ( Molecules()->empty() || Molecules()->back().Frames().empty() ) return false;
+    if ( !GetFrequencies ( Molecules()->back().Frames().back() ) ) return false;
+    return GetNormalModes();
+}
+
+bool OrcaHessianParser::GetSection ( section s, std::string_view& text )
+{
+    const std::streamoff begin=Sections().Find ( s,0 );
+    if ( begin < 0 ) return false;
+    const std::string_view all=Text();
+    const std::streamoff end=Sections().Find ( HEADER,begin+1 );
+    text=all.substr ( static_cast<size_t> ( begin ),end < 0 ? std::string_view::npos : static_cast<size_t> ( end-begin ) );
+    return true;
+}
+
+template<class F>
+bool OrcaHessianParser::ReadMatrix ( std::string_view text, size_t rows, size_t columns, F store )
+{
+    //the numbers of the columns of a block, then a row for each row of the matrix, its number first
+    LineReader reader ( text );
+    std::string_view line;
+    reader.Skip ( 2 );
+    Tokens token;
+    size_t first=0;
+    size_t nblock=0;
+    size_t read=0;
+    while ( read < rows*columns && reader.Next ( line ) )
+    {
+        token.Assign ( line );
+        if ( token.empty() ) continue;
+        if ( IsColumnHeader ( token ) )
+        {
+            first=ToInt ( token.front() );
+            nblock=token.size();
+            continue;
+        }
+        const int row=ToInt ( token.front() );
+        if ( row < 0 || static_cast<size_t> ( row ) >= rows || token.size() < nblock+1 || first+nblock > columns ) return false;
+        for ( size_t i=0;i<nblock;++i )
+            store ( static_cast<size_t> ( row ),first+i,ToDouble ( token[i+1] ) );
+        read+=nblock;
+    }
+    return read == rows*columns;
+}
+
+bool OrcaHessianParser::GetGeometry()
+{
+    std::string_view text;
+    if ( !GetSection ( ATOMS,text ) ) return false;
+
+    LineReader reader ( text );
+    std::string_view line;
+    reader.Skip();
+    if ( !reader.Next ( line ) ) return false;
+    const int natoms=ToInt ( line );
+
+    Molecules()->push_back ( Molecule() );
+    Molecule& molecule=Molecules()->back();
+    molecule.Frames().push_back ( Frame ( &molecule ) );
+    Frame& frame=molecule.Frames().back();
+    //symbol, mass and coordinates in bohr
+    Tokens token;
+    for ( int i=0;i<natoms && reader.Next ( line );++i )
+    {
+        token.Assign ( line );
+        if ( token.size() < 5 ) return false;
+        molecule.Atoms().push_back ( Atom ( std::string ( token[0] ) ) );
+        Coordinate c;
+        c.x() =ToDouble ( token[2] ) *bohrtoangs;
+        c.y() =ToDouble ( token[3] ) *bohrtoangs;
+        c.z() =ToDouble ( token[4] ) *bohrtoangs;
+        frame.XYZ().push_back ( c );
+    }
+    return !frame.XYZ().empty();
+}
+
+bool OrcaHessianParser::GetHessian ( Frame& frame )
+{
+    std::string_view text;
+    if ( !GetSection ( HESSIAN,text ) ) return false;
+    const size_t n3=3*frame.ParentMolecule()->Atoms().size();
+    frame.AllocateHessian();
+    D2Array<double>& hessian=frame.GetHessian();
+    return ReadMatrix ( text,n3,n3,[&hessian] ( size_t i, size_t j, double v ) { hessian ( i,j ) =v; } );
+}
+
+bool OrcaHessianParser::GetFrequencies ( Frame& frame )
+{
+    std::string_view text;
+    if ( !GetSection ( FREQUENCIES,text ) ) return false;
+
+    //the number of modes, then the number and the frequency of each one
+    LineReader reader ( text );
+    std::string_view line;
+    reader.Skip();
+    if ( !reader.Next ( line ) ) return false;
+    const int nmodes=ToInt ( line );
+    std::vector<Frequency>& frequencies=frame.GetFrequencies();
+    frequencies.clear();
+    Tokens token;
+    for ( int i=0;i<nmodes && reader.Next ( line );++i )
+    {
+        token.Assign ( line );
+        if ( token.size() < 2 ) return false;
+        frequencies.push_back ( Frequency ( ToDouble ( token[1] ),0.0f ) );
+    }
+
+    //the frequency and the intensity of each mode, km/mol, after the molar absorption coefficient in
+    //recent versions, six columns, and the squared transition dipole in older ones, five columns
+    if ( !GetSection ( IRSPECTRUM,text ) ) return true;
+    reader=LineReader ( text );
+    reader.Skip ( 2 );
+    for ( size_t i=0;i<frequencies.size() && reader.Next ( line );++i )
+    {
+        token.Assign ( line );
+        if ( token.size() < 5 ) break;
+        frequencies[i].y=ToDouble ( token[token.size() > 5 ? 2 : 1] );
+    }
+    return true;
+}
+
+bool OrcaHessianParser::GetNormalModes()
+{
+    std::string_view text;
+    if ( !GetSection ( NORMALMODES,text ) ) return false;
+    Molecule& molecule=Molecules()->back();
+    const size_t nmodes=molecule.Frames().back().GetFrequencies().size();
+    const size_t n3=3*molecule.Atoms().size();
+
+    //the modes are the columns of the matrix
+    NormalModes& modes=molecule.Modes();
+    modes.Initialize ( nmodes,molecule.Atoms().size() );
+    return ReadMatrix ( text,n3,nmodes,[&modes] ( size_t i, size_t j, double v ) { modes ( j,i ) =static_cast<float> ( v ); } );
+}
@@ -0,0 +1,58 @@
+/*****************************************************************************************
+                            orcahessianparser.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef ORCAHESSIANPARSER_H
+#define ORCAHESSIANPARSER_H
+
+#include <string_view>
+
+#include "parser.h"
+
+namespace kryomol
+{
+class Frame;
+
+/** @brief parser of the Hessian files (.hess) of ORCA frequency jobs
+
+The geometry is read from the $atoms section, the cartesian Hessian from $hessian, and the frequencies,
+IR intensities and normal modes from $vibrational_frequencies, $ir_spectrum and $normal_modes, so a
+frequency job can be shown without its output. The matrices are written in blocks of columns, that are
+read in a single pass over each section straight from the text in memory*/
+class KRYOMOLPARSERS_API OrcaHessianParser : public Parser
+{
+public:
+  OrcaHessianParser(const char* file);
+  OrcaHessianParser(std::istream* stream);
+  ~OrcaHessianParser();
+  bool ParseFile(std::streampos pos=0);
+  /** a single frequency job*/
+  std::vector<JobHeader>& Jobs();
+  bool ParseFrequencies(std::streampos pos=0);
+protected:
+  void DefineSections(SectionIndex& index);
+private:
+  /** sections recorded in the index of the file, HEADER is any of them*/
+  enum section { HEADER, ATOMS, HESSIAN, FREQUENCIES, NORMALMODES, IRSPECTRUM };
+  /** @return false if there is no section @param s, otherwise its text in @param text, the line of the name included*/
+  bool GetSection(section s, std::string_view& text);
+  /** call @param store with the row, the column and the value of every element of the matrix in blocks of
+      columns that follows the line of its dimensions in @param text
+      @return false if the matrix is incomplete*/
+  template<class F> bool ReadMatrix(std::string_view text, size_t rows, size_t columns, F store);
+  bool GetGeometry();
+  bool GetHessian(Frame& frame);
+  bool GetFrequencies(Frame& frame);
+  bool GetNormalModes();
+};
+
+}
+
+#endif
@@ -16,6 +16,7 @@ the Free Software Foundation version 2 of the License.
 #include "stdlib.h"
 #include "mathtools.h"
 #include "orbitalarray.h"
+#include "linereader.h"
 
 #include <QProgressDialog>
 
@@ -23,21 +24,65 @@ the Free Software Foundation version 2 of the License.
 #include <iostream>
 #include <cmath>
 #include <clocale>
+#include <algorithm>
 
 using namespace kryomol;
 
-OrcaParser::OrcaParser ( const char* file ) : Parser ( file )
+namespace
+{
+    /** @return true if @param s is made of digits only*/
+    bool IsInteger ( std::string_view s )
+    {
+        if ( s.empty() ) return false;
+        for ( char c : s )
+        {
+            if ( c < '0' || c > '9' ) return false;
+        }
+        return true;
+    }
+}
+
+OrcaParser::OrcaParser ( const char* file ) : Parser ( file ), m_jobbegin ( 0 )
 {
 
 }
 
-OrcaParser::OrcaParser ( std::istream* stream ) : Parser ( stream )
+OrcaParser::OrcaParser ( std::istream* stream ) : Parser ( stream ), m_jobbegin ( 0 )
 {
 }
 
 OrcaParser::~OrcaParser()
 {}
 
+void OrcaParser::DefineSections ( SectionIndex& index )
+{
+    index.Add ( OPTIMIZATIONRUN,"* Geometry Optimization Run *" );
+    index.Add ( OPTIMIZATIONRUN,"*    Relaxed Surface Scan    *" );
+    index.Add ( SINGLEPOINTRUN,"* Single Point Calculation *" );
+    index.Add ( SINGLEPOINTRUN,"*     ORCA property calculations      *" );
+    index.Add ( SINGLEPOINTRUN,"ORCA PROPERTY CALCULATIONS" ); //Orca 6
+    index.Add ( SINGLEPOINTRUN,"Energy+Gradient Calculation" );
+    index.Add ( EXCITEDSTATES,"TD-DFT/TDA EXCITED STATES" );
+    index.Add ( EXCITEDSTATES,"TD-DFT EXCITED STATES" );
+    index.Add ( HESSIAN,"ORCA NUMERICAL FREQUENCIES" );
+    index.Add ( HESSIAN,"SCF HESSIAN" ); //ORCA SCF HESSIAN, and Orca 6.0
+    index.Add ( COORDINATES,"CARTESIAN COORDINATES (ANGSTROEM)" );
+    index.Add ( JOBNUMBER,"JOB NUMBER" );
+    index.Add ( ENERGY,"FINAL SINGLE POINT ENERGY" );
+    index.Add ( CONVERGENCE,"|Geometry convergence|" );
+    index.Add ( ELECTRONS,"Number of Electrons" );
+    index.Add ( BASIS,"BASIS SET IN INPUT FORMAT" );
+    index.Add ( ORBITALS,"MOLECULAR ORBITALS" );
+    index.Add ( UVSPECTRUM,"ABSORPTION SPECTRUM VIA TRANSITION ELECTRIC DIPOLE MOMENTS" );
+    index.Add ( UVSPECTRUM,"CD SPECTRUM" );
+    index.Add ( SOLVENTSHIFTS,"CALCULATED SOLVENT SHIFTS" );
+    index.Add ( FREQUENCIES,"Scaling factor for frequencies" );
+    index.Add ( NORMALMODES,"NORMAL MODES" );
+    index.SetJobSection ( OPTIMIZATIONRUN );
+    index.SetJobSection ( SINGLEPOINTRUN );
+    index.SetFrameSection ( COORDINATES );
+}
+
 bool OrcaParser::ParseFile ( std::streampos pos )
 {
     m_file->clear();
@@ -62,69 +107,36 @@ bool OrcaParser::ParseFile ( std::streampos pos )
 
 bool OrcaParser::GetGeometry()
 {
-    std::string line;
-    bool bfound=false;
-    while ( std::getline ( *m_file,line ) )
-    {
-        if ( line.find ( "CARTESIAN COORDINATES (ANGSTROEM)" ) != std::string::npos )
-        {
-            bfound=true;
-
-            std::getline ( *m_file,line );
-
-            m_pos.push_back ( m_file->tellg() );
-        }
-        if ( line.find("JOB NUMBER") != std::string::npos ) break;
-    }
-    if ( m_pos.empty() ) return false;
-
-    std::vector<std::streampos>::iterator pt;
+    m_jobbegin=m_file->tellg();
+    //a job that does not print the geometry starts from the last one of the previous job
+    m_framepos.assign ( m_pos.begin(),m_pos.end() );
+    GetFramePositions ( m_jobbegin );
+    if ( m_framepos.empty() ) return false;
+    m_pos.assign ( m_framepos.begin(),m_framepos.end() );
 
     //Get simply the last molecule
     Molecules()->push_back ( Molecule() );
-    pt=m_pos.begin();
-    m_file->clear();
-    m_file->seekg ( *pt,std::ios::beg );
-    while ( std::getline ( *m_file,line ) )
+    Molecule& molecule=Molecules()->back();
+    //the coordinate blocks are read in place from the text of the file
+    const std::string_view text=Text();
+    std::string_view view;
+    LineReader reader ( text,m_pos.front() );
+    while ( reader.Next ( view ) )
     {
-        StringTokenizer token ( line," " );
+        Tokens token ( view );
         size_t size=token.size();
 
         if ( size >= 4 )
         {
-            Molecules()->back().Atoms().push_back ( Atom ( token.at ( 0 ).c_str() ) );
+            molecule.Atoms().push_back ( Atom ( std::string ( token[0] ).c_str() ) );
         }
         else break;
     }
-    for ( pt=m_pos.begin();pt!=m_pos.end();pt++ )
-    {
-        Molecules()->back().Frames().push_back ( Frame ( &Molecules()->back() ) );
 
-        m_file->clear();
-        m_file->seekg ( *pt,std::ios::beg );
-        while ( std::getline ( *m_file,line ) )
-        {
-            StringTokenizer token ( line," " );
-            size_t size=token.size();
-
-            if ( size >= 4 )
-            {
-                Coordinate c;
-                c.x() =std::atof ( token.at ( size-3 ).c_str() );
-                c.y() =std::atof ( token.at ( size-2 ).c_str() );
-                c.z() =std::atof ( token.at ( size-1 ).c_str() );
-                Molecules()->back().Frames().back().XYZ().push_back ( c );
-            }
-            else  break;
-        }
-        GetEnergyForFrame();
-        GetGradientForFrame();
-
-        //Get the SCF energy
+    std::vector<FrameBlock> blocks ( m_framepos.size() );
+    ParseFrames ( molecule,blocks );
 
-    }
-
-    Molecules()->back().SetBonds();
+    molecule.SetBonds();
 
     //just keepe the last position in case we needed later
     //since Orca do not write agian geoemtyr in the job section
@@ -137,63 +149,117 @@ bool OrcaParser::GetGeometry()
     return true;
 }
 
-void OrcaParser::GetEnergyForFrame()
+/** the coordinates of the current job only, they begin two lines after the header*/
+void OrcaParser::GetFramePositions ( std::streamoff from )
 {
     std::string line;
-    while(std::getline(*m_file,line) )
+    const SectionIndex& index=Sections();
+    std::streamoff last=index.Find ( JOBNUMBER,m_jobbegin );
+    if ( last >= 0 ) last+=1;
+    const std::vector<SectionIndex::Entry>& entries=index.Entries ( COORDINATES );
+    for ( size_t i=index.First ( COORDINATES,from );i<entries.size();++i )
     {
-        if ( line.find( "FINAL SINGLE POINT ENERGY") != std::string::npos )
-        {
-            StringTokenizer tok(line," \t:");
-            if ( tok.size() < 3 ) throw kryomol::Exception("error parsing SCF energy");
-            Molecules()->back().Frames().back().SetEnergy(std::stod(tok.back()),"SCF");
-            return;
-        }
+        if ( last >= 0 && entries[i].offset >= last ) break;
+        m_file->clear();
+        m_file->seekg ( entries[i].offset,std::ios::beg );
+        std::getline ( *m_file,line );
+        std::getline ( *m_file,line );
+        //the header of a frame still being written is found again later
+        const std::streampos pos=m_file->tellg();
+        if ( pos < 0 ) break;
+
+        m_framepos.push_back ( pos );
     }
 }
 
-void OrcaParser::GetGradientForFrame()
+void OrcaParser::FindAppendedFrames()
 {
-    std::string line;
-    while(std::getline(*m_file,line) )
+    //the header of the last frame known is before its coordinates
+    GetFramePositions ( std::max<std::streamoff> ( m_framepos.back(),m_jobbegin ) );
+    m_pos.assign ( 1,m_framepos.back() );
+}
+
+/** the energy and the convergence of a frame are the first ones printed after its coordinates*/
+void OrcaParser::ParseFrameBlock ( std::string_view text, size_t frame, Frame& target, FrameBlock& block )
+{
+    std::string_view line;
+    LineReader reader ( text,m_framepos[frame] );
+    while ( reader.Next ( line ) )
     {
-        if ( line.find( "|Geometry convergence|") != std::string::npos )
+        Tokens token ( line );
+        size_t size=token.size();
+
+        if ( size >= 4 )
         {
-            while(std::getline(*m_file,line))
-            {
-                if ( line.find("RMS gradient") != std::string::npos )
-                {
-                    StringTokenizer tok(line," \t:");
-                    Molecules()->back().Frames().back().SetRMSForce(std::stod(tok.at(2)));
+            Coordinate c;
+            c.x() =ToDouble ( token[size-3] );
+            c.y() =ToDouble ( token[size-2] );
+            c.z() =ToDouble ( token[size-1] );
+            target.XYZ().push_back ( c );
+        }
+        else  break;
+    }
+    //the convergence is searched after the energy
+    const std::streamoff pos=GetEnergyForFrame ( text,reader.Offset(),block );
+    GetGradientForFrame ( text,pos,target );
+}
 
-                }
+/** @return the position after the energy line, -1 if there is none*/
+std::streamoff OrcaParser::GetEnergyForFrame ( std::string_view text, std::streamoff from, FrameBlock& block )
+{
+    static const Delimiters separators ( " \t:" );
+    const std::streamoff offset=Sections().Find ( ENERGY,from );
+    if ( offset < 0 ) return -1;
+
+    std::string_view line;
+    LineReader reader ( text,offset );
+    reader.Next ( line );
+    Tokens tok ( line,separators );
+    if ( tok.size() < 3 || !ToDouble ( tok.back(),block.energy ) ) throw kryomol::Exception("error parsing SCF energy");
+    block.level="SCF";
+    return reader.Offset();
+}
 
-                if ( line.find("MAX gradient") != std::string::npos )
-                {
-                    StringTokenizer tok(line," \t:");
-                    Molecules()->back().Frames().back().SetMaximumForce(std::stod(tok.at(2)));
+void OrcaParser::GetGradientForFrame ( std::string_view text, std::streamoff from, Frame& frame )
+{
+    static const Delimiters separators ( " \t:" );
+    const std::streamoff offset=Sections().Find ( CONVERGENCE,from );
+    if ( offset < 0 ) return;
 
-                }
+    std::string_view line;
+    LineReader reader ( text,offset );
+    reader.Skip();
+    while ( reader.Next ( line ) )
+    {
+        if ( line.find("RMS gradient") != std::string_view::npos )
+        {
+            Tokens tok ( line,separators );
+            frame.SetRMSForce ( ToDouble ( tok.at ( 2 ) ) );
 
-                if ( line.find("RMS step") != std::string::npos )
-                {
-                    StringTokenizer tok(line," \t:");
-                    Molecules()->back().Frames().back().SetRMSDisplacement(std::stod(tok.at(2)));
+        }
 
-                }
+        if ( line.find("MAX gradient") != std::string_view::npos )
+        {
+            Tokens tok ( line,separators );
+            frame.SetMaximumForce ( ToDouble ( tok.at ( 2 ) ) );
 
-                if ( line.find("MAX step") != std::string::npos )
-                {
-                    StringTokenizer tok(line," \t:");
-                    Molecules()->back().Frames().back().SetMaximumDisplacement(std::stod(tok.at(2)));
-                    return;
+        }
 
-                }
+        if ( line.find("RMS step") != std::string_view::npos )
+        {
+            Tokens tok ( line,separators );
+            frame.SetRMSDisplacement ( ToDouble ( tok.at ( 2 ) ) );
 
-            }
+        }
 
+        if ( line.find("MAX step") != std::string_view::npos )
+        {
+            Tokens tok ( line,separators );
+            frame.SetMaximumDisplacement ( ToDouble ( tok.at ( 2 ) ) );
+            return;
 
         }
+
     }
 }
 
@@ -202,19 +268,10 @@ bool OrcaParser::ParseOrbitals(std::streampos pos)
 {
     bool b = false;
 
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-    if (GetHomoLumo())
+    if (SeekSection(ELECTRONS,pos) && GetHomoLumo())
     {
-        m_file->clear();
-        m_file->seekg ( pos,std::ios::beg );
-        if (GetBasisCenters())
-        {
-            m_file->clear();
-            m_file->seekg ( pos,std::ios::beg );
-
-            b = GetOrbitalData();
-        }
+        if (SeekSection(BASIS,pos) && GetBasisCenters())
+            b = FindOrbitals(pos);
     }
 
     return b;
@@ -339,131 +396,142 @@ bool OrcaParser::GetBasisCenters()
     return false;
 }
 
-bool OrcaParser::GetOrbitalData()
+/** the orbitals printed after the coordinates of a frame belong to it, the last ones if there are several. Their
+    coefficients are read when they are first used, by a parser of the file that keeps the basis set*/
+bool OrcaParser::FindOrbitals(std::streampos pos)
 {
-    bool b =false;
-    int frame =0;
-    std::vector<Frame>::iterator ft = Molecules()->back().Frames().begin();
+    std::vector<Frame>& frames=Molecules()->back().Frames();
+    if ( frames.empty() ) return false;
+
+    std::shared_ptr<Parser> reader=OrbitalReader();
     size_t pt=0;
-    std::string line;
-    while ( std::getline(*m_file,line) )
+    bool b=false;
+    for ( const SectionIndex::Entry& e : Sections().Entries(ORBITALS) )
     {
-        if ( line.find ( "MOLECULAR ORBITALS" ) != std::string::npos )
-        {
-            while (!(pt==m_pos.size()-1))
-            {
-                if ( (m_file->tellg()>m_pos.at(pt)) && (m_file->tellg()<m_pos.at(pt+1)) )
-                    break;
-                else
-                {
-                    ++pt;
-                    ++ft;
-                    frame+=1;
-                }
-            }
+        if ( e.offset < pos ) continue;
+        while ( pt+1 < m_framepos.size() && pt+1 < frames.size() && e.offset >= m_framepos.at(pt+1) ) ++pt;
+        if ( reader )
+            SetSectionLoader(frames[pt],reader,Frame::ORBITALS,e.offset);
+        else
+            LoadSection(frames[pt],Frame::ORBITALS,e.offset);
+        b=true;
+    }
+    return b;
+}
 
-            D2Array<float> matrix;
-            std::vector<float> eigenvalues;
-            std::vector<float> occupations;
-            matrix.Initialize(m_norbitals,m_norbitals,0.0);
+std::shared_ptr<Parser> OrcaParser::OrbitalReader() const
+{
+    std::shared_ptr<OrcaParser> reader ( new OrcaParser ( static_cast<std::istream*> ( NULL ) ) );
+    if ( !reader->ShareText ( *this ) ) return std::shared_ptr<Parser>();
+    reader->m_homo=m_homo;
+    reader->m_lumo=m_lumo;
+    reader->m_norbitals=m_norbitals;
+    reader->m_atoms=m_atoms;
+    reader->m_orbitals=m_orbitals;
+    return reader;
+}
 
-            std::getline( *m_file,line );
-            std::getline( *m_file,line );
-            int K=0;
-            while ( !(line.empty()) )
-            {
-                StringTokenizer tokenSize ( line," " );
-                int M=tokenSize.size();
+void OrcaParser::LoadSection(Frame& frame, unsigned data, std::streamoff offset)
+{
+    if ( ( data & Frame::ORBITALS ) == 0 ) return;
+    m_file->clear();
+    m_file->seekg(offset,std::ios::beg);
+    std::string line;
+    std::getline(*m_file,line);
+    GetOrbitalData(frame);
+}
 
-                std::getline( *m_file,line );
-                StringTokenizer tokenEigenv ( line," " );
-                for (int e=0; e<M; e++)
-                {
-                    eigenvalues.push_back(atof(tokenEigenv.at(tokenEigenv.size()-M+e)));
-                }
-                std::getline( *m_file,line );
-                StringTokenizer tokenOcc ( line," " );
-                for (int e=0; e<M; e++)
-                {
-                    occupations.push_back(atof(tokenOcc.at(tokenOcc.size()-M+e)));
-                }
-                std::getline( *m_file,line );
-                for (int n=0; n<m_norbitals; n++)
-                {
-                    std::getline( *m_file,line );
-                    StringTokenizer tokenCoeff ( line," " );
-                    for (int m=0; m<M; m++)
-                    {
-                        matrix(n,K+m) = atof(tokenCoeff.at(tokenCoeff.size()-M+m));
-                        //qDebug() << "(" << n << "," << K+m << ") = " << atof(tokenCoeff.at(tokenCoeff.size()-M+m)) << endl;
-                    }
-                }
-                K += M;
-                std::getline( *m_file,line );
-            }
+bool OrcaParser::GetOrbitalData(Frame& frame)
+{
+    //the blocks of up to six orbitals are read in place from the text: their numbers, eigenvalues, occupations,
+    //a dashed line and the coefficients. The numbers are fields of 10 characters, that run together when full
+    const std::streamoff pos=m_file->tellg();
+    if ( pos < 0 ) return false;
+    LineReader reader ( Text(),static_cast<size_t> ( pos ) );
+    std::string_view line;
+    Tokens token;
+    D2Array<float> matrix;
+    std::vector<float> eigenvalues;
+    std::vector<float> occupations;
+    matrix.Initialize(m_norbitals,m_norbitals,0.0);
+
+    reader.Next ( line );
+    bool more=reader.Next ( line );
+    size_t K=0;
+    while ( more )
+    {
+        token.Assign ( line );
+        const size_t M=token.size();
+        if ( M == 0 || K+M > static_cast<size_t> ( m_norbitals ) || !reader.Next ( line ) ) break;
+        const FixedFields eigenvalue ( line,M,10 );
+        for ( size_t e=0;e<eigenvalue.size();++e )
+            eigenvalues.push_back ( ToDouble ( eigenvalue[e] ) );
+        if ( !reader.Next ( line ) ) break;
+        const FixedFields occupation ( line,M,10 );
+        for ( size_t e=0;e<occupation.size();++e )
+            occupations.push_back ( ToDouble ( occupation[e] ) );
+        reader.Skip();
+        for ( int n=0;n<m_norbitals && reader.Next ( line );n++ )
+        {
+            const FixedFields coefficient ( line,M,10 );
+            for ( size_t m=0;m<coefficient.size();++m )
+                matrix ( n,K+m ) =ToDouble ( coefficient[m] );
+        }
+        K+=M;
+        more=reader.Next ( line );
+    }
+    m_file->clear();
+    m_file->seekg ( reader.Offset(),std::ios::beg );
 
-            //Reorder the molecular orbitals coefficients
-            size_t orbital=0;
-            for (std::vector< std::vector<Orbital> >::iterator it=m_orbitals.begin(); it!=m_orbitals.end(); ++it)
+    //Reorder the molecular orbitals coefficients
+    size_t orbital=0;
+    for (std::vector< std::vector<Orbital> >::iterator it=m_orbitals.begin(); it!=m_orbitals.end(); ++it)
+    {
+        for (std::vector<Orbital>::iterator ot=(*it).begin(); ot!=(*it).end(); ++ot)
+        {
+            switch ((*ot).Type())
             {
-                for (std::vector<Orbital>::iterator ot=(*it).begin(); ot!=(*it).end(); ++ot)
-                {
-                    switch ((*ot).Type())
-                    {
-                        qDebug() << "Type: " << (*ot).Type() << endl;
-                    case Orbital::S:
-                        orbital = orbital+1;
-                        break;
-                    case Orbital::SP:
-                        matrix.SwapRows(orbital+1,orbital+2);
-                        matrix.SwapRows(orbital+2,orbital+3);
-                        orbital = orbital+4;
-                        break;
-                    case Orbital::P:
-                        matrix.SwapRows(orbital,orbital+1);
-                        matrix.SwapRows(orbital+1,orbital+2);
-                        orbital = orbital+3;
-                        break;
-                    case Orbital::D:
-                        orbital = orbital+5;
-                        break;
-                    case Orbital::F:
-                        orbital = orbital+7;
-                        break;
-                    }
-                }
+                qDebug() << "Type: " << (*ot).Type() << endl;
+            case Orbital::S:
+                orbital = orbital+1;
+                break;
+            case Orbital::SP:
+                matrix.SwapRows(orbital+1,orbital+2);
+                matrix.SwapRows(orbital+2,orbital+3);
+                orbital = orbital+4;
+                break;
+            case Orbital::P:
+                matrix.SwapRows(orbital,orbital+1);
+                matrix.SwapRows(orbital+1,orbital+2);
+                orbital = orbital+3;
+                break;
+            case Orbital::D:
+                orbital = orbital+5;
+                break;
+            case Orbital::F:
+                orbital = orbital+7;
+                break;
             }
-
-            std::vector<BasisCenter> basis;
-            for (size_t i=0; i<m_atoms.size(); ++i)
-                basis.push_back(BasisCenter(ft->XYZ().at(m_atoms.at(i)),m_orbitals.at(i)));
-            ft->OrbitalsData().SetHomo(m_homo);
-            ft->OrbitalsData().SetLumo(m_lumo);
-            ft->OrbitalsData().SetTypeD(5);
-            ft->OrbitalsData().SetTypeF(7);
-            ft->OrbitalsData().SetBasisCenters(basis);
-            ft->OrbitalsData().SetCoefficients(matrix);
-            ft->OrbitalsData().SetEigenvalues(eigenvalues);
-            ft->OrbitalsData().SetOccupations(occupations);
-            b = true;
-
-            ++pt;
-            ++ft;
-            frame+=1;
         }
     }
-    return b;
+
+    std::vector<BasisCenter> basis;
+    for (size_t i=0; i<m_atoms.size(); ++i)
+        basis.push_back(BasisCenter(frame.XYZ().at(m_atoms.at(i)),m_orbitals.at(i)));
+    frame.OrbitalsData().SetHomo(m_homo);
+    frame.OrbitalsData().SetLumo(m_lumo);
+    frame.OrbitalsData().SetTypeD(5);
+    frame.OrbitalsData().SetTypeF(7);
+    frame.OrbitalsData().SetBasisCenters(basis);
+    frame.OrbitalsData().SetCoefficients(matrix);
+    frame.OrbitalsData().SetEigenvalues(eigenvalues);
+    frame.OrbitalsData().SetOccupations(occupations);
+    return true;
 }
 
 bool OrcaParser::ExistOrbitals()
 {
-    std::string line;
-    while ( std::getline ( *m_file,line ))
-    {
-        if ( line.find("MOLECULAR ORBITALS") != std::string::npos )
-            return true;
-    }
-    return false;
+    return Sections().Find(ORBITALS,m_file->tellg()) >= 0;
 }
 
 bool OrcaParser::GetHomoLumo()
@@ -483,34 +551,32 @@ bool OrcaParser::GetHomoLumo()
     return false;
 }
 
+bool OrcaParser::IsRunning()
+{
+    return !LastJobWrites ( { "ORCA TERMINATED NORMALLY","error termination","aborting the run" } );
+}
+
 std::vector<JobHeader>& OrcaParser::Jobs()
 {
     std::string line;
-    m_file->clear();
-    m_file->seekg(0);
-    std::streampos pos=m_file->tellg();
-
-
-    while(std::getline(*m_file,line) )
+    const SectionIndex& index=Sections();
+    //the jobs begin after their banners, the optimizations before the first single point
+    std::streamoff single=index.Find ( SINGLEPOINTRUN,0 );
+    const std::vector<SectionIndex::Entry>& runs=index.Entries ( OPTIMIZATIONRUN );
+    for ( std::vector<SectionIndex::Entry>::const_iterator it=runs.begin();it!=runs.end();++it )
     {
-        if ( line.find("* Geometry Optimization Run *") != std::string::npos
-            || line.find("*    Relaxed Surface Scan    *") != std::string::npos )
-        {
-            pos=m_file->tellg();
-            m_jobpos.push_back(JobHeader(opt,pos));
-        }
-
-        //if ( line.find("*     ORCA property calculations      *") != std::string::npos )
-        if ( line.find("* Single Point Calculation *") != std::string::npos ||
-            line.find("*     ORCA property calculations      *") != std::string::npos ||
-            /** Orca 6*/
-            line.find("ORCA PROPERTY CALCULATIONS") != std::string::npos ||
-            line.find("Energy+Gradient Calculation")!= std::string::npos )
-        {
-            pos=m_file->tellg();
-            m_jobpos.push_back(JobHeader(singlepoint,pos));
-            break;
-        }
+        if ( single >= 0 && it->offset > single ) break;
+        m_file->clear();
+        m_file->seekg ( it->offset );
+        std::getline ( *m_file,line );
+        m_jobpos.push_back(JobHeader(opt,m_file->tellg()));
+    }
+    if ( single >= 0 )
+    {
+        m_file->clear();
+        m_file->seekg ( single );
+        std::getline ( *m_file,line );
+        m_jobpos.push_back(JobHeader(singlepoint,m_file->tellg()));
     }
 
     //just one job
@@ -523,30 +589,13 @@ std::vector<JobHeader>& OrcaParser::Jobs()
     {
         if ( it->type == singlepoint )
         {
-            m_file->clear();
-            m_file->seekg(it->pos);
-            while(std::getline(*m_file,line) )
-            {
-                bool bfound=false;
-
-
-                if ( line.find("TD-DFT/TDA EXCITED STATES") != std::string::npos
-                    || line.find("TD-DFT EXCITED STATES") != std::string::npos  )
-                {
-                    it->type=uv;
-                    bfound=true;
-                }
-
-                if ( line.find("ORCA NUMERICAL FREQUENCIES") != std::string::npos ||
-                     line.find("ORCA SCF HESSIAN") != std::string::npos ||
-                     //Orca 6.0
-                     line.find("SCF HESSIAN") != std::string::npos )
-                {
-                    it->type=freq;
-                    bfound=true;
-                }
-                if ( bfound ) break;
-            }
+            //the first of the excited states or the hessian sets the type
+            std::streamoff uvpos=index.Find ( EXCITEDSTATES,it->pos );
+            std::streamoff freqpos=index.Find ( HESSIAN,it->pos );
+            if ( freqpos >= 0 && ( uvpos < 0 || freqpos <= uvpos ) )
+                it->type=freq;
+            else if ( uvpos >= 0 )
+                it->type=uv;
         }
 
     }
@@ -556,16 +605,12 @@ std::vector<JobHeader>& OrcaParser::Jobs()
 
 bool OrcaParser::ParseFrequencies ( std::streampos pos )
 {
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
+    SeekSection ( FREQUENCIES,pos );
     if ( !GetFrequencies() ) return false;
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
-
     Molecule& molecule=Molecules()->back();
     molecule.Frames().back().AllocateVectors(true);
 
-    GetNormalModes();
+    GetNormalModes(pos);
 
     /*m_file->clear();
     m_file->seekg ( pos,std::ios::beg );
@@ -682,71 +727,41 @@ bool OrcaParser::GetFrequencies()
 
 }
 
-bool OrcaParser::GetNormalModes()
-{
-    bool modesfound=false;
-    std::string line;
-    while(std::getline(*m_file,line))
-    {
-        if (line.find("NORMAL MODES") != std::string::npos ) modesfound=true;
-        if ( modesfound == true ) break;
-    }
-    if ( modesfound == false ) return false;
-
-    while(std::getline(*m_file,line))
-    {
-        StringTokenizer tok(line," \t\r");
-        if ( !tok.empty() )
-        {
-            if ( kryomol::isinteger(tok.front() )  )
-            {
-                if ( GetNormalModeBlock(tok) ) break;
-            }
-        }
-    }
-
-    return true;
-
-}
-
-bool OrcaParser::GetNormalModeBlock(StringTokenizer& headertok)
+bool OrcaParser::GetNormalModes(std::streampos pos)
 {
-    Molecule& molecule=Molecules()->back();
-    std::vector< std::vector<Coordinate> >& modes = molecule.GetMode();
-    std::string line;
-    size_t firstmode=std::stoi(headertok.front());
-    size_t lastmode=std::stoi(headertok.back());
-    std::streampos pos=m_file->tellg();
-    while(std::getline(*m_file,line))
-    {
-        StringTokenizer tok(line," \t\r");
+    const std::streamoff start=Sections().Find ( NORMALMODES,pos );
+    if ( start < 0 ) return false;
+    NormalModes& modes=Molecules()->back().Modes();
+
+    //blocks of up to six modes, a header with the numbers of the modes followed by a row for each cartesian
+    //coordinate, until the blank line after the last block
+    LineReader reader ( Text(),static_cast<size_t> ( start ) );
+    std::string_view line;
+    Tokens tok;
+    bool inblock=false;
+    size_t firstmode=0;
+    while ( reader.Next ( line ) )
+    {
+        tok.Assign ( line );
         if ( tok.empty() )
         {
-            m_file->clear();
-            m_file->seekg(pos);
-            return true;
-        }
-        if ( kryomol::isinteger(tok.back()))
-        {
-            m_file->clear();
-            m_file->seekg(pos);
-            return false;
+            if ( inblock ) break;
+            continue;
         }
-
-        pos=m_file->tellg();
-        int cnumber=std::stoi(tok.front());
-        int cidx=cnumber/3;
-        int cmod=cnumber % 3;
-        size_t tidx=0;
-        for(size_t i=firstmode;i<=lastmode;++i)
+        if ( IsInteger ( tok.front() ) && IsInteger ( tok.back() ) )
         {
-
-            D1Array<float>& dc=modes.at(i).at(cidx);
-            dc(cmod)=std::stof(tok.at(++tidx));
+            inblock=true;
+            firstmode=ToInt ( tok.front() );
+            continue;
         }
+        if ( !inblock ) continue;
 
+        const size_t cnumber=ToInt ( tok.front() );
+        if ( cnumber >= 3*modes.NAtoms() ) return false;
+        for ( size_t i=1;i<tok.size() && firstmode+i-1<modes.Size();++i )
+            modes ( firstmode+i-1,cnumber ) =ToDouble ( tok[i] );
     }
-    return false;
+    return inblock;
 }
 
 
@@ -840,8 +855,7 @@ void OrcaParser::ParseSolventShiftBlock(std::vector<Spectralline>& lines)
 
 bool OrcaParser::ParseUV ( std::streampos pos )
 {
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
+    SeekSection ( UVSPECTRUM,pos );
     std::string line;
     Molecule& molecule=Molecules()->back();
     std::vector<Spectralline>& lines=molecule.Frames().back().GetSpectralLines();
@@ -895,8 +909,7 @@ bool OrcaParser::ParseUV ( std::streampos pos )
 
     }
 
-    m_file->clear();
-    m_file->seekg ( pos,std::ios::beg );
+    SeekSection ( SOLVENTSHIFTS,pos );
     //I think this was probably a Orca4 thing for TD-DFT and it is no longer present in Orca5 or Orca6 save for %mdci computations
     while(std::getline(*m_file,line))
     {
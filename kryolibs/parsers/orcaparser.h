@@ -13,6 +13,7 @@ the Free Software Foundation version 2 of the License.
 #define ORCAPARSER_H
 
 #include <fstream>
+#include <memory>
 #include <vector>
 
 #include "parser.h"
@@ -31,25 +32,43 @@ public:
   ~OrcaParser();
   bool ParseFile(std::streampos pos=0);
   std::vector<JobHeader>& Jobs();
+  bool IsRunning();
   bool ParseUV(std::streampos pos=0);
   bool ParseFrequencies(std::streampos pos=0);
+protected:
+  void DefineSections(SectionIndex& index);
+  void ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& block);
+  size_t FrameCount() const { return m_framepos.size(); }
+  void FindAppendedFrames();
+  void LoadSection(Frame& frame, unsigned data, std::streamoff offset);
 private:
+  /** sections recorded in the index of the file*/
+  enum section { OPTIMIZATIONRUN, SINGLEPOINTRUN, EXCITEDSTATES, HESSIAN, COORDINATES, JOBNUMBER, ENERGY, CONVERGENCE,
+                 ELECTRONS, BASIS, ORBITALS, UVSPECTRUM, SOLVENTSHIFTS, FREQUENCIES, NORMALMODES };
   bool ParseOrbitals(std::streampos pos);
   bool GetGeometry();
+  /** add the positions of the coordinates of the current job from @param from to the frames*/
+  void GetFramePositions(std::streamoff from);
   bool ExistOrbitals();
-  bool GetOrbitalData();
+  /** give the frames of the current job from @param pos on their orbitals, read on first use if possible*/
+  bool FindOrbitals(std::streampos pos);
+  /** @return a parser with the basis set of this one that reads the orbitals of the frames, sharing the text
+      of the file with this one (@see ShareText), NULL if the parser does not read a mapped file*/
+  std::shared_ptr<Parser> OrbitalReader() const;
+  /** read the orbitals that follow the header line just read into @param frame*/
+  bool GetOrbitalData(Frame& frame);
   bool GetBasisCenters();
   bool GetHomoLumo();
-  void GetEnergyForFrame();
-  void GetGradientForFrame();
+  std::streamoff GetEnergyForFrame(std::string_view text, std::streamoff from, FrameBlock& block);
+  void GetGradientForFrame(std::string_view text, std::streamoff from, Frame& frame);
   void ParseUVLengthBlock(std::vector<Spectralline>& lines);
   void ParseUVVelocityBlock(std::vector<Spectralline>& lines);
   void ParseCDLengthBlock(std::vector<Spectralline>& lines);
   void ParseCDVelocityBlock(std::vector<Spectralline>& lines);
   void ParseSolventShiftBlock(std::vector<Spectralline>& lines);
   bool GetFrequencies();
-  bool GetNormalModes();
-  bool GetNormalModeBlock(StringTokenizer& headertok);
+  /** read the normal modes of the job at @param pos in a single pass*/
+  bool GetNormalModes(std::streampos pos);
 
 
 private:
@@ -57,6 +76,9 @@ private:
   int m_lumo;
   int m_norbitals;
   std::vector<std::streampos> m_pos;
+  /** beginning of the job parsed and positions of the coordinates of all its frames, kept to follow the job*/
+  std::streamoff m_jobbegin;
+  std::vector<std::streampos> m_framepos;
   std::vector<size_t> m_atoms;
   std::vector< std::vector<Orbital> > m_orbitals;
   std::vector < std::string > m_jobkeys;
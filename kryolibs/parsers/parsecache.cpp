@@ -0,0 +1,669 @@
+/*****************************************************************************************
+                            parsecache.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "parsecache.h"
+#include "mappedfile.h"
+#include "frameloader.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+const uint32_t ParseCache::version=3;
+
+namespace
+{
+  const char magic[8]={'K','R','Y','O','C','A','C','H'};
+  /** written in the native byte order, an entry from a machine with another one is discarded*/
+  const uint32_t byteorder=0x01020304;
+
+  /** FNV-1a over 64 bit words, mixed after each word, and the remaining bytes*/
+  uint64_t Hash ( const char* data, size_t size )
+  {
+    const uint64_t prime=1099511628211ULL;
+    uint64_t h=14695981039346656037ULL^size;
+    size_t i=0;
+    for ( ;i+sizeof ( uint64_t ) <= size;i+=sizeof ( uint64_t ) )
+    {
+      uint64_t w;
+      std::memcpy ( &w,data+i,sizeof ( w ) );
+      h= ( h^w ) *prime;
+      h^=h>>29;
+    }
+    for ( ;i<size;++i )
+      h= ( h^static_cast<unsigned char> ( data[i] ) ) *prime;
+    return h;
+  }
+
+  /** @return the hash of the contents of the file at @param path, given in UTF-8, 0 if it can not be read*/
+  uint64_t HashFile ( const std::string& path )
+  {
+    MappedFile map ( path );
+    if ( !map.IsOpen() ) return 0;
+    return Hash ( map.Data(),map.Size() );
+  }
+
+  /** @brief appends the binary representation of values to a buffer*/
+  class Writer
+  {
+    public:
+      template<class T> void Put ( const T& v )
+      {
+        static_assert ( std::is_trivially_copyable<T>::value,"only plain values are written directly" );
+        m_buffer.append ( reinterpret_cast<const char*> ( &v ),sizeof ( T ) );
+      }
+      template<class T> void PutArray ( const T* data, size_t n )
+      {
+        static_assert ( std::is_trivially_copyable<T>::value,"only plain values are written directly" );
+        Put<uint64_t> ( n );
+        if ( n > 0 ) m_buffer.append ( reinterpret_cast<const char*> ( data ),n*sizeof ( T ) );
+      }
+      template<class T> void PutVector ( const std::vector<T>& v ) { PutArray ( v.data(),v.size() ); }
+      template<class T> void PutD1Array ( const D1Array<T>& a )
+      {
+        PutArray ( static_cast<const T*> ( a ),a.size() );
+      }
+      template<class T> void PutD2Array ( const D2Array<T>& a )
+      {
+        Put<uint64_t> ( a.NRows() );
+        PutArray ( static_cast<const T*> ( a ),a.NRows() *a.NColumns() );
+      }
+      void PutString ( const std::string& s ) { PutArray ( s.data(),s.size() ); }
+      void PutCoordinate ( const Coordinate& c ) { Put ( c.x() ); Put ( c.y() ); Put ( c.z() ); }
+      void PutCoordinates ( const std::vector<Coordinate>& v )
+      {
+        Put<uint64_t> ( v.size() );
+        for ( std::vector<Coordinate>::const_iterator it=v.begin();it!=v.end();++it ) PutCoordinate ( *it );
+      }
+      const std::string& Buffer() const { return m_buffer; }
+    private:
+      std::string m_buffer;
+  };
+
+  /** @brief reads the values written by a Writer, a truncated entry throws kryomol::Exception*/
+  class Reader
+  {
+    public:
+      explicit Reader ( std::string_view data ) : m_data ( data ), m_pos ( 0 ) {}
+      bool AtEnd() const { return m_pos == m_data.size(); }
+      template<class T> T Get()
+      {
+        T v;
+        std::memcpy ( &v,Take ( sizeof ( T ) ),sizeof ( T ) );
+        return v;
+      }
+      /** @return the number of elements of an array of @param size bytes each*/
+      size_t GetCount ( size_t size )
+      {
+        const uint64_t n=Get<uint64_t>();
+        if ( n > ( m_data.size()-m_pos ) /size ) throw kryomol::Exception ( "truncated cache entry" );
+        return static_cast<size_t> ( n );
+      }
+      /** skip a string written by Writer::PutString @return its offset in the data and its @param size*/
+      size_t SkipString ( size_t& size )
+      {
+        size=GetCount ( 1 );
+        return static_cast<size_t> ( Take ( size )-m_data.data() );
+      }
+      template<class T> void GetVector ( std::vector<T>& v )
+      {
+        const size_t n=GetCount ( sizeof ( T ) );
+        v.resize ( n );
+        if ( n > 0 ) std::memcpy ( v.data(),Take ( n*sizeof ( T ) ),n*sizeof ( T ) );
+      }
+      template<class T> void GetD1Array ( D1Array<T>& a )
+      {
+        const size_t n=GetCount ( sizeof ( T ) );
+        a.Clear();
+        if ( n == 0 ) return;
+        a.Initialize ( n );
+        std::memcpy ( static_cast<T*> ( a ),Take ( n*sizeof ( T ) ),n*sizeof ( T ) );
+      }
+      template<class T> void GetD2Array ( D2Array<T>& a )
+      {
+        const size_t rows=static_cast<size_t> ( Get<uint64_t>() );
+        const size_t n=GetCount ( sizeof ( T ) );
+        a.Clear();
+        if ( n == 0 ) return;
+        if ( rows == 0 || n%rows != 0 ) throw kryomol::Exception ( "corrupted cache entry" );
+        a.Initialize ( rows,n/rows );
+        std::memcpy ( static_cast<T*> ( a ),Take ( n*sizeof ( T ) ),n*sizeof ( T ) );
+      }
+      std::string GetString()
+      {
+        const size_t n=GetCount ( 1 );
+        return std::string ( Take ( n ),n );
+      }
+      Coordinate GetCoordinate()
+      {
+        const float x=Get<float>();
+        const float y=Get<float>();
+        const float z=Get<float>();
+        return Coordinate ( x,y,z );
+      }
+      void GetCoordinates ( std::vector<Coordinate>& v )
+      {
+        const size_t n=GetCount ( 3*sizeof ( float ) );
+        v.clear();
+        v.reserve ( n );
+        for ( size_t i=0;i<n;++i ) v.push_back ( GetCoordinate() );
+      }
+    private:
+      const char* Take ( size_t n )
+      {
+        if ( n > m_data.size()-m_pos ) throw kryomol::Exception ( "truncated cache entry" );
+        const char* p=m_data.data() +m_pos;
+        m_pos+=n;
+        return p;
+      }
+    private:
+      std::string_view m_data;
+      size_t m_pos;
+  };
+
+  void WriteBonds ( Writer& w, const std::vector<Bond>& bonds )
+  {
+    w.Put<uint64_t> ( bonds.size() );
+    for ( std::vector<Bond>::const_iterator it=bonds.begin();it!=bonds.end();++it )
+    {
+      w.Put<uint64_t> ( it->I() );
+      w.Put<uint64_t> ( it->J() );
+      w.Put<int32_t> ( it->Order() );
+    }
+  }
+
+  void ReadBonds ( Reader& r, std::vector<Bond>& bonds )
+  {
+    const size_t n=r.GetCount ( 2*sizeof ( uint64_t ) +sizeof ( int32_t ) );
+    bonds.clear();
+    bonds.reserve ( n );
+    for ( size_t i=0;i<n;++i )
+    {
+      const size_t a=static_cast<size_t> ( r.Get<uint64_t>() );
+      const size_t b=static_cast<size_t> ( r.Get<uint64_t>() );
+      bonds.push_back ( Bond ( a,b,static_cast<Bond::order> ( r.Get<int32_t>() ) ) );
+    }
+  }
+
+  /** energies are optional, only the set ones are stored*/
+  void WriteEnergy ( Writer& w, const Energy& e )
+  {
+    w.Put<uint8_t> ( e ? 1 : 0 );
+    if ( !e ) return;
+    w.Put<double> ( e.Value() );
+    w.Put<int32_t> ( e.Units() );
+  }
+
+  void ReadEnergy ( Reader& r, Energy& e )
+  {
+    if ( r.Get<uint8_t>() == 0 ) return;
+    const double value=r.Get<double>();
+    e=Energy ( value,static_cast<Energy::unit> ( r.Get<int32_t>() ) );
+  }
+
+  void WriteOrbitals ( Writer& w, const std::vector<Orbital>& orbitals )
+  {
+    w.Put<uint64_t> ( orbitals.size() );
+    for ( std::vector<Orbital>::const_iterator it=orbitals.begin();it!=orbitals.end();++it )
+    {
+      w.Put<int32_t> ( it->Type() );
+      w.PutVector ( it->Alpha() );
+      w.PutVector ( it->Xs() );
+      w.PutVector ( it->Xp() );
+    }
+  }
+
+  void ReadOrbitals ( Reader& r, std::vector<Orbital>& orbitals )
+  {
+    const size_t n=r.GetCount ( sizeof ( int32_t ) );
+    orbitals.clear();
+    orbitals.reserve ( n );
+    for ( size_t i=0;i<n;++i )
+    {
+      const Orbital::OrbitalType type=static_cast<Orbital::OrbitalType> ( r.Get<int32_t>() );
+      std::vector<float> alpha,xs,xp;
+      r.GetVector ( alpha );
+      r.GetVector ( xs );
+      r.GetVector ( xp );
+      orbitals.push_back ( Orbital ( type,alpha,xs,xp ) );
+    }
+  }
+
+  void WriteOrbitalData ( Writer& w, const OrbitalData& data )
+  {
+    w.Put<int32_t> ( data.Homo() );
+    w.Put<int32_t> ( data.Lumo() );
+    w.Put<int32_t> ( data.TypeD() );
+    w.Put<int32_t> ( data.TypeF() );
+    w.PutD2Array ( data.Coefficients() );
+    w.PutVector ( data.Eigenvalues() );
+    w.PutVector ( data.Occupations() );
+    w.PutD2Array ( data.BetaCoefficients() );
+    w.PutVector ( data.BetaEigenvalues() );
+    WriteOrbitals ( w,data.Orbitals() );
+    w.Put<uint64_t> ( data.BasisCenters().size() );
+    for ( std::vector<BasisCenter>::const_iterator it=data.BasisCenters().begin();it!=data.BasisCenters().end();++it )
+    {
+      w.PutCoordinate ( it->Atom() );
+      WriteOrbitals ( w,it->Orbitals() );
+    }
+  }
+
+  void ReadOrbitalData ( Reader& r, OrbitalData& data )
+  {
+    data.SetHomo ( r.Get<int32_t>() );
+    data.SetLumo ( r.Get<int32_t>() );
+    data.SetTypeD ( r.Get<int32_t>() );
+    data.SetTypeF ( r.Get<int32_t>() );
+    r.GetD2Array ( data.Coefficients() );
+    r.GetVector ( data.Eigenvalues() );
+    r.GetVector ( data.Occupations() );
+    r.GetD2Array ( data.BetaCoefficients() );
+    r.GetVector ( data.BetaEigenvalues() );
+    ReadOrbitals ( r,data.Orbitals() );
+    const size_t n=r.GetCount ( 3*sizeof ( float ) +sizeof ( uint64_t ) );
+    std::vector<BasisCenter>& centers=data.BasisCenters();
+    centers.assign ( n,BasisCenter() );
+    for ( size_t i=0;i<n;++i )
+    {
+      centers[i].Atom() =r.GetCoordinate();
+      ReadOrbitals ( r,centers[i].Orbitals() );
+    }
+  }
+
+  /** @brief decodes the orbitals of a frame read from an entry the first time they are used
+
+  The entry stays mapped while the frames of the molecules read from it share the loader*/
+  class OrbitalLoader : public FrameLoader
+  {
+    public:
+      OrbitalLoader ( const std::shared_ptr<MappedFile>& entry, size_t offset, size_t size ) :
+        m_entry ( entry ), m_offset ( offset ), m_size ( size ) {}
+      void Load ( Frame& frame, unsigned data )
+      {
+        if ( ( data & Frame::ORBITALS ) == 0 ) return;
+        Reader r ( m_entry->Text().substr ( m_offset,m_size ) );
+        ReadOrbitalData ( r,frame.OrbitalsData() );
+      }
+    private:
+      std::shared_ptr<MappedFile> m_entry;
+      size_t m_offset;
+      size_t m_size;
+  };
+
+  void WriteSpectralLines ( Writer& w, const std::vector<Spectralline>& lines )
+  {
+    w.Put<uint64_t> ( lines.size() );
+    for ( std::vector<Spectralline>::const_iterator it=lines.begin();it!=lines.end();++it )
+    {
+      w.Put ( it->x );
+      w.Put ( it->y0 );
+      w.Put ( it->y1 );
+      w.Put ( it->y2 );
+      w.Put ( it->y3 );
+      w.PutCoordinate ( it->ElectricDipole() );
+      w.PutCoordinate ( it->VelocityDipole() );
+      w.PutCoordinate ( it->MagneticDipole() );
+      w.Put ( it->RotatoryStrengthLength() );
+      w.Put ( it->RotatoryStrengthVelocity() );
+      w.Put ( it->SolventShift() );
+      w.PutVector ( it->Coefficient() );
+      w.PutVector ( it->OrbitalI() );
+      w.PutVector ( it->OrbitalJ() );
+    }
+  }
+
+  void ReadSpectralLines ( Reader& r, std::vector<Spectralline>& lines )
+  {
+    const size_t n=r.GetCount ( 17*sizeof ( float ) );
+    lines.assign ( n,Spectralline() );
+    for ( std::vector<Spectralline>::iterator it=lines.begin();it!=lines.end();++it )
+    {
+      it->x=r.Get<float>();
+      it->y0=r.Get<float>();
+      it->y1=r.Get<float>();
+      it->y2=r.Get<float>();
+      it->y3=r.Get<float>();
+      it->ElectricDipole() =r.GetCoordinate();
+      it->VelocityDipole() =r.GetCoordinate();
+      it->MagneticDipole() =r.GetCoordinate();
+      it->SetRotatoryStrengthLength ( r.Get<float>() );
+      it->SetRotatoryStrengthVelocity ( r.Get<float>() );
+      it->SetSolventShift ( r.Get<float>() );
+      std::vector<float> coefficient;
+      r.GetVector ( coefficient );
+      it->SetCoefficient ( coefficient );
+      std::vector<int> orbitals;
+      r.GetVector ( orbitals );
+      it->SetOrbitalI ( orbitals );
+      r.GetVector ( orbitals );
+      it->SetOrbitalJ ( orbitals );
+    }
+  }
+
+  void WriteTransitionChanges ( Writer& w, const std::vector< std::vector<TransitionChange> >& transitions )
+  {
+    w.Put<uint64_t> ( transitions.size() );
+    for ( std::vector< std::vector<TransitionChange> >::const_iterator it=transitions.begin();it!=transitions.end();++it )
+    {
+      w.Put<uint64_t> ( it->size() );
+      for ( std::vector<TransitionChange>::const_iterator jt=it->begin();jt!=it->end();++jt )
+      {
+        w.Put<int32_t> ( jt->OrbitalI() );
+        w.Put<int32_t> ( jt->OrbitalJ() );
+        w.PutString ( jt->OrbitalSI() );
+        w.PutString ( jt->OrbitalSJ() );
+        w.Put<float> ( jt->Coefficient() );
+      }
+    }
+  }
+
+  void ReadTransitionChanges ( Reader& r, std::vector< std::vector<TransitionChange> >& transitions )
+  {
+    transitions.resize ( r.GetCount ( sizeof ( uint64_t ) ) );
+    for ( std::vector< std::vector<TransitionChange> >::iterator it=transitions.begin();it!=transitions.end();++it )
+    {
+      const size_t n=r.GetCount ( 2*sizeof ( int32_t ) +2*sizeof ( uint64_t ) +sizeof ( float ) );
+      it->reserve ( n );
+      for ( size_t j=0;j<n;++j )
+      {
+        const int i=r.Get<int32_t>();
+        const int k=r.Get<int32_t>();
+        const std::string si=r.GetString();
+        const std::string sk=r.GetString();
+        it->push_back ( TransitionChange ( i,k,r.Get<float>() ) );
+        it->back().OrbitalSI() =si;
+        it->back().OrbitalSJ() =sk;
+      }
+    }
+  }
+
+  void WriteFrame ( Writer& w, const Frame& frame )
+  {
+    w.PutCoordinates ( frame.XYZ() );
+    w.PutCoordinates ( frame.Gradient() );
+    WriteBonds ( w,frame.Bonds() );
+    WriteEnergy ( w,frame.KineticEnergy() );
+    WriteEnergy ( w,frame.PotentialEnergy() );
+    WriteEnergy ( w,frame.RMSForce() );
+    w.Put ( frame.GetMaximumForce() );
+    w.Put ( frame.GetRMSDisplacement() );
+    w.Put ( frame.GetMaximumDisplacement() );
+    w.Put ( frame.GetS2() );
+    w.Put ( frame.GetThreshold() );
+    w.PutCoordinate ( frame.GetDipole() );
+    w.PutVector ( *frame.Charges ( Frame::ESP ) );
+    w.PutVector ( frame.GetFrequencies() );
+    WriteSpectralLines ( w,frame.GetSpectralLines() );
+    WriteTransitionChanges ( w,frame.TransitionChanges() );
+    w.PutD1Array ( frame.GetForces() );
+    w.PutD2Array ( frame.GetHessian() );
+    w.Put<uint64_t> ( frame.CShiftTensors().size() );
+    for ( std::vector< D2Array<double> >::const_iterator it=frame.CShiftTensors().begin();it!=frame.CShiftTensors().end();++it )
+      w.PutD2Array ( *it );
+    float h,s,l;
+    frame.GetColor ( h,s,l );
+    w.Put ( h );
+    w.Put ( s );
+    w.Put ( l );
+    w.Put<uint8_t> ( frame.HasOrbitals() ? 1 : 0 );
+    //the orbitals are written as a block of their own, so a reader can skip them
+    Writer orbitals;
+    WriteOrbitalData ( orbitals,frame.OrbitalsData() );
+    w.PutString ( orbitals.Buffer() );
+  }
+
+  /** the orbitals, the largest part of an entry, are decoded from the mapped @param entry when they are used*/
+  void ReadFrame ( Reader& r, Frame& frame, const std::shared_ptr<MappedFile>& entry )
+  {
+    r.GetCoordinates ( frame.XYZ() );
+    r.GetCoordinates ( frame.Gradient() );
+    ReadBonds ( r,frame.Bonds() );
+    ReadEnergy ( r,frame.KineticEnergy() );
+    ReadEnergy ( r,frame.PotentialEnergy() );
+    ReadEnergy ( r,frame.RMSForce() );
+    frame.SetMaximumForce ( r.Get<double>() );
+    frame.SetRMSDisplacement ( r.Get<double>() );
+    frame.SetMaximumDisplacement ( r.Get<double>() );
+    frame.SetS2 ( r.Get<double>() );
+    frame.SetThreshold ( r.Get<Threshold>() );
+    frame.SetDipole ( r.GetCoordinate() );
+    r.GetVector ( *frame.Charges ( Frame::ESP ) );
+    r.GetVector ( frame.GetFrequencies() );
+    ReadSpectralLines ( r,frame.GetSpectralLines() );
+    ReadTransitionChanges ( r,frame.TransitionChanges() );
+    r.GetD1Array ( frame.GetForces() );
+    r.GetD2Array ( frame.GetHessian() );
+    frame.CShiftTensors().resize ( r.GetCount ( 2*sizeof ( uint64_t ) ) );
+    for ( std::vector< D2Array<double> >::iterator it=frame.CShiftTensors().begin();it!=frame.CShiftTensors().end();++it )
+      r.GetD2Array ( *it );
+    const float h=r.Get<float>();
+    const float s=r.Get<float>();
+    const float l=r.Get<float>();
+    frame.SetColor ( h,s,l );
+    frame.SetHasOrbitals ( r.Get<uint8_t>() != 0 );
+    size_t size=0;
+    const size_t offset=r.SkipString ( size );
+    frame.SetLoader ( new OrbitalLoader ( entry,offset,size ),Frame::ORBITALS );
+  }
+
+  void WriteMolecule ( Writer& w, const Molecule& molecule )
+  {
+    w.PutString ( molecule.GetEnergyLevel() );
+    w.Put<uint64_t> ( molecule.Atoms().size() );
+    for ( std::vector<Atom>::const_iterator it=molecule.Atoms().begin();it!=molecule.Atoms().end();++it )
+      w.PutString ( it->Symbol() );
+    WriteBonds ( w,molecule.Bonds() );
+    w.PutVector ( molecule.Populations() );
+    w.PutCoordinates ( molecule.InputOrientation() );
+    w.Put<uint64_t> ( molecule.Modes().NAtoms() );
+    w.PutVector ( molecule.Modes().Data() );
+    w.Put<uint64_t> ( molecule.GetCouplings().size() );
+    for ( std::vector<Molecule::Coupling>::const_iterator it=molecule.GetCouplings().begin();it!=molecule.GetCouplings().end();++it )
+    {
+      w.Put<uint64_t> ( it->I() );
+      w.Put<uint64_t> ( it->J() );
+      w.Put<double> ( it->Value() );
+    }
+    w.Put<uint64_t> ( molecule.Frames().size() );
+    for ( std::vector<Frame>::const_iterator it=molecule.Frames().begin();it!=molecule.Frames().end();++it )
+      WriteFrame ( w,*it );
+    w.Put<uint64_t> ( molecule.Frames().empty() ? 0 : molecule.CurrentFrameIndex() );
+  }
+
+  void ReadMolecule ( Reader& r, Molecule& molecule, const std::shared_ptr<MappedFile>& entry )
+  {
+    molecule.SetEnergyLevel ( r.GetString() );
+    const size_t natoms=r.GetCount ( sizeof ( uint64_t ) );
+    molecule.Atoms().reserve ( natoms );
+    for ( size_t i=0;i<natoms;++i )
+      molecule.Atoms().push_back ( Atom ( r.GetString() ) );
+    ReadBonds ( r,molecule.Bonds() );
+    r.GetVector ( molecule.Populations() );
+    r.GetCoordinates ( molecule.InputOrientation() );
+    const size_t nmodeatoms=static_cast<size_t> ( r.Get<uint64_t>() );
+    std::vector<float> displacements;
+    r.GetVector ( displacements );
+    if ( nmodeatoms > 0 && !displacements.empty() )
+    {
+      if ( displacements.size() % ( 3*nmodeatoms ) != 0 ) throw kryomol::Exception ( "corrupted cache entry" );
+      molecule.Modes().Initialize ( 0,nmodeatoms );
+      molecule.Modes().Data().swap ( displacements );
+    }
+    const size_t ncouplings=r.GetCount ( 2*sizeof ( uint64_t ) +sizeof ( double ) );
+    for ( size_t i=0;i<ncouplings;++i )
+    {
+      const size_t a=static_cast<size_t> ( r.Get<uint64_t>() );
+      const size_t b=static_cast<size_t> ( r.Get<uint64_t>() );
+      molecule.GetCouplings().push_back ( Molecule::Coupling ( a,b,r.Get<double>() ) );
+    }
+    const size_t nframes=r.GetCount ( sizeof ( uint64_t ) );
+    molecule.Frames().reserve ( nframes );
+    for ( size_t i=0;i<nframes;++i )
+    {
+      molecule.Frames().push_back ( Frame ( &molecule ) );
+      ReadFrame ( r,molecule.Frames().back(),entry );
+    }
+    const size_t current=static_cast<size_t> ( r.Get<uint64_t>() );
+    if ( current < nframes ) molecule.SetCurrentFrame ( current );
+  }
+
+  void WriteKey ( Writer& w, const ParseCache::Key& key, JobType type, unsigned flags )
+  {
+    w.PutArray ( magic,sizeof ( magic ) );
+    w.Put<uint32_t> ( ParseCache::version );
+    w.Put<uint32_t> ( byteorder );
+    w.Put<int32_t> ( type );
+    w.PutString ( key.path );
+    w.Put<int64_t> ( key.size );
+    w.Put<int64_t> ( key.mtime );
+    w.Put<uint64_t> ( key.hash );
+    w.Put<uint32_t> ( flags );
+  }
+
+  /** @return true if the entry read by @param r was written for the file of @param key, with its size and
+      modification time, in the current format. The @param hash of the contents of the file when the entry
+      was written is returned to be checked by the caller*/
+  bool ReadKey ( Reader& r, const ParseCache::Key& key, JobType type, unsigned& flags, uint64_t& hash )
+  {
+    const size_t n=r.GetCount ( 1 );
+    char m[sizeof ( magic )];
+    if ( n != sizeof ( magic ) ) return false;
+    for ( size_t i=0;i<n;++i ) m[i]=r.Get<char>();
+    if ( std::memcmp ( m,magic,sizeof ( magic ) ) != 0 ) return false;
+    if ( r.Get<uint32_t>() != ParseCache::version ) return false;
+    if ( r.Get<uint32_t>() != byteorder ) return false;
+    if ( r.Get<int32_t>() != type ) return false;
+    if ( r.GetString() != key.path ) return false;
+    if ( r.Get<int64_t>() != key.size ) return false;
+    if ( r.Get<int64_t>() != key.mtime ) return false;
+    hash=r.Get<uint64_t>();
+    flags=r.Get<uint32_t>();
+    return true;
+  }
+}
+
+ParseCache::ParseCache ( const QString& directory /*=QString()*/ ) : m_directory ( directory )
+{
+  if ( m_directory.isEmpty() ) m_directory=DefaultDirectory();
+}
+
+QString ParseCache::DefaultDirectory()
+{
+  const QString location=QStandardPaths::writableLocation ( QStandardPaths::CacheLocation );
+  if ( location.isEmpty() ) return QDir::tempPath() +"/kryomol";
+  return location;
+}
+
+/** the contents are not read, their hash is computed when an entry is checked or written*/
+ParseCache::Key ParseCache::Identify ( const QString& file )
+{
+  Key key;
+  const QFileInfo info ( file );
+  if ( !info.isFile() || !info.isReadable() ) return key;
+  key.path=info.absoluteFilePath().toUtf8().constData();
+  key.size=static_cast<int64_t> ( info.size() );
+  key.mtime=info.lastModified().toMSecsSinceEpoch();
+  return key;
+}
+
+QString ParseCache::EntryPath ( const Key& key, JobType type ) const
+{
+  const QString name=QString::number ( Hash ( key.path.data(),key.path.size() ),16 ).rightJustified ( 16,'0' );
+  return m_directory+"/"+name+"-"+QString::number ( type ) +".kryocache";
+}
+
+bool ParseCache::Load ( const Key& key, JobType type, std::vector<Molecule>& molecules, unsigned& flags ) const
+{
+  if ( !key.IsValid() ) return false;
+  const QString path=EntryPath ( key,type );
+  if ( !QFileInfo::exists ( path ) ) return false;
+
+  std::shared_ptr<MappedFile> entry ( new MappedFile ( path ) );
+  if ( !entry->IsOpen() ) return false;
+  std::vector<Molecule> loaded;
+  unsigned f=0;
+  bool valid=false;
+  try
+  {
+    Reader reader ( entry->Text() );
+    uint64_t hash=0;
+    //the source is only read when the entry matches its size and modification time
+    if ( ReadKey ( reader,key,type,f,hash ) && hash == ( key.hash ? key.hash : HashFile ( key.path ) ) )
+    {
+      loaded.resize ( reader.GetCount ( sizeof ( uint64_t ) ) );
+      for ( std::vector<Molecule>::iterator it=loaded.begin();it!=loaded.end();++it )
+        ReadMolecule ( reader,*it,entry );
+      valid=reader.AtEnd();
+    }
+  }
+  catch ( kryomol::Exception& )
+  {
+    valid=false;
+  }
+  //the source changed or the entry is stale, it will be written again after parsing
+  if ( !valid )
+  {
+    loaded.clear();
+    entry.reset();
+    QFile::remove ( path );
+    return false;
+  }
+  //swapping keeps the molecules in place, so the frames still point to them
+  molecules.swap ( loaded );
+  flags=f;
+  return true;
+}
+
+/** the molecules are only read, so they can be stored by another thread than the one that parsed them*/
+bool ParseCache::Store ( const Key& key, JobType type, const std::vector<Molecule>& molecules, unsigned flags ) const
+{
+  if ( !key.IsValid() ) return false;
+  //writing the frames read on demand would load all that the parser deferred
+  for ( std::vector<Molecule>::const_iterator it=molecules.begin();it!=molecules.end();++it )
+  {
+    if ( it->HasFrameSource() ) return false;
+    for ( std::vector<Frame>::const_iterator ft=it->Frames().begin();ft!=it->Frames().end();++ft )
+      if ( ft->PendingData() ) return false;
+  }
+  Key identity=key;
+  if ( identity.hash == 0 ) identity.hash=HashFile ( identity.path );
+  if ( identity.hash == 0 ) return false;
+  if ( !QDir().mkpath ( m_directory ) ) return false;
+
+  Writer writer;
+  WriteKey ( writer,identity,type,flags );
+  writer.Put<uint64_t> ( molecules.size() );
+  for ( std::vector<Molecule>::const_iterator it=molecules.begin();it!=molecules.end();++it )
+    WriteMolecule ( writer,*it );
+
+  //the entry is written aside and renamed, so a reader never sees it half written
+  QSaveFile file ( EntryPath ( key,type ) );
+  if ( !file.open ( QIODevice::WriteOnly ) ) return false;
+  const std::string& buffer=writer.Buffer();
+  if ( file.write ( buffer.data(),static_cast<qint64> ( buffer.size() ) ) != static_cast<qint64> ( buffer.size() ) )
+  {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
@@ -0,0 +1,79 @@
+/*****************************************************************************************
+                            parsecache.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "molecule.h"
+#include "parser.h"
+#include "parsersexport.h"
+
+namespace kryomol
+{
+  /** @brief persistent cache of the molecules parsed from output files
+
+  The molecules of the jobs of a given type parsed from a file are written in a versioned binary entry of
+  the cache directory, named .kryocache. The entry records the identity of the source file (absolute path,
+  size, modification time and a hash of its contents), so opening the same file again reads the memory
+  mapped entry instead of parsing the text, and an entry whose source changed, or written by another
+  version of the format, is discarded and removed. The geometries, energies, convergence values, charges,
+  dipoles, vibrational modes, spectral lines and molecular orbitals are stored, the orbitals of a frame
+  read from an entry are decoded the first time they are used. Grids and densities, that are computed on
+  demand or read from cube files, are not. Molecules whose frames are still read on demand from their
+  source are not stored either*/
+  class KRYOMOLPARSERS_API ParseCache
+  {
+    public:
+      /** @brief identity of a source file*/
+      struct Key
+      {
+        Key() : size ( 0 ), mtime ( 0 ), hash ( 0 ) {}
+        bool IsValid() const { return !path.empty(); }
+        /** absolute path in UTF-8*/
+        std::string path;
+        int64_t size;
+        /** modification time in milliseconds since the epoch*/
+        int64_t mtime;
+        /** hash of the contents, 0 until it is computed*/
+        uint64_t hash;
+      };
+      /** properties of the source file stored with the molecules*/
+      enum { DENSITY=1, ORBITALS=2, ALPHABETA=4 };
+      /** version of the format of the entries, increase it whenever the layout changes*/
+      static const uint32_t version;
+    public:
+      /** a cache in @param directory, the per user cache location if empty*/
+      explicit ParseCache ( const QString& directory=QString() );
+      /** @return the cache directory of the user*/
+      static QString DefaultDirectory();
+      /** @return the identity of @param file, invalid if the file can not be read. The hash is left
+          to be computed by Load and Store, only when an entry is checked or written*/
+      static Key Identify ( const QString& file );
+      /** @return true and the molecules of the jobs of @param type and the properties @param flags of the
+          file identified by @param key if there is a valid entry*/
+      bool Load ( const Key& key, JobType type, std::vector<Molecule>& molecules, unsigned& flags ) const;
+      /** write the entry of @param molecules, the jobs of @param type of the file identified by @param key
+          @return false if the entry could not be written, or if some frame has data still pending*/
+      bool Store ( const Key& key, JobType type, const std::vector<Molecule>& molecules, unsigned flags ) const;
+      /** @return the path of the entry of @param key for jobs of @param type*/
+      QString EntryPath ( const Key& key, JobType type ) const;
+    private:
+      QString m_directory;
+  };
+}
+
+#endif
@@ -9,18 +9,54 @@ it under the terms of the GNU General Public License as published by
 the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
+#include <algorithm>
 #include <clocale>
+#include <iterator>
+#include <string>
 #include "parser.h"
+#include "mappedfile.h"
+#include "molecule.h"
+#include "frameloader.h"
 
 
 using namespace kryomol;
 
-Parser::Parser ( const char* inputfile ) : m_bcreated ( true )
+namespace
 {
-    m_file= new std::ifstream ( inputfile );
+/** @brief switches LC_NUMERIC to C for its lifetime
+
+  The application sets LC_NUMERIC to C at startup, in that case nothing is changed,
+  so concurrent parsers do not touch the process wide locale*/
+class CNumericLocale
+{
+    public:
+        CNumericLocale()
+        {
+            const char* current=std::setlocale ( LC_NUMERIC,NULL );
+            if ( current && std::string ( current ) != "C" )
+            {
+                m_saved=current;
+                std::setlocale ( LC_NUMERIC,"C" );
+            }
+        }
+        ~CNumericLocale()
+        {
+            if ( !m_saved.empty() ) std::setlocale ( LC_NUMERIC,m_saved.c_str() );
+        }
+    private:
+        CNumericLocale ( const CNumericLocale& );
+        CNumericLocale& operator= ( const CNumericLocale& );
+        std::string m_saved;
+};
+}
+
+Parser::Parser ( const char* inputfile ) : m_path ( QString::fromLocal8Bit ( inputfile ) ), m_bcreated ( true ), m_sectionsdefined ( false ),
+  m_textloaded ( false )
+{
+    m_file= new MappedStream ( std::string ( inputfile ) );
 }
 
-Parser::Parser ( std::istream* stream ) : m_file ( stream ) , m_bcreated ( false )
+Parser::Parser ( std::istream* stream ) : m_file ( stream ) , m_bcreated ( false ), m_sectionsdefined ( false ), m_textloaded ( false )
 {
 }
 
@@ -42,12 +78,11 @@ D2Array<double>  Parser::ParseMagneticSusceptibility()
     return D2Array<double>();
 }
 
-/** Parse will set the locale to C, call the actual virtual implementation ParseFile and restore the locale*/
+/** Parse will set the locale to C if it is not already, call the actual virtual implementation ParseFile and restore the locale*/
 void Parser::Parse(std::streampos pos)
 {
-    const char* locale=std::setlocale(LC_NUMERIC,"C");
+    CNumericLocale locale;
     ParseFile(pos);
-    std::setlocale(LC_NUMERIC,locale);
 }
 
 std::vector<JobHeader>& Parser::Jobs()
@@ -55,3 +90,183 @@ std::vector<JobHeader>& Parser::Jobs()
   if ( m_jobpos.empty() ) m_jobpos.push_back(JobHeader(singlepoint,0));
   return m_jobpos;
 }
+
+const SectionIndex& Parser::Sections()
+{
+    if ( !m_sections.IsBuilt() )
+    {
+        if ( !m_sectionsdefined )
+        {
+            DefineSections ( m_sections );
+            m_sectionsdefined=true;
+        }
+        m_sections.Build ( Text() );
+    }
+    return m_sections;
+}
+
+std::string_view Parser::Text()
+{
+    std::string_view text;
+    if ( StreamText ( *m_file,text ) ) return text;
+    if ( !m_textloaded )
+    {
+        m_file->clear();
+        const std::streampos current=m_file->tellg();
+        m_file->seekg ( 0,std::ios::beg );
+        m_text.assign ( std::istreambuf_iterator<char> ( *m_file ),std::istreambuf_iterator<char>() );
+        m_file->clear();
+        m_file->seekg ( current < 0 ? std::streampos ( 0 ) : current,std::ios::beg );
+        m_textloaded=true;
+    }
+    return m_text;
+}
+
+/** @brief the loader of the data of a frame set by SetSectionLoader*/
+class Parser::SectionLoader : public FrameLoader
+{
+    public:
+        SectionLoader ( const std::shared_ptr<Parser>& reader, std::streamoff offset ) : m_reader ( reader ), m_offset ( offset ) {}
+        /** the numbers are read in the C locale, as in Parse*/
+        void Load ( Frame& frame, unsigned data )
+        {
+            CNumericLocale locale;
+            m_reader->LoadSection ( frame,data,m_offset );
+        }
+    private:
+        std::shared_ptr<Parser> m_reader;
+        std::streamoff m_offset;
+};
+
+void Parser::SetSectionLoader ( Frame& frame, const std::shared_ptr<Parser>& reader, unsigned data, std::streamoff offset )
+{
+    frame.SetLoader ( new SectionLoader ( reader,offset ),data );
+}
+
+QString Parser::Path() const
+{
+    if ( !m_path.isEmpty() ) return m_path;
+    const MappedStream* stream=dynamic_cast<const MappedStream*> ( m_file );
+    return stream != NULL ? stream->Path() : QString();
+}
+
+bool Parser::ShareText ( const Parser& parser )
+{
+    const MappedStream* stream=dynamic_cast<const MappedStream*> ( parser.m_file );
+    if ( stream == NULL || !stream->IsOpen() ) return false;
+    if ( m_bcreated ) delete m_file;
+    m_file=new MappedStream ( *stream );
+    m_bcreated=true;
+    m_text.clear();
+    m_textloaded=false;
+    return true;
+}
+
+bool Parser::SeekSection ( int section, std::streampos from, std::streampos to /*=-1*/ )
+{
+    std::streamoff offset=Sections().Find ( section,from,to );
+    m_file->clear();
+    if ( offset < 0 )
+    {
+        m_file->seekg ( 0,std::ios::end );
+        m_file->setstate ( std::ios::eofbit|std::ios::failbit );
+        return false;
+    }
+    m_file->seekg ( offset,std::ios::beg );
+    return true;
+}
+
+void Parser::ParseFrames ( Molecule& molecule, std::vector<FrameBlock>& blocks, size_t offset /*=0*/ )
+{
+    //build the index and load the text before the frames are parsed
+    Sections();
+    const std::string_view text=Text();
+
+    const size_t first=molecule.Frames().size();
+    molecule.Frames().reserve ( first+blocks.size() );
+    for ( size_t i=0;i<blocks.size();++i )
+        molecule.Frames().push_back ( Frame ( &molecule ) );
+
+    //exceptions can not leave the parallel loop, each one is kept with its frame. Single frames, as the
+    //files of a folder loaded concurrently, do not start a team of threads
+    const long nframes=static_cast<long> ( blocks.size() );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) if(nframes > 1)
+#endif
+    for ( long i=0;i<nframes;++i )
+    {
+        try
+        {
+            ParseFrameBlock ( text,offset+i,molecule.Frames() [first+i],blocks[i] );
+        }
+        catch ( ... )
+        {
+            blocks[i].error=std::current_exception();
+        }
+    }
+
+    //setting the energy also sets the level of the molecule
+    for ( size_t i=0;i<blocks.size();++i )
+    {
+        if ( !blocks[i].level.empty() )
+            molecule.Frames() [first+i].SetEnergy ( blocks[i].energy,blocks[i].level );
+        if ( blocks[i].error )
+        {
+            molecule.Frames().erase ( molecule.Frames().begin() +first+i+1,molecule.Frames().end() );
+            std::rethrow_exception ( blocks[i].error );
+        }
+    }
+}
+
+bool Parser::Reopen ( const QString& file )
+{
+    m_path=file;
+    return Reload ( false );
+}
+
+/** streams given by the caller without the name of their file can not be opened again*/
+bool Parser::Reload ( bool grown )
+{
+    if ( m_path.isEmpty() ) return false;
+    const size_t size=Text().size();
+    MappedStream* stream=new MappedStream ( m_path );
+    //a file rewritten from the beginning is not the job that was followed
+    if ( !stream->IsOpen() || stream->Text().size() < size || ( grown && stream->Text().size() == size ) )
+    {
+        delete stream;
+        return false;
+    }
+    if ( m_bcreated ) delete m_file;
+    m_file=stream;
+    m_bcreated=true;
+    m_text.clear();
+    m_textloaded=false;
+    if ( m_sections.IsBuilt() ) m_sections.Extend ( Text() );
+    return true;
+}
+
+bool Parser::LastJobWrites ( std::initializer_list<const char*> marks )
+{
+    const std::string_view text=Text();
+    const size_t from=m_jobpos.empty() ? 0 : static_cast<size_t> ( std::streamoff ( m_jobpos.back().pos ) );
+    for ( const char* mark : marks )
+        if ( text.find ( mark,from ) != std::string_view::npos ) return true;
+    return false;
+}
+
+bool Parser::ParseAppended ( Molecule& molecule, size_t& first )
+{
+    const size_t known=FrameCount();
+    if ( known == 0 || !Reload ( true ) ) return false;
+    FindAppendedFrames();
+    first=std::min ( known-1,molecule.Frames().size() );
+    molecule.Frames().erase ( molecule.Frames().begin() +first,molecule.Frames().end() );
+
+    std::vector<FrameBlock> blocks ( FrameCount()-first );
+    {
+        CNumericLocale locale;
+        ParseFrames ( molecule,blocks,first );
+    }
+    FinishFrames ( molecule,blocks,first );
+    return true;
+}
@@ -12,17 +12,26 @@ the Free Software Foundation version 2 of the License.
 #ifndef QUANTUMPARSER_H
 #define QUANTUMPARSER_H
 
+#include <exception>
 #include <fstream>
+#include <initializer_list>
 #include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
+#include <QString>
 #include "parsersexport.h"
 
 #include "quantumcoupling.h"
+#include "sectionindex.h"
+#include "threshold.h"
 
 
 namespace kryomol
 {
   class Molecule;
+  class Frame;
   enum QuantumLevel { MNDO, HF, MP2, QCISD, CCSD, CCSDT, SCRF };
   enum JobType {singlepoint, opt, freq, uv, nmr, dyn};
 
@@ -54,16 +63,95 @@ namespace kryomol
       virtual bool ParseFrequencies( std::streampos =0) { return false; }
       virtual bool ParseUV( std::streampos =0) { return false; }
       virtual std::vector<JobHeader>& Jobs();
+      /** follow a job that is still running: parse the frames written to the file since the last call, or since
+          the job was parsed with Parse, and add them to @param molecule, the molecule of that job with its frames
+          as they were parsed. Only the new text is read. The last frame known may have been incomplete, so it is
+          parsed again and replaced @return false if the file did not grow or the format can not be followed,
+          otherwise @param first is the index of the first frame of @param molecule replaced or appended*/
+      bool ParseAppended ( Molecule& molecule, size_t& first );
+      /** read @param file, the file of the stream given to the constructor, from now on, so the parser can outlive
+          the stream @return false if the file can not be opened or is shorter than the text already read*/
+      bool Reopen ( const QString& file );
+      /** @return true if the last job of the file did not write its termination yet, so it can still grow.
+          Formats that can not follow a job are never running*/
+      virtual bool IsRunning() { return false; }
     protected:
       const std::vector<kryomol::Molecule>* Molecules() const { return m_molecules; }
       std::vector<kryomol::Molecule>* Molecules() { return m_molecules; }
+      /** declare the markers of the sections of the format in @param index, called once before the index is built*/
+      virtual void DefineSections ( SectionIndex& /*index*/ ) {}
+      /** @return the index of the sections of the file, built in a single pass on first use*/
+      const SectionIndex& Sections();
+      /** move the file to the beginning of the line where the first @param section at or after @param from
+          (and before @param to if not negative) begins @return false if there is none, the file is then left
+          at its end, as after an unsuccessful search with getline*/
+      bool SeekSection ( int section, std::streampos from, std::streampos to=-1 );
+      /** @return the whole text of the file, read in place if the file is memory mapped (@see MappedStream),
+          otherwise copied once from the stream. Positions in the text are positions of the stream*/
+      std::string_view Text();
+      /** @return the path of the file parsed, empty if the parser reads a stream that is not a file*/
+      QString Path() const;
+      /** read the text of @param parser from now on, through a stream of its own that shares the mapping of
+          the file or its decompressed text, so the text outlives @param parser and is not read again
+          @return false if @param parser does not read a mapped file, nothing is changed then*/
+      bool ShareText ( const Parser& parser );
+
+      /** @brief values of a frame parsed by ParseFrameBlock that are applied to the molecule afterwards,
+          in file order, because they are shared by all the frames or depend on the previous ones*/
+      struct FrameBlock
+      {
+        enum { MAXFORCE=1, RMSFORCE=2, MAXDISPLACEMENT=4, RMSDISPLACEMENT=8 };
+        FrameBlock() : energy ( 0.0 ), found ( 0 ) {}
+        /** energy of the frame, not set if level is empty*/
+        double energy;
+        std::string level;
+        /** convergence criteria printed with the frame, found is an or of the flags of the ones read*/
+        Threshold threshold;
+        unsigned found;
+        /** exception thrown while the frame was parsed*/
+        std::exception_ptr error;
+      };
+      /** parse the frame @param frame of the current job from @param text into @param target. The frames
+          are parsed concurrently, so implementations must only read the parser and write to @param target
+          and @param block*/
+      virtual void ParseFrameBlock ( std::string_view /*text*/, size_t /*frame*/, Frame& /*target*/, FrameBlock& /*block*/ ) {}
+      /** append a frame to @param molecule for every element of @param blocks and parse them on all the
+          processors with ParseFrameBlock, @param offset being the index in the job of the frame of the first
+          block. The energies are then set in order, and the first exception thrown is raised again with the
+          frames after the failing one removed*/
+      void ParseFrames ( Molecule& molecule, std::vector<FrameBlock>& blocks, size_t offset=0 );
+      /** @return the number of frames of the job parsed last, 0 if the format can not follow a running job*/
+      virtual size_t FrameCount() const { return 0; }
+      /** add the frames of the job parsed last that begin in the text appended to the file*/
+      virtual void FindAppendedFrames() {}
+      /** set the values of the frames of @param molecule from @param first on that depend on the previous
+          frames, parsed in @param blocks*/
+      virtual void FinishFrames ( Molecule& /*molecule*/, const std::vector<FrameBlock>& /*blocks*/, size_t /*first*/ ) {}
+      /** @return true if one of @param marks is written after the beginning of the last job found by Jobs*/
+      bool LastJobWrites ( std::initializer_list<const char*> marks );
+      /** read @param data, an or of Frame::Data, of @param frame from the section of the file at @param offset*/
+      virtual void LoadSection ( Frame& /*frame*/, unsigned /*data*/, std::streamoff /*offset*/ ) {}
+      /** read @param data of @param frame from the section at @param offset the first time it is used, with
+          @param reader, a parser of the same format that shares the text of this one (@see ShareText) and so
+          outlives it*/
+      static void SetSectionLoader ( Frame& frame, const std::shared_ptr<Parser>& reader, unsigned data, std::streamoff offset );
     protected:
       std::istream* m_file;
       QuantumLevel m_level;
       std::vector<JobHeader> m_jobpos;
+    private:
+      class SectionLoader;
+      /** map the file again, keeping it only if it @param grown or is not shorter, and index the new text
+          @return true if the file was mapped again*/
+      bool Reload ( bool grown );
     private:
       std::vector<kryomol::Molecule>* m_molecules;
+      QString m_path;
       bool m_bcreated;
+      bool m_sectionsdefined;
+      SectionIndex m_sections;
+      bool m_textloaded;
+      std::string m_text;
 
   };
 
@@ -12,23 +12,137 @@ the Free Software Foundation version 2 of the License.
 #include "parserfactory.h"
 #include "parsers.h"
 #include "stringtools.h"
+#include "multipatternmatcher.h"
+#include "mappedfile.h"
 
 using namespace kryomol;
 
-ParserFactory::ParserFactory(const char* file)
+namespace
 {
-    m_stream = new std::ifstream ( file,std::ios::binary ); m_bstreamcreated=true;
+    /** bytes read to find the file type*/
+    const size_t headersize=1<<20;
+    /** bytes read at once when scanning the whole file*/
+    const size_t blocksize=1<<20;
+
+    struct Signature
+    {
+        const char* text;
+        ParserFactory::filetype type;
+    };
+
+    /** strings identifying a file type anywhere in the header*/
+    const Signature signatures[]=
+    {
+        { "Number of atoms                            I", ParserFactory::FChk },
+        { "[Molden Format]", ParserFactory::Molden },
+        { "[MOLDEN FORMAT]", ParserFactory::Molden },
+        { "Standard orientation", ParserFactory::GaussianFile },
+        { "Input orientation", ParserFactory::GaussianFile },
+        { "Z-Matrix orientation", ParserFactory::GaussianFile },
+        { "* O   R   C   A *", ParserFactory::Orca },
+        { "$orca_hessian_file", ParserFactory::OrcaHessian },
+        { "GAMESS VERSION", ParserFactory::Gamess },
+        { "s_m_m2io_version", ParserFactory::Maestro },
+        { "ACES2: Advanced Concepts in Electronic Structure II", ParserFactory::Aces },
+        { "CFOUR Coupled-Cluster techniques for Computational Chemistry", ParserFactory::Aces },
+        { "Northwest Computational Chemistry Package", ParserFactory::NwChem },
+        { "[HIN System Description]", ParserFactory::HyperChem },
+        { "{PCM ", ParserFactory::PCModel },
+        { "MO coefficients", ParserFactory::GaussianCube },
+        { "HETATM", ParserFactory::PDB },
+        { "ATOM", ParserFactory::PDB }
+    };
+    const size_t nsignatures=sizeof ( signatures ) /sizeof ( Signature );
+
+    /** types found by signature, in the order they are preferred when several signatures are present. The arrays
+        of a checkpoint file contain the signature of cube files*/
+    const ParserFactory::filetype preferred[]=
+    {
+        ParserFactory::FChk, ParserFactory::Molden, ParserFactory::OrcaHessian, ParserFactory::GaussianFile, ParserFactory::Orca, ParserFactory::Gamess,
+        ParserFactory::Maestro, ParserFactory::Aces, ParserFactory::NwChem, ParserFactory::HyperChem, ParserFactory::PCModel,
+        ParserFactory::GaussianCube
+    };
+
+    /** a Gaussian output whose first geometry is beyond the header*/
+    const char* gaussianbanner="Entering Gaussian System";
+
+    struct CapabilitySignature
+    {
+        const char* text;
+        ParserFactory::filetype type;
+        int flag;
+    };
+
+    const CapabilitySignature capabilities[]=
+    {
+        { "AO basis set in the form of general basis input", ParserFactory::GaussianFile, ParserFactory::BasisSet },
+        { "Molecular Orbital Coefficients", ParserFactory::GaussianFile, ParserFactory::MOCoefficients },
+        { "Alpha Molecular Orbital Coefficients:", ParserFactory::GaussianFile, ParserFactory::AlphaBeta },
+        { "BASIS SET IN INPUT FORMAT", ParserFactory::Orca, ParserFactory::BasisSet },
+        { "MOLECULAR ORBITALS", ParserFactory::Orca, ParserFactory::MOCoefficients },
+        { "Shell types", ParserFactory::FChk, ParserFactory::BasisSet },
+        { "Alpha MO coefficients", ParserFactory::FChk, ParserFactory::MOCoefficients },
+        { "Beta MO coefficients", ParserFactory::FChk, ParserFactory::AlphaBeta },
+        { "[GTO]", ParserFactory::Molden, ParserFactory::BasisSet },
+        { "[MO]", ParserFactory::Molden, ParserFactory::MOCoefficients },
+        { "Spin= Beta", ParserFactory::Molden, ParserFactory::AlphaBeta }
+    };
+    const size_t ncapabilities=sizeof ( capabilities ) /sizeof ( CapabilitySignature );
+
+    /** @return line n (starting at 0) of text, without the line feed*/
+    std::string Line ( const std::string& text, size_t n )
+    {
+        size_t start=0;
+        for ( size_t i=0;i<n;++i )
+        {
+            start=text.find ( '\n',start );
+            if ( start == std::string::npos ) return std::string();
+            ++start;
+        }
+        size_t end=text.find ( '\n',start );
+        return text.substr ( start,end == std::string::npos ? std::string::npos : end-start );
+    }
+
+    bool IsMdlV2000 ( const std::string& text )
+    {
+        size_t start=0;
+        while ( start < text.size() )
+        {
+            size_t end=text.find ( '\n',start );
+            if ( end == std::string::npos ) end=text.size();
+            StringTokenizer token ( text.substr ( start,end-start )," \t\r" );
+            if ( token.size() > 4 && kryomol::toupper ( token.back() ) == "V2000" ) return true;
+            start=end+1;
+        }
+        return false;
+    }
+
+    bool IsOldMacroModel ( const std::string& line )
+    {
+        StringTokenizer token ( line," \t\r" );
+        if ( token.size() <= 13 ) return false;
+        for ( int i=0;i<13;i++ )
+        {
+            if ( !isinteger ( token.at ( i ) ) ) return false;
+        }
+        return true;
+    }
 }
 
-ParserFactory::ParserFactory(std::istream* stream) : m_stream(stream), m_bstreamcreated(false)
+ParserFactory::ParserFactory(const char* file) : m_bstreamcreated(true), m_detected(false), m_scanned(false), m_type(None), m_scannedtype(None)
+{
+    m_stream = new MappedStream ( std::string ( file ) );
+}
+
+ParserFactory::ParserFactory(std::istream* stream) : m_stream(stream), m_bstreamcreated(false), m_detected(false), m_scanned(false), m_type(None), m_scannedtype(None)
 {
 
 }
 
 #ifdef __MINGW32__
-ParserFactory::ParserFactory(std::filesystem::path p)
+ParserFactory::ParserFactory(std::filesystem::path p) : m_bstreamcreated(true), m_detected(false), m_scanned(false), m_type(None), m_scannedtype(None)
 {
-    m_stream = new std::ifstream ( p );
+    m_stream = new MappedStream ( QString::fromStdWString ( p.wstring() ) );
 }
 #endif
 
@@ -91,6 +205,15 @@ Parser* ParserFactory::BuildParser()
     case Orca:
         p = new OrcaParser ( m_stream );
         break;
+    case FChk:
+        p = new FChkParser ( m_stream );
+        break;
+    case Molden:
+        p = new MoldenParser ( m_stream );
+        break;
+    case OrcaHessian:
+        p = new OrcaHessianParser ( m_stream );
+        break;
     case None:
     default:
         p = NULL;
@@ -101,273 +224,232 @@ Parser* ParserFactory::BuildParser()
 
 ParserFactory::filetype ParserFactory::GetFileType()
 {
+    if ( !m_detected ) Detect();
+    return m_type;
+}
 
-    //first try gaussian
-    std::string line;
+size_t ParserFactory::HeaderSize()
+{
+    return headersize;
+}
 
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while(std::getline(*m_stream,line))
-    {
-        if(line.find("Standard orientation") != std::string::npos ||  line.find("Input orientation") != std::string::npos || line.find("Z-Matrix orientation") != std::string::npos )
-        {
-            return GaussianFile;
-        }
-    }
+void ParserFactory::Detect()
+{
+    m_detected=true;
+    m_type=None;
 
     m_stream->clear();
     m_stream->seekg(0,std::ios::beg);
-    while(std::getline(*m_stream,line))
+    m_header.resize(headersize);
+    m_stream->read(&m_header[0],headersize);
+    m_header.resize(static_cast<size_t>(m_stream->gcount()));
+    const bool complete = m_header.size() < headersize;
+
+    //all the signatures in one pass over the header
+    std::vector<bool> found(OrcaHessian+1,false);
+    MultiPatternMatcher matcher;
+    for(size_t i=0;i<nsignatures;++i)
+        matcher.Add(signatures[i].text);
+    const size_t banner=matcher.Add(gaussianbanner);
+    bool bannerfound=false;
+    matcher.Feed(m_header.data(),m_header.size(),[&](size_t p,size_t)
     {
-        if(line.find("* O   R   C   A *") != std::string::npos )
-        {
-            return Orca;
-        }
-    }
+        if ( p == banner ) bannerfound=true;
+        else found[signatures[p].type]=true;
+        return true;
+    });
 
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while(std::getline(*m_stream,line))
+    //a Gaussian output with a long input section, look for the geometry in the rest of the file
+    if ( bannerfound && !found[GaussianFile] && !complete )
     {
-        if(line.find("GAMESS VERSION") != std::string::npos)
-            return Gamess;
+        ScanBody();
+        found[GaussianFile]=m_type == GaussianFile;
     }
 
     m_stream->clear();
     m_stream->seekg(0,std::ios::beg);
-    while(std::getline(*m_stream,line))
+
+    for(size_t i=0;i<sizeof(preferred)/sizeof(filetype);++i)
     {
-        if(line.find("s_m_m2io_version") != std::string::npos)
+        if ( found[preferred[i]] )
         {
-            std::cout << "MacroModel Maestro format" << std::endl;
-            return Maestro;
+            m_type=preferred[i];
+            switch ( m_type )
+            {
+            case Maestro:
+                std::cout << "MacroModel Maestro format" << std::endl;
+                break;
+            case Aces:
+                std::cout << "ACESII/CFOUR file" << std::endl;
+                break;
+            case NwChem:
+                std::cout << "NwChem file" << std::endl;
+                break;
+            case HyperChem:
+                std::cout << "HyperChem file" << std::endl;
+                break;
+            case PCModel:
+                std::cout << "PCModel file" << std::endl;
+                break;
+            case GaussianCube:
+                std::cout << "GaussianCube file" << std::endl;
+                break;
+            case FChk:
+                std::cout << "Gaussian formatted checkpoint file" << std::endl;
+                break;
+            case Molden:
+                std::cout << "Molden file" << std::endl;
+                break;
+            case OrcaHessian:
+                std::cout << "ORCA Hessian file" << std::endl;
+                break;
+            default:
+                break;
+            }
+            return;
         }
-
     }
 
-    m_stream->clear();
-    m_stream->seekg ( 0,std::ios::beg );
-    while ( std::getline ( *m_stream,line ) )
+    const std::string first=Line(m_header,0);
+    StringTokenizer tok(first," \t\r,");
+    if( tok.size()== 2 )
     {
-        if ( line.find ( "ACES2: Advanced Concepts in Electronic Structure II" ) != std::string::npos || line.find("CFOUR Coupled-Cluster techniques for Computational Chemistry") != std::string::npos )
+        if ( isinteger(tok.at(0)) && isinteger(tok.at(1)) )
         {
-            std::cout << "ACESII/CFOUR file" << std::endl;
-            return Aces;
+            m_type=GaussianInput;
+            return;
         }
     }
 
-
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while ( std::getline ( *m_stream,line ) )
+    if ( IsMdlV2000(m_header) )
     {
-        if ( line.find ( "Northwest Computational Chemistry Package" ) != std::string::npos )
-        {
-            std::cout << "NwChem file" << std::endl;
-            return NwChem;
-        }
+        std::cout << "MDL V2000 file" << std::endl;
+        m_type=MdlV2000;
+        return;
     }
 
-
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while ( std::getline ( *m_stream,line ) )
+    if( ( first.find( "1\\1\\" ) != std::string::npos  ) ||  ( first.find( "1|1|") != std::string::npos ) )
     {
-        if ( line.find ( "[HIN System Description]" ) != std::string::npos )
-        {
-            std::cout << "HyperChem file" << std::endl;
-            return HyperChem;
-        }
+        m_type=GaussianArchive;
+        return;
     }
 
-
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while ( std::getline ( *m_stream,line ) )
+    if ( found[PDB] )
     {
-        if ( line.find ( "{PCM " ) != std::string::npos )
-        {
-            std::cout << "PCModel file" << std::endl;
-            return PCModel;
-        }
+        m_type=PDB;
+        return;
     }
 
+    if ( IsOldMacroModel(Line(m_header,1)) )
+    {
+        std::cout << "MacroModel Old Format" << std::endl;
+        m_type=MacroModel;
+        return;
+    }
 
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while ( std::getline ( *m_stream,line ) )
+    StringTokenizer token(first," \t\r");
+    if( token.size() == 1 )
     {
-        if ( line.find ( "MO coefficients" ) != std::string::npos )
-        {
-            std::cout << "GaussianCube file" << std::endl;
-            return GaussianCube;
-        }
+        if( kryomol::isnum(token.at(0)) ) m_type=XYZ;
     }
+}
 
+void ParserFactory::ScanBody()
+{
+    m_scanned=true;
+    m_capabilityfound.assign(ncapabilities,false);
 
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    std::getline(*m_stream,line);
-    StringTokenizer tok(line," \t\r,");
-    if( tok.size()== 2 )
+    //Gaussian geometries, when the type is still unknown, and then the capabilities of a Gaussian file
+    const bool searchgeometry = !m_detected || m_type == None;
+    m_scannedtype = searchgeometry ? GaussianFile : m_type;
+
+    //only the capabilities of the file type are searched, so the scan stops when all of them are found
+    MultiPatternMatcher matcher;
+    std::vector<size_t> capability;
+    for(size_t i=0;i<ncapabilities;++i)
     {
-        if ( isinteger(tok.at(0)) && isinteger(tok.at(1)) )
-            return GaussianInput;
+        if ( capabilities[i].type != m_scannedtype ) continue;
+        matcher.Add(capabilities[i].text);
+        capability.push_back(i);
+    }
+    const size_t ncapabilitypatterns=capability.size();
+    for(size_t i=0;i<nsignatures && searchgeometry;++i)
+    {
+        if ( signatures[i].type == GaussianFile ) matcher.Add(signatures[i].text);
     }
 
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-
-    //well, I dont know exactly what to search for, maybe 5 integers?
-    while(std::getline(*m_stream,line) )
+    size_t pending=ncapabilitypatterns;
+    auto match=[&](size_t p,size_t)
     {
-        StringTokenizer token(line," \t\r");
-        if ( token.size() > 4  )
+        if ( p >= ncapabilitypatterns )
         {
-            std::cout << token.back() << std::endl;
-
-            if  ( kryomol::toupper(token.back())  == "V2000" )
-            {
-                std::cout << "MDL V2000 file" << std::endl;
-                return MdlV2000;
-            }
-
+            m_type=GaussianFile;
         }
-    }
-
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    std::getline(*m_stream,line);
-    if( ( line.find( "1\\1\\" ) != std::string::npos  ) ||  ( line.find( "1|1|") != std::string::npos ) ) return GaussianArchive;
+        else if ( !m_capabilityfound[capability[p]] )
+        {
+            m_capabilityfound[capability[p]]=true;
+            --pending;
+        }
+        return pending > 0 || ( searchgeometry && m_type != GaussianFile );
+    };
 
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    while(std::getline(*m_stream,line) )
+    //the header is already in memory, continue with the rest of the file
+    bool go=matcher.Feed(m_header.data(),m_header.size(),match);
+    std::string_view text;
+    if ( go && m_header.size() == headersize && StreamText(*m_stream,text) )
     {
-        if ( (line.find( "HETATM" ) != std::string::npos ) || line.find( "ATOM" ) != std::string::npos )
-            return PDB;
+        //memory mapped file, scan it in place
+        go=matcher.Feed(text.data()+headersize,text.size()-headersize,match);
     }
-
-    m_stream->clear();
-    m_stream->seekg(0,std::ios::beg);
-    std::getline(*m_stream,line);
-    std::getline(*m_stream,line);
+    else if ( go && m_header.size() == headersize )
     {
-        StringTokenizer token(line," \t\r");
-        if (token.size() > 13 )
+        std::vector<char> block(blocksize);
+        m_stream->clear();
+        m_stream->seekg(m_header.size(),std::ios::beg);
+        while ( go && m_stream->read(&block[0],blocksize).gcount() > 0 )
         {
-            for(int i=0;i<13;i++)
-            {
-                if ( !isinteger(token.at(i))) goto lb;
-            }
-            std::cout << "MacroModel Old Format" << std::endl;
-            return MacroModel;
+            go=matcher.Feed(&block[0],static_cast<size_t>(m_stream->gcount()),match);
         }
     }
-lb:
     m_stream->clear();
     m_stream->seekg(0,std::ios::beg);
-    std::getline(*m_stream,line);
-    StringTokenizer token(line," \t\r");
-    if( token.size() == 1 )
-    {
-        if( kryomol::isnum(token.at(0)) ) return XYZ;
-    }
+}
 
-    return None;
+int ParserFactory::Capabilities()
+{
+    filetype type=GetFileType();
+    if ( type != GaussianFile && type != Orca && type != FChk && type != Molden ) return 0;
+    if ( !m_scanned || m_scannedtype != type ) ScanBody();
 
+    int flags=0;
+    for(size_t i=0;i<ncapabilities;++i)
+    {
+        if ( m_capabilityfound[i] && capabilities[i].type == type ) flags |= capabilities[i].flag;
+    }
+    return flags;
 }
 
 bool ParserFactory::isGaussianFile()
 {
-    bool ftype;
-
-    if ( (this->GetFileType() == GaussianFile) || (this->GetFileType() == Aces) || ( this->GetFileType() == Orca ))
-        ftype = true;
-    else
-        ftype = false;
-
-    return ftype;
+    filetype type=GetFileType();
+    return ( type == GaussianFile ) || ( type == Aces ) || ( type == Orca ) || ( type == FChk ) || ( type == OrcaHessian );
 }
 
 
 bool ParserFactory::existDensity()
 {
-    bool ftype = false;
-
-    if (this->GetFileType() == GaussianCube)
-        ftype = true;
-    if (this->GetFileType() == GaussianFile)
-    {
-        std::string line;
-        while ((std::getline(*m_stream,line)) && (!(ftype)))
-        {
-            if (line.find("AO basis set in the form of general basis input") != std::string::npos)
-            {
-                ftype = true;
-            }
-        }
-    }
-    if (this->GetFileType() == Orca)
-    {
-        std::string line;
-        while ((std::getline(*m_stream,line)) && (!(ftype)))
-        {
-            if (line.find("BASIS SET IN INPUT FORMAT") != std::string::npos)
-            {
-                ftype = true;
-            }
-        }
-    }
-    return ftype;
+    if ( GetFileType() == GaussianCube ) return true;
+    return ( Capabilities() & BasisSet ) != 0;
 }
 
 
 bool ParserFactory::existOrbitals()
 {
-    bool ftype = false;
-
-    if (this->GetFileType() == GaussianFile)
-    {
-        std::string line;
-        while ((std::getline(*m_stream,line)) && (!(ftype)))
-        {
-            if (line.find("Molecular Orbital Coefficients" ) != std::string::npos)
-            {
-                ftype = true;
-            }
-        }
-    }
-    if (this->GetFileType() == Orca)
-    {
-        std::string line;
-        while ((std::getline(*m_stream,line)) && (!(ftype)))
-        {
-            if (line.find("MOLECULAR ORBITALS") != std::string::npos)
-            {
-                ftype = true;
-            }
-        }
-    }
-
-    return ftype;
+    return ( Capabilities() & MOCoefficients ) != 0;
 }
 
 bool ParserFactory::existAlphaBeta()
 {
-    bool ftype = false;
-
-    if (this->GetFileType() == GaussianFile)
-    {
-        std::string line;
-        while ((std::getline(*m_stream,line)) && (!(ftype)))
-        {
-            if (line.find("Alpha Molecular Orbital Coefficients:" ) != std::string::npos)
-            {
-                ftype = true;
-            }
-        }
-    }
-
-    return ftype;
+    filetype type=GetFileType();
+    return ( type == GaussianFile || type == FChk || type == Molden ) && ( Capabilities() & AlphaBeta ) != 0;
 }
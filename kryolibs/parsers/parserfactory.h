@@ -16,6 +16,8 @@ the Free Software Foundation version 2 of the License.
 
 #include <fstream>
 #include <istream>
+#include <string>
+#include <vector>
 
 #ifdef __MINGW32__
 #include <filesystem>
@@ -26,7 +28,12 @@ namespace kryomol
 class MagicFile;
 class Parser;
 
-/**A class to build specialized parsers */
+/**A class to build specialized parsers
+
+The file type is found reading only the first bytes of the file (@see HeaderSize) and searching all the
+format signatures at once with a @see MultiPatternMatcher. The capabilities of quantum chemistry outputs
+(basis set, molecular orbitals, alpha and beta orbitals) are found in a single pass over the rest of the
+file, done only when they are requested and shared by existDensity, existOrbitals and existAlphaBeta*/
 class KRYOMOLPARSERS_API ParserFactory
 {
 public:
@@ -38,15 +45,31 @@ public:
     ~ParserFactory();
     /** return a pointer to a specialized parser, NULL if file type cannot be discerned*/
     Parser* BuildParser();
-    enum filetype { None, Aces, Gaussian, GaussianArchive, GaussianInput, GaussianFile, GaussianCube, Gamess, MdlV2000, PDB, MacroModel, Maestro, NwChem, XYZ, HyperChem, PCModel, Orca };
+    enum filetype { None, Aces, Gaussian, GaussianArchive, GaussianInput, GaussianFile, GaussianCube, Gamess, MdlV2000, PDB, MacroModel, Maestro, NwChem, XYZ, HyperChem, PCModel, Orca, FChk, Molden, OrcaHessian };
+    /** contents found in the file*/
+    enum capability { BasisSet=1, MOCoefficients=2, AlphaBeta=4 };
     filetype GetFileType();
     bool isGaussianFile();
     bool existDensity();
     bool existOrbitals();
     bool existAlphaBeta();
+    /** @return the contents found in the file as a combination of @see capability flags*/
+    int Capabilities();
+    /** @return the number of bytes read to find the file type*/
+    static size_t HeaderSize();
+private:
+    void Detect();
+    void ScanBody();
 private:
     std::istream* m_stream;
     bool m_bstreamcreated;
+    bool m_detected;
+    bool m_scanned;
+    filetype m_type;
+    /** file type whose capabilities were searched by the last scan*/
+    filetype m_scannedtype;
+    std::string m_header;
+    std::vector<bool> m_capabilityfound;
 
 };
 
@@ -28,4 +28,7 @@ the Free Software Foundation version 2 of the License.
 #include "pcmodelparser.h"
 #include "acesparser.h"
 #include "orcaparser.h"
+#include "fchkparser.h"
+#include "moldenparser.h"
+#include "orcahessianparser.h"
 #endif
@@ -65,7 +65,14 @@ HEADERS += archiveparser.h \
            pcmodelparser.h \
            gaussiancubeparser.h \
            acesparser.h \
-    orcaparser.h
+    orcaparser.h \
+    parsecache.h \
+    sectionindex.h \
+    fchkparser.h \
+    moldenparser.h \
+    orcahessianparser.h \
+    indexedframes.h \
+    structurewriter.h
 
 SOURCES += archiveparser.cpp \
 	   gamessparser.cpp \
@@ -87,7 +94,14 @@ SOURCES += archiveparser.cpp \
            pcmodelparser.cpp \
            gaussiancubeparser.cpp \
            acesparser.cpp \
-    orcaparser.cpp
+    orcaparser.cpp \
+    parsecache.cpp \
+    sectionindex.cpp \
+    fchkparser.cpp \
+    moldenparser.cpp \
+    orcahessianparser.cpp \
+    indexedframes.cpp \
+    structurewriter.cpp
 
 
 headers.files = $$HEADERS
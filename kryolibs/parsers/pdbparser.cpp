@@ -10,12 +10,42 @@ the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
 #include <algorithm>
+#include <unordered_map>
 #include "pdbparser.h"
 #include "molecule.h"
 #include "stringtools.h"
+#include "linereader.h"
 
 using namespace kryomol;
 
+namespace
+{
+    /** @return true if @param line is an ATOM or HETATM record*/
+    bool IsAtomRecord(std::string_view line)
+    {
+        return line.compare(0,6,"ATOM  ") == 0 || line.compare(0,6,"HETATM") == 0;
+    }
+
+    /** @return the columns @param first to @param first+@param n-1 of @param line, shorter if the line is*/
+    std::string_view Columns(std::string_view line, size_t first, size_t n)
+    {
+        if ( first >= line.size() ) return std::string_view();
+        return line.substr(first,n);
+    }
+
+    /** @return @param s without blanks*/
+    std::string RemoveBlanks(std::string_view s)
+    {
+        std::string r;
+        r.reserve(s.size());
+        for(char c : s)
+        {
+            if ( c != ' ' && c != '\r' ) r+=c;
+        }
+        return r;
+    }
+}
+
 PDBParser::PDBParser(const char* file)
 : Parser(file)
 {}
@@ -28,154 +58,104 @@ PDBParser::PDBParser(std::istream* stream) : Parser(stream)
 PDBParser::~PDBParser()
 {}
 
-bool PDBParser::ParseFile(std::streampos pos)
+void PDBParser::DefineSections(SectionIndex& index)
 {
-	
-	m_file->seekg(0,std::ios::beg);
-	std::string line;
-	std::vector<std::streampos> spos;
-	
-	while(std::getline(*m_file,line))
-	{
-		if( line.find("MODEL") == 0 )
-		{
-			spos.push_back(m_file->tellg());
-		}
-	}
-	if( spos.empty() )  //only one structure
-	{ spos.push_back(0); }
-	
-	//Reserve the number of frames
-	Molecules()->push_back(Molecule());
-	
-	Molecule& molecule=Molecules()->back();
-	
-	std::vector<std::streampos>::iterator it;
-	
-	
-	it=spos.begin();
-	m_file->clear();
-        m_file->seekg(*it,std::ios::beg);
-	while(std::getline(*m_file,line))
-	{
-		if ( line.find("HETATM")  != std::string::npos || line.find("ATOM") != std::string::npos)
-		{
-			std::vector<std::string> tokens=ParseAtomLine(line);
-			
-			if ( tokens.at(0) == "HETATM" || tokens.at(0) == "ATOM  " )
-			{
-                                //get atom symbol
-				std::string symbol;
-				
-				//if we dont have symbol record extract it from the pdb atom name 
-				if ( tokens.size() == 9 )
-					symbol=tokens.at(8);
-				else
-					symbol=ExtractAtomName(tokens.at(2));
-				
-				Atom atom(symbol);
-				atom.SetPDBName(tokens.at(2).c_str());
-
-				
-				std::vector<PDBResidue*>::iterator rt=molecule.Residues().begin();
-				for(;rt!=molecule.Residues().end();++rt)
-				{
-					if ( (*rt)->Name() == tokens.at(3) && (*rt)->Index() == tokens.at(4) )
-						break;
-				}
-				if ( rt != molecule.Residues().end() )
-					atom.SetPDBResidue(*rt);
-				else
-				{
-					PDBResidue* nresidue= new PDBResidue(tokens.at(3),tokens.at(4));
-					molecule.Residues().push_back(nresidue);
-					atom.SetPDBResidue(nresidue);
-				}
-				
-				
-				
-				molecule.Atoms().push_back(atom);
-			}
-		}
-		if( line.find("MODEL") == 0 ) break;
-	}
-	
-	molecule.Frames().reserve(spos.size()); 
+    index.Add(MODEL,"MODEL",0);
+    index.SetFrameSection(MODEL);
+}
 
-	for(it=spos.begin();it!=spos.end();++it)
-        {
-		m_file->clear();
-		m_file->seekg(*it,std::ios::beg);
-		//First count the atoms
-		
-		molecule.Frames().push_back(Frame(&molecule));
-		Frame& frame=molecule.Frames().back();
-		
-		frame.XYZ().resize(molecule.Atoms().size());
-		
-		std::vector<Coordinate>::iterator ct=frame.XYZ().begin();
-		
-		while(std::getline(*m_file,line))
-		{
-#ifdef __GNUC__
-#warning optimize this function call, redundant parsering
-#endif
-			if ( line.find("HETATM") != std::string::npos  || line.find("ATOM") != std::string::npos )
-			{
-				std::vector<std::string> tokens=ParseAtomLine(line);
-				
-				ct->x()=std::atof(tokens.at(5).c_str());
-				ct->y()=std::atof(tokens.at(6).c_str());
-				ct->z()=std::atof(tokens.at(7).c_str());
-				++ct;
-				
-			}
-			if( line.find("MODEL") == 0  ) break;
-		}
-		
-		
-	}
-        return true;
-	
+bool PDBParser::ParseFile(std::streampos /*pos*/)
+{
+    const std::string_view text=Text();
+
+    //each model begins after its MODEL line, a file without models is a single structure
+    m_models.clear();
+    for(const SectionIndex::Entry& e : Sections().Entries(MODEL))
+    {
+        LineReader reader(text,static_cast<size_t>(e.offset));
+        reader.Skip();
+        m_models.push_back(reader.Offset());
+    }
+    if ( m_models.empty() ) m_models.push_back(0);
+    m_models.push_back(text.size());
+
+    Molecules()->push_back(Molecule());
+    Molecule& molecule=Molecules()->back();
+    GetAtoms(m_models[0],m_models[1]);
+
+    std::vector<FrameBlock> blocks(m_models.size()-1);
+    ParseFrames(molecule,blocks);
+
+    m_file->clear();
+    m_file->seekg(0,std::ios::beg);
+    return true;
 }
 
+void PDBParser::GetAtoms(size_t begin, size_t end)
+{
+    Molecule& molecule=Molecules()->back();
+    const std::string_view text=Text().substr(0,end);
+
+    //the residues of the file and the atoms already built, by the columns identifying them: residue name,
+    //chain, sequence number and insertion code (17-26) and atom name and element (12-15 and 76-77)
+    std::unordered_map<std::string_view,PDBResidue*> residues;
+    std::unordered_map<std::string,Atom> atoms;
+
+    LineReader reader(text,begin);
+    std::string_view line;
+    while ( reader.Next(line) )
+    {
+        if ( !IsAtomRecord(line) ) continue;
 
-std::vector<std::string> PDBParser::ParseAtomLine(const std::string& line)
+        const std::string_view element=Columns(line,76,2);
+        std::string key(Columns(line,12,4));
+        key.append(element.begin(),element.end());
+        std::unordered_map<std::string,Atom>::iterator at=atoms.find(key);
+        if ( at == atoms.end() )
+        {
+            //if we dont have symbol record extract it from the pdb atom name
+            const std::string pdbname=RemoveBlanks(Columns(line,12,4));
+            std::string symbol=RemoveBlanks(element);
+            if ( symbol.empty() ) symbol=ExtractAtomName(pdbname);
+            Atom atom(symbol);
+            atom.SetPDBName(pdbname);
+            at=atoms.insert(std::make_pair(key,atom)).first;
+        }
+
+        const std::string_view residuekey=Columns(line,17,10);
+        std::unordered_map<std::string_view,PDBResidue*>::iterator rt=residues.find(residuekey);
+        if ( rt == residues.end() )
+        {
+            //resnumber is not an index see especification!!!
+            const std::string_view chain=Columns(line,21,1);
+            PDBResidue* nresidue=new PDBResidue(RemoveBlanks(Columns(line,17,3)),RemoveBlanks(Columns(line,22,5)),
+                                                chain.empty() ? ' ' : chain[0]);
+            molecule.Residues().push_back(nresidue);
+            rt=residues.insert(std::make_pair(residuekey,nresidue)).first;
+        }
+
+        molecule.Atoms().push_back(at->second);
+        molecule.Atoms().back().SetPDBResidue(rt->second);
+    }
+}
+
+void PDBParser::ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& /*block*/)
 {
-	std::vector<std::string> tokens;
-	tokens.reserve(9);
-	tokens.push_back(line.substr(0,6)); //"ATOM  " or "HETATOM" 0
-	tokens.push_back(line.substr(6,5)); //Serial number 1
-	
-	std::string pdbname=line.substr(12,4);
-	
-	
-	pdbname.erase(std::remove(pdbname.begin(), pdbname.end(),' '), pdbname.end()); 
-	tokens.push_back(pdbname);// atom pdb name 2
-	
-	std::string resname=line.substr(17,3);
-	resname.erase(std::remove(resname.begin(),resname.end(),' '),resname.end());
-	tokens.push_back(resname);// atom residue name
-	
-	
-	std::string resindex=line.substr(22,5);
-	resindex.erase(std::remove(resindex.begin(),resindex.end(),' '),resindex.end());
-	tokens.push_back(resindex);//resnumber is not an index see especification!!! 4
-	
-	tokens.push_back(line.substr(30,8));//x coordinate 5
-	tokens.push_back(line.substr(38,8));//y coordinate 6
-	tokens.push_back(line.substr(46,8));//z coordinate 7
-	
-       //we may not have atomic number here
-	if (line.size() >= 78 )
-	{
-		std::string symbol=line.substr(76,2);
-		symbol.erase(std::remove(symbol.begin(),symbol.end(),' '),symbol.end());
-		tokens.push_back(symbol);//element symbol 8
-	}
-	
-	return tokens;
-	
+    //the atoms of every model are the atoms of the first one, coordinates missing in a model are left at the origin
+    const size_t natoms=target.ParentMolecule()->Atoms().size();
+    target.XYZ().resize(natoms);
+    std::vector<Coordinate>::iterator ct=target.XYZ().begin();
+
+    LineReader reader(text.substr(0,m_models[frame+1]),m_models[frame]);
+    std::string_view line;
+    while ( ct != target.XYZ().end() && reader.Next(line) )
+    {
+        if ( !IsAtomRecord(line) ) continue;
+        ct->x()=ToDouble(Columns(line,30,8));
+        ct->y()=ToDouble(Columns(line,38,8));
+        ct->z()=ToDouble(Columns(line,46,8));
+        ++ct;
+    }
 }
 
 std::string PDBParser::ExtractAtomName(const std::string& s)
@@ -191,12 +171,12 @@ std::string PDBParser::ExtractAtomName(const std::string& s)
 			atomnames.push_back(it);
 			cpos.push_back(s.find(p,0));
 		}
-		
+
 		if( atomnames.size() == 1 ) break;
 	}
-	
-	if ( !atomnames.empty() ) 
+
+	if ( !atomnames.empty() )
 		return atomnames.at(0)->first;
 	else return "X";
-	
+
 }
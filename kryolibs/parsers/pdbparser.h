@@ -20,6 +20,12 @@ the Free Software Foundation version 2 of the License.
 namespace kryomol
 {
 
+/** @brief parser of PDB files
+
+The atoms and residues are read from the ATOM and HETATM records of the first model, and every MODEL
+(NMR ensembles, MD snapshots) is a frame of the molecule. The records are read by their fixed columns
+straight from the text in memory. Residues are found through a hash table keyed by the residue name, chain,
+sequence number and insertion code, and the coordinates of the models are parsed concurrently*/
 class KRYOMOLPARSERS_API PDBParser : public kryomol::Parser
 {
 public:
@@ -27,10 +33,20 @@ public:
     PDBParser(std::istream* stream);
     ~PDBParser();
     bool ParseFile(std::streampos pos=0);
+protected:
+    void DefineSections(SectionIndex& index);
+    void ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& block);
 private:
-  std::vector<std::string> ParseAtomLine(const std::string& line);
+  /** sections recorded in the index of the file*/
+  enum section { MODEL };
+  /** read the atoms and residues of the first model, from @param begin to @param end of the text*/
+  void GetAtoms(size_t begin, size_t end);
   std::string ExtractAtomName(const std::string& s);
 
+private:
+  /** beginning of each model in the text, and the end of the last one*/
+  std::vector<size_t> m_models;
+
 };
 
 }
@@ -0,0 +1,210 @@
+/*****************************************************************************************
+                            sectionindex.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <algorithm>
+
+#include "sectionindex.h"
+#include "mappedfile.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** size of the blocks read from the stream*/
+    const size_t blocksize=1<<20;
+
+    bool LessOffset ( const SectionIndex::Entry& e, std::streamoff offset )
+    {
+        return e.offset < offset;
+    }
+}
+
+SectionIndex::SectionIndex() : m_lastjob ( -1 ), m_lastframe ( -1 ), m_job ( 0 ), m_frame ( 0 ), m_scanned ( 0 ), m_linestart ( 0 ),
+  m_built ( false )
+{
+}
+
+void SectionIndex::Resize ( int section )
+{
+    if ( section < 0 )
+        throw kryomol::Exception ( "negative section identifier" );
+    if ( static_cast<size_t> ( section ) >= m_entries.size() )
+    {
+        m_entries.resize ( section+1 );
+        m_jobsection.resize ( section+1,false );
+        m_framesection.resize ( section+1,false );
+    }
+}
+
+void SectionIndex::Add ( int section, const std::string& marker, int column /*=-1*/ )
+{
+    if ( marker.find_first_of ( "\n\r" ) != std::string::npos )
+        throw kryomol::Exception ( "section markers can not span several lines" );
+    Resize ( section );
+    m_matcher.Add ( marker );
+    m_patternsection.push_back ( section );
+    m_patterncolumn.push_back ( column );
+    Clear();
+}
+
+void SectionIndex::SetJobSection ( int section )
+{
+    Resize ( section );
+    m_jobsection[section]=true;
+}
+
+void SectionIndex::SetFrameSection ( int section )
+{
+    Resize ( section );
+    m_framesection[section]=true;
+}
+
+void SectionIndex::Clear()
+{
+    for ( std::vector< std::vector<Entry> >::iterator it=m_entries.begin();it!=m_entries.end();++it )
+        it->clear();
+    m_lastjob=-1;
+    m_lastframe=-1;
+    m_job=0;
+    m_frame=0;
+    m_scanned=0;
+    m_linestart=0;
+    m_built=false;
+}
+
+void SectionIndex::Record ( size_t pattern, std::streamoff linestart, std::streamoff offset )
+{
+    const int column=m_patterncolumn[pattern];
+    if ( column >= 0 && offset-linestart != column ) return;
+    const int section=m_patternsection[pattern];
+
+    //several markers of a section can be found in the same line
+    std::vector<Entry>& entries=m_entries[section];
+    if ( !entries.empty() && entries.back().offset == linestart ) return;
+
+    if ( m_jobsection[section] && m_lastjob != linestart )
+    {
+        ++m_job;
+        m_lastjob=linestart;
+    }
+    if ( m_framesection[section] && m_lastframe != linestart )
+    {
+        ++m_frame;
+        m_lastframe=linestart;
+    }
+    entries.push_back ( Entry ( linestart,m_job,m_frame ) );
+}
+
+/** search the block @param data starting at offset @param base of the text. @param linestart is the beginning
+    of the last line of the previous blocks, and is updated for the next one*/
+void SectionIndex::Scan ( const char* data, size_t size, std::streamoff base, std::streamoff& linestart )
+{
+    m_matcher.Feed ( data,size,[&] ( size_t p,size_t offset )
+    {
+        //markers do not hold newlines, so a marker starting in a previous block belongs to its last line
+        std::streamoff start=linestart;
+        for ( std::streamoff i=static_cast<std::streamoff> ( offset )-base-1;i >= 0;--i )
+        {
+            if ( data[i] == '\n' )
+            {
+                start=base+i+1;
+                break;
+            }
+        }
+        Record ( p,start,static_cast<std::streamoff> ( offset ) );
+        return true;
+    } );
+    for ( std::streamoff i=static_cast<std::streamoff> ( size )-1;i >= 0;--i )
+    {
+        if ( data[i] == '\n' )
+        {
+            linestart=base+i+1;
+            break;
+        }
+    }
+}
+
+void SectionIndex::Build ( std::istream& stream )
+{
+    std::string_view text;
+    if ( StreamText ( stream,text ) )
+    {
+        Build ( text );
+        return;
+    }
+
+    Clear();
+    stream.clear();
+    const std::streampos current=stream.tellg();
+    stream.seekg ( 0,std::ios::beg );
+    m_matcher.Reset();
+
+    std::vector<char> block ( blocksize );
+    //m_scanned is the offset of the first character of the block
+    while ( stream )
+    {
+        stream.read ( &block[0],blocksize );
+        const std::streamsize n=stream.gcount();
+        if ( n <= 0 ) break;
+        Scan ( &block[0],static_cast<size_t> ( n ),m_scanned,m_linestart );
+        m_scanned+=n;
+    }
+
+    stream.clear();
+    stream.seekg ( current < 0 ? std::streampos ( 0 ) : current,std::ios::beg );
+    m_built=true;
+}
+
+void SectionIndex::Build ( std::string_view text )
+{
+    Clear();
+    m_matcher.Reset();
+    Scan ( text.data(),text.size(),0,m_linestart );
+    m_scanned=static_cast<std::streamoff> ( text.size() );
+    m_built=true;
+}
+
+/** the matcher keeps its state between blocks, so the markers split by the previous end of the text are found*/
+void SectionIndex::Extend ( std::string_view text )
+{
+    const std::streamoff size=static_cast<std::streamoff> ( text.size() );
+    if ( !m_built || size < m_scanned )
+    {
+        Build ( text );
+        return;
+    }
+    Scan ( text.data() +m_scanned,static_cast<size_t> ( size-m_scanned ),m_scanned,m_linestart );
+    m_scanned=size;
+}
+
+const std::vector<SectionIndex::Entry>& SectionIndex::Entries ( int section ) const
+{
+    static const std::vector<Entry> none;
+    if ( section < 0 || static_cast<size_t> ( section ) >= m_entries.size() ) return none;
+    return m_entries[section];
+}
+
+size_t SectionIndex::First ( int section, std::streamoff from ) const
+{
+    const std::vector<Entry>& entries=Entries ( section );
+    if ( from < 0 ) return entries.size();
+    return std::lower_bound ( entries.begin(),entries.end(),from,LessOffset )-entries.begin();
+}
+
+std::streamoff SectionIndex::Find ( int section, std::streamoff from, std::streamoff to /*=-1*/ ) const
+{
+    const std::vector<Entry>& entries=Entries ( section );
+    const size_t i=First ( section,from );
+    if ( i == entries.size() ) return -1;
+    if ( to >= 0 && entries[i].offset >= to ) return -1;
+    return entries[i].offset;
+}
@@ -0,0 +1,96 @@
+/*****************************************************************************************
+                            sectionindex.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef SECTIONINDEX_H
+#define SECTIONINDEX_H
+
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "multipatternmatcher.h"
+#include "parsersexport.h"
+
+namespace kryomol
+{
+  /** @brief byte offsets of the sections of a program output
+
+  Each section is identified by an integer chosen by the parser and recognized by one or more marker
+  strings. The whole stream is read once in large blocks and all the markers are searched together, so
+  a parser can afterwards seek directly to the line where a section begins instead of reading the file
+  again with getline for every quantity. Every entry is tagged with the job and the frame it belongs to,
+  counted as the number of lines of the sections declared as job or frame boundaries found up to the
+  entry (so entries before the first boundary belong to job 0 and frame 0)*/
+  class KRYOMOLPARSERS_API SectionIndex
+  {
+    public:
+      struct Entry
+      {
+        Entry ( std::streamoff o, size_t j, size_t f ) : offset ( o ), job ( j ), frame ( f ) {}
+        /** position of the beginning of the line holding the marker*/
+        std::streamoff offset;
+        size_t job;
+        size_t frame;
+      };
+    public:
+      SectionIndex();
+      /** lines containing @param marker begin a section @param section. If @param column is not negative the
+          marker must start at that column of the line. Markers can not span several lines*/
+      void Add ( int section, const std::string& marker, int column=-1 );
+      /** each line of @param section begins a new job*/
+      void SetJobSection ( int section );
+      /** each line of @param section begins a new frame*/
+      void SetFrameSection ( int section );
+      /** read @param stream from the beginning and record the sections. The position of the stream is restored.
+          Streams reading memory, as MappedStream, are scanned in place*/
+      void Build ( std::istream& stream );
+      /** record the sections of the whole @param text*/
+      void Build ( std::string_view text );
+      /** record the sections of the characters of @param text after the ones already indexed, the text of a
+          file that grew since the index was built. The whole text is indexed again if it is shorter*/
+      void Extend ( std::string_view text );
+      /** forget the entries, the markers are kept so the index can be built again*/
+      void Clear();
+      bool IsBuilt() const { return m_built; }
+      /** @return the entries of @param section ordered by offset*/
+      const std::vector<Entry>& Entries ( int section ) const;
+      /** @return the index in Entries(section) of the first entry at or after @param from. A negative
+          @param from, the position of a stream that failed, is past all the entries*/
+      size_t First ( int section, std::streamoff from ) const;
+      /** @return the offset of the first entry of @param section at or after @param from and before
+          @param to (till the end if negative), -1 if there is none*/
+      std::streamoff Find ( int section, std::streamoff from, std::streamoff to=-1 ) const;
+      /** @return the number of entries of @param section*/
+      size_t Count ( int section ) const { return Entries ( section ).size(); }
+    private:
+      void Record ( size_t pattern, std::streamoff linestart, std::streamoff offset );
+      void Scan ( const char* data, size_t size, std::streamoff base, std::streamoff& linestart );
+      void Resize ( int section );
+    private:
+      MultiPatternMatcher m_matcher;
+      std::vector<int> m_patternsection;
+      std::vector<int> m_patterncolumn;
+      std::vector<bool> m_jobsection;
+      std::vector<bool> m_framesection;
+      std::vector< std::vector<Entry> > m_entries;
+      std::streamoff m_lastjob;
+      std::streamoff m_lastframe;
+      size_t m_job;
+      size_t m_frame;
+      /** number of characters indexed and beginning of the last line indexed*/
+      std::streamoff m_scanned;
+      std::streamoff m_linestart;
+      bool m_built;
+  };
+}
+
+#endif
@@ -0,0 +1,377 @@
+/*****************************************************************************************
+                            structurewriter.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <QFile>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "structurewriter.h"
+#include "molecule.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** size of the blocks of text given to the compressor and of the data it writes at once*/
+    const size_t blocksize=1<<20;
+
+    /** append @param s to @param text, left justified in @param width characters*/
+    void AppendLeft ( std::string& text, std::string_view s, size_t width )
+    {
+        text.append ( s.data(),s.size() );
+        if ( s.size() < width ) text.append ( width-s.size(),' ' );
+    }
+
+    /** append @param s to @param text, right justified in @param width characters*/
+    void AppendRight ( std::string& text, std::string_view s, size_t width )
+    {
+        if ( s.size() < width ) text.append ( width-s.size(),' ' );
+        text.append ( s.data(),s.size() );
+    }
+
+    void AppendInt ( std::string& text, long value, size_t width )
+    {
+        char buffer[24];
+        const std::to_chars_result r=std::to_chars ( buffer,buffer+sizeof ( buffer ),value );
+        AppendRight ( text,std::string_view ( buffer,r.ptr-buffer ),width );
+    }
+
+    /** append @param value with @param precision decimals, right justified in @param width characters*/
+    void AppendFixed ( std::string& text, double value, size_t width, int precision )
+    {
+        char buffer[64];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        const std::to_chars_result r=std::to_chars ( buffer,buffer+sizeof ( buffer ),value,std::chars_format::fixed,precision );
+        const size_t n= r.ec == std::errc() ? r.ptr-buffer : 0;
+#else
+        //standard libraries without floating point to_chars
+        const int written=std::snprintf ( buffer,sizeof ( buffer ),"%.*f",precision,value );
+        const size_t n= written < 0 ? 0 : std::min ( static_cast<size_t> ( written ),sizeof ( buffer )-1 );
+#endif
+        AppendRight ( text,std::string_view ( buffer,n ),width );
+    }
+
+    /** @return the MDL bond type of @param order*/
+    int MDLBondType ( Bond::order order )
+    {
+        switch ( order )
+        {
+        case Bond::DOUBLE:
+            return 2;
+        case Bond::TRIPLE:
+            return 3;
+        case Bond::AROMATIC:
+            return 4;
+        default:
+            return 1;
+        }
+    }
+
+    /** @brief the text written to a stream as is or compressed*/
+    class Sink
+    {
+    public:
+        Sink ( std::ostream& s, bool gzip ) : m_stream ( s ), m_gzip ( gzip ), m_open ( !gzip )
+        {
+#ifdef WITH_ZLIB
+            if ( m_gzip )
+            {
+                std::memset ( &m_z,0,sizeof ( m_z ) );
+                //gzip header and trailer
+                m_open=deflateInit2 ( &m_z,Z_DEFAULT_COMPRESSION,Z_DEFLATED,15+16,8,Z_DEFAULT_STRATEGY ) == Z_OK;
+                if ( m_open ) m_buffer.resize ( blocksize );
+            }
+#endif
+        }
+        ~Sink()
+        {
+#ifdef WITH_ZLIB
+            if ( m_gzip && m_open ) deflateEnd ( &m_z );
+#endif
+        }
+        bool IsOpen() const { return m_open; }
+        bool Write ( const std::string& text )
+        {
+            if ( !m_gzip )
+            {
+                m_stream.write ( text.data(),text.size() );
+                return m_stream.good();
+            }
+#ifdef WITH_ZLIB
+            return Deflate ( text.data(),text.size(),Z_NO_FLUSH );
+#else
+            return false;
+#endif
+        }
+        /** write what the compressor still holds*/
+        bool Finish()
+        {
+#ifdef WITH_ZLIB
+            if ( m_gzip ) return Deflate ( NULL,0,Z_FINISH );
+#endif
+            return m_stream.good();
+        }
+    private:
+#ifdef WITH_ZLIB
+        bool Deflate ( const char* data, size_t size, int flush )
+        {
+            if ( !m_open ) return false;
+            do
+            {
+                //the sizes given to zlib are 32 bits
+                const size_t n=std::min ( size,blocksize );
+                m_z.next_in=reinterpret_cast<Bytef*> ( const_cast<char*> ( data ) );
+                m_z.avail_in=static_cast<uInt> ( n );
+                data+=n;
+                size-=n;
+                const int mode= size == 0 ? flush : Z_NO_FLUSH;
+                do
+                {
+                    m_z.next_out=reinterpret_cast<Bytef*> ( &m_buffer[0] );
+                    m_z.avail_out=static_cast<uInt> ( m_buffer.size() );
+                    if ( deflate ( &m_z,mode ) == Z_STREAM_ERROR ) return false;
+                    m_stream.write ( &m_buffer[0],m_buffer.size()-m_z.avail_out );
+                }
+                while ( m_z.avail_out == 0 );
+            }
+            while ( size > 0 );
+            return m_stream.good();
+        }
+        z_stream m_z;
+        std::vector<char> m_buffer;
+#endif
+        std::ostream& m_stream;
+        bool m_gzip;
+        bool m_open;
+    };
+}
+
+StructureWriter::StructureWriter ( const Molecule* molecule, Format format ) : m_molecule ( molecule ), m_format ( format )
+{}
+
+StructureWriter::~StructureWriter()
+{}
+
+bool StructureWriter::FormatOf ( const QString& file, Format& format, bool& gzip )
+{
+    QString name=file.toLower();
+    gzip=name.endsWith ( ".gz" );
+    if ( gzip ) name.chop ( 3 );
+    if ( name.endsWith ( ".xyz" ) )
+        format=XYZ;
+    else if ( name.endsWith ( ".sdf" ) || name.endsWith ( ".sd" ) || name.endsWith ( ".mol" ) )
+        format=SDF;
+    else if ( name.endsWith ( ".pdb" ) )
+        format=PDB;
+    else return false;
+    return true;
+}
+
+/** the extension decides the format, so the file is read back as it was written*/
+bool StructureWriter::Write ( const QString& file ) const
+{
+    Format format;
+    bool gzip=false;
+    if ( !FormatOf ( file,format,gzip ) ) return false;
+    StructureWriter writer ( *this );
+    writer.m_format=format;
+    std::ofstream s ( QFile::encodeName ( file ).constData(),std::ios::out|std::ios::binary );
+    if ( !s ) return false;
+    if ( !writer.Write ( s,gzip ) ) return false;
+    s.close();
+    return !s.fail();
+}
+
+bool StructureWriter::Write ( std::ostream& s, bool gzip /*=false*/ ) const
+{
+    Sink sink ( s,gzip );
+    if ( !sink.IsOpen() ) return false;
+
+    std::vector<size_t> frames;
+    const size_t count=m_molecule->FrameCount();
+    if ( m_frames.empty() )
+    {
+        frames.resize ( count );
+        for ( size_t i=0;i<count;++i ) frames[i]=i;
+    }
+    else
+    {
+        for ( size_t i=0;i<m_frames.size();++i )
+        {
+            if ( m_frames[i] < count ) frames.push_back ( m_frames[i] );
+        }
+    }
+
+    //the buffers keep their memory from one block to the next
+    std::vector<std::string> texts ( std::min<size_t> ( BLOCKSIZE,frames.size() ) );
+    std::vector<const Frame*> block;
+    std::vector<Frame> read;
+    for ( size_t first=0;first<frames.size();first+=BLOCKSIZE )
+    {
+        const size_t n=std::min<size_t> ( BLOCKSIZE,frames.size()-first );
+        block.resize ( n );
+        if ( m_molecule->HasFrameSource() )
+        {
+            //the frame source is read by a single thread
+            read.resize ( n,Frame ( const_cast<Molecule*> ( m_molecule ) ) );
+            for ( size_t i=0;i<n;++i )
+            {
+                //the buffer holds a conformer of the previous block, it is not written in place of a malformed one
+                if ( !m_molecule->ReadFrame ( frames[first+i],read[i] ) ) return false;
+                block[i]=&read[i];
+            }
+        }
+        else
+        {
+            for ( size_t i=0;i<n;++i ) block[i]=&m_molecule->Frames() [frames[first+i]];
+        }
+
+        const long nframes=static_cast<long> ( n );
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) if(nframes > 1)
+#endif
+        for ( long i=0;i<nframes;++i )
+        {
+            texts[i].clear();
+            FormatFrame ( *block[i],frames[first+i],texts[i] );
+        }
+
+        for ( size_t i=0;i<n;++i )
+        {
+            if ( !sink.Write ( texts[i] ) ) return false;
+        }
+    }
+
+    if ( m_format == PDB && !sink.Write ( "END\n" ) ) return false;
+    return sink.Finish();
+}
+
+void StructureWriter::FormatFrame ( const Frame& frame, size_t index, std::string& text ) const
+{
+    const std::vector<Atom>& atoms=m_molecule->Atoms();
+    const std::vector<Coordinate>& xyz=frame.XYZ();
+    const size_t natoms=std::min ( atoms.size(),xyz.size() );
+    std::string title="Frame #";
+    AppendInt ( title,static_cast<long> ( index+1 ),0 );
+
+    switch ( m_format )
+    {
+    case XYZ:
+    {
+        text.reserve ( text.size() +natoms*40+title.size() +16 );
+        AppendInt ( text,static_cast<long> ( natoms ),0 );
+        text+='\n';
+        text+=title;
+        text+='\n';
+        for ( size_t i=0;i<natoms;++i )
+        {
+            AppendLeft ( text,atoms[i].Symbol(),3 );
+            AppendFixed ( text,xyz[i].x(),12,6 );
+            AppendFixed ( text,xyz[i].y(),12,6 );
+            AppendFixed ( text,xyz[i].z(),12,6 );
+            text+='\n';
+        }
+        break;
+    }
+    case SDF:
+    {
+        //V2000 connection table, the bonds of the molecule or else those of the frame
+        const std::vector<Bond>& bonds=m_molecule->Bonds().empty() ? frame.Bonds() : m_molecule->Bonds();
+        text.reserve ( text.size() +natoms*70+bonds.size() *22+title.size() +128 );
+        text+=title;
+        text+="\n  KryoMol           3D\n\n";
+        AppendInt ( text,static_cast<long> ( natoms ),3 );
+        AppendInt ( text,static_cast<long> ( bonds.size() ),3 );
+        text+="  0  0  0  0  0  0  0  0999 V2000\n";
+        for ( size_t i=0;i<natoms;++i )
+        {
+            AppendFixed ( text,xyz[i].x(),10,4 );
+            AppendFixed ( text,xyz[i].y(),10,4 );
+            AppendFixed ( text,xyz[i].z(),10,4 );
+            text+=' ';
+            AppendLeft ( text,atoms[i].Symbol(),3 );
+            text+=" 0  0  0  0  0  0  0  0  0  0  0  0\n";
+        }
+        for ( std::vector<Bond>::const_iterator bt=bonds.begin();bt!=bonds.end();++bt )
+        {
+            AppendInt ( text,static_cast<long> ( bt->I() +1 ),3 );
+            AppendInt ( text,static_cast<long> ( bt->J() +1 ),3 );
+            AppendInt ( text,MDLBondType ( bt->Order() ),3 );
+            text+="  0  0  0  0\n";
+        }
+        text+="M  END\n$$$$\n";
+        break;
+    }
+    case PDB:
+    {
+        //a single structure is written without MODEL records
+        const bool models= m_frames.empty() ? m_molecule->FrameCount() > 1 : m_frames.size() > 1;
+        text.reserve ( text.size() +natoms*82+32 );
+        if ( models )
+        {
+            text+="MODEL ";
+            AppendInt ( text,static_cast<long> ( index+1 ),8 );
+            text+='\n';
+        }
+        for ( size_t i=0;i<natoms;++i )
+        {
+            const Atom& atom=atoms[i];
+            const PDBResidue* residue=atom.Residue();
+            std::string_view name=atom.PDBName();
+            if ( name.empty() ) name=atom.Symbol();
+            //the residue sequence number followed by the insertion code
+            std::string_view sequence="1";
+            char icode=' ';
+            if ( residue )
+            {
+                sequence=residue->Index();
+                if ( !sequence.empty() && std::isalpha ( static_cast<unsigned char> ( sequence.back() ) ) )
+                {
+                    icode=sequence.back();
+                    sequence.remove_suffix ( 1 );
+                }
+            }
+
+            text+= residue ? "ATOM  " : "HETATM";
+            AppendInt ( text,static_cast<long> ( ( i+1 ) %100000 ),5 );
+            text+=' ';
+            //names of one letter elements begin in the second column of the field
+            const size_t width= ( name.size() < 4 && atom.Symbol().size() == 1 ) ? 3 : 4;
+            if ( width == 3 ) text+=' ';
+            AppendLeft ( text,name.substr ( 0,width ),width );
+            text+=' ';
+            AppendRight ( text,residue ? std::string_view ( residue->Name() ).substr ( 0,3 ) : std::string_view ( "UNL" ),3 );
+            text+=' ';
+            text+= residue ? residue->Chain() : ' ';
+            AppendRight ( text,sequence.substr ( 0,4 ),4 );
+            text+=icode;
+            text+="   ";
+            AppendFixed ( text,xyz[i].x(),8,3 );
+            AppendFixed ( text,xyz[i].y(),8,3 );
+            AppendFixed ( text,xyz[i].z(),8,3 );
+            text+="  1.00  0.00          ";
+            AppendRight ( text,std::string_view ( atom.Symbol() ).substr ( 0,2 ),2 );
+            text+='\n';
+        }
+        if ( models ) text+="ENDMDL\n";
+        break;
+    }
+    }
+}
@@ -0,0 +1,62 @@
+/*****************************************************************************************
+                            structurewriter.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef STRUCTUREWRITER_H
+#define STRUCTUREWRITER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <QString>
+
+#include "parsersexport.h"
+
+namespace kryomol
+{
+  class Molecule;
+  class Frame;
+
+  /** @brief writer of the conformers of a molecule as multi-structure XYZ, SDF or PDB files
+
+  The conformers are formatted in blocks, the frames of a block concurrently, each one in a buffer of its
+  own with the numbers converted by std::to_chars, and the buffers are written in order in a single call
+  each. Nothing is flushed until the end, so long trajectories and large conformer sets are not bound by
+  the calls to the system. Conformers read on demand from a frame source are read block by block. The
+  output can be compressed with gzip (WITH_ZLIB)*/
+  class KRYOMOLPARSERS_API StructureWriter
+  {
+    public:
+      enum Format { XYZ, SDF, PDB };
+      /** conformers formatted at once*/
+      enum { BLOCKSIZE=256 };
+      StructureWriter ( const kryomol::Molecule* molecule, Format format );
+      ~StructureWriter();
+      /** write only the conformers @param frames, in that order. All of them are written by default*/
+      void SetFrames ( const std::vector<size_t>& frames ) { m_frames=frames; }
+      /** @return false if the extension of @param file, .xyz, .sdf, .sd, .mol or .pdb optionally followed by
+          .gz, is none of them, otherwise its format in @param format and whether it is compressed in @param gzip*/
+      static bool FormatOf ( const QString& file, Format& format, bool& gzip );
+      /** write the conformers to @param s, compressed with gzip if @param gzip
+          @return false if the stream fails, gzip is not available or a conformer read on demand is malformed*/
+      bool Write ( std::ostream& s, bool gzip=false ) const;
+      /** write the conformers to @param file, in the format of its extension and compressed if it ends in .gz
+          @return false if the extension is not known (@see FormatOf) or the file can not be written*/
+      bool Write ( const QString& file ) const;
+      /** append conformer @param frame, numbered @param index from 0, to @param text*/
+      void FormatFrame ( const Frame& frame, size_t index, std::string& text ) const;
+    private:
+      const kryomol::Molecule* m_molecule;
+      Format m_format;
+      std::vector<size_t> m_frames;
+  };
+}
+
+#endif
@@ -10,11 +10,10 @@ the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
 
-#include <iostream>
-#include <sstream>
 #include "xyzparser.h"
+#include "indexedframes.h"
 #include "molecule.h"
-#include "stringtools.h"
+#include "exception.h"
 
 using namespace kryomol;
 
@@ -32,63 +31,46 @@ XYZParser::~XYZParser()
 
 bool XYZParser::ParseFile(std::streampos pos)
 {
-  m_file->clear();
-  m_file->seekg(pos,std::ios::beg);
-  GetGeometry();
-
-  return true;
+  const std::string_view text=Text();
+  m_structures=IndexedFrames::Index(text,IndexedFrames::XYZ,static_cast<size_t>(pos));
+  Molecules()->push_back(Molecule());
+  Molecule& molecule=Molecules()->back();
 
-}
+  //the atoms are those of the first structure
+  std::vector<Coordinate> xyz;
+  if ( m_structures.empty() || !IndexedFrames::Decode(text,m_structures.front(),IndexedFrames::XYZ,xyz,&molecule.Atoms()) )
+    return true;
 
-bool XYZParser::GetGeometry()
-{
-  std::string line;
-  Molecules()->push_back(Molecule());
-  m_bfirst=false;
-  while(std::getline(*m_file,line))
+  //large files are read on demand from a mapping of their own, the stream of the parser does not outlive it
+  const QString path=Path();
+  if ( m_structures.size() > IndexedFrames::ONDEMAND && !path.isEmpty() )
   {
-
-    StringTokenizer token(line," \t\r");
-    if ( token.size() == 4  )
+    IndexedFrames* source=new IndexedFrames(path,IndexedFrames::XYZ,m_structures,molecule.Atoms().size());
+    if ( source->IsOpen() )
     {
-      if ( kryomol::isnum(token.at(1)) && kryomol::isnum(token.at(2)) && kryomol::isnum(token.at(3)) )
-        GetMolecule(line);
+      molecule.SetFrameSource(source);
+      return true;
     }
-
+    delete source;
   }
+
+  std::vector<FrameBlock> blocks(m_structures.size());
+  ParseFrames(molecule,blocks);
 #ifdef __GNUC__
 #warning supressed move to centroid
 #endif
 
+  m_file->clear();
+  m_file->seekg(0,std::ios::beg);
   return true;
 }
 
-void XYZParser::GetMolecule(std::string& line)
+/** every structure must have the atoms of the first one, that are those of the molecule*/
+void XYZParser::ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& /*block*/)
 {
-  Molecule& molecule=Molecules()->back();
-  molecule.Frames().push_back(Frame(&molecule));
-  Frame& frame= molecule.Frames().back();
-  do
+  if ( !IndexedFrames::Decode(text,m_structures[frame],IndexedFrames::XYZ,target.XYZ()) ||
+       target.XYZ().size() != Molecules()->back().Atoms().size() )
   {
-    StringTokenizer token(line," \t\r");
-    if ( token.size() != 4 )
-    {
-      m_bfirst=true;
-      return;
-    }
-    if(!m_bfirst)
-    {
-      Atom atom(token.at(0));
-      molecule.Atoms().push_back(atom);
-    }
-    Coordinate c;
-    c.x()=std::atof(token.at(1).c_str());
-    c.y()=std::atof(token.at(2).c_str());
-    c.z()=std::atof(token.at(3).c_str());
-
-    frame.XYZ().push_back(c);
-
+    throw kryomol::Exception("Error parsering xyz file");
   }
-  while(std::getline(*m_file,line));
 }
-
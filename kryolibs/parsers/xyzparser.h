@@ -12,13 +12,18 @@ the Free Software Foundation version 2 of the License.
 #ifndef XYZPARSER_H
 #define XYZPARSER_H
 
+#include <vector>
+
 #include "parser.h"
 
 namespace kryomol
 {
-/**
-A class for parsering of XYZ files
-*/
+/** @brief parser of XYZ files
+
+Every structure of the file, an atom count, a comment and the atoms, is a frame of the molecule. The
+structures are found in a single pass over the text; a few of them are parsed concurrently, while files
+with more than IndexedFrames::ONDEMAND structures, as the conformer searches and trajectories, are read on
+demand through @see IndexedFrames, so only the frame shown is held in memory*/
 class KRYOMOLPARSERS_API XYZParser : public kryomol::Parser
 {
 public:
@@ -26,10 +31,11 @@ public:
     XYZParser(std::istream* stream);
     ~XYZParser();
     bool ParseFile(std::streampos pos=0);
+protected:
+    void ParseFrameBlock(std::string_view text, size_t frame, Frame& target, FrameBlock& block);
 private:
-  bool GetGeometry();
-  void GetMolecule(std::string& line);
-  bool m_bfirst;
+  /** beginning of each structure in the text*/
+  std::vector<size_t> m_structures;
 
 };
 
@@ -13,6 +13,7 @@ the Free Software Foundation version 2 of the License.
 
 #include  "molecule.h"
 #include "xyzwriter.h"
+#include "structurewriter.h"
 
 using namespace kryomol;
 
@@ -27,22 +28,10 @@ XYZWriter::~XYZWriter()
 std::ostream& kryomol::operator << (std::ostream& s, const XYZWriter& w)
 {
     std::cout << "Exporting in XYZ format" << std::endl;
-    s << w.m_molecule->Atoms().size() << std::endl;
-    if (w.m_all)
-    {
-        for (size_t i=0; i<w.m_molecule->Frames().size();++i)
-        {
-            s << "Frame #" << i+1 << std::endl;
-            s << w.m_molecule->Frames().at(i) << std::endl;
-            s << std::endl;
-        }
-
-    }
-    else
-    {
-        s << "title" << std::endl;
-        s << w.m_molecule->CurrentFrame() << std::endl;
-    }
+    StructureWriter writer(w.m_molecule,StructureWriter::XYZ);
+    if (!w.m_all) writer.SetFrames(std::vector<size_t>(1,w.m_molecule->CurrentFrameIndex()));
+    //a conformer that can not be read fails the stream, as an error writing it would
+    if (!writer.Write(s)) s.setstate(std::ios::failbit);
     return s;
 
 }
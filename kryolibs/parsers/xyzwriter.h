@@ -19,6 +19,7 @@ namespace kryomol
 {
   class Molecule;
 
+/** @brief XYZ coordinates of the current conformer or of all of them, written by a @see StructureWriter*/
 class KRYOMOLPARSERS_API XYZWriter
 {
 public:
@@ -38,10 +38,17 @@ const float rotationpass=5.0f;
 class GLVisor::GLVisorPrivate
 {
 public:
-    GLVisorPrivate() {}
+    GLVisorPrivate() : m_seriesmolecule ( NULL ), m_seriesframes ( 0 ), m_seriesversion ( 0 ), m_seriesvalid ( false ) {}
     ~GLVisorPrivate() {}
     //draw wireframe when moving
     bool m_bwfonmoving;
+    //measures evaluated along all the frames
+    GeometricDescriptors m_series;
+    const Molecule* m_seriesmolecule;
+    size_t m_seriesframes;
+    /** coordinates version of the molecule the series was computed from*/
+    size_t m_seriesversion;
+    bool m_seriesvalid;
 };
 
 /** \brief Constructor
@@ -174,7 +181,7 @@ void GLVisor::RenderScene ( GLenum mode )
     if ( m_world->CurrentMolecule() )
     {
         glPushMatrix();
-        Handlers() [m_world->CurrentMoleculeIndex()].ApplyTransformation(m_world->CurrentMolecule()->CurrentFrameIndex());
+        Handlers() [m_world->CurrentMoleculeIndex()].ApplyTransformation(HandlerFrame());
         RenderPlugins ( mode );
         glPopMatrix();
         if ( mode == GL_RENDER )
@@ -236,7 +243,7 @@ void GLVisor::RenderScreenText()
 {
     if ( !m_world->CurrentMolecule() ) return;
     std::stringstream label;
-    label << "#" << m_world->CurrentMolecule()->CurrentFrameIndex() +1 << " of " << m_world->CurrentMolecule()->Frames().size();
+    label << "#" << m_world->CurrentMolecule()->CurrentFrameIndex() +1 << " of " << m_world->CurrentMolecule()->FrameCount();
     QString str ( label.str().c_str() );
 
     int left=this->rect().left();
@@ -415,7 +422,7 @@ void GLVisor::mouseMoveEvent ( QMouseEvent* e )
 #endif
         if ( !Handlers().empty() )
         {
-            Handlers() [m_world->CurrentMoleculeIndex() ].Rotate ( -rotationpass,rotationvector,m_world->CurrentMolecule()->CurrentFrameIndex() );
+            Handlers() [m_world->CurrentMoleculeIndex() ].Rotate ( -rotationpass,rotationvector,HandlerFrame() );
             updateGL();
         }
 
@@ -441,13 +448,13 @@ void GLVisor::mouseMoveEvent ( QMouseEvent* e )
     {
         if ( x != 0 || y != 0 )
         {
-            Coordinate newc=Handlers() [m_world->CurrentMoleculeIndex()].RotationCenter(m_world->CurrentMolecule()->CurrentFrameIndex());
+            Coordinate newc=Handlers() [m_world->CurrentMoleculeIndex()].RotationCenter(HandlerFrame());
 
             if ( x != 0 ) newc.x() -= ( x*0.1 );
             if ( y != 0 ) newc.y() += ( y*0.1 );
 
 
-            Handlers() [m_world->CurrentMoleculeIndex()].SetRotationCenter ( newc,m_world->CurrentMolecule()->CurrentFrameIndex() );
+            Handlers() [m_world->CurrentMoleculeIndex()].SetRotationCenter ( newc,HandlerFrame() );
             update();
         }
     }
@@ -526,6 +533,7 @@ void GLVisor::ProcessOwnSelection ( int atom )
                     m_selatoms[1]+1,
                     fr.Distance ( m_selatoms[0],m_selatoms[1] ) );
             m_distances.push_back ( Molecule::pair ( m_selatoms[0],m_selatoms[1],str.toStdString() ) );
+            _d->m_seriesvalid=false;
             emit distance ( str );
             OnResetSelection ();
         }
@@ -543,6 +551,7 @@ void GLVisor::ProcessOwnSelection ( int atom )
                     m_selatoms[2]+1,
                     180*fr.Angle ( m_selatoms[0],m_selatoms[1],m_selatoms[2] ) /M_PI );
             m_angles.push_back ( Molecule::triad ( m_selatoms[0],m_selatoms[1],m_selatoms[2],str.toStdString() ) );
+            _d->m_seriesvalid=false;
             //emit text ( str );
             emit angle ( str );
             OnResetSelection ();
@@ -564,6 +573,7 @@ void GLVisor::ProcessOwnSelection ( int atom )
                     180*fr.Dihedral ( m_selatoms[0],m_selatoms[1],m_selatoms[2],m_selatoms[3] ) /M_PI );
             m_dihedrals.push_back ( Molecule::quad ( m_selatoms[0],m_selatoms[1],m_selatoms[2],
                     m_selatoms[3],str.toStdString() ) );
+            _d->m_seriesvalid=false;
 
             //emit text ( str );
             emit dihedral ( str );
@@ -611,7 +621,7 @@ void GLVisor::RenderMolecule ( size_t index,GLenum mode/*=GL_RENDER*/ )
     if ( molecule.Frames().empty() ) return;
 
     glPushMatrix();
-    Handlers()[m_world->CurrentMoleculeIndex()].ApplyTransformation(m_world->CurrentMolecule()->CurrentFrameIndex());
+    Handlers()[m_world->CurrentMoleculeIndex()].ApplyTransformation(HandlerFrame());
 
     GLUquadricObj* quadric=gluNewQuadric();
     gluQuadricDrawStyle ( quadric, ( GLenum ) GLU_FILL );
@@ -1244,6 +1254,15 @@ void GLVisor::RenderMolecule ( size_t index,GLenum mode/*=GL_RENDER*/ )
 }
 
 
+/** @return the frame of the handler of the current molecule. The structures of a molecule read on demand
+    share the handler of its single frame*/
+size_t GLVisor::HandlerFrame() const
+{
+    const Molecule* molecule=m_world->CurrentMolecule();
+    if ( molecule->HasFrameSource() ) return 0;
+    return molecule->CurrentFrameIndex();
+}
+
 /** Put trackball rotation center on centroid of the visible part*/
 void GLVisor::CenterVisiblePart()
 {
@@ -1267,7 +1286,7 @@ void GLVisor::CenterVisiblePart()
         }
         c/=visibleatoms;
         Handlers() [ m_world->CurrentMoleculeIndex() ].SetRotationCenter ( c,i );
-        if ( i == m_world->CurrentMolecule()->CurrentFrameIndex() )
+        if ( i == HandlerFrame() )
             current=c;
     }
 
@@ -1311,7 +1330,7 @@ void GLVisor::CenterMolecule ( bool b/*=true*/, bool bblock/*=true*/ )
 /** Center current molecule*/
 void GLVisor::Center()
 {
-    SetCamera ( Handlers()[m_world->CurrentMoleculeIndex()].RotationCenter(m_world->CurrentMolecule()->CurrentFrameIndex() ) );
+    SetCamera ( Handlers()[m_world->CurrentMoleculeIndex()].RotationCenter(HandlerFrame() ) );
     SetupProjection();
     update();
 }
@@ -1353,20 +1372,52 @@ void GLVisor::ResetTrackball()
     }
 }
 
+const GeometricDescriptors& GLVisor::MeasureSeries()
+{
+    //without measures there is nothing to read from the frames
+    if ( m_distances.empty() && m_angles.empty() && m_dihedrals.empty() )
+    {
+        _d->m_series.Clear();
+        _d->m_seriesvalid=false;
+        return _d->m_series;
+    }
+    const Molecule* molecule=m_world->CurrentMolecule();
+    //the structures read on demand are measured in the file, moving the one in memory does not change them
+    if ( !_d->m_seriesvalid || _d->m_seriesmolecule != molecule || _d->m_seriesframes != molecule->FrameCount() ||
+         ( !molecule->HasFrameSource() && _d->m_seriesversion != molecule->CoordinatesVersion() ) )
+    {
+        _d->m_series.Clear();
+        for ( std::vector<Molecule::pair>::const_iterator it=m_distances.begin();it!=m_distances.end();++it )
+            _d->m_series.AddDistance ( it->i,it->j );
+        for ( std::vector<Molecule::triad>::const_iterator it=m_angles.begin();it!=m_angles.end();++it )
+            _d->m_series.AddAngle ( it->i,it->j,it->k );
+        for ( std::vector<Molecule::quad>::const_iterator it=m_dihedrals.begin();it!=m_dihedrals.end();++it )
+            _d->m_series.AddDihedral ( it->i,it->j,it->k,it->l );
+        _d->m_series.Calculate ( *molecule );
+        _d->m_seriesmolecule=molecule;
+        _d->m_seriesframes=molecule->FrameCount();
+        _d->m_seriesversion=molecule->CoordinatesVersion();
+        _d->m_seriesvalid=true;
+    }
+    return _d->m_series;
+}
+
 QStringList GLVisor::GetDistances (size_t frame)
 {
     std::vector<Molecule::pair>::iterator it;
-    const Frame& fr=m_world->CurrentMolecule()->Frames().at(frame);
+    const Molecule& mol=*m_world->CurrentMolecule();
+    const GeometricDescriptors& series=MeasureSeries();
+    size_t d=0;
     QStringList list;
-    for (it=m_distances.begin();it!=m_distances.end();it++)
+    for (it=m_distances.begin();it!=m_distances.end();++it,++d)
     {
         QString str;
         str.sprintf ( "(%s%d,%s%d)  %.3f",
-                      m_world->CurrentMolecule()->Atoms() [it->i].Symbol().c_str(),
+                      mol.Atoms() [it->i].Symbol().c_str(),
                 it->i+1,
-                m_world->CurrentMolecule()->Atoms() [it->j].Symbol().c_str(),
+                mol.Atoms() [it->j].Symbol().c_str(),
                 it->j+1,
-                fr.Distance ( it->i,it->j ) );
+                series.Value ( d,frame ) );
         it->value = str.toStdString();
         list << str;
     }
@@ -1376,19 +1427,21 @@ QStringList GLVisor::GetDistances (size_t frame)
 QStringList GLVisor::GetAngles (size_t frame)
 {
     std::vector<Molecule::triad>::iterator it;
-    const Frame& fr=m_world->CurrentMolecule()->Frames().at(frame);
+    const Molecule& mol=*m_world->CurrentMolecule();
+    const GeometricDescriptors& series=MeasureSeries();
+    size_t d=m_distances.size();
     QStringList list;
-    for (it=m_angles.begin();it!=m_angles.end();it++)
+    for (it=m_angles.begin();it!=m_angles.end();++it,++d)
     {
         QString str;
         str.sprintf ( "(%s%d,%s%d,%s%d)  %.3f",
-                      m_world->CurrentMolecule()->Atoms() [it->i].Symbol().c_str(),
+                      mol.Atoms() [it->i].Symbol().c_str(),
                 it->i+1,
-                m_world->CurrentMolecule()->Atoms() [it->j].Symbol().c_str(),
+                mol.Atoms() [it->j].Symbol().c_str(),
                 it->j+1,
-                m_world->CurrentMolecule()->Atoms() [it->k].Symbol().c_str(),
+                mol.Atoms() [it->k].Symbol().c_str(),
                 it->k+1,
-                fr.Angle ( it->i,it->j,it->k ) );
+                series.Value ( d,frame ) );
         it->value = str.toStdString();
         list << str;
     }
@@ -1398,21 +1451,23 @@ QStringList GLVisor::GetAngles (size_t frame)
 QStringList GLVisor::GetDihedrals (size_t frame)
 {
     std::vector<Molecule::quad>::iterator it;
-    const Frame& fr=m_world->CurrentMolecule()->Frames().at(frame);
+    const Molecule& mol=*m_world->CurrentMolecule();
+    const GeometricDescriptors& series=MeasureSeries();
+    size_t d=m_distances.size()+m_angles.size();
     QStringList list;
-    for (it=m_dihedrals.begin();it!=m_dihedrals.end();it++)
+    for (it=m_dihedrals.begin();it!=m_dihedrals.end();++it,++d)
     {
         QString str;
         str.sprintf ( "(%s%d,%s%d,%s%d,%s%d)  %.3f",
-                      m_world->CurrentMolecule()->Atoms() [it->i].Symbol().c_str(),
+                      mol.Atoms() [it->i].Symbol().c_str(),
                 it->i+1,
-                m_world->CurrentMolecule()->Atoms() [it->j].Symbol().c_str(),
+                mol.Atoms() [it->j].Symbol().c_str(),
                 it->j+1,
-                m_world->CurrentMolecule()->Atoms() [it->k].Symbol().c_str(),
+                mol.Atoms() [it->k].Symbol().c_str(),
                 it->k+1,
-                m_world->CurrentMolecule()->Atoms() [it->l].Symbol().c_str(),
+                mol.Atoms() [it->l].Symbol().c_str(),
                 it->l+1,
-                fr.Dihedral ( it->i,it->j,it->k,it->l )*180/M_PI );
+                series.Value ( d,frame ) );
         it->value = str.toStdString();
         list << str;
     }
@@ -1431,6 +1486,7 @@ void GLVisor::OnClearMeasures()
     m_distances.clear();
     m_angles.clear();
     m_dihedrals.clear();
+    _d->m_seriesvalid=false;
 
     update();
 }
@@ -13,6 +13,7 @@ the Free Software Foundation version 2 of the License.
 #define GLVISOR_H
 
 #include "glvisorbase.h"
+#include "geometricdescriptors.h"
 
 class QToolBar;
 namespace kryomol
@@ -308,6 +309,8 @@ namespace kryomol
       QStringList GetDistances (size_t frame);
       QStringList GetAngles (size_t frame);
       QStringList GetDihedrals (size_t frame);
+      /** @return the measured distances, angles and dihedrals (in this order) evaluated for all the frames*/
+      const GeometricDescriptors& MeasureSeries();
       void SetDensity(Density* d) {m_density = d;}
       Density* GetDensity() {return m_density;}
 
@@ -355,6 +358,7 @@ namespace kryomol
     private:
       void InitToolBars();
       void ProcessOwnSelection ( int atom );
+      size_t HandlerFrame() const;
 
     private slots:
       void OnResetSelection();
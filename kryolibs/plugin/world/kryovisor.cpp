@@ -119,7 +119,7 @@ void KryoVisor::OnResetSelection ( bool repaint /*=true*/ )
 void KryoVisor::RenderScreenText()
 {
   std::stringstream label;
-  label << "#" << m_world->CurrentMolecule()->CurrentFrameIndex()+1 << " of " << m_world->CurrentMolecule()->Frames().size();
+  label << "#" << m_world->CurrentMolecule()->CurrentFrameIndex()+1 << " of " << m_world->CurrentMolecule()->FrameCount();
   QColor col ( QColor ( 255,255,255 ) );
   qglColor ( col );
   renderText ( rect().left() +30,rect().bottom() - 30,QString ( label.str().c_str() ),GLFont() );
@@ -134,7 +134,7 @@ void KryoVisor::OnFirstFrame()
 void KryoVisor::OnLastFrame()
 {
   if ( m_world->CurrentMolecule() )
-    m_world->SelectFrame ( m_world->CurrentMolecule()->Frames().size()-1 );
+    m_world->SelectFrame ( m_world->CurrentMolecule()->FrameCount()-1 );
   RefreshDistances();
 }
 
@@ -409,7 +409,7 @@ void KryoVisorOpt::RenderMolecule ( size_t index,GLenum mode )
 if ( m_bshowforces ) //dont draw anything for wireframe in render mode
 {
   glPushMatrix();
-  Handlers() [index].ApplyTransformation(molecule.CurrentFrameIndex());
+  Handlers() [index].ApplyTransformation(molecule.HasFrameSource() ? 0 : molecule.CurrentFrameIndex());
   Coordinate zaxis ( 0,0,1 );
   GLUquadricObj* quadric= gluNewQuadric();
   for ( mit=frame.Gradient().begin();mit!=frame.Gradient().end();++mit,i++,++ct )
@@ -454,7 +454,7 @@ return;
 
 void KryoVisorOpt::OnChangeFrame()
 {
-  if ( m_world->CurrentMolecule()->CurrentFrameIndex() == ( m_world->CurrentMolecule()->Frames().size() -1 ) )
+  if ( m_world->CurrentMolecule()->CurrentFrameIndex() == ( m_world->CurrentMolecule()->FrameCount() -1 ) )
   {
     m_timer->stop();
     emit playing ( false );
@@ -476,7 +476,7 @@ void KryoVisorOpt::wheelEvent ( QWheelEvent* e )
 
 void KryoVisorOpt::OnStartAnimation()
 {
-  if ( m_world->CurrentMolecule()->CurrentFrameIndex() == ( m_world->CurrentMolecule()->Frames().size() -1 ) )
+  if ( m_world->CurrentMolecule()->CurrentFrameIndex() == ( m_world->CurrentMolecule()->FrameCount() -1 ) )
   {
     m_world->SelectFrame(0);
     emit selectedPoint ( m_world->CurrentMolecule()->CurrentFrameIndex() );
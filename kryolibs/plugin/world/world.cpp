@@ -9,6 +9,8 @@ it under the terms of the GNU General Public License as published by
 the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
+#include <exception>
+#include <iostream>
 #include <sstream>
 
 #include "world.h"
@@ -114,6 +116,7 @@ void World::Initialize()
 void World::SetTemperature ( double t )
 {
   Thermostat::SetTemperature ( t );
+  UpdatePopulations();
   emit thermostatChanged();
 }
 /** \brief Set the type of ensamble
@@ -126,9 +129,29 @@ void World::SetTemperature ( double t )
 void World::SetEnsamble ( ensamble e )
 {
   Thermostat::SetEnsamble ( e );
+  UpdatePopulations();
   emit thermostatChanged();
 }
 
+/** \brief Compute the populations of all molecules for the current thermostat
+
+  Molecules whose frames lack potential energies keep their populations
+  */
+void World::UpdatePopulations()
+{
+  for(std::vector<Molecule>::iterator mt=m_molecules.begin();mt!=m_molecules.end();++mt)
+  {
+      try
+      {
+          SetPopulations(*mt);
+      }
+      catch(std::exception& e)
+      {
+          std::cerr << e.what() << std::endl;
+      }
+  }
+}
+
 
 /** \brief Clear the simulation world
 
@@ -171,7 +194,7 @@ void  World::SelectFrame ( size_t frame )
 {
   if (!CurrentMolecule() ) return;
 
-    if ( frame >= CurrentMolecule()->Frames().size() )
+    if ( frame >= CurrentMolecule()->FrameCount() )
     {
       std::cerr << "World:: Invalid frame index" << frame << std::endl;
       return;
@@ -77,6 +77,8 @@ namespace kryomol
       void SelectMolecule ( size_t );
       void OnShowDensity(bool b);
 
+    private:
+      void UpdatePopulations();
     private:
         #ifdef __GNUC__
         #warning implement d pointer
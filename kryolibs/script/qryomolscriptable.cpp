@@ -13,6 +13,8 @@ the Free Software Foundation version 2 of the License.
 #include "stringtools.h"
 #include "world.h"
 #include "molecule.h"
+#include "geometricdescriptors.h"
+#include "torsionscan.h"
 #include "glvisor.h"
 #include "exception.h"
 #include "qryomolapp.h"
@@ -146,6 +148,79 @@ void KryoMolScriptable::eckarttransform(QString text)
     }
 }
 
+QVariantList KryoMolScriptable::measure(QString text)
+{
+    StringTokenizer tok(text.toStdString(),",");
+    std::vector<size_t> atomlist;
+    for(StringTokenizer::iterator it=tok.begin();it!=tok.end();++it)
+    {
+        int atom=atoi(it->c_str());
+        if ( atom < 1 )
+            throw kryomol::Exception("Invalid syntaxis");
+        atomlist.push_back(atom-1);
+    }
+    if ( atomlist.size() < 2 || atomlist.size() > 4 )
+        throw kryomol::Exception("Need two, three or four atoms to measure");
+
+    GeometricDescriptors descriptors;
+    descriptors.Add(atomlist);
+    descriptors.Calculate(*m_world->CurrentMolecule());
+
+    QVariantList values;
+    const float* series=descriptors.Series(0);
+    for(size_t f=0;f<descriptors.NFrames();++f)
+    {
+        values << series[f];
+    }
+    return values;
+}
+
+void KryoMolScriptable::torsionscan(QString text, double increment, int maxframes)
+{
+    if ( maxframes <= 0 )
+        throw kryomol::Exception("The maximum number of conformers must be greater than zero");
+    Molecule& molecule=*m_world->CurrentMolecule();
+    TorsionScan scan(molecule,molecule.CurrentFrameIndex());
+    std::string str=text.toStdString();
+    if ( str.empty() )
+    {
+        std::vector<Bond> bonds=TorsionScan::RotatableBonds(molecule);
+        for(std::vector<Bond>::const_iterator it=bonds.begin();it!=bonds.end();++it)
+        {
+            scan.AddBond(it->I(),it->J(),increment);
+        }
+    }
+    else
+    {
+        StringTokenizer tok(str,",");
+        for(StringTokenizer::iterator it=tok.begin();it!=tok.end();++it)
+        {
+            StringTokenizer tok1(*it,"-");
+            if ( tok1.size() != 2 )
+                throw kryomol::Exception("Invalid syntaxis");
+            scan.AddBond(atoi(tok1.at(0).c_str())-1,atoi(tok1.at(1).c_str())-1,increment);
+        }
+    }
+
+    size_t nframes=scan.Generate(molecule,maxframes);
+    std::cout << nframes << " conformers generated, " << scan.NRejected() << " rejected by clashes" << std::endl;
+    if ( scan.Truncated() )
+    {
+        std::cout << "stopped at " << maxframes << " conformers, out of " << scan.NCandidates()-1
+                  << " combinations" << std::endl;
+    }
+    try
+    {
+        m_world->SetPopulations(molecule);
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
+    m_app->InitializePlugins();
+}
+
 void KryoMolScriptable::SetWorld(World* w)
 {
     m_world=w;
@@ -32,6 +32,12 @@ class SCRIPT_API  KryoMolScriptable : public QObject, protected QScriptable
   void popmessage(QString text);
   void superimpose(QString text);
   void eckarttransform(QString text);
+  /** @return the distance, angle or dihedral between the atoms in text (like "1,2,3") for every frame,
+      in angstroms or degrees*/
+  QVariantList measure(QString text);
+  /** append the conformers obtained rotating the bonds in text (like "2-3,5-6", all the rotatable bonds if empty)
+      in steps of increment degrees, discarding the ones with clashes, at most maxframes of them*/
+  void torsionscan(QString text, double increment, int maxframes=10000);
   private:
   World* m_world;
   KryoMolApplication* m_app;
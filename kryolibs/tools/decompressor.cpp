@@ -0,0 +1,163 @@
+/*****************************************************************************************
+                            decompressor.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WITH_LZMA
+#include <lzma.h>
+#endif
+
+#include "decompressor.h"
+
+using namespace kryomol;
+
+namespace
+{
+    /** size of the blocks of compressed data given to the decoders and of the text they write at once*/
+    const size_t blocksize=1<<20;
+
+    const unsigned char gzipmagic[]={ 0x1f,0x8b };
+    const unsigned char xzmagic[]={ 0xfd,'7','z','X','Z',0x00 };
+
+    /** make room for a block of text after the @param used characters decompressed, @return its beginning*/
+    char* Grow ( std::string& text, size_t used )
+    {
+        if ( text.size()-used < blocksize ) text.resize ( std::max ( used+blocksize,2*text.size() ) );
+        return &text[used];
+    }
+
+#ifdef WITH_ZLIB
+    bool Inflate ( const char* data, size_t size, std::string& text )
+    {
+        //the size of the text modulo 2^32 is stored at the end of a gzip member. It is only a hint, the end of a
+        //file cut short is not a size
+        size_t used=0;
+        if ( size >= 18 )
+        {
+            const unsigned char* isize=reinterpret_cast<const unsigned char*> ( data+size-4 );
+            const size_t hint=isize[0] | ( isize[1] << 8 ) | ( isize[2] << 16 ) | ( size_t ( isize[3] ) << 24 );
+            text.resize ( std::min ( hint,32*size ) );
+        }
+
+        z_stream z;
+        std::memset ( &z,0,sizeof ( z ) );
+        //gzip header only
+        if ( inflateInit2 ( &z,15+16 ) != Z_OK ) return false;
+        size_t consumed=0;
+        int status=Z_OK;
+        while ( true )
+        {
+            if ( z.avail_in == 0 && consumed < size )
+            {
+                z.next_in=reinterpret_cast<Bytef*> ( const_cast<char*> ( data+consumed ) );
+                z.avail_in=static_cast<uInt> ( std::min ( blocksize,size-consumed ) );
+                consumed+=z.avail_in;
+            }
+            z.next_out=reinterpret_cast<Bytef*> ( Grow ( text,used ) );
+            z.avail_out=static_cast<uInt> ( blocksize );
+            status=inflate ( &z,Z_NO_FLUSH );
+            used+=blocksize-z.avail_out;
+            if ( status == Z_STREAM_END )
+            {
+                //a following member, anything else after the end is ignored as gzip does
+                const size_t next=consumed-z.avail_in;
+                if ( size-next < 2 || std::memcmp ( data+next,gzipmagic,2 ) != 0 ) break;
+                inflateReset ( &z );
+                continue;
+            }
+            if ( status == Z_BUF_ERROR && z.avail_in == 0 && consumed == size ) break;
+            if ( status != Z_OK && status != Z_BUF_ERROR ) break;
+        }
+        inflateEnd ( &z );
+        text.resize ( used );
+        return status == Z_STREAM_END || status == Z_BUF_ERROR;
+    }
+#endif
+
+#ifdef WITH_LZMA
+    bool Unxz ( const char* data, size_t size, std::string& text )
+    {
+        lzma_stream z=LZMA_STREAM_INIT;
+        //several streams can be concatenated in a file, as for gzip
+        if ( lzma_stream_decoder ( &z,UINT64_MAX,LZMA_CONCATENATED ) != LZMA_OK ) return false;
+        size_t used=0;
+        size_t consumed=0;
+        lzma_ret status=LZMA_OK;
+        while ( status == LZMA_OK )
+        {
+            if ( z.avail_in == 0 && consumed < size )
+            {
+                z.next_in=reinterpret_cast<const uint8_t*> ( data+consumed );
+                z.avail_in=std::min ( blocksize,size-consumed );
+                consumed+=z.avail_in;
+            }
+            z.next_out=reinterpret_cast<uint8_t*> ( Grow ( text,used ) );
+            z.avail_out=blocksize;
+            status=lzma_code ( &z,consumed == size ? LZMA_FINISH : LZMA_RUN );
+            used+=blocksize-z.avail_out;
+        }
+        lzma_end ( &z );
+        text.resize ( used );
+        return status == LZMA_STREAM_END || status == LZMA_BUF_ERROR;
+    }
+#endif
+}
+
+Decompressor::Format Decompressor::Detect ( const char* data, size_t size )
+{
+    if ( size >= sizeof ( gzipmagic ) && std::memcmp ( data,gzipmagic,sizeof ( gzipmagic ) ) == 0 ) return Gzip;
+    if ( size >= sizeof ( xzmagic ) && std::memcmp ( data,xzmagic,sizeof ( xzmagic ) ) == 0 ) return Xz;
+    return None;
+}
+
+bool Decompressor::IsSupported ( Format format )
+{
+    switch ( format )
+    {
+    case None:
+        return true;
+#ifdef WITH_ZLIB
+    case Gzip:
+        return true;
+#endif
+#ifdef WITH_LZMA
+    case Xz:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+bool Decompressor::Decompress ( const char* data, size_t size, std::string& text )
+{
+    text.clear();
+    switch ( Detect ( data,size ) )
+    {
+    case None:
+        text.assign ( data,size );
+        return true;
+#ifdef WITH_ZLIB
+    case Gzip:
+        return Inflate ( data,size,text );
+#endif
+#ifdef WITH_LZMA
+    case Xz:
+        return Unxz ( data,size,text );
+#endif
+    default:
+        return false;
+    }
+}
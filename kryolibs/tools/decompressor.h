@@ -0,0 +1,43 @@
+/*****************************************************************************************
+                            decompressor.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+
+#include "toolsexport.h"
+
+namespace kryomol
+{
+  /** @brief streaming decompression of compressed files
+
+  The format is recognized by its magic number, not by the extension. The compressed data is decompressed
+  in blocks appended to the text, so no temporary file is written. gzip files, also made of several
+  members as written by pigz or bgzip, are read with zlib (WITH_ZLIB), and xz files with liblzma
+  (WITH_LZMA), each one when the library was found at build time*/
+  class TOOLS_API Decompressor
+  {
+    public:
+      enum Format { None, Gzip, Xz };
+      /** @return the format of the data starting at @param data, None if it is not compressed*/
+      static Format Detect ( const char* data, size_t size );
+      /** @return true if files of format @param format can be read*/
+      static bool IsSupported ( Format format );
+      /** decompress the @param size bytes at @param data to @param text. Data cut short, as the file of a
+          job still being compressed, gives the text decompressed up to the cut
+          @return false if the data is corrupt or its format is not supported*/
+      static bool Decompress ( const char* data, size_t size, std::string& text );
+  };
+}
+
+#endif
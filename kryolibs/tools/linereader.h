@@ -0,0 +1,267 @@
+/*****************************************************************************************
+                            linereader.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace kryomol
+{
+  /** @brief the lines of a text in memory, without copies
+
+  Each line is returned as a view of the text without the final newline, as std::getline would return it,
+  so a carriage return of DOS files is kept*/
+  class LineReader
+  {
+    public:
+      LineReader() : m_begin ( "" ), m_end ( m_begin ), m_pos ( m_begin ), m_line ( m_begin ) {}
+      /** read @param text starting at @param offset*/
+      explicit LineReader ( std::string_view text, size_t offset=0 );
+      /** @return false at the end of the text, otherwise the next line in @param line*/
+      bool Next ( std::string_view& line );
+      /** skip @param n lines @return false if the end of the text was reached first*/
+      bool Skip ( size_t n=1 );
+      /** move to @param offset, that should be the beginning of a line*/
+      void Seek ( size_t offset );
+      /** @return the offset of the next line*/
+      size_t Offset() const { return m_pos-m_begin; }
+      /** @return the offset of the last line returned*/
+      size_t LineOffset() const { return m_line-m_begin; }
+      bool AtEnd() const { return m_pos == m_end; }
+    private:
+      const char* m_begin;
+      const char* m_end;
+      const char* m_pos;
+      const char* m_line;
+  };
+
+  /** @brief a set of delimiter characters, checked with a table lookup*/
+  class Delimiters
+  {
+    public:
+      explicit Delimiters ( const char* chars );
+      bool operator() ( char c ) const { return m_table[static_cast<unsigned char> ( c )]; }
+      /** space, tab, carriage return and newline*/
+      static const Delimiters& Blanks();
+    private:
+      bool m_table[256];
+  };
+
+  /** @brief the tokens of a line as views of the line
+
+  The views of up to 32 tokens are kept in the object itself, so splitting a line does not allocate memory.
+  Only lines with more tokens use a vector, whose memory is reused when the object splits the next lines*/
+  class Tokens
+  {
+    public:
+      Tokens() : m_size ( 0 ) {}
+      explicit Tokens ( std::string_view line, const Delimiters& delimiters=Delimiters::Blanks() );
+      /** split @param line, replacing the tokens of the previous one*/
+      void Assign ( std::string_view line, const Delimiters& delimiters=Delimiters::Blanks() );
+      size_t size() const { return m_size; }
+      bool empty() const { return m_size == 0; }
+      std::string_view operator[] ( size_t i ) const { return begin() [i]; }
+      /** throws std::out_of_range as std::vector::at*/
+      std::string_view at ( size_t i ) const;
+      std::string_view front() const { return begin() [0]; }
+      std::string_view back() const { return begin() [m_size-1]; }
+      const std::string_view* begin() const { return m_more.empty() ? m_inline : m_more.data(); }
+      const std::string_view* end() const { return begin() +m_size; }
+    private:
+      void Push ( std::string_view token );
+    private:
+      enum { capacity=32 };
+      std::string_view m_inline[capacity];
+      std::vector<std::string_view> m_more;
+      size_t m_size;
+  };
+
+  /** @brief the fields of fixed width at the end of a line, as views of the line
+
+  Fortran formatted numbers can fill their fields and run together, as -100.12345-100.23456 in F10.5, so the
+  tables of numbers of the programs are split by the width of their columns instead of by blanks. The fields
+  are counted from the end of the line, where the numbers are right aligned, so the labels before them can
+  have any width*/
+  class FixedFields
+  {
+    public:
+      /** the last @param n fields of @param width characters of @param line, blanks at its end ignored. There
+          are fewer if the line is shorter*/
+      FixedFields ( std::string_view line, size_t n, size_t width );
+      size_t size() const { return m_size; }
+      bool empty() const { return m_size == 0; }
+      std::string_view operator[] ( size_t i ) const { return m_line.substr ( m_first+i*m_width,m_width ); }
+    private:
+      std::string_view m_line;
+      size_t m_width;
+      size_t m_size;
+      size_t m_first;
+  };
+
+  /** convert the number at the beginning of @param s as std::atof does: leading blanks are skipped and the
+      characters after the number ignored. Fortran exponents (1.0D-03) are accepted. The conversion does not
+      depend on the locale @return false if there is no number*/
+  inline bool ToDouble ( std::string_view s, double& value );
+  /** @return the number at the beginning of @param s, 0 if there is none*/
+  inline double ToDouble ( std::string_view s ) { double v=0.0; ToDouble ( s,v ); return v; }
+  /** convert the integer at the beginning of @param s as std::atoi does @return false if there is none*/
+  inline bool ToInt ( std::string_view s, int& value );
+  /** @return the integer at the beginning of @param s, 0 if there is none*/
+  inline int ToInt ( std::string_view s ) { int v=0; ToInt ( s,v ); return v; }
+
+
+  inline LineReader::LineReader ( std::string_view text, size_t offset ) :
+    m_begin ( text.data() ), m_end ( text.data() +text.size() ), m_pos ( m_begin ), m_line ( m_begin )
+  {
+    Seek ( offset );
+  }
+
+  inline bool LineReader::Next ( std::string_view& line )
+  {
+    if ( m_pos == m_end ) return false;
+    m_line=m_pos;
+    const char* nl=static_cast<const char*> ( std::memchr ( m_pos,'\n',m_end-m_pos ) );
+    if ( nl == NULL )
+    {
+      line=std::string_view ( m_pos,m_end-m_pos );
+      m_pos=m_end;
+    }
+    else
+    {
+      line=std::string_view ( m_pos,nl-m_pos );
+      m_pos=nl+1;
+    }
+    return true;
+  }
+
+  inline bool LineReader::Skip ( size_t n )
+  {
+    std::string_view line;
+    for ( size_t i=0;i<n;++i )
+    {
+      if ( !Next ( line ) ) return false;
+    }
+    return true;
+  }
+
+  inline void LineReader::Seek ( size_t offset )
+  {
+    m_pos=m_begin+std::min ( offset,static_cast<size_t> ( m_end-m_begin ) );
+    m_line=m_pos;
+  }
+
+  inline Delimiters::Delimiters ( const char* chars )
+  {
+    std::fill ( m_table,m_table+256,false );
+    for ( ;*chars;++chars ) m_table[static_cast<unsigned char> ( *chars )]=true;
+  }
+
+  inline const Delimiters& Delimiters::Blanks()
+  {
+    static const Delimiters blanks ( " \t\r\n" );
+    return blanks;
+  }
+
+  inline Tokens::Tokens ( std::string_view line, const Delimiters& delimiters ) : m_size ( 0 )
+  {
+    Assign ( line,delimiters );
+  }
+
+  inline void Tokens::Assign ( std::string_view line, const Delimiters& delimiters )
+  {
+    m_size=0;
+    m_more.clear();
+    const char* p=line.data();
+    const char* end=p+line.size();
+    while ( true )
+    {
+      while ( p != end && delimiters ( *p ) ) ++p;
+      if ( p == end ) break;
+      const char* first=p;
+      while ( p != end && !delimiters ( *p ) ) ++p;
+      Push ( std::string_view ( first,p-first ) );
+    }
+  }
+
+  inline void Tokens::Push ( std::string_view token )
+  {
+    if ( m_size < capacity )
+    {
+      m_inline[m_size++]=token;
+      return;
+    }
+    if ( m_more.empty() ) m_more.assign ( m_inline,m_inline+capacity );
+    m_more.push_back ( token );
+    ++m_size;
+  }
+
+  inline std::string_view Tokens::at ( size_t i ) const
+  {
+    if ( i >= m_size ) throw std::out_of_range ( "token index out of range" );
+    return begin() [i];
+  }
+
+  inline FixedFields::FixedFields ( std::string_view line, size_t n, size_t width ) : m_width ( width )
+  {
+    const Delimiters& blanks=Delimiters::Blanks();
+    while ( !line.empty() && blanks ( line.back() ) ) line.remove_suffix ( 1 );
+    m_line=line;
+    m_size= ( width == 0 ) ? 0 : std::min ( n,line.size() /width );
+    m_first=line.size()-m_size*width;
+  }
+
+  namespace detail
+  {
+    inline const char* SkipBlanks ( const char* p, const char* end )
+    {
+      while ( p != end && ( *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' ) ) ++p;
+      if ( p != end && *p == '+' ) ++p;
+      return p;
+    }
+  }
+
+  inline bool ToDouble ( std::string_view s, double& value )
+  {
+    const char* p=detail::SkipBlanks ( s.data(),s.data() +s.size() );
+    const char* end=s.data() +s.size();
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars_result r=std::from_chars ( p,end,value );
+    if ( r.ec == std::errc::invalid_argument ) return false;
+    if ( r.ec == std::errc() && ( r.ptr == end || ( *r.ptr != 'D' && *r.ptr != 'd' ) ) ) return true;
+#endif
+    //Fortran exponents, out of range values, or no floating point from_chars: convert a bounded copy
+    char buffer[64];
+    const size_t n=std::min ( static_cast<size_t> ( end-p ),sizeof ( buffer )-1 );
+    for ( size_t i=0;i<n;++i )
+      buffer[i]= ( p[i] == 'D' || p[i] == 'd' ) ? 'E' : p[i];
+    buffer[n]='\0';
+    char* stop=NULL;
+    value=std::strtod ( buffer,&stop );
+    return stop != buffer;
+  }
+
+  inline bool ToInt ( std::string_view s, int& value )
+  {
+    const char* p=detail::SkipBlanks ( s.data(),s.data() +s.size() );
+    std::from_chars_result r=std::from_chars ( p,s.data() +s.size(),value );
+    return r.ec == std::errc();
+  }
+}
+
+#endif
@@ -0,0 +1,172 @@
+/*****************************************************************************************
+                            mappedfile.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <QFile>
+#include <QByteArray>
+
+#include "mappedfile.h"
+#include "decompressor.h"
+
+using namespace kryomol;
+
+MappedFile::MappedFile() : m_file ( NULL ), m_data ( "" ), m_size ( 0 ), m_open ( false ), m_mapped ( false )
+{
+}
+
+MappedFile::MappedFile ( const std::string& path ) : m_file ( NULL ), m_data ( "" ), m_size ( 0 ), m_open ( false ), m_mapped ( false )
+{
+    Open ( QString::fromUtf8 ( path.c_str() ) );
+}
+
+MappedFile::MappedFile ( const QString& path ) : m_file ( NULL ), m_data ( "" ), m_size ( 0 ), m_open ( false ), m_mapped ( false )
+{
+    Open ( path );
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open ( const QString& path )
+{
+    Close();
+    m_file=new QFile ( path );
+    if ( !m_file->open ( QIODevice::ReadOnly ) )
+    {
+        Close();
+        return false;
+    }
+    m_open=true;
+
+    const qint64 size=m_file->size();
+    if ( size > 0 && !m_file->isSequential() )
+    {
+        uchar* p=m_file->map ( 0,size );
+        if ( p != NULL )
+        {
+            m_data=reinterpret_cast<const char*> ( p );
+            m_size=static_cast<size_t> ( size );
+            m_mapped=true;
+            return true;
+        }
+    }
+
+    //can not be mapped, keep a copy
+    QByteArray contents=m_file->readAll();
+    m_copy.assign ( contents.constData(),contents.size() );
+    m_data=m_copy.data();
+    m_size=m_copy.size();
+    m_file->close();
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if ( m_file != NULL )
+    {
+        //closing the file releases the map
+        m_file->close();
+        delete m_file;
+        m_file=NULL;
+    }
+    m_copy.clear();
+    m_data="";
+    m_size=0;
+    m_open=false;
+    m_mapped=false;
+}
+
+MemoryBuffer::MemoryBuffer ( const char* data, size_t size )
+{
+    Reset ( data,size );
+}
+
+void MemoryBuffer::Reset ( const char* data, size_t size )
+{
+    char* begin=const_cast<char*> ( data );
+    setg ( begin,begin,begin+size );
+}
+
+MemoryBuffer::pos_type MemoryBuffer::seekoff ( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which )
+{
+    if ( ! ( which & std::ios_base::in ) ) return pos_type ( off_type ( -1 ) );
+    off_type base=0;
+    switch ( dir )
+    {
+    case std::ios_base::cur:
+        base=gptr()-eback();
+        break;
+    case std::ios_base::end:
+        base=egptr()-eback();
+        break;
+    default:
+        break;
+    }
+    const off_type target=base+off;
+    if ( target < 0 || target > egptr()-eback() ) return pos_type ( off_type ( -1 ) );
+    setg ( eback(),eback()+target,egptr() );
+    return pos_type ( target );
+}
+
+MemoryBuffer::pos_type MemoryBuffer::seekpos ( pos_type pos, std::ios_base::openmode which )
+{
+    return seekoff ( off_type ( pos ),std::ios_base::beg,which );
+}
+
+MappedStream::MappedStream ( const std::string& path ) : std::istream ( NULL ), m_path ( QString::fromUtf8 ( path.c_str() ) ),
+  m_map ( new MappedFile ( path ) ), m_buffer ( m_map->Data(),m_map->Size() ), m_open ( m_map->IsOpen() ), m_compressed ( false )
+{
+    rdbuf ( &m_buffer );
+    if ( !m_open ) setstate ( std::ios::failbit );
+    else Decompress();
+}
+
+MappedStream::MappedStream ( const QString& path ) : std::istream ( NULL ), m_path ( path ), m_map ( new MappedFile ( path ) ),
+  m_buffer ( m_map->Data(),m_map->Size() ), m_open ( m_map->IsOpen() ), m_compressed ( false )
+{
+    rdbuf ( &m_buffer );
+    if ( !m_open ) setstate ( std::ios::failbit );
+    else Decompress();
+}
+
+MappedStream::MappedStream ( const MappedStream& stream ) : std::istream ( NULL ), m_path ( stream.m_path ), m_map ( stream.m_map ),
+  m_buffer ( stream.Text().data(),stream.Text().size() ), m_text ( stream.m_text ), m_open ( stream.m_open ),
+  m_compressed ( stream.m_compressed )
+{
+    rdbuf ( &m_buffer );
+    if ( !m_open ) setstate ( std::ios::failbit );
+}
+
+void MappedStream::Decompress()
+{
+    if ( Decompressor::Detect ( m_map->Data(),m_map->Size() ) == Decompressor::None ) return;
+    m_compressed=true;
+    std::shared_ptr<std::string> text ( new std::string() );
+    if ( !Decompressor::Decompress ( m_map->Data(),m_map->Size(),*text ) )
+    {
+        text->clear();
+        m_open=false;
+        setstate ( std::ios::failbit );
+    }
+    m_text=text;
+    m_buffer.Reset ( m_text->data(),m_text->size() );
+    //the compressed data is not needed any more
+    m_map->Close();
+}
+
+bool kryomol::StreamText ( const std::istream& stream, std::string_view& text )
+{
+    const MemoryBuffer* buffer=dynamic_cast<const MemoryBuffer*> ( stream.rdbuf() );
+    if ( buffer == NULL ) return false;
+    text=buffer->Text();
+    return true;
+}
@@ -0,0 +1,118 @@
+/*****************************************************************************************
+                            mappedfile.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+#include <QString>
+
+#include "toolsexport.h"
+
+class QFile;
+
+namespace kryomol
+{
+  /** @brief read only view of the whole contents of a file
+
+  The file is mapped in memory, so the operating system pages it in on demand and no copy is done. Files
+  that can not be mapped (pipes, special files) are read once into memory instead*/
+  class TOOLS_API MappedFile
+  {
+    public:
+      MappedFile();
+      /** open @param path, given in UTF-8*/
+      explicit MappedFile ( const std::string& path );
+      explicit MappedFile ( const QString& path );
+      ~MappedFile();
+      /** @return false if the file can not be read*/
+      bool Open ( const QString& path );
+      void Close();
+      bool IsOpen() const { return m_open; }
+      /** @return true if the contents are mapped and not copied*/
+      bool IsMapped() const { return m_mapped; }
+      const char* Data() const { return m_data; }
+      size_t Size() const { return m_size; }
+      std::string_view Text() const { return std::string_view ( m_data,m_size ); }
+    private:
+      MappedFile ( const MappedFile& );
+      MappedFile& operator= ( const MappedFile& );
+    private:
+      QFile* m_file;
+      std::string m_copy;
+      const char* m_data;
+      size_t m_size;
+      bool m_open;
+      bool m_mapped;
+  };
+
+  /** @brief stream buffer over a block of memory
+
+  The whole block is the get area, so std::getline and read take the characters directly from it, and
+  seekg and tellg work with offsets in the block*/
+  class TOOLS_API MemoryBuffer : public std::streambuf
+  {
+    public:
+      MemoryBuffer ( const char* data, size_t size );
+      /** read @param size bytes at @param data from the beginning*/
+      void Reset ( const char* data, size_t size );
+      std::string_view Text() const { return std::string_view ( eback(),egptr()-eback() ); }
+    protected:
+      pos_type seekoff ( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which=std::ios_base::in );
+      pos_type seekpos ( pos_type pos, std::ios_base::openmode which=std::ios_base::in );
+  };
+
+  /** @brief input stream reading a MappedFile
+
+  An adapter for the parsers written on std::istream: the stream can be used as an std::ifstream opened in
+  binary mode, while the parsers that want it can take the whole text with @see StreamText and walk it
+  with a LineReader. Compressed files (gzip, xz) are decompressed in memory when they are opened
+  (@see Decompressor), so the parsers read them as any other file and seek in the text without
+  decompressing it again*/
+  class TOOLS_API MappedStream : public std::istream
+  {
+    public:
+      /** open @param path, given in UTF-8. The failbit is set if the file can not be read, or is compressed
+          and can not be decompressed*/
+      explicit MappedStream ( const std::string& path );
+      explicit MappedStream ( const QString& path );
+      /** a stream of its own over the text of @param stream. The mapping, or the decompressed text, is shared
+          and not read again, it lives as long as one of the streams*/
+      explicit MappedStream ( const MappedStream& stream );
+      bool IsOpen() const { return m_open; }
+      /** @return true if the file was compressed, the text is then a copy in memory*/
+      bool IsCompressed() const { return m_compressed; }
+      std::string_view Text() const { return m_buffer.Text(); }
+      /** @return the path of the file, to open it again*/
+      const QString& Path() const { return m_path; }
+    private:
+      void Decompress();
+    private:
+      QString m_path;
+      std::shared_ptr<MappedFile> m_map;
+      MemoryBuffer m_buffer;
+      std::shared_ptr<const std::string> m_text;
+      bool m_open;
+      bool m_compressed;
+  };
+
+  /** @return true and the text read by @param stream in @param text if the stream reads memory
+      through a MemoryBuffer, false otherwise*/
+  TOOLS_API bool StreamText ( const std::istream& stream, std::string_view& text );
+}
+
+#endif
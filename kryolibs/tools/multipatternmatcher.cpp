@@ -0,0 +1,108 @@
+/*****************************************************************************************
+                            multipatternmatcher.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <deque>
+
+#include "multipatternmatcher.h"
+#include "exception.h"
+
+using namespace kryomol;
+
+MultiPatternMatcher::MultiPatternMatcher() : m_built ( false ), m_state ( 0 ), m_offset ( 0 )
+{
+}
+
+size_t MultiPatternMatcher::Add ( const std::string& pattern )
+{
+    if ( pattern.empty() )
+        throw kryomol::Exception ( "empty search pattern" );
+    m_patterns.push_back ( pattern );
+    m_built=false;
+    Reset();
+    return m_patterns.size()-1;
+}
+
+void MultiPatternMatcher::Build()
+{
+    //trie of the patterns, -1 marks a missing transition
+    m_delta.assign ( 256,-1 );
+    std::vector< std::vector<size_t> > outputs ( 1 );
+    for ( size_t p=0;p<m_patterns.size();++p )
+    {
+        int state=0;
+        for ( std::string::const_iterator it=m_patterns[p].begin();it!=m_patterns[p].end();++it )
+        {
+            unsigned char c=static_cast<unsigned char> ( *it );
+            if ( m_delta[ ( state<<8 ) |c] < 0 )
+            {
+                m_delta[ ( state<<8 ) |c]=static_cast<int> ( outputs.size() );
+                m_delta.resize ( m_delta.size() +256,-1 );
+                outputs.push_back ( std::vector<size_t>() );
+            }
+            state=m_delta[ ( state<<8 ) |c];
+        }
+        outputs[state].push_back ( p );
+    }
+
+    //breadth first completion of the transitions with the failure links
+    const size_t nstates=outputs.size();
+    std::vector<int> fail ( nstates,0 );
+    std::deque<int> queue;
+    for ( int c=0;c<256;++c )
+    {
+        int& next=m_delta[c];
+        if ( next < 0 )
+        {
+            next=0;
+        }
+        else
+        {
+            fail[next]=0;
+            queue.push_back ( next );
+        }
+    }
+    while ( !queue.empty() )
+    {
+        int state=queue.front();
+        queue.pop_front();
+        const std::vector<size_t>& inherited=outputs[fail[state]];
+        outputs[state].insert ( outputs[state].end(),inherited.begin(),inherited.end() );
+        for ( int c=0;c<256;++c )
+        {
+            int& next=m_delta[ ( state<<8 ) |c];
+            if ( next < 0 )
+            {
+                next=m_delta[ ( fail[state]<<8 ) |c];
+            }
+            else
+            {
+                fail[next]=m_delta[ ( fail[state]<<8 ) |c];
+                queue.push_back ( next );
+            }
+        }
+    }
+
+    m_outputstart.assign ( nstates+1,0 );
+    m_outputs.clear();
+    for ( size_t s=0;s<nstates;++s )
+    {
+        m_outputstart[s]=m_outputs.size();
+        m_outputs.insert ( m_outputs.end(),outputs[s].begin(),outputs[s].end() );
+    }
+    m_outputstart[nstates]=m_outputs.size();
+
+    //store the transitions as target rows flagged with the presence of outputs
+    for ( std::vector<int>::iterator it=m_delta.begin();it!=m_delta.end();++it )
+    {
+        *it= ( *it<<8 ) | ( outputs[*it].empty() ? 0 : 1 );
+    }
+    m_built=true;
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************************
+                            multipatternmatcher.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef MULTIPATTERNMATCHER_H
+#define MULTIPATTERNMATCHER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "toolsexport.h"
+
+namespace kryomol
+{
+  /** @brief search many strings at once in a text (Aho-Corasick automaton)
+
+  The patterns are compiled to a deterministic automaton with a full transition table, so the text is
+  read once, one table lookup per character, whatever the number of patterns. The text can be fed in
+  consecutive blocks: matches spanning two blocks are found, and the reported offsets are counted from
+  the first character fed after the last Reset()*/
+  class TOOLS_API MultiPatternMatcher
+  {
+    public:
+      MultiPatternMatcher();
+      /** add a pattern @return its index*/
+      size_t Add ( const std::string& pattern );
+      /** @return the number of patterns*/
+      size_t NPatterns() const { return m_patterns.size(); }
+      /** @return pattern i*/
+      const std::string& Pattern ( size_t i ) const { return m_patterns[i]; }
+      /** restart the search at the beginning of a new text*/
+      void Reset() { m_state=0; m_offset=0; }
+      /** search the block @param data of @param size characters. @param match is called as match(pattern,offset)
+          for every occurrence, with offset the position of the first character of the occurrence.
+          If match returns false the search stops @return false if the search was stopped*/
+      template <class F> bool Feed ( const char* data, size_t size, F match );
+    private:
+      void Build();
+    private:
+      std::vector<std::string> m_patterns;
+      std::vector<int> m_delta;
+      std::vector<size_t> m_outputstart;
+      std::vector<size_t> m_outputs;
+      bool m_built;
+      int m_state;
+      size_t m_offset;
+  };
+
+  template <class F> bool MultiPatternMatcher::Feed ( const char* data, size_t size, F match )
+  {
+    if ( !m_built ) Build();
+    const unsigned char* text=reinterpret_cast<const unsigned char*> ( data );
+    //each transition holds the target row (state*256) and, in the lowest bit, whether the target has outputs
+    int row=m_state<<8;
+    for ( size_t i=0;i<size;++i )
+    {
+      row=m_delta[ ( row&~0xff ) |text[i]];
+      if ( ! ( row&1 ) ) continue;
+      int state=row>>8;
+      size_t first=m_outputstart[state];
+      size_t last=m_outputstart[state+1];
+      for ( size_t o=first;o<last;++o )
+      {
+        size_t p=m_outputs[o];
+        if ( !match ( p,m_offset+i+1-m_patterns[p].size() ) )
+        {
+          m_state=row>>8;
+          m_offset+=i+1;
+          return false;
+        }
+      }
+    }
+    m_state=row>>8;
+    m_offset+=size;
+    return true;
+  }
+}
+
+#endif
@@ -25,6 +25,10 @@ HEADERS +=  mathtools.h toolsexport.h \
             physicalconstants.h \
             sse_mathfun.h \
             orbitalarray.h \
+            multipatternmatcher.h \
+            mappedfile.h \
+            decompressor.h \
+            linereader.h \
     qdoubleslider.h
 
 lapack {
@@ -38,6 +42,9 @@ lapack {
 SOURCES += mathtools.cpp qdoubleeditbox.cpp fidarray.cpp \
            physicalconstants.cpp \
            orbitalarray.cpp \
+           multipatternmatcher.cpp \
+           mappedfile.cpp \
+           decompressor.cpp \
            qdoubleslider.cpp
 
 
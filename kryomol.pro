@@ -1,7 +1,8 @@
 QT += opengl
 TEMPLATE = subdirs
 CONFIG += ordered
-SUBDIRS += kryolibs mainwindow
+#benchmarks measures the throughput of the parsers
+SUBDIRS += kryolibs mainwindow benchmarks
 CONFIG += c++17
 
 
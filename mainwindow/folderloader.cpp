@@ -0,0 +1,136 @@
+/*****************************************************************************************
+                            folderloader.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <exception>
+#include <string>
+
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QtConcurrentMap>
+
+#include "folderloader.h"
+#include "parsecache.h"
+#include "parserfactory.h"
+
+#ifdef __MINGW32__
+#include <filesystem>
+#endif
+
+namespace
+{
+    /** parse the file of a result, called from the threads of the pool*/
+    struct LoadFile
+    {
+        explicit LoadFile(kryomol::JobType t) : type(t) {}
+        void operator()(FolderLoader::Result& result) const;
+        kryomol::JobType type;
+    };
+
+    void LoadFile::operator()(FolderLoader::Result& result) const
+    {
+        kryomol::Parser* qparser=nullptr;
+        try
+        {
+            //a file already parsed and not modified since is read from the cache
+            const kryomol::ParseCache cache;
+            const kryomol::ParseCache::Key key=kryomol::ParseCache::Identify(result.file);
+            unsigned flags=0;
+            if ( cache.Load(key,type,result.molecules,flags) )
+            {
+                result.hasdensity=flags & kryomol::ParseCache::DENSITY;
+                result.hasorbitals=flags & kryomol::ParseCache::ORBITALS;
+                result.hasalphabeta=flags & kryomol::ParseCache::ALPHABETA;
+                result.parsed=true;
+                return;
+            }
+#ifdef __MINGW32__
+            kryomol::ParserFactory factory(std::filesystem::u8path(result.file.toUtf8().data()));
+#else
+            kryomol::ParserFactory factory(result.file.toStdString().c_str());
+#endif
+            qparser=factory.BuildParser();
+            if ( qparser == nullptr ) return;
+            result.hasdensity=factory.existDensity();
+            result.hasorbitals=factory.existOrbitals();
+            result.hasalphabeta=factory.existAlphaBeta();
+
+            for(const auto& j : qparser->Jobs() )
+            {
+                if ( j.type != type ) continue;
+                std::vector<kryomol::Molecule> mol;
+                qparser->SetMolecules(&mol);
+                qparser->Parse(j.pos);
+                if ( type == kryomol::uv )
+                    qparser->ParseUV(j.pos);
+                else
+                    qparser->ParseFrequencies(j.pos);
+                if ( !mol.empty() ) result.molecules.push_back(mol.back());
+            }
+            result.parsed=true;
+            //an output still being written would be parsed again when it grows
+            if ( !qparser->IsRunning() )
+            {
+                flags=(result.hasdensity ? kryomol::ParseCache::DENSITY : 0) |
+                      (result.hasorbitals ? kryomol::ParseCache::ORBITALS : 0) |
+                      (result.hasalphabeta ? kryomol::ParseCache::ALPHABETA : 0);
+                cache.Store(key,type,result.molecules,flags);
+            }
+        }
+        catch(std::exception& e)
+        {
+            result.molecules.clear();
+            result.error=QString::fromUtf8(e.what());
+        }
+        catch(...)
+        {
+            result.molecules.clear();
+            result.error="unknown error";
+        }
+        delete qparser;
+    }
+}
+
+FolderLoader::FolderLoader(kryomol::JobType type, const QFileInfoList& files) : m_type(type)
+{
+    m_results.resize(files.size());
+    for(int i=0;i<files.size();++i)
+        m_results[i].file=files.at(i).absoluteFilePath();
+}
+
+bool FolderLoader::Run(QWidget* parent, const QString& label)
+{
+    QProgressDialog dialog(label,QObject::tr("Cancel"),0,static_cast<int>(m_results.size()),parent);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setMinimumDuration(0);
+
+    QFutureWatcher<void> watcher;
+    QObject::connect(&watcher,SIGNAL(finished()),&dialog,SLOT(reset()));
+    QObject::connect(&dialog,SIGNAL(canceled()),&watcher,SLOT(cancel()));
+    QObject::connect(&watcher,SIGNAL(progressRangeChanged(int,int)),&dialog,SLOT(setRange(int,int)));
+    QObject::connect(&watcher,SIGNAL(progressValueChanged(int)),&dialog,SLOT(setValue(int)));
+    watcher.setFuture(QtConcurrent::map(m_results,LoadFile(m_type)));
+
+    //the dialog runs the event loop until the files are parsed or the load is canceled
+    dialog.exec();
+    watcher.waitForFinished();
+
+    return !watcher.future().isCanceled();
+}
+
+QStringList FolderLoader::Errors() const
+{
+    QStringList errors;
+    for(const auto& r : m_results)
+    {
+        if ( !r.error.isEmpty() ) errors << r.file+": "+r.error;
+    }
+    return errors;
+}
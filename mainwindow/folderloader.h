@@ -0,0 +1,63 @@
+/*****************************************************************************************
+                            folderloader.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef FOLDERLOADER_H
+#define FOLDERLOADER_H
+
+#include <vector>
+
+#include <QFileInfoList>
+#include <QString>
+#include <QStringList>
+
+#include "molecule.h"
+#include "parser.h"
+
+class QWidget;
+
+/** @brief parse the outputs of a folder of conformers concurrently
+
+Every file is opened and parsed on its own on the global thread pool, while a progress dialog keeps the
+event loop running and lets the user cancel the load. The results are stored by file, so they can be merged
+in the order of the folder whatever the order in which the parsers finish. The molecules parsed are kept
+in a ParseCache, so loading the folder again only parses the files that changed*/
+class FolderLoader
+{
+public:
+    /** the molecules of the jobs of a file*/
+    struct Result
+    {
+        Result() : parsed(false), hasdensity(true), hasorbitals(true), hasalphabeta(true) {}
+        QString file;
+        /** one molecule for each job of the type loaded*/
+        std::vector<kryomol::Molecule> molecules;
+        /** false if the format was not recognized or the parser failed*/
+        bool parsed;
+        bool hasdensity;
+        bool hasorbitals;
+        bool hasalphabeta;
+        QString error;
+    };
+    /** load the jobs of type @param type (uv or freq) of @param files*/
+    FolderLoader(kryomol::JobType type, const QFileInfoList& files);
+    /** parse all the files, showing the progress with @param label over @param parent
+    @return false if the load was canceled*/
+    bool Run(QWidget* parent, const QString& label);
+    /** @return the results in the order of the files*/
+    const std::vector<Result>& Results() const { return m_results; }
+    /** @return the files that could not be parsed, with the reason*/
+    QStringList Errors() const;
+private:
+    kryomol::JobType m_type;
+    std::vector<Result> m_results;
+};
+
+#endif // FOLDERLOADER_H
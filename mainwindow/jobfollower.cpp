@@ -0,0 +1,68 @@
+/*****************************************************************************************
+                            jobfollower.cpp  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#include <exception>
+
+#include <QDebug>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include "jobfollower.h"
+#include "parser.h"
+#include "molecule.h"
+
+namespace
+{
+    /** time without changes of the file before it is parsed, in ms*/
+    const int delay=500;
+}
+
+JobFollower::JobFollower(const QString& file, kryomol::Parser* parser, kryomol::Molecule* molecule, QObject* parent)
+    : QObject(parent), m_file(file), m_parser(parser), m_molecule(molecule)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(m_file);
+    connect(m_watcher,SIGNAL(fileChanged(const QString&)),this,SLOT(OnFileChanged(const QString&)));
+
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(delay);
+    connect(m_timer,SIGNAL(timeout()),this,SLOT(OnUpdate()));
+}
+
+JobFollower::~JobFollower()
+{
+    delete m_parser;
+}
+
+void JobFollower::OnFileChanged(const QString& file)
+{
+    //some editors and file systems replace the file, and the watcher drops it
+    if ( !m_watcher->files().contains(file) ) m_watcher->addPath(file);
+    //the timer is not restarted, so a program writing continuously is still followed
+    if ( !m_timer->isActive() ) m_timer->start();
+}
+
+void JobFollower::OnUpdate()
+{
+    size_t first=0;
+    try
+    {
+        if ( !m_parser->ParseAppended(*m_molecule,first) ) return;
+    }
+    catch(std::exception& e)
+    {
+        //a step that is still being written, it is parsed again with the next change. The frames parsed
+        //before it are shown, first was set before they were replaced
+        qDebug() << "following" << m_file << ":" << e.what();
+    }
+    emit framesChanged(first);
+}
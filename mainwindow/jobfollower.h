@@ -0,0 +1,54 @@
+/*****************************************************************************************
+                            jobfollower.h  -  description
+                             -------------------
+This file is part of the KryoMol project.
+For more information, see <http://kryomol.sourceforge.io/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+******************************************************************************************/
+
+#ifndef JOBFOLLOWER_H
+#define JOBFOLLOWER_H
+
+#include <QObject>
+#include <QString>
+
+namespace kryomol
+{
+class Parser;
+class Molecule;
+}
+
+class QFileSystemWatcher;
+class QTimer;
+
+/** @brief follow the output of a job that is still running
+
+The file is watched and, once the program stops writing for a moment, only the frames appended since the
+last update are parsed into the molecule. The frame that was last when the file was read before is parsed
+again, since it could be incomplete*/
+class JobFollower : public QObject
+{
+    Q_OBJECT
+public:
+    /** follow @param file, whose last job was parsed by @param parser into @param molecule.
+    The follower takes the ownership of the parser*/
+    JobFollower(const QString& file, kryomol::Parser* parser, kryomol::Molecule* molecule, QObject* parent=0);
+    ~JobFollower();
+signals:
+    /** emitted when the frames from @param first on were parsed again or appended*/
+    void framesChanged(size_t first);
+private slots:
+    void OnFileChanged(const QString& file);
+    void OnUpdate();
+private:
+    QString m_file;
+    kryomol::Parser* m_parser;
+    kryomol::Molecule* m_molecule;
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_timer;
+};
+
+#endif // JOBFOLLOWER_H
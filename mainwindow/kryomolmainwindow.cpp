@@ -6,6 +6,8 @@
 #include <sstream>
 #include <stdlib.h>
 #include <iostream>
+#include <map>
+#include <algorithm>
 
 #include "kryomolmainwindow.h"
 #include "qryomolapp.h"
@@ -15,6 +17,7 @@
 #include "parserfactory.h"
 #include "stringtools.h"
 #include "xyzwriter.h"
+#include "structurewriter.h"
 #include "aceswriter.h"
 #include "cpmdwriter.h"
 #include "kryovisor.h"
@@ -41,6 +44,8 @@
 #include <QStatusBar>
 #include <QDockWidget>
 #include <QTextEdit>
+#include <QInputDialog>
+#include <QtConcurrentRun>
 
 #include "qryomolinfo.h"
 #include "qjobwidget.h"
@@ -55,6 +60,8 @@
 #include "qjcdrawing.h"
 #include "qmeasurewidget.h"
 #include "openingthread.h"
+#include "folderloader.h"
+#include "parsecache.h"
 
 #ifdef __MINGW32__
 #include <filesystem>
@@ -270,6 +277,10 @@ void KryoMolMainWindow::Init()
     connect(exportXYZcurrentAction,SIGNAL( triggered() ),this,SLOT(OnExportGeomCurrent()));
     exportXYZmenu->addAction(exportXYZcurrentAction);
 
+    QAction* saveStructuresAction = new QAction( tr("Save Structures..."),this);
+    connect(saveStructuresAction,SIGNAL( triggered() ),this,SLOT(OnSaveStructures()));
+    exportgeommenu->addAction(saveStructuresAction);
+
     QMenu* extratoolsmenu= new QMenu(tr ( "Extra tools" ),this );
     editmenu->addMenu(extratoolsmenu);
     QAction* protonateTrigonalCenterAction = new QAction( tr("Protonate trigonal center"),this);
@@ -588,6 +599,10 @@ void KryoMolMainWindow::FinishGaussian()
     connect(exportXYZcurrentAction,SIGNAL( triggered() ),this,SLOT(OnExportGeomCurrent()));
     exportXYZmenu->addAction(exportXYZcurrentAction);
 
+    QAction* saveStructuresAction = new QAction( tr("Save Structures..."),this);
+    connect(saveStructuresAction,SIGNAL( triggered() ),this,SLOT(OnSaveStructures()));
+    exportgeommenu->addAction(saveStructuresAction);
+
     QMenu* extratoolsmenu= new QMenu(tr ( "Extra tools" ),this );
     editmenu->addMenu(extratoolsmenu);
     QAction* protonateTrigonalCenterAction = new QAction( tr("Protonate trigonal center"),this);
@@ -874,14 +889,57 @@ void KryoMolMainWindow::OnOpenFile(QString fname)
 
 
 
-    for(const auto& j : qparser->Jobs() )
+    //the parsers find the jobs again with every call
+    const std::vector<kryomol::JobHeader> jobs=qparser->Jobs();
+    //the last job is followed while it runs, it is parsed so that the parser knows its frames
+    const bool running=qparser->IsRunning();
+
+    //a file already parsed and not modified since is read from the cache, one molecule per job of each type
+    const kryomol::ParseCache cache;
+    const kryomol::ParseCache::Key key=kryomol::ParseCache::Identify(fname);
+    const kryomol::JobType cachedtypes[]={kryomol::opt,kryomol::freq,kryomol::dyn,kryomol::singlepoint};
+    std::map< kryomol::JobType,std::vector<kryomol::Molecule> > cached,parsed;
+    std::map<kryomol::JobType,size_t> next;
+    bool fromcache=!jobs.empty() && !running;
+    for(const auto t : cachedtypes )
     {
+        const size_t njobs=std::count_if(jobs.begin(),jobs.end(),
+                                         [t](const kryomol::JobHeader& j) { return j.type == t; });
+        unsigned flags=0;
+        if ( njobs > 0 && ( !cache.Load(key,t,cached[t],flags) || cached[t].size() != njobs ) )
+            fromcache=false;
+    }
+
+    //parse the job @param j into @param molecules, or take its molecule from the cache
+    auto parse=[&](const kryomol::JobHeader& j, std::vector<kryomol::Molecule>& molecules)
+    {
+        if ( fromcache )
+        {
+            molecules.push_back(cached[j.type][next[j.type]++]);
+            for(auto& f : molecules.back().Frames() )
+                f.SetParentMolecule(&molecules.back());
+            return;
+        }
+        qparser->SetMolecules( &molecules );
+        qparser->Parse(j.pos);
+        if ( j.type == kryomol::freq )
+            qparser->ParseFrequencies(j.pos);
+        if ( !molecules.empty() )
+            parsed[j.type].push_back(molecules.back());
+    };
+
+    //an optimization or a dynamics run that is the last job of the file can still be running
+    QJobOptWidget* lastopt=nullptr;
+    QJobDynWidget* lastdyn=nullptr;
+    for(const auto& j : jobs )
+    {
+        lastopt=nullptr;
+        lastdyn=nullptr;
         if ( j.type == kryomol::opt )
         {
             QJobOptWidget* w = new QJobOptWidget(m_tabwidget);
-            qparser->SetMolecules( &w->World()->Molecules() );
             try {
-                qparser->Parse(j.pos);
+                parse(j,w->World()->Molecules());
             }
             catch(...)
             {
@@ -893,19 +951,15 @@ void KryoMolMainWindow::OnOpenFile(QString fname)
 
             SetBondOrders();
             w->InitWidgets();
+            lastopt=w;
 
         }
 
         if ( j.type == kryomol::freq )
         {
             QJobFreqWidget* w = new QJobFreqWidget(fname,m_tabwidget);
-            qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
-            qparser->SetMolecules( &w->World()->Molecules() );
-            qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
-
             try {
-                qparser->Parse(j.pos);
-                qparser->ParseFrequencies(j.pos);
+                parse(j,w->World()->Molecules());
                 qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
                 qDebug() << "nframes=" << w->World()->Molecules().back().Frames().size() << endl;
             }
@@ -923,12 +977,8 @@ void KryoMolMainWindow::OnOpenFile(QString fname)
         if ( j.type == kryomol::dyn )
         {
             QJobDynWidget* w = new QJobDynWidget(m_tabwidget);
-            qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
-            qparser->SetMolecules( &w->World()->Molecules() );
-            qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
-
             try {
-                qparser->Parse(j.pos);
+                parse(j,w->World()->Molecules());
                 qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
                 qDebug() << "nframes=" << w->World()->Molecules().back().Frames().size() << endl;
             }
@@ -940,6 +990,7 @@ void KryoMolMainWindow::OnOpenFile(QString fname)
             ctab->addTab(w,"Dyn");
             SetBondOrders();
             w->InitWidgets();
+            lastdyn=w;
         }
 
         if ( j.type == kryomol::singlepoint )
@@ -948,12 +999,8 @@ void KryoMolMainWindow::OnOpenFile(QString fname)
             w->World()->SetHasDensity(m_hasdensity);
             w->World()->SetHasOrbitals(m_hasorbitals);
             w->World()->SetHasAlphaBetaOrbitals(m_hasalphabeta);
-            qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
-            qparser->SetMolecules( &w->World()->Molecules() );
-            qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
-
             try {
-                qparser->Parse(j.pos);
+                parse(j,w->World()->Molecules());
                 qDebug() << "nmol=" << w->World()->Molecules().size() << endl;
                 qDebug() << "nframes=" << w->World()->Molecules().back().Frames().size() << endl;
             }
@@ -969,7 +1016,31 @@ void KryoMolMainWindow::OnOpenFile(QString fname)
 
 
     }
-    delete qparser;
+    //a job still running is not stored, it would be parsed again when it grows. The entries are written by
+    //a thread of the pool from the copies of the parsed molecules, without blocking the window
+    if ( !fromcache && !running )
+    {
+        const unsigned flags=(m_hasdensity ? kryomol::ParseCache::DENSITY : 0) |
+                             (m_hasorbitals ? kryomol::ParseCache::ORBITALS : 0) |
+                             (m_hasalphabeta ? kryomol::ParseCache::ALPHABETA : 0);
+        QtConcurrent::run([cache,key,flags,parsed=std::move(parsed)]()
+        {
+            for(const auto& p : parsed )
+                cache.Store(key,p.first,p.second,flags);
+        });
+    }
+
+    //the parser reads the stream of the factory, it reads the file itself to follow the job.
+    //A job that wrote its termination does not grow any more
+    if ( running && ( lastopt || lastdyn ) && qparser->Reopen(fname) )
+    {
+        if ( lastopt )
+            lastopt->Follow(fname,qparser);
+        else
+            lastdyn->Follow(fname,qparser);
+    }
+    else
+        delete qparser;
 
     //Should this work ?
     //SetBondOrders();
@@ -1011,9 +1082,9 @@ void KryoMolMainWindow::OpenUVFolder(QString foldername)
     QDir dir(foldername);
     QFileInfoList flist=dir.entryInfoList(QDir::Files);
     //This should be a list of files containing the ecd computations
-    QStringList validfiles;
-    bool hasdensity=true;
-    bool hasorbitals=true;
+    FolderLoader loader(kryomol::uv,flist);
+    if ( !loader.Run(this,tr("Loading %1").arg(dir.canonicalPath())) ) return;
+
     QTabWidget* ftab = new QTabWidget(m_tabwidget);
     m_tabwidget->addTab(ftab,dir.canonicalPath());
 
@@ -1026,28 +1097,21 @@ void KryoMolMainWindow::OpenUVFolder(QString foldername)
     //m_glstack->update();
 
 
+    //the files are merged in the order of the folder
     m_hasdensity=m_hasorbitals=m_hasalphabeta=true;
-    for(int i=0;i<flist.size();++i)
+    for(const auto& r : loader.Results() )
     {
-        QString f=flist.at(i).absoluteFilePath();
-        qDebug() << "file=" << f << endl;
-#ifdef __MINGW32__
-        kryomol::ParserFactory factory(std::filesystem::u8path(f.toUtf8().data()));
-#else
-        kryomol::ParserFactory factory(f.toStdString().c_str());
-#endif
-        kryomol::Parser* qparser=factory.BuildParser();
-        if ( qparser == nullptr ) continue;
-        if ( !factory.existDensity() )
+        if ( !r.parsed ) continue;
+        if ( !r.hasdensity )
         {
             m_hasdensity=false;
         }
-        if ( !factory.existOrbitals() )
+        if ( !r.hasorbitals )
         {
             m_hasorbitals=false;
         }
 
-        if ( !factory.existAlphaBeta() )
+        if ( !r.hasalphabeta )
         {
             m_hasalphabeta=false;
         }
@@ -1056,29 +1120,22 @@ void KryoMolMainWindow::OpenUVFolder(QString foldername)
         world->SetHasOrbitals(m_hasorbitals);
         world->SetHasAlphaBetaOrbitals(m_hasalphabeta);
 
-        for(const auto& j : qparser->Jobs() )
+        for(const auto& mol : r.molecules )
         {
-            if ( j.type == kryomol::uv )
+            if ( world->Molecules().empty() )
             {
-                std::vector<Molecule> mol;
-                qparser->SetMolecules(&mol);
-                qparser->Parse(j.pos);
-                qparser->ParseUV(j.pos);
-                if ( world->Molecules().empty() )
-                {
-                    world->Molecules().push_back(mol.back());
-                }
-                else
-                {
-                    world->Molecules().back().Frames().push_back(mol.back().Frames().back());
-                }
-
-                world->Molecules().back().Frames().back().SetHasOrbitals(m_hasorbitals);
-
+                world->Molecules().push_back(mol);
             }
+            else
+            {
+                world->Molecules().back().Frames().push_back(mol.Frames().back());
+            }
+
+            world->Molecules().back().Frames().back().SetHasOrbitals(m_hasorbitals);
         }
-        delete qparser;
     }
+    ReportFolderErrors(loader);
+    if ( world->Molecules().empty() ) return;
 
     qDebug() << "nframes=" << world->Molecules().back().Frames().size() << endl;
     //Should this work ?
@@ -1095,60 +1152,48 @@ void KryoMolMainWindow::OpenIRFolder(QString foldername)
     QDir dir(foldername);
     QFileInfoList flist=dir.entryInfoList(QDir::Files);
     //This should be a list of files containing the ecd computations
-    QStringList validfiles;
-    //bool hasdensity=true;
-    //bool hasorbitals=true;
+    FolderLoader loader(kryomol::freq,flist);
+    if ( !loader.Run(this,tr("Loading %1").arg(dir.canonicalPath())) ) return;
 
     QJobFreqWidget* juv= new QJobFreqWidget(foldername,this);
 
     m_tabwidget->addTab( juv,"Freq" );
     kryomol::World* world = juv->World();
 
+    //the files are merged in the order of the folder
     m_hasdensity=m_hasorbitals=m_hasalphabeta=true;
-    for(int i=0;i<flist.size();++i)
+    for(const auto& r : loader.Results() )
     {
-        QString f=flist.at(i).absoluteFilePath();
-#ifdef __MINGW32__
-        kryomol::ParserFactory factory(std::filesystem::u8path(f.toUtf8().data()));
-#else
-        kryomol::ParserFactory factory(f.toStdString().c_str());
-#endif
-        kryomol::Parser* qparser=factory.BuildParser();
-        if ( !factory.existDensity() )
+        if ( !r.parsed ) continue;
+        if ( !r.hasdensity )
         {
             m_hasdensity=false;
         }
-        if ( !factory.existOrbitals() )
+        if ( !r.hasorbitals )
         {
             m_hasorbitals=false;
         }
 
-        if ( !factory.existAlphaBeta() )
+        if ( !r.hasalphabeta )
         {
             m_hasalphabeta=false;
         }
 
-        for(const auto& j : qparser->Jobs() )
+        for(const auto& mol : r.molecules )
         {
-            if ( j.type == kryomol::freq )
+            if ( world->Molecules().empty() )
             {
-                std::vector<Molecule> mol;
-                qparser->SetMolecules(&mol);
-                qparser->Parse(j.pos);
-                qparser->ParseFrequencies(j.pos);
-                if ( world->Molecules().empty() )
-                {
-                    world->Molecules().push_back(mol.back());
-                }
-                else
-                {
-                    world->Molecules().back().Frames().push_back(mol.back().Frames().back());
-                }
-
+                world->Molecules().push_back(mol);
             }
+            else
+            {
+                world->Molecules().back().Frames().push_back(mol.Frames().back());
+            }
+
         }
-        delete qparser;
     }
+    ReportFolderErrors(loader);
+    if ( world->Molecules().empty() ) return;
 
     qDebug() << "nframes=" << world->Molecules().back().Frames().size() << endl;
 
@@ -1158,6 +1203,13 @@ void KryoMolMainWindow::OpenIRFolder(QString foldername)
     //this->InitWidgets(kryomol::freq,m_hasdensity,m_hasorbitals);
 }
 
+void KryoMolMainWindow::ReportFolderErrors(const FolderLoader& loader)
+{
+    QStringList errors=loader.Errors();
+    if ( errors.isEmpty() ) return;
+    QMessageBox::warning(this,tr("Error loading folder"),tr("The following files could not be loaded:\n")+errors.join("\n"));
+}
+
 void KryoMolMainWindow::InitWidgets(kryomol::JobType t,bool hasdensity,bool hasorbitals)
 {
     //Build the stacked widget for holding the different type of jobs
@@ -1963,7 +2015,7 @@ void KryoMolMainWindow::OnFirstFrame()
 void KryoMolMainWindow::OnLastFrame()
 {
     kryomol::World* w=this->GetCurrentWorld();
-    if ( w )  w->SelectFrame ( w->CurrentMolecule()->Frames().size()-1 );
+    if ( w )  w->SelectFrame ( w->CurrentMolecule()->FrameCount()-1 );
 }
 
 void KryoMolMainWindow::OnNextFrame()
@@ -2227,6 +2279,43 @@ void KryoMolMainWindow::OnExportGeom()
 
 }
 
+void KryoMolMainWindow::OnSaveStructures()
+{
+    kryomol::World* w=this->GetCurrentWorld();
+    if ( !w || !w->CurrentMolecule() ) return;
+
+    QString filter;
+    QString s=QFileDialog::getSaveFileName ( this,tr ( "Save Structures" ),QDir::home().canonicalPath(),
+                                             tr ( "XYZ (*.xyz *.xyz.gz);;SD (*.sdf *.sdf.gz);;PDB (*.pdb *.pdb.gz)" ),&filter );
+    if ( s.isEmpty() ) return;
+
+    kryomol::StructureWriter::Format format;
+    bool gzip;
+    if ( !kryomol::StructureWriter::FormatOf ( s,format,gzip ) )
+    {
+        //the extension of the filter chosen
+        format=filter.startsWith ( "SD" ) ? kryomol::StructureWriter::SDF :
+               filter.startsWith ( "PDB" ) ? kryomol::StructureWriter::PDB : kryomol::StructureWriter::XYZ;
+        s+= format == kryomol::StructureWriter::SDF ? ".sdf" : format == kryomol::StructureWriter::PDB ? ".pdb" : ".xyz";
+    }
+
+    kryomol::StructureWriter writer ( w->CurrentMolecule(),format );
+    //all the conformers or the one shown
+    if ( w->CurrentMolecule()->FrameCount() > 1 )
+    {
+        const QStringList choices=QStringList() << tr ( "All conformers" ) << tr ( "Current conformer" );
+        bool ok=false;
+        const QString choice=QInputDialog::getItem ( this,tr ( "Save Structures" ),tr ( "Conformers" ),choices,0,false,&ok );
+        if ( !ok ) return;
+        if ( choice == choices.at ( 1 ) )
+            writer.SetFrames ( std::vector<size_t> ( 1,w->CurrentMolecule()->CurrentFrameIndex() ) );
+    }
+    if ( !writer.Write ( s ) )
+    {
+        QMessageBox::warning ( this,tr ( "Save Structures" ),tr ( "Could not write " ) +s );
+    }
+}
+
 void KryoMolMainWindow::OnExportACES()
 {
 
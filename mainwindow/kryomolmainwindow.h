@@ -41,6 +41,7 @@ class RenderOrbitals;
 }
 
 class OrcaDialog;
+class FolderLoader;
 
 
 class KryoMolMainWindow : public QMainWindow
@@ -61,6 +62,8 @@ private:
     void OpenFile();
     void OpenUVFolder(QString foldername);
     void OpenIRFolder(QString foldername);
+    /** warn about the files of a folder that could not be parsed*/
+    void ReportFolderErrors(const FolderLoader& loader);
     void Init();
     void InitToolBars();
     void InitGaussian();
@@ -110,6 +113,7 @@ private slots:
     void OnExportRasterGraphics();
     void OnExportGeom();
     void OnExportGeomCurrent();
+    void OnSaveStructures();
     void OnExportACES();
     void OnExportCPMD();
     void OnExportGaussian(bool whithessian=false);
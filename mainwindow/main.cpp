@@ -10,6 +10,8 @@ the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
 
+#include <clocale>
+
 #include "kryomolmainwindow.h"
 #include "qryomolapp.h"
 #include "iostream"
@@ -18,6 +20,10 @@ the Free Software Foundation version 2 of the License.
 int main(int argc, char *argv[])
 {
     kryomol::KryoMolApplication a(argc, argv);
+    //the files are read with the C numeric locale, the application shows the numbers with QLocale.
+    //Set once here, after Qt sets the locale of the system, so the parsers running in several threads
+    //never have to change it
+    std::setlocale(LC_NUMERIC,"C");
 
     KryoMolMainWindow *mw=NULL;
     int nargs;
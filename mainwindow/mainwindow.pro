@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core gui opengl svg
+QT += core gui opengl svg concurrent
 
 TARGET = KryoMol
 TEMPLATE = app
@@ -86,6 +86,8 @@ SOURCES += main.cpp \
     orcadialog.cpp \
     orcaengine.cpp \
     kryomolmainwindow.cpp \
+    folderloader.cpp \
+    jobfollower.cpp \
     qjoboptwidget.cpp \
     qjobfreqwidget.cpp \
     qjobwidget.cpp \
@@ -95,6 +97,8 @@ SOURCES += main.cpp \
     qjobdynwidget.cpp
 
 HEADERS  += kryomolmainwindow.h \
+    folderloader.h \
+    jobfollower.h \
     orcadialog.h \
     orcaengine.h \
     qjoboptwidget.h \
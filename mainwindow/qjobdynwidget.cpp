@@ -4,14 +4,20 @@
 #include "molecule.h"
 #include "qconvwidget.h"
 #include "kryovisor.h"
+#include "jobfollower.h"
 
 #include <QDockWidget>
 
-QJobDynWidget::QJobDynWidget(QWidget *parent) : QJobWidget(parent)
+QJobDynWidget::QJobDynWidget(QWidget *parent) : QJobWidget(parent), m_follower(NULL)
 {
     m_world = new kryomol::World(kryomol::World::optvisor);
 }
 
+QJobDynWidget::~QJobDynWidget()
+{
+    delete m_follower;
+}
+
 void QJobDynWidget::InitWidgets()
 {
     World()->Visor()->Initialize();
@@ -65,3 +71,23 @@ void QJobDynWidget::InitWidgets()
     connect ( World(),SIGNAL ( currentFrame(size_t ) ),m_dynwidget,SLOT ( OnSelectedPoint ( size_t ) ) );
     m_dynwidget->OnSelectedPoint ( World()->CurrentMolecule()->CurrentFrameIndex());*/
 }
+
+void QJobDynWidget::Follow(const QString& file, kryomol::Parser* parser)
+{
+    delete m_follower;
+    //every step of a dynamics run is shown, so the frames are parsed into the molecule of the world
+    m_follower = new JobFollower(file,parser,&World()->Molecules().back(),this);
+    connect ( m_follower,SIGNAL ( framesChanged ( size_t ) ),this,SLOT ( OnFramesChanged ( size_t ) ) );
+}
+
+void QJobDynWidget::OnFramesChanged(size_t /*first*/)
+{
+    kryomol::Molecule& molecule=World()->Molecules().back();
+    if ( molecule.Frames().empty() ) return;
+    m_dynwidget->Resize(molecule.Frames().size());
+
+    if ( molecule.CurrentFrameIndex() >= molecule.Frames().size() )
+        World()->SelectFrame(molecule.Frames().size()-1);
+    else
+        World()->Visor()->update();
+}
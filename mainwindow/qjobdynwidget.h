@@ -3,17 +3,30 @@
 
 #include "qjobwidget.h"
 
+namespace kryomol
+{
+class Parser;
+}
+
 class QConvWidget;
+class JobFollower;
 class QJobDynWidget : public QJobWidget
 {
     Q_OBJECT
 public:
     explicit QJobDynWidget(QWidget *parent = 0);
+    ~QJobDynWidget();
     void InitWidgets();
+    /** show the new steps written to @param file while the dynamics runs.
+    The widget takes the ownership of @param parser, that parsed the job*/
+    void Follow(const QString& file, kryomol::Parser* parser);
 
+private slots:
+    void OnFramesChanged(size_t first);
 
 private:
     QConvWidget* m_dynwidget;
+    JobFollower* m_follower;
 };
 
 #endif // QJOBDYNWIDGET_H
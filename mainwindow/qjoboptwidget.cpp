@@ -9,8 +9,11 @@ it under the terms of the GNU General Public License as published by
 the Free Software Foundation version 2 of the License.
 ******************************************************************************************/
 
+#include <algorithm>
+
 #include "qjoboptwidget.h"
 #include "qconvwidget.h"
+#include "jobfollower.h"
 
 #include "world.h"
 #include "glvisor.h"
@@ -20,13 +23,14 @@ the Free Software Foundation version 2 of the License.
 
 #include <QDockWidget>
 
-QJobOptWidget::QJobOptWidget(QWidget* parent ) : QJobWidget (parent)
+QJobOptWidget::QJobOptWidget(QWidget* parent ) : QJobWidget (parent), m_follower(NULL)
 {
     m_world = new kryomol::World(this,kryomol::World::optvisor);
 }
 
 QJobOptWidget::~QJobOptWidget()
 {
+    delete m_follower;
 }
 
 
@@ -53,47 +57,21 @@ void QJobOptWidget::InitWidgets()
 
 
 
-    std::vector<kryomol::Frame> frames;
-    std::vector<kryomol::Frame>::iterator mt;
-    //remember to modify this horror
-    for (mt=World()->Molecules().back().Frames().begin();mt!=World()->Molecules().back().Frames().end();mt++)
-    {
-        if ((mt->PotentialEnergy()) && (mt->RMSForce()))
-            frames.push_back(*mt);
-    }
-    World()->Molecules().back().Frames().erase(World()->Molecules().back().Frames().begin(),World()->Molecules().back().Frames().end());
-    for(mt=frames.begin();mt!=frames.end();mt++)
-    {
-        World()->Molecules().back().Frames().push_back(*mt);
-    }
+    //the frames without energy or forces are not shown, all of them are kept to follow the job
+    m_parsed=World()->Molecules().back();
+    for(auto& f : m_parsed.Frames() )
+        f.SetParentMolecule(&m_parsed);
+    World()->Molecules().back().Frames().clear();
+    m_source.clear();
+    AppendFrames(0);
 
     m_convwidget->SetNData ( World()->Molecules().back().Frames().size() );
-    double* energies=m_convwidget->GetEnergies();
-    double* s2= m_convwidget->GetS2();
-    double* rmsforce=m_convwidget->GetRMSForces();
-    double* maximumforce=m_convwidget->GetMaximumForces();
-    double* rmsdisplacement=m_convwidget->GetRMSDisplacements();
-    double* maximumdisplacement=m_convwidget->GetMaximumDisplacements();
     m_convwidget->SetEnergyLevel ( World()->Molecules().back().GetEnergyLevel().c_str() );
 
-    if ( energies )
+    if ( !World()->Molecules().back().Frames().empty() )
     {
-        std::vector<kryomol::Frame>::iterator mt;
-        mt=World()->Molecules().back().Frames().begin();
-        m_convwidget->SetThreshold ( mt->GetThreshold() );
-
-        int i=0;
-        mt=World()->Molecules().back().Frames().begin();
-        for ( i=0;mt!=World()->Molecules().back().Frames().end();mt++,i++ )
-        {
-            energies[i]=mt->GetEnergy();
-            s2[i]=mt->GetS2();
-            rmsforce[i]=mt->GetRMSForce();
-            maximumforce[i]=mt->GetMaximumForce();
-            rmsdisplacement[i]=mt->GetRMSDisplacement();
-            maximumdisplacement[i]=mt->GetMaximumDisplacement();
-        }
-
+        m_convwidget->SetThreshold ( World()->Molecules().back().Frames().front().GetThreshold() );
+        SetConvergence(0);
     }
 
     //Initialize the visor and actions of the widget
@@ -106,3 +84,71 @@ void QJobOptWidget::InitWidgets()
     connect ( m_convwidget,SIGNAL ( showforces( bool ) ),World()->Visor(),SLOT ( OnShowForces( bool ) ) );
 
 }
+
+void QJobOptWidget::Follow(const QString& file, kryomol::Parser* parser)
+{
+    delete m_follower;
+    m_follower = new JobFollower(file,parser,&m_parsed,this);
+    connect ( m_follower,SIGNAL ( framesChanged ( size_t ) ),this,SLOT ( OnFramesChanged ( size_t ) ) );
+}
+
+/** append to the world the frames of m_parsed from @param first on that have energy and forces*/
+void QJobOptWidget::AppendFrames(size_t first)
+{
+    std::vector<kryomol::Frame>& frames=World()->Molecules().back().Frames();
+    for ( size_t i=first;i<m_parsed.Frames().size();i++ )
+    {
+        const kryomol::Frame& f=m_parsed.Frames()[i];
+        if ( f.PotentialEnergy() && f.RMSForce() )
+        {
+            frames.push_back(f);
+            frames.back().SetParentMolecule(&World()->Molecules().back());
+            m_source.push_back(i);
+        }
+    }
+}
+
+/** copy the convergence of the frames of the world from @param first on to the plots*/
+void QJobOptWidget::SetConvergence(size_t first)
+{
+    double* energies=m_convwidget->GetEnergies();
+    double* s2= m_convwidget->GetS2();
+    double* rmsforce=m_convwidget->GetRMSForces();
+    double* maximumforce=m_convwidget->GetMaximumForces();
+    double* rmsdisplacement=m_convwidget->GetRMSDisplacements();
+    double* maximumdisplacement=m_convwidget->GetMaximumDisplacements();
+
+    const std::vector<kryomol::Frame>& frames=World()->Molecules().back().Frames();
+    for ( size_t i=first;i<frames.size();i++ )
+    {
+        energies[i]=frames[i].GetEnergy();
+        s2[i]=frames[i].GetS2();
+        rmsforce[i]=frames[i].GetRMSForce();
+        maximumforce[i]=frames[i].GetMaximumForce();
+        rmsdisplacement[i]=frames[i].GetRMSDisplacement();
+        maximumdisplacement[i]=frames[i].GetMaximumDisplacement();
+    }
+}
+
+void QJobOptWidget::OnFramesChanged(size_t first)
+{
+    kryomol::Molecule& molecule=World()->Molecules().back();
+    //the view moves to the new steps only if the user was looking at the last one
+    const bool last=molecule.CurrentFrameIndex()+1 >= molecule.Frames().size();
+
+    //the frames of the world from the first one parsed again are replaced
+    const size_t shown=std::lower_bound(m_source.begin(),m_source.end(),first)-m_source.begin();
+    molecule.Frames().erase(molecule.Frames().begin()+shown,molecule.Frames().end());
+    m_source.resize(shown);
+    AppendFrames(first);
+    if ( molecule.Frames().empty() ) return;
+
+    m_convwidget->Resize(molecule.Frames().size());
+    SetConvergence(shown);
+    m_convwidget->UpdateCurves(shown);
+
+    if ( last || molecule.CurrentFrameIndex() >= molecule.Frames().size() )
+        World()->SelectFrame(molecule.Frames().size()-1);
+    else
+        World()->Visor()->update();
+}
@@ -12,17 +12,23 @@ the Free Software Foundation version 2 of the License.
 #ifndef QJOBOPTWIDGET_H
 #define QJOBOPTWIDGET_H
 
+#include <vector>
+
 #include <QWidget>
 
 #include "qjobwidget.h"
 #include "qconvwidget.h"
+#include "molecule.h"
 
 namespace kryomol
 {
 class World;
+class Parser;
 
 };
 
+class JobFollower;
+
 class QJobOptWidget : public QJobWidget
 {
 
@@ -32,12 +38,25 @@ public:
     QJobOptWidget(QWidget* parent = 0);
     ~QJobOptWidget();
     void InitWidgets();
+    /** show the new steps written to @param file while the optimization runs.
+    The widget takes the ownership of @param parser, that parsed the job*/
+    void Follow(const QString& file, kryomol::Parser* parser);
+
+private slots:
+    void OnFramesChanged(size_t first);
 
 private:
     void Init();
+    void AppendFrames(size_t first);
+    void SetConvergence(size_t first);
 
 private:
     QConvWidget* m_convwidget;
+    /** all the frames parsed, the molecule of the world only keeps the ones with energy and forces*/
+    kryomol::Molecule m_parsed;
+    /** index in m_parsed of each frame of the world*/
+    std::vector<size_t> m_source;
+    JobFollower* m_follower;
 
 };
 
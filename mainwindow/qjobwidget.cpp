@@ -19,10 +19,12 @@ the Free Software Foundation version 2 of the License.
 #include "qorbitalwidget.h"
 #include "qmolecularlistcontrol.h"
 #include "renderorbitals.h"
+#include "exception.h"
 
 #include <QDockWidget>
+#include <QMessageBox>
 
-QJobWidget::QJobWidget(QWidget* parent) : QMainWindow (parent), m_world (nullptr)
+QJobWidget::QJobWidget(QWidget* parent) : QMainWindow (parent), m_world (nullptr), m_measures (nullptr)
 {
     m_tabwidget = new QTabWidget();
     //This is necessary to the right docked widget occupy the whole height
@@ -83,11 +85,18 @@ void QJobWidget::InitCommonWidgets()
 
     m_tabwidget->addTab(new QPDBControl(m_tabwidget),"PDB Info");
     QMeasureWidget* mw=new QMeasureWidget(m_tabwidget);
+    m_measures=mw;
     m_tabwidget->addTab(mw,"Measure");
     //m_tabwidget->addTab(new QOrbitalWidget(m_tabwidget),"Density");
     //Add measure connections
     //CONNECTIONS
     connect( m_world->Visor(), SIGNAL ( distance ( QString& ) ), mw, SLOT ( OnWriteDistance ( QString& ) ) );
+    connect( m_world->Visor(), SIGNAL ( angle ( QString& ) ), mw, SLOT ( OnWriteAngle ( QString& ) ) );
+    connect( m_world->Visor(), SIGNAL ( dihedral ( QString& ) ), mw, SLOT ( OnWriteDihedral ( QString& ) ) );
+    connect( m_world->Visor(), SIGNAL ( distance ( QString& ) ), this, SLOT ( OnUpdateMeasureSeries() ) );
+    connect( m_world->Visor(), SIGNAL ( angle ( QString& ) ), this, SLOT ( OnUpdateMeasureSeries() ) );
+    connect( m_world->Visor(), SIGNAL ( dihedral ( QString& ) ), this, SLOT ( OnUpdateMeasureSeries() ) );
+    connect( m_world, SIGNAL ( currentFrame ( size_t ) ), this, SLOT ( OnUpdateMeasures ( size_t ) ) );
     //connect( m_world->Visor(), SIGNAL ( angle ( QString& ) ), m_measures, SLOT ( OnWriteAngle ( QString& ) ) );
     //connect( m_world->Visor(), SIGNAL ( dihedral ( QString& ) ), m_measures, SLOT ( OnWriteDihedral ( QString& ) ) );
     //connect(m_world, SIGNAL ( currentFrame ( size_t ) ), this, SLOT ( OnUpdateMeasures ( size_t )) );*/
@@ -102,6 +111,14 @@ void QJobWidget::InitCommonWidgets()
         QOrbitalWidget* ow= new QOrbitalWidget(m_tabwidget);
         ow->SetWorld(m_world);
         m_tabwidget->addTab(ow,"Density");
+        try
+        {
+            m_world->CurrentMolecule()->CurrentFrame().LoadData(kryomol::Frame::ORBITALS);
+        }
+        catch(const kryomol::Exception& e)
+        {
+            QMessageBox::critical(this,"",QString(e.what()));
+        }
         ow->SetRenderOrbitals(kryomol::RenderOrbitals(
                                   m_world->CurrentMolecule()->CurrentFrame()));
         connect(m_world, SIGNAL ( currentFrame ( size_t ) ), ow, SLOT ( OnSetFrame ( size_t )) );
@@ -154,3 +171,23 @@ void QJobWidget::InitCommonWidgets()
 
 }
 
+void QJobWidget::OnUpdateMeasures(size_t frame)
+{
+    if ( !m_measures ) return;
+    //all the frames were evaluated when the measures were defined, this only reads the values
+    QStringList distances=m_world->Visor()->GetDistances(frame);
+    QStringList angles=m_world->Visor()->GetAngles(frame);
+    QStringList dihedrals=m_world->Visor()->GetDihedrals(frame);
+    if ( !distances.empty() )
+        m_measures->updateDistances(distances);
+    if ( !angles.empty() )
+        m_measures->updateAngles(angles);
+    if ( !dihedrals.empty() )
+        m_measures->updateDihedrals(dihedrals);
+}
+
+void QJobWidget::OnUpdateMeasureSeries()
+{
+    if ( !m_measures ) return;
+    m_measures->SetSeries(m_world->Visor()->MeasureSeries());
+}
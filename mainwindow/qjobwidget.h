@@ -28,6 +28,7 @@ class QDockWidget;
 class QTabWidget;
 
 class QOrbitalWidget;
+class QMeasureWidget;
 class QJobWidget : public QMainWindow
 {
 
@@ -41,6 +42,9 @@ public:
     //void SetWorld(kryomol::World* world) {m_world = world;}
     QList<QDockWidget*> DockWidgets() const { return m_dockwidgets; }
     virtual void InitWidgets() {}
+protected slots:
+    void OnUpdateMeasures(size_t frame);
+    void OnUpdateMeasureSeries();
 protected:
     void InitCommonWidgets();
     virtual void showEvent(QShowEvent *event);
@@ -50,6 +54,7 @@ protected:
     kryomol::World* m_world;
     QList<QDockWidget*> m_dockwidgets;
     QTabWidget* m_tabwidget;
+    QMeasureWidget* m_measures;
 
 };
 